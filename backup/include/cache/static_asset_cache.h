@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <ctime>
+
+namespace zbackup::cache
+{
+    // 单个静态资源，加载后不可变
+    struct StaticAsset
+    {
+        std::string content;      // 原始内容
+        std::string gzip_content; // gzip预压缩内容（不可压缩时为空）
+        std::string br_content;   // brotli预压缩内容（不可压缩时为空）
+        std::string mime_type;    // MIME类型
+        std::string etag;         // 原始内容的校验标签
+        std::string gzip_etag;    // gzip内容的校验标签，各编码的字节不同，强ETag不能共用
+        std::string br_etag;      // brotli内容的校验标签
+        time_t mtime = 0;         // 最后修改时间
+    };
+
+    // 静态资源内存缓存：启动时整体加载资源目录，通过inotify监听变化并整体替换
+    class StaticAssetCache
+    {
+    public:
+        using ptr = std::shared_ptr<StaticAssetCache>;
+        using AssetPtr = std::shared_ptr<const StaticAsset>;
+        using AssetMap = std::unordered_map<std::string, AssetPtr>; // 相对路径 -> 资源
+
+        explicit StaticAssetCache(std::string root_dir, size_t min_compress_size = 256);
+        ~StaticAssetCache();
+
+        StaticAssetCache(const StaticAssetCache &) = delete;
+        StaticAssetCache &operator=(const StaticAssetCache &) = delete;
+
+        // 重新加载整个资源目录，成功后原子替换当前快照
+        bool load();
+
+        // 启动/停止目录监听线程
+        bool start_watch();
+        void stop_watch();
+
+        // 按相对路径查找资源（如 "index.html"），不存在返回nullptr
+        AssetPtr find(const std::string &path) const;
+        size_t size() const;
+
+    private:
+        std::shared_ptr<const AssetMap> build_assets() const;
+        AssetPtr build_asset(const std::string &file_path) const;
+        bool add_watches();
+        void watch_loop();
+
+        static std::string get_mime_type(const std::string &extension);
+        static bool is_compressible(const std::string &mime_type);
+
+        std::string root_dir_;
+        size_t min_compress_size_; // 小于该大小的资源不做预压缩
+        std::shared_ptr<const AssetMap> assets_; // 当前快照，通过std::atomic_load/atomic_store访问
+
+        std::atomic<bool> stop_;
+        int inotify_fd_;
+        int wakeup_fd_; // 用于唤醒监听线程退出
+        std::thread watch_thread_;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+
+namespace zbackup
+{
+    // HTTP内容编码（Content-Encoding）压缩实现，数据在内存中一次性处理
+    class ContentCodec
+    {
+    public:
+        static constexpr int DEFAULT_LEVEL = -1; // 使用各算法的默认压缩级别
+
+        static bool gzip(const std::string &input, std::string *output, int level = DEFAULT_LEVEL);
+        static bool deflate(const std::string &input, std::string *output, int level = DEFAULT_LEVEL);
+        static bool brotli(const std::string &input, std::string *output, int quality = DEFAULT_LEVEL);
+
+        // 按编码名称（gzip/deflate/br）压缩，不支持的编码返回false
+        static bool encode(const std::string &encoding, const std::string &input, std::string *output,
+                           int level = DEFAULT_LEVEL);
+
+    private:
+        static bool zlib_compress(const std::string &input, std::string *output, int level, int window_bits);
+    };
+}
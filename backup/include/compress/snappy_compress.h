@@ -10,5 +10,6 @@ namespace zbackup
     public:
         bool compress(const std::string& source_path, const std::string& target_path) override; // 使用Snappy压缩
         bool un_compress(const std::string& target_path, const std::string& source_path) override; // 使用Snappy解压
+        bool un_compress_to(const std::string& source_path, char* data, size_t len) override; // 解压到内存
     };
 }
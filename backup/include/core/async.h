@@ -0,0 +1,279 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "core/task_graph.h"
+
+namespace zbackup::core
+{
+    // C++20 协程支持：处理器与存储层返回 Async<T>，在 co_await 阻塞调用时挂起，释放所在的工作线程
+    // 挂起的协程在被等待的操作完成后，回到挂起前所在的线程池通道继续执行（不在线程池中时就地继续）
+
+    template<typename T>
+    class Async;
+
+    namespace detail
+    {
+        // 让协程在指定通道恢复执行；线程池已退出时就地恢复，避免协程帧泄漏
+        inline void resume_on(bool has_lane, TaskLane lane, TaskPriority priority, std::coroutine_handle<> handle)
+        {
+            if (has_lane && ThreadPool::get_instance(lane)->post_continuation(
+                                priority, [handle]() { handle.resume(); }) == SubmitStatus::ACCEPTED)
+            {
+                return;
+            }
+            handle.resume();
+        }
+
+        // 协程结束时把执行权转移给等待者，没有等待者时直接返回
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                auto continuation = handle.promise().continuation();
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        // Async<T> 的 promise 公共部分：惰性启动，结束时对称转移到等待者
+        class AsyncPromiseBase
+        {
+        public:
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            void unhandled_exception() { error_ = std::current_exception(); }
+
+            void set_continuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+            [[nodiscard]] std::coroutine_handle<> continuation() const { return continuation_; }
+
+            void rethrow_if_failed() const
+            {
+                if (error_)
+                {
+                    std::rethrow_exception(error_);
+                }
+            }
+
+        private:
+            std::coroutine_handle<> continuation_; // 等待本协程结果的协程
+            std::exception_ptr error_;
+        };
+
+        template<typename T>
+        class AsyncPromise final : public AsyncPromiseBase
+        {
+        public:
+            Async<T> get_return_object();
+
+            template<typename U>
+            void return_value(U &&value) { value_.emplace(std::forward<U>(value)); }
+
+            T take()
+            {
+                rethrow_if_failed();
+                return std::move(*value_);
+            }
+
+        private:
+            std::optional<T> value_;
+        };
+
+        template<>
+        class AsyncPromise<void> final : public AsyncPromiseBase
+        {
+        public:
+            Async<void> get_return_object();
+
+            void return_void() {}
+
+            void take() { rethrow_if_failed(); }
+        };
+
+        // 分离执行的驱动协程：立即挂起，由线程池恢复，结束时自行销毁
+        struct DetachedCoroutine
+        {
+            struct promise_type
+            {
+                DetachedCoroutine get_return_object()
+                {
+                    return {std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() {}
+                void unhandled_exception() { std::terminate(); }
+            };
+
+            std::coroutine_handle<promise_type> handle;
+        };
+    }
+
+    // 惰性协程任务：被 co_await 时才开始执行，结果或异常通过 co_await 返回
+    template<typename T>
+    class [[nodiscard]] Async
+    {
+    public:
+        using promise_type = detail::AsyncPromise<T>;
+
+        explicit Async(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+        Async(Async &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+        Async &operator=(Async &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_)
+                    handle_.destroy();
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+
+        Async(const Async &) = delete;
+        Async &operator=(const Async &) = delete;
+
+        ~Async()
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+        }
+
+        auto operator co_await() && noexcept
+        {
+            struct Awaiter
+            {
+                std::coroutine_handle<promise_type> handle;
+
+                bool await_ready() noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    handle.promise().set_continuation(awaiting);
+                    return handle;
+                }
+
+                T await_resume() { return handle.promise().take(); }
+            };
+            return Awaiter{handle_};
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        Async<T> AsyncPromise<T>::get_return_object()
+        {
+            return Async<T>(std::coroutine_handle<AsyncPromise<T> >::from_promise(*this));
+        }
+
+        inline Async<void> AsyncPromise<void>::get_return_object()
+        {
+            return Async<void>(std::coroutine_handle<AsyncPromise<void> >::from_promise(*this));
+        }
+
+        template<typename T>
+        DetachedCoroutine drive(Async<T> task, std::shared_ptr<TaskState<T> > state)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await std::move(task);
+                    state->set_value();
+                }
+                else
+                {
+                    state->set_value(co_await std::move(task));
+                }
+            }
+            catch (...)
+            {
+                state->abort(TaskStatus::FAILED, std::current_exception());
+            }
+        }
+    }
+
+    // 在指定通道启动协程（非阻塞提交），返回可等待的结果；队列满时结果为 REJECTED
+    template<typename T>
+    TaskFuture<T> spawn_coroutine(TaskLane lane, TaskPriority priority, Async<T> task)
+    {
+        auto state = std::make_shared<detail::TaskState<T> >(CancellationToken());
+        auto handle = detail::drive(std::move(task), state).handle;
+        auto status = ThreadPool::get_instance(lane)->try_post_task(priority, [handle]() { handle.resume(); });
+        if (status != SubmitStatus::ACCEPTED)
+        {
+            handle.destroy();
+            state->abort(TaskStatus::REJECTED);
+        }
+        return TaskFuture<T>(state);
+    }
+
+    // 把阻塞调用卸载到指定通道执行，用于已接纳请求内部的存储与文件操作（不受队列上限限制）
+    template<typename Func>
+    auto offload(TaskLane lane, TaskPriority priority, Func &&func)
+        -> TaskFuture<std::invoke_result_t<std::decay_t<Func> &> >
+    {
+        using R = std::invoke_result_t<std::decay_t<Func> &>;
+        auto state = std::make_shared<detail::TaskState<R> >(CancellationToken());
+        auto status = ThreadPool::get_instance(lane)->post_continuation(
+            priority, [state, func = std::decay_t<Func>(std::forward<Func>(func))]() mutable
+            {
+                detail::run_stage(*state, func);
+            });
+        if (status != SubmitStatus::ACCEPTED)
+        {
+            state->abort(TaskStatus::REJECTED);
+        }
+        return TaskFuture<R>(state);
+    }
+
+    // 数据库与文件读写都是阻塞调用，统一在IO线程池以高优先级执行
+    template<typename Func>
+    auto offload_io(Func &&func)
+    {
+        return offload(TaskLane::IO, TaskPriority::HIGH, std::forward<Func>(func));
+    }
+
+    // 等待任务图结果：成功返回结果，失败重新抛出异常，取消或被拒绝时抛出 TaskAbortedError
+    template<typename T>
+    auto operator co_await(TaskFuture<T> future)
+    {
+        struct Awaiter
+        {
+            TaskFuture<T> future;
+
+            bool await_ready() const { return future.is_ready(); }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                TaskLane lane = TaskLane::CPU;
+                bool has_lane = ThreadPool::current_lane(&lane);
+                // 回调可能在其他线程立即恢复协程并销毁本等待器，注册时使用局部副本
+                TaskFuture<T> pending = future;
+                pending.finally([has_lane, lane, handle](TaskStatus)
+                {
+                    detail::resume_on(has_lane, lane, TaskPriority::HIGH, handle);
+                });
+            }
+
+            typename TaskFuture<T>::Result await_resume() const { return future.get(); }
+        };
+        return Awaiter{std::move(future)};
+    }
+}
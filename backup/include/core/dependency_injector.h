@@ -9,6 +9,9 @@
 #include "interfaces/handler_factory_interface.h"
 #include "interfaces/route_registry_interface.h"
 #include "interfaces/compress_interface.h"
+#include "cache/static_asset_cache.h"
+#include "data/snapshot_manager.h"
+#include "storage/blob/blob_tiers.h"
 #include <memory>
 #include <string>
 
@@ -66,6 +69,7 @@ namespace zbackup::core
         void step5_create_and_register_compressor();
         void step6_create_and_register_auth_layer();
         void step7_create_and_register_factory_and_registry();
+        void step8_create_and_register_static_cache();
         
         // 创建具体组件的方法
         void create_config_manager();
@@ -73,6 +77,10 @@ namespace zbackup::core
         void create_manager_components();
         void create_auth_components();
         void create_factory_and_registry();
+        // 按类型创建压缩包存储：local 使用 local_root 目录，s3 使用 prefix 作为键前缀，
+        // erasure 在 ec_dirs 的每个目录下以 prefix 为子目录存放分片
+        interfaces::IBlobStore::ptr create_blob_store(const std::string &kind, const std::string &local_root,
+                                                      const std::string &prefix, const std::string &storage_class) const;
         
         // 配置
         DependencyConfig config_;
@@ -81,12 +89,15 @@ namespace zbackup::core
         interfaces::IConfigManager::ptr config_manager_;
         interfaces::IBackupStorage::ptr backup_storage_;
         interfaces::IUserStorage::ptr user_storage_;
+        storage::BlobTiers::ptr blob_tiers_;
         interfaces::IDataManager::ptr data_manager_;
         interfaces::IUserManager::ptr user_manager_;
+        SnapshotManager::ptr snapshot_manager_;
         interfaces::ISessionManager::ptr session_manager_;
         interfaces::IAuthenticationService::ptr auth_service_;
         interfaces::IHandlerFactory::ptr handler_factory_;
         interfaces::IRouteRegistry::ptr route_registry_;
         interfaces::ICompress::ptr compressor_;
+        cache::StaticAssetCache::ptr static_cache_;
     };
 }
@@ -13,8 +13,14 @@ namespace zbackup::core
         ~HandlerFactory() override = default;
 
         HandlerPtr create_upload_handler() override;
+        HandlerPtr create_batch_upload_handler() override;
         HandlerPtr create_download_handler() override;
+        HandlerPtr create_archive_handler() override;
         HandlerPtr create_list_handler() override;
+        HandlerPtr create_versions_handler() override;
+        HandlerPtr create_snapshot_create_handler() override;
+        HandlerPtr create_snapshot_show_handler() override;
+        HandlerPtr create_snapshot_delete_handler() override;
         HandlerPtr create_delete_handler() override;
         HandlerPtr create_static_handler() override;
         HandlerPtr create_login_handler() override;
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace zbackup::core
+{
+    // 仅可移动的任务封装，小对象直接存放在内部缓冲区（SBO），避免 std::function 的堆分配
+    // 与 std::function 不同，可以持有 std::packaged_task 等不可拷贝的可调用对象
+    class MoveOnlyTask
+    {
+    public:
+        static constexpr size_t INLINE_SIZE = 48; // 内联存储大小，足以容纳捕获少量指针/字符串的lambda
+
+        MoveOnlyTask() noexcept = default;
+
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, MoveOnlyTask> > >
+        MoveOnlyTask(F &&func) // NOLINT(google-explicit-constructor)
+        {
+            using Callable = std::decay_t<F>;
+            if constexpr (fits_inline<Callable>())
+            {
+                ::new(static_cast<void *>(storage_)) Callable(std::forward<F>(func));
+                ops_ = &INLINE_OPS<Callable>;
+            }
+            else
+            {
+                ::new(static_cast<void *>(storage_)) Callable *(new Callable(std::forward<F>(func)));
+                ops_ = &HEAP_OPS<Callable>;
+            }
+        }
+
+        MoveOnlyTask(MoveOnlyTask &&other) noexcept
+        {
+            move_from(other);
+        }
+
+        MoveOnlyTask &operator=(MoveOnlyTask &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                move_from(other);
+            }
+            return *this;
+        }
+
+        MoveOnlyTask(const MoveOnlyTask &) = delete;
+        MoveOnlyTask &operator=(const MoveOnlyTask &) = delete;
+
+        ~MoveOnlyTask()
+        {
+            reset();
+        }
+
+        void operator()()
+        {
+            ops_->invoke(storage_);
+        }
+
+        explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+        // 是否使用了内联存储（用于测试与统计）
+        [[nodiscard]] bool is_inline() const noexcept { return ops_ != nullptr && ops_->is_inline; }
+
+        void reset() noexcept
+        {
+            if (ops_)
+            {
+                ops_->destroy(storage_);
+                ops_ = nullptr;
+            }
+        }
+
+    private:
+        struct Ops
+        {
+            void (*invoke)(void *storage);
+            void (*move)(void *dst, void *src) noexcept; // 移动到dst并销毁src
+            void (*destroy)(void *storage) noexcept;
+            bool is_inline;
+        };
+
+        template<typename F>
+        static constexpr bool fits_inline()
+        {
+            return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) &&
+                   std::is_nothrow_move_constructible_v<F>;
+        }
+
+        template<typename F>
+        static void inline_invoke(void *storage) { (*static_cast<F *>(storage))(); }
+
+        template<typename F>
+        static void inline_move(void *dst, void *src) noexcept
+        {
+            ::new(dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        }
+
+        template<typename F>
+        static void inline_destroy(void *storage) noexcept { static_cast<F *>(storage)->~F(); }
+
+        template<typename F>
+        static void heap_invoke(void *storage) { (**static_cast<F **>(storage))(); }
+
+        template<typename F>
+        static void heap_move(void *dst, void *src) noexcept { ::new(dst) F *(*static_cast<F **>(src)); }
+
+        template<typename F>
+        static void heap_destroy(void *storage) noexcept { delete *static_cast<F **>(storage); }
+
+        template<typename F>
+        static constexpr Ops INLINE_OPS{&inline_invoke<F>, &inline_move<F>, &inline_destroy<F>, true};
+
+        template<typename F>
+        static constexpr Ops HEAP_OPS{&heap_invoke<F>, &heap_move<F>, &heap_destroy<F>, false};
+
+        void move_from(MoveOnlyTask &other) noexcept
+        {
+            if (other.ops_)
+            {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+
+    private:
+        alignas(std::max_align_t) unsigned char storage_[INLINE_SIZE]{};
+        const Ops *ops_ = nullptr;
+    };
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <utility>
+
+namespace zbackup::core
+{
+    // 有界无锁多生产者多消费者环形队列（Dmitry Vyukov 算法）
+    // 每个槽位带序号：序号==位置 表示可写，序号==位置+1 表示可读；容量向上取整为2的幂
+    template<typename T>
+    class BoundedMpmcQueue
+    {
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+    public:
+        explicit BoundedMpmcQueue(size_t capacity)
+            : capacity_(round_up_pow2(capacity < 2 ? 2 : capacity)), mask_(capacity_ - 1),
+              buffer_(new Cell[capacity_]), enqueue_pos_(0), dequeue_pos_(0)
+        {
+            for (size_t i = 0; i < capacity_; i++)
+            {
+                buffer_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedMpmcQueue(const BoundedMpmcQueue &) = delete;
+        BoundedMpmcQueue &operator=(const BoundedMpmcQueue &) = delete;
+
+        // 入队，队列满时返回false
+        bool try_push(T value)
+        {
+            Cell *cell;
+            size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                cell = &buffer_[pos & mask_];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false; // 队列已满
+                }
+                else
+                {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // 出队，队列空时返回false
+        bool try_pop(T *value)
+        {
+            Cell *cell;
+            size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                cell = &buffer_[pos & mask_];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false; // 队列为空
+                }
+                else
+                {
+                    pos = dequeue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            *value = std::move(cell->data);
+            cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] size_t capacity() const { return capacity_; }
+
+        // 近似长度（并发修改时仅供参考）
+        [[nodiscard]] size_t size_approx() const
+        {
+            size_t enqueue = enqueue_pos_.load(std::memory_order_relaxed);
+            size_t dequeue = dequeue_pos_.load(std::memory_order_relaxed);
+            return enqueue > dequeue ? enqueue - dequeue : 0;
+        }
+
+    private:
+        static size_t round_up_pow2(size_t value)
+        {
+            size_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+    private:
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<Cell[]> buffer_;
+        alignas(64) std::atomic<size_t> enqueue_pos_; // 生产端位置
+        alignas(64) std::atomic<size_t> dequeue_pos_; // 消费端位置
+    };
+}
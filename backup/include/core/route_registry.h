@@ -3,6 +3,7 @@
 #include "interfaces/handler_factory_interface.h"
 #include "interfaces/config_manager_interface.h"
 #include "http/http_server.h"
+#include "handlers/async_handler.h"
 #include <memory>
 
 namespace zbackup::core
@@ -24,8 +25,15 @@ namespace zbackup::core
         
         std::function<void(const zhttp::HttpRequest&, zhttp::HttpResponse*)> create_status_handler();
         std::function<void(const zhttp::HttpRequest&, zhttp::HttpResponse*)> create_redirect_handler();
+        std::function<void(const zhttp::HttpRequest&, zhttp::HttpResponse*)> create_scrub_report_handler();
+        std::function<void(const zhttp::HttpRequest&, zhttp::HttpResponse*)> create_usage_handler();
+
+        // 按配置把处理器包装为异步处理器，阻塞工作交给REQUEST线程池；share_inflight 用于可重放的GET请求
+        interfaces::IHandlerFactory::HandlerPtr make_async(interfaces::IHandlerFactory::HandlerPtr handler,
+                                                           bool share_inflight);
 
         interfaces::IHandlerFactory::ptr handler_factory_;
         interfaces::IConfigManager::ptr config_manager_;
+        AsyncJobRegistry::ptr async_jobs_; // 超过等待时限、转入后台的不可共享请求
     };
 }
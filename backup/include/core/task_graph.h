@@ -0,0 +1,467 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "core/threadpool.h"
+
+namespace zbackup::core
+{
+    // 基于 ThreadPool 的轻量任务图：spawn 提交首个步骤，then 串联后续步骤，when_all 汇合并行分支
+    // 每个步骤可单独指定执行通道与优先级，IO 步骤与 CPU 步骤在各自的线程池中重叠执行
+
+    // 任务状态
+    enum class TaskStatus
+    {
+        PENDING,   // 未完成
+        SUCCEEDED, // 成功
+        FAILED,    // 步骤抛出异常
+        CANCELLED, // 执行前已被取消
+        REJECTED   // 线程池拒绝提交（队列满或正在退出）
+    };
+
+    // 取消令牌：拷贝之间共享状态；child() 派生的令牌在父令牌取消时一并视为已取消
+    // 取消只阻止尚未开始的步骤，正在执行的步骤可自行检查 is_cancelled() 提前结束
+    class CancellationToken
+    {
+    public:
+        CancellationToken() : state_(std::make_shared<State>()) {}
+
+        void cancel() const { state_->cancelled.store(true); }
+
+        [[nodiscard]] bool is_cancelled() const
+        {
+            for (const State *state = state_.get(); state; state = state->parent.get())
+            {
+                if (state->cancelled.load())
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] CancellationToken child() const
+        {
+            CancellationToken token;
+            token.state_->parent = state_;
+            return token;
+        }
+
+    private:
+        struct State
+        {
+            std::atomic<bool> cancelled{false};
+            std::shared_ptr<const State> parent;
+        };
+
+        std::shared_ptr<State> state_;
+    };
+
+    // 任务未成功完成（取消、被拒绝）时 get() 抛出的异常
+    class TaskAbortedError : public std::runtime_error
+    {
+    public:
+        explicit TaskAbortedError(TaskStatus status)
+            : std::runtime_error(status == TaskStatus::CANCELLED ? "task cancelled"
+                                 : status == TaskStatus::REJECTED ? "task rejected" : "task failed"),
+              status_(status)
+        {
+        }
+
+        [[nodiscard]] TaskStatus status() const { return status_; }
+
+    private:
+        TaskStatus status_;
+    };
+
+    template<typename T>
+    class TaskFuture;
+
+    namespace detail
+    {
+        // 共享状态的公共部分：完成状态、异常与完成回调
+        class TaskStateBase
+        {
+        public:
+            explicit TaskStateBase(CancellationToken token) : token_(std::move(token)) {}
+            virtual ~TaskStateBase() = default;
+
+            [[nodiscard]] TaskStatus status() const
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                return status_;
+            }
+
+            [[nodiscard]] std::exception_ptr error() const
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                return error_;
+            }
+
+            [[nodiscard]] const CancellationToken &token() const { return token_; }
+
+            void wait() const
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                done_.wait(lock, [this]() { return status_ != TaskStatus::PENDING; });
+            }
+
+            template<typename Rep, typename Period>
+            bool wait_for(std::chrono::duration<Rep, Period> timeout) const
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                return done_.wait_for(lock, timeout, [this]() { return status_ != TaskStatus::PENDING; });
+            }
+
+            // 注册完成回调：已完成时在当前线程立即执行，否则由完成该状态的线程执行
+            void on_complete(MoveOnlyTask callback)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    if (status_ == TaskStatus::PENDING)
+                    {
+                        callbacks_.push_back(std::move(callback));
+                        return;
+                    }
+                }
+                callback();
+            }
+
+            // 以非成功状态结束
+            void abort(TaskStatus status, std::exception_ptr error = nullptr)
+            {
+                finish(status, std::move(error));
+            }
+
+        protected:
+            void finish(TaskStatus status, std::exception_ptr error)
+            {
+                std::vector<MoveOnlyTask> callbacks;
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    if (status_ != TaskStatus::PENDING)
+                    {
+                        return;
+                    }
+                    status_ = status;
+                    error_ = std::move(error);
+                    callbacks.swap(callbacks_);
+                }
+                done_.notify_all();
+                for (auto &callback: callbacks)
+                {
+                    callback();
+                }
+            }
+
+        private:
+            mutable std::mutex mtx_;
+            mutable std::condition_variable done_;
+            TaskStatus status_ = TaskStatus::PENDING;
+            std::exception_ptr error_;
+            std::vector<MoveOnlyTask> callbacks_; // 完成后执行的回调（后续步骤的调度、汇合计数等）
+            CancellationToken token_;
+        };
+
+        template<typename T>
+        class TaskState final : public TaskStateBase
+        {
+        public:
+            using TaskStateBase::TaskStateBase;
+
+            void set_value(T value)
+            {
+                value_.emplace(std::move(value));
+                finish(TaskStatus::SUCCEEDED, nullptr);
+            }
+
+            // 仅在成功完成后访问
+            [[nodiscard]] const T &value() const { return *value_; }
+
+        private:
+            std::optional<T> value_;
+        };
+
+        template<>
+        class TaskState<void> final : public TaskStateBase
+        {
+        public:
+            using TaskStateBase::TaskStateBase;
+
+            void set_value() { finish(TaskStatus::SUCCEEDED, nullptr); }
+        };
+
+        // 执行一个步骤，把返回值或异常写入状态
+        template<typename T, typename Func, typename... Args>
+        void run_stage(TaskState<T> &state, Func &func, Args &&... args)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    func(std::forward<Args>(args)...);
+                    state.set_value();
+                }
+                else
+                {
+                    state.set_value(func(std::forward<Args>(args)...));
+                }
+            }
+            catch (...)
+            {
+                state.abort(TaskStatus::FAILED, std::current_exception());
+            }
+        }
+
+        // 后续步骤的返回类型：上一步的结果以 const 引用传入，void 结果不传参数
+        template<typename T, typename Func>
+        struct ThenResult
+        {
+            using type = std::invoke_result_t<Func &, const T &>;
+        };
+
+        template<typename Func>
+        struct ThenResult<void, Func>
+        {
+            using type = std::invoke_result_t<Func &>;
+        };
+
+        struct StateAccess
+        {
+            template<typename T>
+            static std::shared_ptr<TaskStateBase> get(const TaskFuture<T> &future) { return future.state_; }
+        };
+
+        // 汇合多个分支：全部完成后结束；任一分支失败时取第一个失败分支的异常，否则取第一个非成功状态
+        inline std::shared_ptr<TaskState<void> > join_states(std::vector<std::shared_ptr<TaskStateBase> > states)
+        {
+            auto joined = std::make_shared<TaskState<void> >(states.empty() ? CancellationToken()
+                                                                             : states.front()->token());
+            if (states.empty())
+            {
+                joined->set_value();
+                return joined;
+            }
+
+            struct JoinContext
+            {
+                std::vector<std::shared_ptr<TaskStateBase> > states;
+                std::atomic<size_t> remaining{0};
+            };
+            auto context = std::make_shared<JoinContext>();
+            context->states = states;
+            context->remaining = states.size();
+
+            for (const auto &state: states)
+            {
+                state->on_complete([context, joined]()
+                {
+                    if (context->remaining.fetch_sub(1) != 1)
+                    {
+                        return;
+                    }
+
+                    TaskStatus result = TaskStatus::SUCCEEDED;
+                    std::exception_ptr error;
+                    for (const auto &branch: context->states)
+                    {
+                        TaskStatus status = branch->status();
+                        if (status == TaskStatus::FAILED)
+                        {
+                            result = status;
+                            error = branch->error();
+                            break;
+                        }
+                        if (status != TaskStatus::SUCCEEDED && result == TaskStatus::SUCCEEDED)
+                        {
+                            result = status;
+                        }
+                    }
+                    context->states.clear();
+
+                    if (result == TaskStatus::SUCCEEDED)
+                        joined->set_value();
+                    else
+                        joined->abort(result, error);
+                });
+            }
+            return joined;
+        }
+    }
+
+    // 任务图中一个步骤的结果
+    template<typename T>
+    class TaskFuture
+    {
+    public:
+        using Result = std::conditional_t<std::is_void_v<T>, void, T>;
+
+        TaskFuture() = default;
+
+        explicit TaskFuture(std::shared_ptr<detail::TaskState<T> > state) : state_(std::move(state)) {}
+
+        [[nodiscard]] bool valid() const { return state_ != nullptr; }
+        [[nodiscard]] TaskStatus status() const { return state_->status(); }
+        [[nodiscard]] bool is_ready() const { return status() != TaskStatus::PENDING; }
+        [[nodiscard]] const CancellationToken &token() const { return state_->token(); }
+
+        // 取消整条流水线中尚未开始的步骤（共享同一令牌）
+        void cancel() const { state_->token().cancel(); }
+
+        // 阻塞等待完成；不要在执行后续步骤的线程池的工作线程中等待，以免占满线程
+        void wait() const { state_->wait(); }
+
+        template<typename Rep, typename Period>
+        bool wait_for(std::chrono::duration<Rep, Period> timeout) const { return state_->wait_for(timeout); }
+
+        // 等待并获取结果：失败时重新抛出步骤中的异常，取消或被拒绝时抛出 TaskAbortedError
+        Result get() const
+        {
+            wait();
+            TaskStatus status = state_->status();
+            if (status == TaskStatus::FAILED && state_->error())
+            {
+                std::rethrow_exception(state_->error());
+            }
+            if (status != TaskStatus::SUCCEEDED)
+            {
+                throw TaskAbortedError(status);
+            }
+            if constexpr (!std::is_void_v<T>)
+            {
+                return state_->value();
+            }
+        }
+
+        // 本步骤成功后在指定线程池执行 func(结果)；本步骤失败、取消或被拒绝时后续步骤以相同状态结束
+        template<typename Func>
+        auto then(TaskLane lane, TaskPriority priority, Func &&func) const
+            -> TaskFuture<typename detail::ThenResult<T, std::decay_t<Func> >::type>
+        {
+            using R = typename detail::ThenResult<T, std::decay_t<Func> >::type;
+            auto next = std::make_shared<detail::TaskState<R> >(state_->token());
+
+            state_->on_complete([prev = state_, next, lane, priority,
+                                 func = std::decay_t<Func>(std::forward<Func>(func))]() mutable
+            {
+                if (prev->status() != TaskStatus::SUCCEEDED)
+                {
+                    next->abort(prev->status(), prev->error());
+                    return;
+                }
+                if (next->token().is_cancelled())
+                {
+                    next->abort(TaskStatus::CANCELLED);
+                    return;
+                }
+
+                // 已接纳流水线的后续步骤不受队列上限限制
+                auto status = ThreadPool::get_instance(lane)->post_continuation(
+                    priority, [prev, next, func = std::move(func)]() mutable
+                    {
+                        if (next->token().is_cancelled())
+                        {
+                            next->abort(TaskStatus::CANCELLED);
+                            return;
+                        }
+                        if constexpr (std::is_void_v<T>)
+                            detail::run_stage(*next, func);
+                        else
+                            detail::run_stage(*next, func, prev->value());
+                    });
+                if (status != SubmitStatus::ACCEPTED)
+                {
+                    next->abort(TaskStatus::REJECTED);
+                }
+            });
+            return TaskFuture<R>(next);
+        }
+
+        // 在CPU线程池以NORMAL优先级执行后续步骤
+        template<typename Func>
+        auto then(Func &&func) const
+        {
+            return then(TaskLane::CPU, TaskPriority::NORMAL, std::forward<Func>(func));
+        }
+
+        // 完成后（无论成功与否）在完成该步骤的线程上调用 func(status)，只适合释放标记等轻量收尾
+        template<typename Func>
+        void finally(Func &&func) const
+        {
+            state_->on_complete([state = state_, func = std::decay_t<Func>(std::forward<Func>(func))]() mutable
+            {
+                func(state->status());
+            });
+        }
+
+    private:
+        friend struct detail::StateAccess;
+
+        std::shared_ptr<detail::TaskState<T> > state_;
+    };
+
+    // 限时提交流水线的首个步骤：队列满时最多等待 timeout，被拒绝时返回 REJECTED 状态的结果
+    template<typename Rep, typename Period, typename Func>
+    auto spawn_for(std::chrono::duration<Rep, Period> timeout, TaskLane lane, TaskPriority priority, Func &&func,
+                   CancellationToken token = CancellationToken())
+        -> TaskFuture<std::invoke_result_t<std::decay_t<Func> &> >
+    {
+        using R = std::invoke_result_t<std::decay_t<Func> &>;
+        auto state = std::make_shared<detail::TaskState<R> >(std::move(token));
+        if (state->token().is_cancelled())
+        {
+            state->abort(TaskStatus::CANCELLED);
+            return TaskFuture<R>(state);
+        }
+
+        auto status = ThreadPool::get_instance(lane)->post_task_for(
+            timeout, priority, [state, func = std::decay_t<Func>(std::forward<Func>(func))]() mutable
+            {
+                if (state->token().is_cancelled())
+                {
+                    state->abort(TaskStatus::CANCELLED);
+                    return;
+                }
+                detail::run_stage(*state, func);
+            });
+        if (status != SubmitStatus::ACCEPTED)
+        {
+            state->abort(TaskStatus::REJECTED);
+        }
+        return TaskFuture<R>(state);
+    }
+
+    // 非阻塞提交流水线的首个步骤，队列满时立即返回 REJECTED 状态的结果
+    template<typename Func>
+    auto spawn(TaskLane lane, TaskPriority priority, Func &&func, CancellationToken token = CancellationToken())
+    {
+        return spawn_for(std::chrono::milliseconds(0), lane, priority, std::forward<Func>(func), std::move(token));
+    }
+
+    // 等待所有分支完成，分支的结果通过各自的 get() 读取
+    template<typename... Ts>
+    TaskFuture<void> when_all(const TaskFuture<Ts> &... futures)
+    {
+        return TaskFuture<void>(detail::join_states({detail::StateAccess::get(futures)...}));
+    }
+
+    template<typename T>
+    TaskFuture<void> when_all(const std::vector<TaskFuture<T> > &futures)
+    {
+        std::vector<std::shared_ptr<detail::TaskStateBase> > states;
+        states.reserve(futures.size());
+        for (const auto &future: futures)
+        {
+            states.push_back(detail::StateAccess::get(future));
+        }
+        return TaskFuture<void>(detail::join_states(std::move(states)));
+    }
+}
@@ -6,23 +6,82 @@
 #include <unordered_map>
 #include <functional>
 #include <queue>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <algorithm>
 #include <future>
 #include <chrono>
+#include "core/work_stealing_deque.h"
+#include "core/mpmc_queue.h"
+#include "core/move_only_task.h"
+#include "util/cpu_affinity.h"
 #include "log/backup_logger.h"
 
 namespace zbackup::core
 {
     // 线程池配置常量
     static const size_t DEFAULT_THREAD_NUM = std::thread::hardware_concurrency(); // 默认线程数量（CPU核心数）
-    static constexpr size_t MAX_THREAD_LIMIT = 16; // 最大线程数量限制
+    static constexpr size_t MAX_THREAD_LIMIT = 1024; // 单个线程池线程数的安全上限（实际数量由配置决定）
     static constexpr size_t MAX_TASK_DEFAULT_NUM = 10000; // 默认任务队列最大长度
     static constexpr std::chrono::seconds MAX_IDLE_TIME = std::chrono::seconds(10); // 线程最大空闲时间
     static constexpr std::chrono::seconds SUBMIT_TIME = std::chrono::seconds(1); // 任务提交最大等待时间
+    static constexpr size_t DEFAULT_IO_THREAD_NUM = 4; // IO线程池默认线程数量
+    static constexpr size_t DEFAULT_REQUEST_THREAD_NUM = 8; // 请求处理线程池默认线程数量
+    static constexpr size_t INJECT_QUEUE_CAPACITY = 4096; // 每个优先级无锁注入队列的容量
 
     // 类型别名定义
     using Task = std::function<void()>; // 任务类型
     using ThreadId = std::thread::id; // 线程ID类型
 
+    // 任务优先级：交互请求（如下载解压）使用HIGH，后台任务（热点压缩、数据校验）使用LOW
+    enum class TaskPriority
+    {
+        HIGH = 0,
+        NORMAL = 1,
+        LOW = 2
+    };
+    static constexpr size_t PRIORITY_COUNT = 3;
+
+    // 任务执行通道：CPU密集型（编解码）与阻塞IO型任务使用不同的线程池
+    // 从事件循环卸载的HTTP处理器单独使用REQUEST通道，处理器内部再向CPU/IO通道提交子任务并等待，不会互相占满
+    enum class TaskLane
+    {
+        CPU = 0,
+        IO = 1,
+        REQUEST = 2
+    };
+    static constexpr size_t LANE_COUNT = 3;
+
+    // 任务提交结果
+    enum class SubmitStatus
+    {
+        ACCEPTED,   // 已进入队列
+        QUEUE_FULL, // 队列已满（非阻塞提交）
+        TIMEOUT,    // 等待队列空位超时
+        SHUTDOWN    // 线程池正在退出
+    };
+
+    // 带状态的提交结果，仅在 ACCEPTED 时 future 有效
+    template<typename R>
+    struct SubmitResult
+    {
+        SubmitStatus status = SubmitStatus::ACCEPTED;
+        std::future<R> future;
+
+        [[nodiscard]] bool accepted() const { return status == SubmitStatus::ACCEPTED; }
+    };
+
+    // 线程池运行统计
+    struct PoolStats
+    {
+        size_t queue_depth = 0;      // 当前排队任务数
+        size_t peak_queue_depth = 0; // 历史最大排队任务数
+        size_t submitted = 0;        // 累计接收任务数
+        size_t rejected = 0;         // 累计拒绝任务数（队列满、超时或退出）
+        size_t completed = 0;        // 累计完成任务数
+    };
+
     // 线程池工作模式枚举
     enum class PoolMode
     {
@@ -130,27 +189,75 @@ namespace zbackup::core
     class ThreadPool final : public PoolInfo
     {
     public:
-        // 获取线程池单例
-        static ThreadPool *get_instance()
+        // 获取指定通道的线程池单例（默认CPU通道）
+        static ThreadPool *get_instance(TaskLane lane = TaskLane::CPU)
         {
-            // once_flag与call_once保证单例只执行一次
-            std::call_once(flag_, []()
+            auto index = static_cast<size_t>(lane);
+            // once_flag与call_once保证每个通道的单例只执行一次
+            std::call_once(flags_[index], [index]()
             {
-                instance_.reset(new ThreadPool());
+                instances_[index].reset(new ThreadPool(static_cast<TaskLane>(index)));
             });
-            return instance_.get();
+            return instances_[index].get();
+        }
+
+        // 当前线程是否为某个线程池的工作线程，是则返回其所属通道
+        static bool current_lane(TaskLane *lane)
+        {
+            if (current_pool_ == nullptr)
+            {
+                return false;
+            }
+            *lane = current_pool_->lane_;
+            return true;
+        }
+
+        // 设置工作线程绑定的CPU（需在start之前调用），第i个线程绑定到cpus[i % cpus.size()]，空表示不绑定
+        void set_cpu_affinity(std::vector<int> cpus)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (workers_.empty())
+            {
+                cpu_affinity_ = std::move(cpus);
+            }
         }
 
+        [[nodiscard]] const std::vector<int> &get_cpu_affinity() const { return cpu_affinity_; }
+
         // 启动线程池
         void start(size_t max_thread_nums = DEFAULT_THREAD_NUM, PoolMode mode = PoolMode::MODE_FIXED)
         {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!workers_.empty())
+            {
+                return;
+            }
+
+            if (max_thread_nums == 0)
+            {
+                max_thread_nums = std::max<size_t>(1, DEFAULT_THREAD_NUM);
+            }
+            if (max_thread_nums > MAX_THREAD_LIMIT)
+            {
+                ZBACKUP_LOG_WARN("Thread pool size {} exceeds limit, clamped to {}", max_thread_nums, MAX_THREAD_LIMIT);
+                max_thread_nums = MAX_THREAD_LIMIT;
+            }
             max_thread_nums_ = max_thread_nums;
             pool_mode_ = mode;
 
-            // 启动初始线程
+            // 工作线程槽位在启动时一次性分配，运行期间不再改变，窃取时可无锁遍历
             for (size_t i = 0; i < max_thread_nums; i++)
             {
-                launch_ex_thread();
+                workers_.emplace_back(std::make_unique<WorkerSlot>());
+            }
+
+            // 启动初始线程（动态模式下按需增加）
+            size_t init_nums = pool_mode_ == PoolMode::MODE_CACHED
+                                   ? std::min(max_thread_nums, DEFAULT_THREAD_NUM)
+                                   : max_thread_nums;
+            for (size_t i = 0; i < init_nums; i++)
+            {
+                launch_ex_thread(i);
             }
 
             // 启动监视线程
@@ -160,157 +267,677 @@ namespace zbackup::core
             }
         }
 
-        // 提交任务到线程池
+        // 提交任务到线程池（NORMAL优先级）
         template<typename Func, typename... Ts>
         auto submit_task(Func &&func, Ts &&... params)
             -> std::future<decltype(func(params...))>
         {
-            // 1. 封装任务
-            auto execute = std::bind(std::forward<Func>(func), std::forward<Ts>(params)...); // 创建绑定函数
+            return submit_task(TaskPriority::NORMAL, std::forward<Func>(func), std::forward<Ts>(params)...);
+        }
+
+        // 按指定优先级提交任务到线程池，队列满时最多等待 SUBMIT_TIME
+        // 提交失败时返回立即就绪的默认值 future；需要区分失败原因时使用 submit_task_for / try_submit_task
+        template<typename Func, typename... Ts>
+        auto submit_task(TaskPriority priority, Func &&func, Ts &&... params)
+            -> std::future<decltype(func(params...))>
+        {
             using ReturnType = decltype(func(params...));
-            using PackagedTask = std::packaged_task<ReturnType()>;
-            auto task = std::make_shared<PackagedTask>(execute); // 创建任务包装器
-            auto result = task->get_future(); // 获取异步任务的结果
+            auto result = submit_task_for(SUBMIT_TIME, priority, std::forward<Func>(func), std::forward<Ts>(params)...);
+            if (result.accepted())
+            {
+                return std::move(result.future);
+            }
 
-            // 2. 加入任务队列，并且判断是否需要增加线程
+            ZBACKUP_LOG_WARN("Task queue is full, submit task failed");
+            std::packaged_task<ReturnType()> fail_task([]()
             {
-                std::unique_lock<std::mutex> lock(mtx_); // 锁住线程池
+                return ReturnType();
+            });
+            fail_task();
+            return fail_task.get_future();
+        }
 
-                // 等待超过1s，任务提交失败
-                if (!not_full_.wait_for(lock, SUBMIT_TIME, [this]()
-                {
-                    return tasks_queue_.size() < task_max_size_;
-                }))
-                {
-                    ZBACKUP_LOG_WARN("Task queue is full, submit task failed");
-                    auto fail_task = std::make_shared<PackagedTask>([]()
-                    {
-                        return ReturnType();
-                    });
-                    (*fail_task)();
-                    return fail_task->get_future();
-                }
+        // 非阻塞提交（NORMAL优先级），队列满时立即返回 QUEUE_FULL
+        template<typename Func, typename... Ts>
+        auto try_submit_task(Func &&func, Ts &&... params)
+            -> SubmitResult<decltype(func(params...))>
+        {
+            return try_submit_task(TaskPriority::NORMAL, std::forward<Func>(func), std::forward<Ts>(params)...);
+        }
 
-                tasks_queue_.emplace([task]()
-                {
-                    (*task)();
-                }); // 将任务加入队列
+        // 非阻塞提交，队列满时立即返回 QUEUE_FULL
+        template<typename Func, typename... Ts>
+        auto try_submit_task(TaskPriority priority, Func &&func, Ts &&... params)
+            -> SubmitResult<decltype(func(params...))>
+        {
+            return submit_task_for(std::chrono::milliseconds(0), priority,
+                                   std::forward<Func>(func), std::forward<Ts>(params)...);
+        }
+
+        // 限时提交：队列满时最多等待 timeout，超时返回 TIMEOUT
+        template<typename Rep, typename Period, typename Func, typename... Ts>
+        auto submit_task_for(std::chrono::duration<Rep, Period> timeout, TaskPriority priority,
+                             Func &&func, Ts &&... params)
+            -> SubmitResult<decltype(func(params...))>
+        {
+            using ReturnType = decltype(func(params...));
+            using PackagedTask = std::packaged_task<ReturnType()>;
+            SubmitResult<ReturnType> result;
+
+            // 1. 先占用队列名额，被拒绝时不必封装任务
+            result.status = acquire_slot(std::chrono::duration_cast<std::chrono::milliseconds>(timeout));
+            if (!result.accepted())
+            {
+                ++rejected_tasks_;
+                return result;
             }
 
-            if (idle_thread_nums_ > 0)
+            // 2. 封装任务，packaged_task 直接移入任务节点，不再额外包一层 shared_ptr 和 std::function
+            PackagedTask task(std::bind(std::forward<Func>(func), std::forward<Ts>(params)...));
+            result.future = task.get_future(); // 获取异步任务的结果
+
+            // 3. 工作线程内提交放入本地队列，外部提交放入全局注入队列
+            schedule(static_cast<size_t>(priority), std::move(task));
+            ++submitted_tasks_;
+            return result;
+        }
+
+        // 非阻塞投递不需要返回值的任务，小lambda全程无堆分配；队列满时立即返回 QUEUE_FULL
+        template<typename Func>
+        SubmitStatus try_post_task(TaskPriority priority, Func &&func)
+        {
+            return post_task_for(std::chrono::milliseconds(0), priority, std::forward<Func>(func));
+        }
+
+        // 限时投递不需要返回值的任务，任务抛出的异常会被记录并忽略
+        template<typename Rep, typename Period, typename Func>
+        SubmitStatus post_task_for(std::chrono::duration<Rep, Period> timeout, TaskPriority priority, Func &&func)
+        {
+            SubmitStatus status = acquire_slot(std::chrono::duration_cast<std::chrono::milliseconds>(timeout));
+            if (status != SubmitStatus::ACCEPTED)
             {
-                not_empty_.notify_one(); // 通知空闲线程处理任务
+                ++rejected_tasks_;
+                return status;
             }
-            else if (cur_thread_nums_ < max_thread_nums_ && pool_mode_ == PoolMode::MODE_CACHED)
+
+            schedule(static_cast<size_t>(priority), std::forward<Func>(func));
+            ++submitted_tasks_;
+            return status;
+        }
+
+        // 投递已接纳任务的后续步骤（任务图的延续），不受队列上限限制，仅在线程池退出时拒绝
+        // 避免流水线在中途因队列满而失败，也避免工作线程阻塞等待队列空位
+        template<typename Func>
+        SubmitStatus post_continuation(TaskPriority priority, Func &&func)
+        {
+            if (quit_)
             {
-                launch_ex_thread(); // 启动新线程处理任务
+                ++rejected_tasks_;
+                return SubmitStatus::SHUTDOWN;
             }
-            return result; // 返回任务的future对象
+
+            update_peak_depth(queue_depth_.fetch_add(1) + 1);
+            schedule(static_cast<size_t>(priority), std::forward<Func>(func));
+            ++submitted_tasks_;
+            return SubmitStatus::ACCEPTED;
+        }
+
+        // 获取运行统计
+        [[nodiscard]] PoolStats get_stats() const
+        {
+            PoolStats stats;
+            int64_t depth = queue_depth_.load();
+            stats.queue_depth = depth > 0 ? static_cast<size_t>(depth) : 0;
+            stats.peak_queue_depth = static_cast<size_t>(peak_queue_depth_.load());
+            stats.submitted = submitted_tasks_.load();
+            stats.rejected = rejected_tasks_.load();
+            stats.completed = completed_tasks_.load();
+            return stats;
+        }
+
+        // 设置某一优先级同时运行的最大任务数（0表示不限制），防止后台任务占满所有线程
+        void set_concurrency_limit(TaskPriority priority, size_t limit)
+        {
+            limits_[static_cast<size_t>(priority)] = limit;
+            notify_sleeper();
+        }
+
+        [[nodiscard]] size_t get_concurrency_limit(TaskPriority priority) const
+        {
+            return limits_[static_cast<size_t>(priority)].load();
+        }
+
+        // 获取排队中（尚未开始执行）的任务数
+        [[nodiscard]] size_t get_pending_count() const
+        {
+            int64_t pending = pending_tasks_.load();
+            return pending > 0 ? static_cast<size_t>(pending) : 0;
+        }
+
+        // 获取某一优先级排队中的任务数
+        [[nodiscard]] size_t get_pending_count(TaskPriority priority) const
+        {
+            int64_t pending = pending_by_priority_[static_cast<size_t>(priority)].load();
+            return pending > 0 ? static_cast<size_t>(pending) : 0;
+        }
+
+        // 获取某一优先级正在执行的任务数
+        [[nodiscard]] size_t get_running_count(TaskPriority priority) const
+        {
+            return running_[static_cast<size_t>(priority)].load();
         }
 
         // 清理单例资源
         ~ThreadPool() override
         {
-            // 1. 设置标记位，通知所有线程退出
+            // 1. 设置标记位，通知所有线程退出（排队中的任务执行完后退出）
             quit_ = true;
-            not_empty_.notify_all(); // 通知所有线程退出
-            not_full_.notify_all(); // 通知所有线程退出
-            time_out_.notify_all(); // 通知监视线程退出
+            {
+                std::lock_guard<std::mutex> lock(park_mtx_);
+                park_cv_.notify_all();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                not_full_.notify_all(); // 通知等待提交的线程退出
+                time_out_.notify_all(); // 通知监视线程退出
+            }
 
             // 2. 回收监视线程
             if (pool_mode_ == PoolMode::MODE_CACHED && monitor_thread_)
                 monitor_thread_->join();
 
             // 3. 回收执行任务所有线程
-            for (const auto &excute_thread: excute_threads_)
+            for (const auto &worker: workers_)
             {
-                // 回收每个线程
-                excute_thread.second->join();
+                if (worker->thread)
+                {
+                    worker->thread->join();
+                }
+            }
+
+            // 4. 释放未执行的任务
+            TaskNode *node = nullptr;
+            for (const auto &worker: workers_)
+            {
+                for (auto &deque: worker->deques)
+                {
+                    while (deque.pop(&node))
+                    {
+                        delete node;
+                    }
+                }
+            }
+            for (size_t p = 0; p < PRIORITY_COUNT; p++)
+            {
+                while (inject_rings_[p]->try_pop(&node))
+                {
+                    delete node;
+                }
+                for (TaskNode *overflow: inject_overflow_[p])
+                {
+                    delete overflow;
+                }
             }
         }
 
     private:
-        // 构造函数，初始化线程池
-        ThreadPool() = default;
+        // 任务节点：队列中只传递节点指针，节点执行完后回收复用
+        struct TaskNode
+        {
+            MoveOnlyTask task;
+            TaskNode *next = nullptr;
+        };
 
-        // 执行任务
-        void excute_task()
+        // 线程本地节点缓存，线程退出时释放
+        struct LocalNodeCache
         {
-            while (true)
+            TaskNode *head = nullptr;
+            size_t size = 0;
+
+            ~LocalNodeCache()
             {
-                Task task;
+                while (head)
+                {
+                    TaskNode *next = head->next;
+                    delete head;
+                    head = next;
+                }
+            }
+        };
 
-                // 1. 从任务队列提取任务，判断任务是否需要放入超时回收队列
+        // 工作线程槽位：按优先级划分的本地任务队列 + 线程对象
+        struct WorkerSlot
+        {
+            WorkStealingDeque<TaskNode *> deques[PRIORITY_COUNT]; // 本地双端队列
+            std::unique_ptr<ExcuteThread> thread; // 执行线程（动态模式下可能为空）
+            std::atomic<bool> running{false}; // 线程是否在运行
+        };
+
+        // 构造函数，初始化线程池
+        explicit ThreadPool(TaskLane lane) : lane_(lane), pending_tasks_(0), sleepers_(0), wakeups_(0),
+                                             full_waiters_(0), queue_depth_(0), peak_queue_depth_(0),
+                                             submitted_tasks_(0), rejected_tasks_(0), completed_tasks_(0)
+        {
+            for (size_t i = 0; i < PRIORITY_COUNT; i++)
+            {
+                inject_rings_[i] = std::make_unique<BoundedMpmcQueue<TaskNode *> >(INJECT_QUEUE_CAPACITY);
+                overflow_sizes_[i] = 0;
+                pending_by_priority_[i] = 0;
+                running_[i] = 0;
+                limits_[i] = 0;
+            }
+        }
+
+        // 无等待地占用一个队列名额
+        bool reserve_slot()
+        {
+            auto max_depth = static_cast<int64_t>(task_max_size_.load());
+            int64_t depth = queue_depth_.load();
+            do
+            {
+                if (depth >= max_depth)
                 {
-                    std::unique_lock<std::mutex> lock(mtx_);
-                    ThreadId thread_id = std::this_thread::get_id();
+                    return false;
+                }
+            } while (!queue_depth_.compare_exchange_weak(depth, depth + 1));
+
+            update_peak_depth(depth + 1);
+            return true;
+        }
+
+        // 更新历史最大排队数
+        void update_peak_depth(int64_t depth)
+        {
+            int64_t peak = peak_queue_depth_.load(std::memory_order_relaxed);
+            while (depth > peak && !peak_queue_depth_.compare_exchange_weak(peak, depth))
+            {
+            }
+        }
 
-                    if (pool_mode_ == PoolMode::MODE_CACHED)
+        // 占用一个队列名额，队列满时最多等待timeout
+        SubmitStatus acquire_slot(std::chrono::milliseconds timeout)
+        {
+            if (quit_)
+            {
+                return SubmitStatus::SHUTDOWN;
+            }
+            if (reserve_slot())
+            {
+                return SubmitStatus::ACCEPTED;
+            }
+            if (timeout.count() <= 0)
+            {
+                return SubmitStatus::QUEUE_FULL;
+            }
+
+            std::unique_lock<std::mutex> lock(mtx_);
+            ++full_waiters_;
+            bool reserved = false;
+            not_full_.wait_for(lock, timeout, [this, &reserved]()
+            {
+                return quit_ || (reserved = reserve_slot());
+            });
+            --full_waiters_;
+
+            if (reserved && quit_)
+            {
+                queue_depth_.fetch_sub(1);
+            }
+            if (quit_)
+            {
+                return SubmitStatus::SHUTDOWN;
+            }
+            return reserved ? SubmitStatus::ACCEPTED : SubmitStatus::TIMEOUT;
+        }
+
+        // 全局空闲节点池，各线程本地缓存满时归还到这里；进程退出时不析构，避免与线程池析构顺序冲突
+        static BoundedMpmcQueue<TaskNode *> &global_node_pool()
+        {
+            static auto *pool = new BoundedMpmcQueue<TaskNode *>(NODE_POOL_CAPACITY);
+            return *pool;
+        }
+
+        static LocalNodeCache &local_node_cache()
+        {
+            thread_local LocalNodeCache cache;
+            return cache;
+        }
+
+        // 获取一个空闲节点：本地缓存 -> 全局节点池 -> 新分配
+        static TaskNode *acquire_node()
+        {
+            auto &cache = local_node_cache();
+            if (cache.head)
+            {
+                TaskNode *node = cache.head;
+                cache.head = node->next;
+                --cache.size;
+                return node;
+            }
+            TaskNode *node = nullptr;
+            if (global_node_pool().try_pop(&node))
+            {
+                return node;
+            }
+            return new TaskNode();
+        }
+
+        // 归还节点：本地缓存 -> 全局节点池 -> 释放
+        static void release_node(TaskNode *node)
+        {
+            node->task.reset();
+            auto &cache = local_node_cache();
+            if (cache.size < LOCAL_NODE_CACHE_SIZE)
+            {
+                node->next = cache.head;
+                cache.head = node;
+                ++cache.size;
+                return;
+            }
+            if (!global_node_pool().try_push(node))
+            {
+                delete node;
+            }
+        }
+
+        // 将任务放入队列并按需唤醒空闲线程
+        template<typename Func>
+        void schedule(size_t priority, Func &&func)
+        {
+            TaskNode *node = acquire_node();
+            node->task = MoveOnlyTask(std::forward<Func>(func));
+
+            if (current_pool_ == this)
+            {
+                workers_[current_index_]->deques[priority].push(node);
+            }
+            else if (!inject_rings_[priority]->try_push(node))
+            {
+                // 运行期间调大了队列上限时，无锁队列可能放不下，退回到加锁的溢出队列
+                std::lock_guard<std::mutex> lock(inject_mtx_);
+                inject_overflow_[priority].push_back(node);
+                overflow_sizes_[priority].fetch_add(1);
+            }
+
+            // 先发布任务再检查休眠线程数，与 park 中的顺序配对，保证不会丢失唤醒
+            pending_by_priority_[priority].fetch_add(1);
+            pending_tasks_.fetch_add(1);
+            if (sleepers_.load() > 0)
+            {
+                notify_sleeper();
+            }
+            else if (pool_mode_ == PoolMode::MODE_CACHED && cur_thread_nums_ < max_thread_nums_)
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                for (size_t i = 0; i < workers_.size(); i++)
+                {
+                    if (!workers_[i]->running && !workers_[i]->thread)
                     {
-                        // 等待任务超时且任务队列为空
-                        bool is_time_out = not_empty_.wait_for(lock, MAX_IDLE_TIME, [this]
-                        {
-                            return quit_ || !tasks_queue_.empty();
-                        });
-
-                        // 线程超时
-                        if (!is_time_out)
-                        {
-                            // 不能低于默认大小
-                            if (cur_thread_nums_ <= DEFAULT_THREAD_NUM)
-                            {
-                                not_empty_.wait(lock, [this]
-                                {
-                                    return quit_ || !tasks_queue_.empty();
-                                });
-                            }
-                            else
-                            {
-                                --idle_thread_nums_;
-                                --cur_thread_nums_;
-                                time_out_queue_.emplace(thread_id); // 超时线程加入回收队列
-                                time_out_.notify_all();
-                                return;
-                            }
-                        }
+                        launch_ex_thread(i); // 启动新线程处理任务
+                        break;
                     }
-                    else
+                }
+            }
+        }
+
+        // 唤醒一个休眠线程
+        void notify_sleeper()
+        {
+            std::lock_guard<std::mutex> lock(park_mtx_);
+            if (sleepers_.load() > wakeups_)
+            {
+                ++wakeups_;
+                park_cv_.notify_one();
+            }
+        }
+
+        // 占用一个优先级的运行名额，达到并发上限时返回false
+        bool try_reserve(size_t priority)
+        {
+            size_t limit = limits_[priority].load(std::memory_order_relaxed);
+            size_t running = running_[priority].load(std::memory_order_relaxed);
+            do
+            {
+                if (limit != 0 && running >= limit)
+                {
+                    return false;
+                }
+            } while (!running_[priority].compare_exchange_weak(running, running + 1));
+            return true;
+        }
+
+        // 是否存在可以立即执行的任务（有排队任务且未达到并发上限）
+        bool has_runnable_task() const
+        {
+            for (size_t p = 0; p < PRIORITY_COUNT; p++)
+            {
+                size_t limit = limits_[p].load();
+                if (pending_by_priority_[p].load() > 0 && (limit == 0 || running_[p].load() < limit))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 从某一优先级的本地队列、全局注入队列、其他线程队列依次获取任务
+        TaskNode *take_task(size_t index, size_t priority)
+        {
+            TaskNode *task = nullptr;
+            if (workers_[index]->deques[priority].pop(&task))
+            {
+                return task;
+            }
+
+            if (inject_rings_[priority]->try_pop(&task))
+            {
+                return task;
+            }
+            if (overflow_sizes_[priority].load() > 0)
+            {
+                std::lock_guard<std::mutex> lock(inject_mtx_);
+                auto &queue = inject_overflow_[priority];
+                if (!queue.empty())
+                {
+                    task = queue.front();
+                    queue.pop_front();
+                    overflow_sizes_[priority].fetch_sub(1);
+                    return task;
+                }
+            }
+
+            // 从随机位置开始窃取，避免所有线程争抢同一个队列
+            size_t count = workers_.size();
+            size_t start = next_random() % count;
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t victim = (start + i) % count;
+                if (victim != index && workers_[victim]->deques[priority].steal(&task))
+                {
+                    return task;
+                }
+            }
+            return nullptr;
+        }
+
+        // 按优先级从高到低查找任务，成功时已占用对应优先级的运行名额
+        TaskNode *find_task(size_t index, size_t *priority)
+        {
+            for (size_t p = 0; p < PRIORITY_COUNT; p++)
+            {
+                if (pending_by_priority_[p].load(std::memory_order_relaxed) <= 0 || !try_reserve(p))
+                {
+                    continue;
+                }
+                TaskNode *task = take_task(index, p);
+                if (task)
+                {
+                    *priority = p;
+                    return task;
+                }
+                running_[p].fetch_sub(1);
+            }
+            return nullptr;
+        }
+
+        // 没有任务时休眠，返回false表示线程应退出
+        bool park(size_t index)
+        {
+            std::unique_lock<std::mutex> lock(park_mtx_);
+            sleepers_.fetch_add(1);
+            // 登记休眠后再检查一次任务数，避免与 schedule 之间丢失唤醒
+            if (has_runnable_task())
+            {
+                sleepers_.fetch_sub(1);
+                return true;
+            }
+            if (quit_)
+            {
+                sleepers_.fetch_sub(1);
+                return false;
+            }
+
+            auto wakeup = [this] { return quit_ || wakeups_ > 0; };
+            bool woken = true;
+            if (pool_mode_ == PoolMode::MODE_CACHED)
+            {
+                woken = park_cv_.wait_for(lock, MAX_IDLE_TIME, wakeup);
+            }
+            else
+            {
+                park_cv_.wait(lock, wakeup);
+            }
+            sleepers_.fetch_sub(1);
+
+            if (wakeups_ > 0)
+            {
+                --wakeups_;
+                return true;
+            }
+            if (quit_)
+            {
+                return pending_tasks_.load() > 0;
+            }
+
+            // 线程超时，不能低于默认大小
+            if (!woken && cur_thread_nums_ > DEFAULT_THREAD_NUM && local_empty(index))
+            {
+                std::lock_guard<std::mutex> guard(mtx_);
+                --idle_thread_nums_;
+                --cur_thread_nums_;
+                workers_[index]->running = false;
+                time_out_queue_.emplace(index); // 超时线程加入回收队列
+                time_out_.notify_all();
+                return false;
+            }
+            return true;
+        }
+
+        // 执行任务
+        void excute_task(size_t index)
+        {
+            current_pool_ = this;
+            current_index_ = index;
+            bind_worker(index);
+
+            while (true)
+            {
+                // 1. 获取任务，没有任务时短暂自旋后休眠
+                TaskNode *task = nullptr;
+                size_t priority = 0;
+                for (int spin = 0; spin < SPIN_COUNT && !task; spin++)
+                {
+                    task = find_task(index, &priority);
+                    if (!task)
                     {
-                        not_empty_.wait(lock, [this]
-                        {
-                            return quit_ || !tasks_queue_.empty();
-                        });
+                        std::this_thread::yield();
                     }
-
-                    if (quit_ && tasks_queue_.empty()) // 退出条件
+                }
+                if (!task)
+                {
+                    if (!park(index))
                     {
                         return;
                     }
+                    continue;
+                }
 
-                    task = std::move(tasks_queue_.front()); // 获取任务
-                    tasks_queue_.pop();
-                    --idle_thread_nums_; // 空闲线程数减少
+                pending_by_priority_[priority].fetch_sub(1);
+                pending_tasks_.fetch_sub(1);
+                queue_depth_.fetch_sub(1);
+                if (full_waiters_.load() > 0)
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    not_full_.notify_one(); // 通知可继续生产任务
                 }
 
                 // 2. 执行任务
-                not_empty_.notify_one(); // 还有任务可执行继续通知
-                not_full_.notify_one(); // 通知可继续生产任务
-                task();
+                --idle_thread_nums_; // 空闲线程数减少
+                try
+                {
+                    task->task();
+                }
+                catch (const std::exception &e)
+                {
+                    ZBACKUP_LOG_ERROR("Uncaught exception in thread pool task: {}", e.what());
+                }
+                catch (...)
+                {
+                    ZBACKUP_LOG_ERROR("Uncaught unknown exception in thread pool task");
+                }
+                release_node(task);
+                ++completed_tasks_;
 
-                // 3. 修改线程状态
+                // 3. 修改线程状态，释放运行名额；受并发上限限制的任务可能在等待该名额
                 ++idle_thread_nums_; // 空闲线程数增加
+                running_[priority].fetch_sub(1);
+                if (limits_[priority].load(std::memory_order_relaxed) != 0 &&
+                    pending_by_priority_[priority].load() > 0 && sleepers_.load() > 0)
+                {
+                    notify_sleeper();
+                }
             }
         }
 
-        // 启动一个执行任务线程
-        void launch_ex_thread()
+        // 按配置将工作线程绑定到单个CPU，线程分配的内存随之落在该CPU所在的NUMA节点
+        void bind_worker(size_t index) const
         {
-            std::unique_ptr<ExcuteThread> excu(new ExcuteThread());
-            excu->start([this] { excute_task(); });
-            ThreadId id = excu->get_id();
-            excute_threads_[id] = std::move(excu);
+            if (cpu_affinity_.empty())
+            {
+                return;
+            }
+            int cpu = cpu_affinity_[index % cpu_affinity_.size()];
+            if (!util::CpuAffinity::set_current_affinity({cpu}))
+            {
+                ZBACKUP_LOG_WARN("Failed to bind thread pool worker {} to CPU {}", index, cpu);
+                return;
+            }
+            ZBACKUP_LOG_DEBUG("Thread pool worker {} bound to CPU {} (NUMA node {})", index, cpu,
+                              util::CpuAffinity::numa_node_of_cpu(cpu));
+        }
+
+        // 本地队列是否全部为空
+        bool local_empty(size_t index) const
+        {
+            for (const auto &deque: workers_[index]->deques)
+            {
+                if (!deque.empty())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 启动一个执行任务线程（调用方持有mtx_）
+        void launch_ex_thread(size_t index)
+        {
+            auto &worker = workers_[index];
+            worker->running = true;
             ++cur_thread_nums_; // 当前线程数增加
             ++idle_thread_nums_; // 空闲线程数增加
+            worker->thread = std::make_unique<ExcuteThread>();
+            worker->thread->start([this, index] { excute_task(index); });
         }
 
         // 启动一个监视线程
@@ -333,12 +960,13 @@ namespace zbackup::core
                         return !time_out_queue_.empty() || quit_;
                     });
 
-                    // 回收线程
+                    // 回收线程，槽位可被重新启动
                     while (!time_out_queue_.empty())
                     {
-                        ThreadId thread_id = time_out_queue_.front();
+                        size_t index = time_out_queue_.front();
                         time_out_queue_.pop();
-                        excute_threads_[thread_id]->join();
+                        workers_[index]->thread->join();
+                        workers_[index]->thread.reset();
                     }
                 }
                 // 打印线程池状态
@@ -347,17 +975,55 @@ namespace zbackup::core
             }
         }
 
+        // 线程本地的xorshift随机数，用于选择窃取目标
+        static size_t next_random()
+        {
+            thread_local uint64_t state = std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<size_t>(state);
+        }
+
     private:
-        std::mutex mtx_; // 互斥锁
-        std::queue<Task> tasks_queue_; // 任务队列
-        std::condition_variable not_empty_; // 任务可用条件变量
+        static constexpr int SPIN_COUNT = 64; // 休眠前自旋查找任务的次数
+        static constexpr size_t LOCAL_NODE_CACHE_SIZE = 256; // 每个线程缓存的空闲节点数
+        static constexpr size_t NODE_POOL_CAPACITY = 8192; // 全局空闲节点池容量
+
+        const TaskLane lane_; // 所属通道
+        std::mutex mtx_; // 线程管理互斥锁
         std::condition_variable not_full_; // 任务可生产条件变量
         std::condition_variable time_out_; // 超时回收条件变量
-        std::unordered_map<ThreadId, std::unique_ptr<ExcuteThread> > excute_threads_; // 存储执行线程信息
+        std::vector<std::unique_ptr<WorkerSlot> > workers_; // 工作线程槽位
         std::unique_ptr<MonitorThread> monitor_thread_; // 监视空闲线程
-        std::queue<ThreadId> time_out_queue_; // 超时线程队列
+        std::queue<size_t> time_out_queue_; // 超时线程槽位队列
+        std::vector<int> cpu_affinity_; // 工作线程绑定的CPU列表（启动后只读）
+
+        std::unique_ptr<BoundedMpmcQueue<TaskNode *> > inject_rings_[PRIORITY_COUNT]; // 全局无锁注入队列（非工作线程提交的任务）
+        std::mutex inject_mtx_; // 溢出队列锁
+        std::deque<TaskNode *> inject_overflow_[PRIORITY_COUNT]; // 注入队列放不下时的溢出队列
+        std::atomic<size_t> overflow_sizes_[PRIORITY_COUNT]; // 溢出队列长度，用于无锁判断是否为空
+        std::atomic<int64_t> pending_by_priority_[PRIORITY_COUNT]; // 各优先级排队中的任务数
+        std::atomic<size_t> running_[PRIORITY_COUNT]; // 各优先级正在执行的任务数
+        std::atomic<size_t> limits_[PRIORITY_COUNT]; // 各优先级并发上限（0表示不限制）
+
+        std::atomic<int64_t> pending_tasks_; // 排队中的任务数
+        std::mutex park_mtx_; // 休眠互斥锁
+        std::condition_variable park_cv_; // 休眠条件变量
+        std::atomic<size_t> sleepers_; // 休眠中的线程数
+        size_t wakeups_; // 待领取的唤醒次数（受park_mtx_保护）
+        std::atomic<size_t> full_waiters_; // 等待队列空位的提交者数
+
+        std::atomic<int64_t> queue_depth_; // 已占用的队列名额（提交后、开始执行前）
+        std::atomic<int64_t> peak_queue_depth_; // 历史最大排队数
+        std::atomic<size_t> submitted_tasks_; // 累计接收任务数
+        std::atomic<size_t> rejected_tasks_; // 累计拒绝任务数
+        std::atomic<size_t> completed_tasks_; // 累计完成任务数
+
+        inline static thread_local const ThreadPool *current_pool_ = nullptr; // 当前线程所属线程池
+        inline static thread_local size_t current_index_ = 0; // 当前线程在线程池中的槽位
 
-        inline static std::unique_ptr<ThreadPool> instance_;
-        inline static std::once_flag flag_;
+        inline static std::unique_ptr<ThreadPool> instances_[LANE_COUNT];
+        inline static std::once_flag flags_[LANE_COUNT];
     };
 };
@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+namespace zbackup::core
+{
+    // Chase-Lev 工作窃取双端队列（参考 Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models"）
+    // 只有所属线程调用 push/pop（从底部操作），其他线程调用 steal（从顶部窃取）
+    // 元素类型需可平凡拷贝（通常为任务指针）
+    template<typename T>
+    class WorkStealingDeque
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque element must be trivially copyable");
+
+        // 环形数组，容量为2的幂；扩容时旧数组保留到析构，窃取线程可能仍在读取
+        struct Array
+        {
+            explicit Array(int64_t capacity)
+                : capacity_(capacity), mask_(capacity - 1), buffer_(new std::atomic<T>[capacity])
+            {
+            }
+
+            T get(int64_t index) const { return buffer_[index & mask_].load(std::memory_order_relaxed); }
+            void put(int64_t index, T value) { buffer_[index & mask_].store(value, std::memory_order_relaxed); }
+
+            int64_t capacity_;
+            int64_t mask_;
+            std::unique_ptr<std::atomic<T>[]> buffer_;
+        };
+
+    public:
+        explicit WorkStealingDeque(int64_t capacity = 256)
+            : top_(0), bottom_(0)
+        {
+            auto array = std::make_unique<Array>(capacity);
+            array_.store(array.get(), std::memory_order_relaxed);
+            arrays_.push_back(std::move(array));
+        }
+
+        WorkStealingDeque(const WorkStealingDeque &) = delete;
+        WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+        // 所属线程入队
+        void push(T value)
+        {
+            int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            int64_t top = top_.load(std::memory_order_acquire);
+            Array *array = array_.load(std::memory_order_relaxed);
+            if (bottom - top > array->capacity_ - 1)
+            {
+                array = grow(array, top, bottom);
+            }
+            array->put(bottom, value);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // 所属线程出队（LIFO，缓存友好）
+        bool pop(T *value)
+        {
+            int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            Array *array = array_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = top_.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                // 队列为空
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            *value = array->get(bottom);
+            if (top == bottom)
+            {
+                // 最后一个元素，与窃取线程竞争
+                bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                        std::memory_order_relaxed);
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        // 其他线程窃取（FIFO，取最早入队的任务）
+        bool steal(T *value)
+        {
+            int64_t top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = bottom_.load(std::memory_order_acquire);
+            if (top >= bottom)
+            {
+                return false;
+            }
+
+            Array *array = array_.load(std::memory_order_acquire);
+            T result = array->get(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return false;
+            }
+            *value = result;
+            return true;
+        }
+
+        [[nodiscard]] bool empty() const { return size() <= 0; }
+
+        [[nodiscard]] int64_t size() const
+        {
+            return bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        Array *grow(Array *old_array, int64_t top, int64_t bottom)
+        {
+            auto array = std::make_unique<Array>(old_array->capacity_ * 2);
+            for (int64_t i = top; i < bottom; i++)
+            {
+                array->put(i, old_array->get(i));
+            }
+            Array *raw = array.get();
+            arrays_.push_back(std::move(array));
+            array_.store(raw, std::memory_order_release);
+            return raw;
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> top_;    // 窃取端
+        alignas(64) std::atomic<int64_t> bottom_; // 所属线程端
+        std::atomic<Array *> array_;
+        std::vector<std::unique_ptr<Array>> arrays_; // 仅所属线程修改
+    };
+}
@@ -2,6 +2,8 @@
 #include "interfaces/data_manager_interface.h"
 #include "interfaces/backup_storage_interface.h"
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace zbackup
 {
@@ -17,16 +19,56 @@ namespace zbackup
 
         // IDataManager 接口实现
         bool insert(const info::BackupInfo &info) override;
+        bool insert_versions(std::vector<info::BackupInfo> *infos) override;
         bool update(const info::BackupInfo &info) override;
         bool get_one_by_url(const std::string &url, info::BackupInfo *info) override;
         bool get_one_by_real_path(const std::string &real_path, info::BackupInfo *info) override;
         void get_all(std::vector<info::BackupInfo> *arry) override;
+        void get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry) override;
+        Usage get_usage(const std::string &owner) override;
+        bool try_reserve(const std::string &owner, const Usage &request, const Usage &quota, Usage *usage) override;
+        void release_reserved(const std::string &owner, const Usage &amount) override;
         bool delete_one(const info::BackupInfo &info) override;
         bool delete_by_url(const std::string &url) override;
         bool delete_by_real_path(const std::string &real_path) override;
+        bool delete_batch(const std::vector<info::BackupInfo> &infos) override;
+        bool update_verify(const std::string &url, bool corrupt_flag, time_t verify_time) override;
+        bool record_checksum(const std::string &url, bool pack, const std::string &checksum) override;
+        bool mark_cold(const std::string &url, const std::string &pack_path, const std::string &cold_path,
+                       const std::string &pack_checksum) override;
+        bool mark_unpacked(const info::BackupInfo &expected) override;
+        void get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry) override;
+        bool get_version(const std::string &base_url, uint32_t version, info::BackupInfo *info) override;
         bool persistence() override;
 
+        // 协程版本直接转交给存储层，由存储实现决定如何挂起
+        core::Async<bool> insert_async(info::BackupInfo info) override;
+        core::Async<bool> update_async(info::BackupInfo info) override;
+        core::Async<bool> get_one_by_url_async(std::string url, info::BackupInfo *info) override;
+        core::Async<bool> get_one_by_real_path_async(std::string real_path, info::BackupInfo *info) override;
+        core::Async<void> get_all_async(std::vector<info::BackupInfo> *arry) override;
+        core::Async<void> get_by_owner_async(std::string owner, std::vector<info::BackupInfo> *arry) override;
+        core::Async<void> get_versions_async(std::string base_url, std::vector<info::BackupInfo> *arry) override;
+        core::Async<bool> get_version_async(std::string base_url, uint32_t version, info::BackupInfo *info) override;
+        core::Async<bool> delete_one_async(info::BackupInfo info) override;
+        core::Async<bool> delete_by_url_async(std::string url) override;
+        core::Async<bool> delete_by_real_path_async(std::string real_path) override;
+        core::Async<bool> persistence_async() override;
+
     private:
+        // 启动时从目录汇总各用户用量
+        void load_usage();
+        // 条目登记或删除成功后调整所有者的用量
+        void add_usage(const info::BackupInfo &info);
+        void remove_usage(const info::BackupInfo &info);
+        // 新版本登记成功：计入用量并扣除上传准入时的预留，两者在同一把锁内完成
+        void commit_usage(const info::BackupInfo &info);
+        // 从按版本号升序的列表中选出指定版本，version 为0时取最新版本
+        static bool pick_version(std::vector<info::BackupInfo> *versions, uint32_t version, info::BackupInfo *info);
+
         interfaces::IBackupStorage::ptr storage_;
+        std::unordered_map<std::string, Usage> usage_; // 所有者 -> 用量，无主条目不计入
+        std::unordered_map<std::string, Usage> reserved_; // 所有者 -> 进行中上传的预留
+        std::mutex usage_mutex_;
     };
 }
@@ -0,0 +1,70 @@
+#pragma once
+#include "info/backup_info.h"
+#include "util/snapshot_manifest.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zbackup
+{
+    // 快照管理器：一个快照把某个主机命名空间当时每个文件的最新版本固定下来，存为一个不可变的清单文件
+    // 清单位于 <快照目录>/<用户>/<主机>/<ID>.snap；内存中只保存各快照的汇总与被引用的版本URL
+    // 按时间点恢复只需在索引中找到快照并顺序读取一个清单，不逐个文件查询目录
+    class SnapshotManager
+    {
+    public:
+        using ptr = std::shared_ptr<SnapshotManager>;
+
+        // 快照汇总：头部与结尾，不含条目
+        struct Summary
+        {
+            util::SnapshotHeader header;
+            util::SnapshotTrailer trailer;
+        };
+
+        explicit SnapshotManager(std::string snapshot_dir);
+
+        SnapshotManager(const SnapshotManager &) = delete;
+        SnapshotManager &operator=(const SnapshotManager &) = delete;
+
+        // 扫描快照目录，读取全部清单重建索引与引用计数；损坏的清单跳过
+        bool load();
+
+        // 创建快照，files 为主机命名空间（URL前缀 base）下每个文件要固定的版本
+        bool create(const std::string &owner, const std::string &host, const std::string &base,
+                    const std::vector<info::BackupInfo> &files, Summary *summary);
+        // 主机的全部快照，按创建时间升序
+        std::vector<Summary> list(const std::string &owner, const std::string &host) const;
+        // id 非空时按ID查找，否则取 at 时刻及之前最新的快照
+        bool find(const std::string &owner, const std::string &host, const std::string &id, time_t at,
+                  Summary *summary) const;
+        // 读取快照的全部条目并校验清单
+        bool read_entries(const Summary &summary, std::vector<util::SnapshotEntry> *entries) const;
+        // 删除快照，释放它对各版本的引用
+        bool remove(const std::string &owner, const std::string &host, const std::string &id);
+
+        // 版本是否被某个快照引用；被引用的版本不能被保留策略或删除请求清除
+        bool is_referenced(const std::string &url) const;
+
+        // 条目对应的带版本URL
+        static std::string entry_url(const util::SnapshotHeader &header, const util::SnapshotEntry &entry);
+
+    private:
+        // 命名空间在快照目录下的相对目录：<用户>/<主机>
+        static std::string namespace_dir(const std::string &owner, const std::string &host);
+        std::string manifest_path(const util::SnapshotHeader &header) const;
+        // 生成按时间排序的快照ID：UTC时间 + 进程内序号
+        static std::string make_id(time_t created);
+
+        void add_references(const std::vector<std::string> &urls);
+        void release_references(const std::vector<std::string> &urls);
+
+    private:
+        std::string snapshot_dir_;
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, std::vector<Summary> > index_; // 命名空间目录 -> 快照（按ID升序）
+        std::unordered_map<std::string, uint32_t> references_;          // 版本URL -> 引用它的快照数
+    };
+}
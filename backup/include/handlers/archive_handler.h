@@ -0,0 +1,51 @@
+#pragma once
+#include "coro_handler.h"
+#include "info/backup_info.h"
+#include "interfaces/compress_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "data/snapshot_manager.h"
+#include "storage/blob/blob_tiers.h"
+#include <string>
+#include <vector>
+
+namespace zbackup
+{
+    // 多文件打包下载：按URL列表或名字前缀选出备份，组装成一个 tar 归档返回，整机恢复只需一次传输
+    // GET /archive?prefix=<前缀>，或 POST /archive，正文为 {"urls": [...]} 或 {"prefix": "..."}
+    // GET /archive?snapshot=<ID>（或 at=<Unix时间>）&host=<主机> 恢复一个快照中的全部文件
+    class ArchiveHandler final : public CoroHandler
+    {
+    public:
+        ArchiveHandler() = default;
+
+        core::Async<void> handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
+
+    private:
+        // 归档中的一个成员
+        struct Member
+        {
+            info::BackupInfo info;
+            std::string name;         // 归档内的路径：去掉下载前缀的不带版本URL
+            size_t header_offset = 0; // 头部在归档中的位置
+            size_t data_offset = 0;   // 内容在归档中的位置
+        };
+
+        // 解析请求并按URL排序选出成员，按前缀选择时每个文件取最新版本；只包含 owner 的文件与无主的旧条目
+        // 请求非法或没有匹配的备份时设置响应并返回false
+        static core::Async<bool> select_members(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                                interfaces::IDataManager::ptr data_manager,
+                                                std::string download_prefix, std::string owner,
+                                                std::vector<Member> *members);
+        // 按快照清单选出成员，成员信息来自清单，只有已迁移到冷层的压缩包需要查询目录
+        static bool select_snapshot(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                    const SnapshotManager::ptr &snapshots,
+                                    const interfaces::IDataManager::ptr &data_manager,
+                                    const std::string &download_prefix,
+                                    const std::string &owner, std::vector<Member> *members);
+        // 把成员内容读入归档中的位置；已压缩的成员直接解压到该位置
+        static bool fill_member(const interfaces::ICompress::ptr &compressor, const storage::BlobTiers::ptr &tiers,
+                                const Member &member, char *data);
+        // 等待一个成员填充完成，任务失败或被中止时返回false
+        static core::Async<bool> wait_member(core::TaskFuture<bool> pending);
+    };
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "base_handler.h"
+#include "coro_handler.h"
+#include "core/task_graph.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace zbackup
+{
+    // 一次卸载到工作线程的处理任务：请求从事件循环移入，响应由工作线程生成
+    struct AsyncJob
+    {
+        std::shared_ptr<const zhttp::HttpRequest> request;
+        std::shared_ptr<zhttp::HttpResponse> response;
+        core::TaskFuture<void> done;
+        size_t waiters = 0; // 等待结果的请求数，由所属处理器的锁保护
+        bool taken = false; // 响应已移交给最后一个等待者，不再接受新的等待者
+    };
+
+    // 超过等待时限的不可共享任务登记在此，客户端凭编号轮询结果；结果只能取走一次
+    class AsyncJobRegistry
+    {
+    public:
+        using ptr = std::shared_ptr<AsyncJobRegistry>;
+
+        // 查询结果的路由
+        static constexpr const char *STATUS_PATH = "/api/jobs";
+
+        explicit AsyncJobRegistry(std::chrono::seconds ttl);
+
+        // 登记任务，返回查询编号；owner 为提交请求的用户，只有该用户能取走结果
+        std::string add(std::shared_ptr<AsyncJob> job, std::string owner);
+
+        // 查找属于 owner 的任务，不存在、已过期或不属于 owner 时返回空；已结束的任务同时移出登记表
+        std::shared_ptr<AsyncJob> take(const std::string &id, const std::string &owner);
+
+        // 任务仍在执行：返回202与查询地址
+        static void reply_accepted(const std::string &id, zhttp::HttpResponse *rsp);
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<AsyncJob> job;
+            std::string owner;
+            std::chrono::steady_clock::time_point expire; // 到期且已结束的任务在登记新任务时清理
+        };
+
+        std::chrono::seconds ttl_;
+        std::mutex mutex_;
+        std::mt19937_64 rng_;
+        std::unordered_map<std::string, Entry> jobs_;
+    };
+
+    // 异步处理器：把被包装处理器的阻塞磁盘与编解码工作卸载到REQUEST线程池，事件循环只做有界等待
+    // 路由处理接口是同步的，无法在任务结束后由事件循环补发响应，因此所有请求都只等待 wait_budget
+    // 在等待时限内完成时，把工作线程生成的响应移交给本次请求，由所属事件循环照常发送
+    // 超时后任务继续执行：可共享的请求（GET）返回503并提示重试，重试请求会挂到同一个进行中的任务上；
+    // 不可共享的请求（如上传）登记到 AsyncJobRegistry，返回202与查询地址，客户端轮询取得最终结果
+    // 被包装的是协程处理器时按协程调度，等待数据库与文件操作期间REQUEST线程可处理其他请求
+    class AsyncHandler final : public BaseHandler
+    {
+    public:
+        using HandlerPtr = zhttp::zrouter::RouterHandler::ptr;
+
+        AsyncHandler(HandlerPtr inner, std::chrono::milliseconds wait_budget, bool share_inflight,
+                     AsyncJobRegistry::ptr jobs);
+
+        void handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
+
+        // 把已结束任务的结果写入响应：失败时返回500；last 为真时移交响应正文，否则复制
+        static void deliver(AsyncJob &job, bool last, zhttp::HttpResponse *rsp);
+
+    private:
+        // 获取进行中的相同请求或新建任务并登记为等待者，线程池拒绝时返回空
+        std::shared_ptr<AsyncJob> acquire_job(const zhttp::HttpRequest &req, const zhttp::HttpResponse &rsp);
+        // 退出等待，返回是否为最后一个等待者
+        bool release_waiter(AsyncJob &job);
+        // 共享键：路径、版本参数、范围与身份相关头部都相同的请求才能共享结果
+        static std::string inflight_key(const zhttp::HttpRequest &req);
+
+    private:
+        HandlerPtr inner_;                     // 被包装的处理器
+        std::shared_ptr<CoroHandler> coro_;     // 被包装的处理器为协程处理器时非空
+        std::chrono::milliseconds wait_budget_; // 事件循环最长等待时间
+        bool share_inflight_;                  // 是否允许相同请求共享进行中的任务
+        AsyncJobRegistry::ptr jobs_;           // 超时的不可共享任务
+
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::shared_ptr<AsyncJob> > inflight_; // 进行中的可共享任务
+    };
+
+    // 轮询超时任务的结果：GET /api/jobs?id=<编号>，未完成时返回202，完成后返回任务的原始响应
+    class AsyncJobHandler final : public BaseHandler
+    {
+    public:
+        explicit AsyncJobHandler(AsyncJobRegistry::ptr jobs);
+
+        void handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
+
+    private:
+        AsyncJobRegistry::ptr jobs_;
+    };
+}
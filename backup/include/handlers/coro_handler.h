@@ -0,0 +1,17 @@
+#pragma once
+#include "base_handler.h"
+#include "core/async.h"
+
+namespace zbackup
+{
+    // 协程处理器：在 handle 中 co_await 数据库与文件操作，等待期间不占用REQUEST线程
+    // 由 AsyncHandler 包装时直接作为协程调度；未包装时同步入口在事件循环线程中等待协程结束
+    class CoroHandler : public BaseHandler
+    {
+    public:
+        void handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) final;
+
+        // 处理请求，req 与 rsp 由调用方保证在协程结束前有效
+        virtual core::Async<void> handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) = 0;
+    };
+}
@@ -1,13 +1,13 @@
 #pragma once
-#include "base_handler.h"
+#include "coro_handler.h"
 
 namespace zbackup
 {
-    class ListShowHandler final : public BaseHandler
+    class ListShowHandler final : public CoroHandler
     {
     public:
         ListShowHandler() = default;
 
-        void handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
+        core::Async<void> handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
     };
 }
@@ -0,0 +1,44 @@
+#pragma once
+#include "coro_handler.h"
+#include "data/snapshot_manager.h"
+
+namespace zbackup
+{
+    // 主机快照：主机以 X-Host 头部或 host 参数指定
+    // POST /snapshots 为主机当前每个文件的最新版本创建快照（一次备份结束时调用）
+    // GET /snapshots 列出主机的快照；带 id 或 at=<Unix时间> 时返回该快照（或该时刻的快照）的文件列表
+    // DELETE /snapshots?id= 删除快照；恢复整个快照用 GET /archive?snapshot=<id>（或 at=）
+    class SnapshotHandler final : public CoroHandler
+    {
+    public:
+        // 三个路由各用一个实例，按构造时的操作处理
+        enum class Action
+        {
+            CREATE, // POST
+            SHOW,   // GET
+            REMOVE  // DELETE
+        };
+
+        explicit SnapshotHandler(Action action) : action_(action) {}
+
+        core::Async<void> handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
+
+        // 请求中的主机名：host 参数优先，其次 X-Host 头部，与上传时的命名空间一致
+        static std::string request_host(const zhttp::HttpRequest &req);
+        // 按 id 或 at 参数查找 owner 的快照，参数非法或快照不存在时设置响应并返回false
+        static bool resolve(const zhttp::HttpRequest &req, const SnapshotManager::ptr &snapshots,
+                            const std::string &owner, SnapshotManager::Summary *summary, zhttp::HttpResponse *rsp);
+
+    private:
+        static core::Async<void> create(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                        SnapshotManager::ptr snapshots, std::string owner,
+                                        std::string download_prefix);
+        static core::Async<void> show(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                      SnapshotManager::ptr snapshots, std::string owner);
+        static core::Async<void> remove(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                        SnapshotManager::ptr snapshots, std::string owner);
+
+    private:
+        Action action_;
+    };
+}
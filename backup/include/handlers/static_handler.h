@@ -1,6 +1,6 @@
 #pragma once
 #include "base_handler.h"
-#include <unordered_map>
+#include "cache/static_asset_cache.h"
 
 namespace zbackup
 {
@@ -12,7 +12,6 @@ namespace zbackup
         void handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
 
     private:
-        std::string get_mime_type(const std::string &extension);
-        std::unordered_map<std::string, std::string> mime_types_;
+        cache::StaticAssetCache::ptr cache_; // 静态资源内存缓存
     };
 }
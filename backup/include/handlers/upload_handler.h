@@ -1,18 +1,108 @@
 #pragma once
 #include "base_handler.h"
+#include "core/task_graph.h"
+#include "info/backup_info.h"
+#include "interfaces/data_manager_interface.h"
+#include <memory>
+#include <vector>
 
 namespace zbackup
 {
     class UploadHandler final : public BaseHandler
     {
     public:
-        UploadHandler() = default;
+        // batch 为true时（/upload/batch）请求中的文件并行写入，目录条目整批登记
+        explicit UploadHandler(bool batch = false) : batch_(batch) {}
 
         void handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
 
     private:
-        static bool parse_multipart_data(const zhttp::HttpRequest &req, std::string &filename, std::string &file_content);
-        bool save_file(const std::string &filename, const std::string &file_content) const;
+        // 客户端提供的期望校验值（小写十六进制，空表示未提供）
+        struct ExpectedDigest
+        {
+            std::string crc32c;
+            std::string sha256;
+        };
+
+        // 请求中的一个上传文件
+        struct UploadedFile
+        {
+            std::string filename; // 客户端给出的文件名，可以带相对路径
+            std::string content;
+            std::string key;      // 命名空间键：<用户>/<主机>/<相对路径>
+            std::string owner;    // 上传者用户名，登记到目录用于按用户过滤与计量
+            std::string shard;    // 本次上传在存储目录下的相对路径，同一键的每个版本各不相同
+        };
+
+        enum class SaveResult
+        {
+            OK,
+            WRITE_FAILED,
+            DIGEST_MISMATCH,
+            CATALOG_FAILED,
+            BUSY // 工作线程队列已满
+        };
+
+        // 准入时为本次请求预留的配额：登记成功的文件由 insert_versions 转为已用量，其余在析构时释放
+        class QuotaReservation
+        {
+        public:
+            QuotaReservation() = default;
+            ~QuotaReservation();
+            QuotaReservation(const QuotaReservation &) = delete;
+            QuotaReservation &operator=(const QuotaReservation &) = delete;
+
+            void hold(interfaces::IDataManager::ptr data_manager, std::string owner,
+                      const interfaces::IDataManager::Usage &amount);
+            // 一个文件已登记，其预留已转为已用量
+            void committed(uint64_t bytes);
+
+        private:
+            interfaces::IDataManager::ptr data_manager_;
+            std::string owner_;
+            interfaces::IDataManager::Usage remaining_;
+        };
+
+        // 文件写入、校验并改名到备份目录后的结果（尚未登记目录）
+        struct StagedFile
+        {
+            SaveResult result = SaveResult::WRITE_FAILED;
+            info::BackupInfo info; // result 为OK时有效，checksum_ 为CRC32C；登记后 url_ 与 version_ 才确定
+        };
+
+        // 单遍解析 multipart/form-data，收集所有带 filename 的分片
+        static bool parse_multipart_data(const zhttp::HttpRequest &req, std::vector<UploadedFile> *files);
+        // 解析 Content-Digest / X-Checksum 头部，格式非法返回false
+        static bool parse_expected_digest(const zhttp::HttpRequest &req, ExpectedDigest *digest);
+        // 为每个文件生成命名空间键与本次上传的存储路径，并记录所有者；路径非法时设置响应并返回false
+        static bool assign_keys(const zhttp::HttpRequest &req, std::vector<UploadedFile> *files,
+                                zhttp::HttpResponse *rsp);
+        // 上传开始前按所有者的配额预留本次请求的用量（与并发上传的预留一起计算），超出时设置响应并返回false
+        static bool reserve_quota(const std::vector<UploadedFile> &files, QuotaReservation *reservation,
+                                  zhttp::HttpResponse *rsp);
+        // 按保存结果设置失败响应
+        static void set_failure(SaveResult result, const std::string &filename, zhttp::HttpResponse *rsp);
+        static const char *result_name(SaveResult result);
+        // 上传在存储目录下的实际路径与临时文件路径（同一分片目录，改名是原子的）
+        static std::string real_path_of(const std::string &back_dir, const std::string &shard);
+        static std::string temp_path_of(const std::string &back_dir, const std::string &shard);
+
+        // 提交写入与校验流水线：写临时文件、校验、改名并生成备份信息，不登记目录
+        static core::TaskFuture<StagedFile> stage_file(const std::string &back_dir, const UploadedFile &file,
+                                                       std::shared_ptr<const std::string> file_content,
+                                                       const ExpectedDigest &expected);
+        // 等待流水线结束；被拒绝或中止时清理临时文件
+        static StagedFile finish_stage(const core::TaskFuture<StagedFile> &staged, const std::string &temp_path);
+
+        // 写入与校验在工作线程池中流水线执行，调用方等待最终结果
+        SaveResult save_file(const UploadedFile &file, std::shared_ptr<const std::string> file_content,
+                             const ExpectedDigest &expected, info::BackupInfo *saved) const;
+        // 批量保存：有限并发写入，全部结束后把成功的文件一次登记为新版本；results 与 files 一一对应
+        void save_batch(std::vector<UploadedFile> *files, std::vector<StagedFile> *results) const;
+        void handle_batch(std::vector<UploadedFile> *files, QuotaReservation *reservation,
+                          zhttp::HttpResponse *rsp) const;
+
+    private:
+        bool batch_;
     };
 }
-
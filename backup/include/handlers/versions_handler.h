@@ -0,0 +1,15 @@
+#pragma once
+#include "coro_handler.h"
+
+namespace zbackup
+{
+    // 列出一个文件的所有版本：GET /versions?file=<不带版本的URL或去掉下载前缀的路径>
+    // 返回JSON，按版本号升序；每个版本的 url 可直接下载
+    class VersionsHandler final : public CoroHandler
+    {
+    public:
+        VersionsHandler() = default;
+
+        core::Async<void> handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override;
+    };
+}
@@ -1,9 +1,17 @@
 #pragma once
 #include "interfaces/base_info_interface.h"
+#include <cstdint>
 #include <ctime>
 
 namespace zbackup::info
 {
+    // 压缩包所在的存储层：打包后在热层（pack_store），长期未访问后迁移到冷层（cold_store）
+    enum class StorageTier : uint8_t
+    {
+        HOT = 0,
+        COLD = 1
+    };
+
     // 备份文件信息类
     class BackupInfo : public interfaces::IBaseInfo
     {
@@ -12,6 +20,14 @@ namespace zbackup::info
         BackupInfo() = default;
         BackupInfo(const std::string& real_path);
         bool new_backup_info(const std::string &real_path);
+        // 命名空间中的一次上传：base_url 为下载前缀加命名空间键，shard 为存储目录下的相对路径
+        // 压缩包使用相同的相对路径；版本号与带版本的 url 在登记到目录时确定
+        bool new_backup_info(const std::string &real_path, const std::string &key, const std::string &shard);
+
+        // 某个版本的URL：不带版本的URL加 "?version=N"，与下载请求的查询参数一致
+        static std::string version_url(const std::string &base_url, uint32_t version);
+        // 解析请求中的版本号参数：为空时得到0（最新版本），不是正整数时返回false
+        static bool parse_version(const std::string &text, uint32_t *version);
 
         // 实现基础接口
         std::string get_id() const override { return url_; }
@@ -28,5 +44,14 @@ namespace zbackup::info
         std::string real_path_; // 真实文件路径
         std::string pack_path_; // 压缩文件路径
         std::string url_; // 下载URL (唯一标识符)
+        std::string checksum_; // 原始文件CRC32C校验值（十六进制）
+        std::string pack_checksum_; // 压缩文件CRC32C校验值（十六进制）
+        time_t verify_time_ = 0; // 最近一次完整性校验时间
+        bool corrupt_flag_ = false; // 校验是否发现损坏
+        std::string owner_; // 上传者用户名，旧版本登记的条目为空
+        std::string base_url_; // 不带版本的URL，同一逻辑路径的所有版本相同
+        uint32_t version_ = 1; // 版本号，从1开始；版本化之前登记的条目视为版本1
+        StorageTier tier_ = StorageTier::HOT; // 压缩包所在的存储层
+        std::string cold_path_; // 压缩包在冷层存储中的键，热层时为空
     };
 }
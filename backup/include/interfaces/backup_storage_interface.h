@@ -1,11 +1,7 @@
 #pragma once
 #include "storage_interface.h"
-
-// 前向声明
-namespace zbackup::info
-{
-    class BackupInfo;
-}
+#include "info/backup_info.h"
+#include "core/async.h"
 
 namespace zbackup::interfaces
 {
@@ -20,5 +16,81 @@ namespace zbackup::interfaces
         virtual bool get_one_by_real_path(const std::string &real_path, info::BackupInfo *info) = 0;
         virtual bool delete_by_url(const std::string &url) = 0;
         virtual bool delete_by_real_path(const std::string &real_path) = 0;
+        // 按所有者查询（走索引），owner 为空时返回旧版本登记的无主条目
+        virtual void get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry) = 0;
+        // 某个逻辑路径的所有版本（按 base_url 查询，走索引），按版本号升序
+        virtual void get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry) = 0;
+        // 把每个条目登记为其 base_url_ 的新版本：版本号取已有最大版本加一，url_ 设为带版本的URL
+        // 全部成功或全部不生效，整批只持久化一次
+        virtual bool insert_versions(std::vector<info::BackupInfo> *infos) = 0;
+        // 批量删除（按 url_），已不存在的条目忽略；整批只持久化一次
+        virtual bool delete_batch(const std::vector<info::BackupInfo> &infos) = 0;
+        // 只写校验结果（损坏标记与校验时间），不覆盖条目的其他字段；条目不存在时返回false
+        virtual bool update_verify(const std::string &url, bool corrupt_flag, time_t verify_time) = 0;
+        // 补记缺失的校验值：pack 为真时写压缩包校验值，要求条目仍是压缩状态，否则写原始文件校验值，
+        // 要求条目仍未压缩；已有校验值时不覆盖，条件不满足时返回false
+        virtual bool record_checksum(const std::string &url, bool pack, const std::string &checksum) = 0;
+        // 冷层迁移完成：仅当条目仍是热层中的 pack_path 压缩包时改为冷层并记录 cold_path，
+        // 压缩包校验值为空时补记 pack_checksum；条件不满足时不修改并返回false
+        virtual bool mark_cold(const std::string &url, const std::string &pack_path, const std::string &cold_path,
+                               const std::string &pack_checksum) = 0;
+        // 下载解压完成：仅当条目仍处于 expected 的压缩状态（压缩包、存储层与冷层键都相同）时改为未压缩的热层条目，
+        // 条件不满足时不修改并返回false
+        virtual bool mark_unpacked(const info::BackupInfo &expected) = 0;
+
+        // 协程版本：默认把同步调用卸载到IO线程池执行，调用方协程挂起期间不占用所在线程
+        // 参数按值传入，出参由调用方保证在 co_await 结束前有效；原生异步的存储实现可覆盖这些方法
+        virtual core::Async<bool> insert_async(info::BackupInfo info)
+        {
+            co_return co_await core::offload_io([this, &info]() { return insert(info); });
+        }
+
+        virtual core::Async<bool> update_async(info::BackupInfo info)
+        {
+            co_return co_await core::offload_io([this, &info]() { return update(info); });
+        }
+
+        virtual core::Async<bool> get_one_by_url_async(std::string url, info::BackupInfo *info)
+        {
+            co_return co_await core::offload_io([this, &url, info]() { return get_one_by_url(url, info); });
+        }
+
+        virtual core::Async<bool> get_one_by_real_path_async(std::string real_path, info::BackupInfo *info)
+        {
+            co_return co_await core::offload_io([this, &real_path, info]()
+            {
+                return get_one_by_real_path(real_path, info);
+            });
+        }
+
+        virtual core::Async<void> get_all_async(std::vector<info::BackupInfo> *arry)
+        {
+            co_await core::offload_io([this, arry]() { get_all(arry); });
+        }
+
+        virtual core::Async<void> get_by_owner_async(std::string owner, std::vector<info::BackupInfo> *arry)
+        {
+            co_await core::offload_io([this, &owner, arry]() { get_by_owner(owner, arry); });
+        }
+
+        virtual core::Async<void> get_versions_async(std::string base_url, std::vector<info::BackupInfo> *arry)
+        {
+            co_await core::offload_io([this, &base_url, arry]() { get_versions(base_url, arry); });
+        }
+
+        virtual core::Async<bool> delete_one_async(info::BackupInfo info)
+        {
+            co_return co_await core::offload_io([this, &info]() { return delete_one(info); });
+        }
+
+        virtual core::Async<bool> delete_by_url_async(std::string url)
+        {
+            co_return co_await core::offload_io([this, &url]() { return delete_by_url(url); });
+        }
+
+        virtual core::Async<bool> delete_by_real_path_async(std::string real_path)
+        {
+            co_return co_await core::offload_io([this, &real_path]() { return delete_by_real_path(real_path); });
+        }
     };
 }
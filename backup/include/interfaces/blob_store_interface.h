@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+
+namespace zbackup::interfaces
+{
+    // 对象存储接口：按键保存不可变的压缩包，键为 '/' 分隔的相对路径
+    class IBlobStore
+    {
+    public:
+        using ptr = std::shared_ptr<IBlobStore>;
+        using ChunkCallback = std::function<void(const char *, size_t)>;
+        virtual ~IBlobStore() = default;
+
+        // 保存本地文件，已存在的键被覆盖；每读出一块回调一次（用于限速与计算校验值）
+        virtual bool put_file(const std::string &key, const std::string &local_path,
+                              const ChunkCallback &on_chunk = nullptr) = 0;
+
+        // 取回到本地文件，先写临时文件再改名
+        virtual bool get_file(const std::string &key, const std::string &local_path) = 0;
+
+        // 读取 [offset, offset+len) 到调用方提供的缓冲区，读满才返回true
+        virtual bool read_range(const std::string &key, uint64_t offset, size_t len, char *data) = 0;
+
+        // 获取对象大小与最后写入时间，不存在返回false
+        virtual bool stat(const std::string &key, uint64_t *size, time_t *mtime = nullptr) = 0;
+
+        // 删除对象，不存在视为成功
+        virtual bool remove(const std::string &key) = 0;
+
+        // 对象在本机文件系统中的路径，可直接打开时非空；远程存储返回空
+        virtual std::string local_path(const std::string &key) const = 0;
+
+        // 存储名称，用于日志
+        virtual const char *name() const = 0;
+    };
+}
@@ -16,5 +16,8 @@ namespace zbackup::interfaces
         
         // 解压文件：将source_path压缩文件解压到target_path
         virtual bool un_compress(const std::string& target_path, const std::string& source_path) = 0;
+
+        // 解压到调用方提供的内存：解压后长度必须恰好为len，不产生临时文件
+        virtual bool un_compress_to(const std::string& source_path, char* data, size_t len) = 0;
     };
 }
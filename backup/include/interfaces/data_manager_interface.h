@@ -1,5 +1,7 @@
 #pragma once
 #include "info/backup_info.h"
+#include "core/async.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
@@ -13,15 +15,113 @@ namespace zbackup::interfaces
         using ptr = std::shared_ptr<IDataManager>;
         virtual ~IDataManager() = default;
 
+        // 某个用户已登记文件的总量
+        struct Usage
+        {
+            uint64_t bytes = 0;
+            uint64_t files = 0;
+        };
+
         // 基本操作
         virtual bool insert(const info::BackupInfo &info) = 0;
+        // 登记为新版本，成功后 infos 中的 url_ 与 version_ 为实际登记的值
+        virtual bool insert_versions(std::vector<info::BackupInfo> *infos) = 0;
         virtual bool update(const info::BackupInfo &info) = 0;
         virtual bool get_one_by_url(const std::string &url, info::BackupInfo *info) = 0;
         virtual bool get_one_by_real_path(const std::string &real_path, info::BackupInfo *info) = 0;
         virtual void get_all(std::vector<info::BackupInfo> *arry) = 0;
+        // 按所有者查询，owner 为空时返回旧版本登记的无主条目
+        virtual void get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry) = 0;
+        // 用户当前用量，随插入与删除增量维护，不扫描目录
+        virtual Usage get_usage(const std::string &owner) = 0;
+        // 上传准入：已用量、进行中上传的预留与 request 之和不超过 quota 时预留 request 并返回true，检查与预留是原子的；
+        // quota 中为0的项不限制，usage 返回检查时的已用量加预留；预留在 insert_versions 登记成功时转为已用量
+        virtual bool try_reserve(const std::string &owner, const Usage &request, const Usage &quota, Usage *usage) = 0;
+        // 释放未能登记的预留
+        virtual void release_reserved(const std::string &owner, const Usage &amount) = 0;
         virtual bool delete_one(const info::BackupInfo &info) = 0;
         virtual bool delete_by_url(const std::string &url) = 0;
         virtual bool delete_by_real_path(const std::string &real_path) = 0;
+        virtual bool delete_batch(const std::vector<info::BackupInfo> &infos) = 0;
+        // 后台校验只写校验结果与缺失的校验值，不用读到的旧条目覆盖并发的迁移、解压等修改
+        virtual bool update_verify(const std::string &url, bool corrupt_flag, time_t verify_time) = 0;
+        virtual bool record_checksum(const std::string &url, bool pack, const std::string &checksum) = 0;
+        // 迁移与解压按读取时的状态做条件更新，并发的迁移与下载解压只有一方生效，不会用旧条目覆盖对方的修改
+        virtual bool mark_cold(const std::string &url, const std::string &pack_path, const std::string &cold_path,
+                               const std::string &pack_checksum) = 0;
+        virtual bool mark_unpacked(const info::BackupInfo &expected) = 0;
+        // 某个逻辑路径的所有版本，按版本号升序
+        virtual void get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry) = 0;
+        // 按不带版本的URL取指定版本，version 为0时取最新版本
+        virtual bool get_version(const std::string &base_url, uint32_t version, info::BackupInfo *info) = 0;
         virtual bool persistence() = 0;
+
+        // 协程版本：供可挂起的处理器 co_await，默认把同步调用卸载到IO线程池执行
+        // 参数按值传入，出参由调用方保证在 co_await 结束前有效
+        virtual core::Async<bool> insert_async(info::BackupInfo info)
+        {
+            co_return co_await core::offload_io([this, &info]() { return insert(info); });
+        }
+
+        virtual core::Async<bool> update_async(info::BackupInfo info)
+        {
+            co_return co_await core::offload_io([this, &info]() { return update(info); });
+        }
+
+        virtual core::Async<bool> get_one_by_url_async(std::string url, info::BackupInfo *info)
+        {
+            co_return co_await core::offload_io([this, &url, info]() { return get_one_by_url(url, info); });
+        }
+
+        virtual core::Async<bool> get_one_by_real_path_async(std::string real_path, info::BackupInfo *info)
+        {
+            co_return co_await core::offload_io([this, &real_path, info]()
+            {
+                return get_one_by_real_path(real_path, info);
+            });
+        }
+
+        virtual core::Async<void> get_all_async(std::vector<info::BackupInfo> *arry)
+        {
+            co_await core::offload_io([this, arry]() { get_all(arry); });
+        }
+
+        virtual core::Async<void> get_by_owner_async(std::string owner, std::vector<info::BackupInfo> *arry)
+        {
+            co_await core::offload_io([this, &owner, arry]() { get_by_owner(owner, arry); });
+        }
+
+        virtual core::Async<void> get_versions_async(std::string base_url, std::vector<info::BackupInfo> *arry)
+        {
+            co_await core::offload_io([this, &base_url, arry]() { get_versions(base_url, arry); });
+        }
+
+        virtual core::Async<bool> get_version_async(std::string base_url, uint32_t version, info::BackupInfo *info)
+        {
+            co_return co_await core::offload_io([this, &base_url, version, info]()
+            {
+                return get_version(base_url, version, info);
+            });
+        }
+
+        virtual core::Async<bool> delete_one_async(info::BackupInfo info)
+        {
+            co_return co_await core::offload_io([this, &info]() { return delete_one(info); });
+        }
+
+        virtual core::Async<bool> delete_by_url_async(std::string url)
+        {
+            co_return co_await core::offload_io([this, &url]() { return delete_by_url(url); });
+        }
+
+        virtual core::Async<bool> delete_by_real_path_async(std::string real_path)
+        {
+            co_return co_await core::offload_io([this, &real_path]() { return delete_by_real_path(real_path); });
+        }
+
+        virtual core::Async<bool> persistence_async()
+        {
+            co_return co_await core::offload_io([this]() { return persistence(); });
+        }
     };
 }
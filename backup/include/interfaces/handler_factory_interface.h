@@ -14,8 +14,14 @@ namespace zbackup::interfaces
         virtual ~IHandlerFactory() = default;
 
         virtual HandlerPtr create_upload_handler() = 0;
+        virtual HandlerPtr create_batch_upload_handler() = 0;
         virtual HandlerPtr create_download_handler() = 0;
+        virtual HandlerPtr create_archive_handler() = 0;
         virtual HandlerPtr create_list_handler() = 0;
+        virtual HandlerPtr create_versions_handler() = 0;
+        virtual HandlerPtr create_snapshot_create_handler() = 0;
+        virtual HandlerPtr create_snapshot_show_handler() = 0;
+        virtual HandlerPtr create_snapshot_delete_handler() = 0;
         virtual HandlerPtr create_delete_handler() = 0;
         virtual HandlerPtr create_static_handler() = 0;
         virtual HandlerPtr create_login_handler() = 0;
@@ -0,0 +1,25 @@
+#pragma once
+#include "middleware/middleware.h"
+#include <string>
+
+namespace zbackup
+{
+    // 响应压缩中间件：根据Accept-Encoding对文本/JSON类响应做gzip/deflate/br压缩
+    class CompressMiddleware final : public zhttp::zmiddleware::Middleware
+    {
+    public:
+        explicit CompressMiddleware(size_t min_size = 1024, int level = 6);
+
+        // 请求前处理：记录客户端可接受的编码
+        void before(zhttp::HttpRequest &request) override;
+
+        // 响应后处理：按协商结果压缩响应体
+        void after(zhttp::HttpResponse &response) override;
+
+    private:
+        static bool is_compressible(const std::string &content_type);
+
+        size_t min_size_; // 小于该大小的响应不压缩
+        int level_;       // 压缩级别（br使用较低质量以控制CPU开销）
+    };
+}
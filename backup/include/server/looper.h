@@ -5,9 +5,14 @@
 
 #pragma once
 #include "interfaces/compress_interface.h"
+#include "info/backup_info.h"
+#include "core/task_graph.h"
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <mutex>
+#include <string>
+#include <unordered_set>
 
 namespace zbackup
 {
@@ -23,21 +28,32 @@ namespace zbackup
         explicit BackupLooper(interfaces::ICompress::ptr comp);
         ~BackupLooper();
 
-        // 启动热点监控
-        void start() const;
+        // 启动热点监控线程
+        void start();
 
     private:
         // 热点监控主循环
         void hot_monitor() const;
         
-        // 处理热点文件压缩任务
-        void deal_task(const std::string &str) const;
+        // 提交热点文件的打包流水线，线程池未接纳时返回false
+        bool deal_task(const std::string &str) const;
+
+        // 打包流水线最后一步：记录压缩包校验值、删除源文件并更新目录
+        void finish_pack(const std::string &str, info::BackupInfo bi) const;
         
         // 判断文件是否为热点文件（长时间未访问）
         static bool hot_judge(const std::string &filename, int hot_time);
+
+        // 标记文件压缩任务已提交/已结束，避免下一轮扫描重复提交
+        bool mark_inflight(const std::string &str) const;
+        void clear_inflight(const std::string &str) const;
     
     private:
         std::atomic<bool> stop_;              // 停止标志
+        std::thread monitor_thread_;          // 监控线程，析构时等待退出
+        core::CancellationToken cancel_;      // 停止时取消尚未开始的打包步骤
         interfaces::ICompress::ptr comp_;     // 压缩器接口
+        mutable std::mutex inflight_mtx_;     // 保护 inflight_
+        mutable std::unordered_set<std::string> inflight_; // 已提交但未完成的压缩任务
     };
 }
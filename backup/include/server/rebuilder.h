@@ -0,0 +1,47 @@
+/**
+ * @file rebuilder.h
+ * @brief 纠删码重建器头文件，后台校验纠删码存储中的压缩包并重建缺失或损坏的分片
+ */
+
+#pragma once
+#include "info/backup_info.h"
+#include "storage/blob/blob_tiers.h"
+#include "util/rate_limiter.h"
+#include <memory>
+#include <atomic>
+#include <thread>
+
+namespace zbackup
+{
+    /**
+     * @class BackupRebuilder
+     * @brief 后台重建器：定期读取纠删码存储中每个压缩包的全部分片，按限速校验各块CRC，
+     * 磁盘更换或分片损坏后用其余分片解码重写；可用分片不足以恢复时标记条目损坏
+     */
+    class BackupRebuilder
+    {
+    public:
+        using ptr = std::shared_ptr<BackupRebuilder>;
+
+        BackupRebuilder();
+        ~BackupRebuilder();
+
+        // 启动后台重建线程
+        void start();
+
+    private:
+        // 重建主循环
+        void rebuild_loop() const;
+
+        // 校验并重建一轮中全部纠删码存储中的压缩包
+        void rebuild_pass(const storage::BlobTiers::ptr &tiers) const;
+
+        // 重建结果写回目录：不可恢复或缺失时标记损坏，恢复后清除损坏标记
+        void record_result(const info::BackupInfo &bi, bool lost) const;
+
+    private:
+        std::atomic<bool> stop_;            // 停止标志
+        mutable util::RateLimiter limiter_; // 读取限速（字节/秒）
+        std::thread rebuild_thread_;        // 重建线程，析构时等待退出
+    };
+}
@@ -0,0 +1,64 @@
+/**
+ * @file retention.h
+ * @brief 版本保留器头文件，按保留策略定期清理同一文件的旧版本
+ */
+
+#pragma once
+#include "info/backup_info.h"
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace zbackup
+{
+    // 版本保留策略（与 restic 的 --keep-* 语义相同）：各项为0表示不按该项保留，全部为0时不清理
+    // 日、周、月为祖父-父-子（GFS）轮换：最近 N 个有版本的日/周/月，各保留其中最新的一个版本
+    struct RetentionPolicy
+    {
+        int keep_last = 0;    // 最新的若干个版本
+        int keep_daily = 0;   // 按日
+        int keep_weekly = 0;  // 按ISO周
+        int keep_monthly = 0; // 按月
+
+        [[nodiscard]] bool enabled() const
+        {
+            return keep_last > 0 || keep_daily > 0 || keep_weekly > 0 || keep_monthly > 0;
+        }
+    };
+
+    /**
+     * @class BackupRetention
+     * @brief 后台版本保留器，按文件分组应用保留策略，待删除的旧版本分批删除
+     */
+    class BackupRetention
+    {
+    public:
+        using ptr = std::shared_ptr<BackupRetention>;
+
+        BackupRetention();
+        ~BackupRetention();
+
+        // 启动后台清理线程
+        void start();
+
+        // 按策略标记要保留的版本：versions 为同一文件按版本号升序的全部版本，结果与之一一对应
+        // 最新版本总是保留；按版本的修改时间（上传时间）以本地时区划分日、周、月
+        static std::vector<bool> select_keep(const std::vector<info::BackupInfo> &versions,
+                                             const RetentionPolicy &policy);
+
+    private:
+        // 清理主循环
+        void retention_loop() const;
+
+        // 扫描目录一轮，待删除的版本每满 batch_size 个删除一批
+        void retention_pass(const RetentionPolicy &policy, size_t batch_size) const;
+
+        // 删除一批版本：先从目录中删除，成功后再删除数据文件与压缩包
+        void prune_batch(std::vector<info::BackupInfo> *batch) const;
+
+    private:
+        std::atomic<bool> stop_;         // 停止标志
+        std::thread retention_thread_;   // 清理线程，析构时等待退出
+    };
+}
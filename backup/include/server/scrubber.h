@@ -0,0 +1,58 @@
+/**
+ * @file scrubber.h
+ * @brief 后台数据校验器头文件，定期重新计算备份文件与压缩包的校验值以发现静默损坏
+ */
+
+#pragma once
+#include "info/backup_info.h"
+#include "util/rate_limiter.h"
+#include <memory>
+#include <atomic>
+#include <thread>
+
+namespace zbackup
+{
+    /**
+     * @class BackupScrubber
+     * @brief 后台校验器，按限速读取目录中的文件，与目录记录的CRC32C比对
+     */
+    class BackupScrubber
+    {
+    public:
+        using ptr = std::shared_ptr<BackupScrubber>;
+
+        BackupScrubber();
+        ~BackupScrubber();
+
+        // 启动后台校验线程
+        void start();
+
+    private:
+        enum class VerifyResult
+        {
+            OK,        // 校验通过
+            RECORDED,  // 此前没有校验值，本次计算后记录
+            CORRUPT,   // 校验值不一致
+            MISSING,   // 数据文件缺失或读取失败
+            CHANGED,   // 校验期间条目被修改（如刚被压缩），下轮再校验
+            REMOTE     // 压缩包在远程对象存储或纠删码存储中，由存储服务或重建器保证完整性，不在此读取校验
+        };
+
+        // 校验主循环
+        void scrub_loop() const;
+
+        // 对一轮中到期的条目逐个校验
+        void scrub_pass(int verify_interval) const;
+
+        // 校验单个条目并写回校验结果
+        VerifyResult verify_one(const info::BackupInfo &bi) const;
+
+        // 降低当前线程的磁盘IO优先级
+        static void lower_io_priority();
+
+    private:
+        std::atomic<bool> stop_;               // 停止标志
+        std::thread scrub_thread_;             // 校验线程，析构时等待退出
+        mutable util::RateLimiter limiter_;    // 读取限速（字节/秒）
+    };
+}
@@ -1,5 +1,9 @@
 #pragma once
 #include "looper.h"
+#include "scrubber.h"
+#include "retention.h"
+#include "tiering.h"
+#include "rebuilder.h"
 #include "interfaces/server_lifecycle_interface.h"
 #include "interfaces/config_manager_interface.h"
 #include "interfaces/route_registry_interface.h"
@@ -8,6 +12,8 @@
 #include "http/http_server.h"
 #include <memory>
 #include <atomic>
+#include <string>
+#include <vector>
 
 namespace zbackup
 {
@@ -36,8 +42,15 @@ namespace zbackup
     private:
         void inject_dependencies();
         void resolve_dependencies();
+        void configure_file_io();
         void initialize_server();
         void setup_routes();
+        void start_thread_pools();
+        void bind_http_threads();
+        // 读取CPU列表配置项，配置为空或非法时返回false
+        bool load_cpu_list(const std::string &key, std::vector<int> *cpus);
+
+        static constexpr int DEFAULT_HTTP_THREAD_NUM = 4; // HTTP事件循环线程默认数量
 
         // 依赖注入管理器
         std::unique_ptr<core::DependencyInjector> dependency_injector_;
@@ -45,6 +58,10 @@ namespace zbackup
         // 服务器组件
         std::unique_ptr<zhttp::HttpServer> server_;
         BackupLooper::ptr looper_;
+        BackupScrubber::ptr scrubber_;
+        BackupRetention::ptr retention_;
+        BackupTiering::ptr tiering_;
+        BackupRebuilder::ptr rebuilder_;
         std::atomic<bool> running_;
 
         // 主要依赖服务
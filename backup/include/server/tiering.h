@@ -0,0 +1,48 @@
+/**
+ * @file tiering.h
+ * @brief 分层存储迁移器头文件，把长期未访问的压缩包从热层存储迁移到冷层存储
+ */
+
+#pragma once
+#include "info/backup_info.h"
+#include "storage/blob/blob_tiers.h"
+#include "util/rate_limiter.h"
+#include <memory>
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace zbackup
+{
+    /**
+     * @class BackupTiering
+     * @brief 后台迁移器：压缩包超过 cold_time 未被访问（下载会解压并删除压缩包）时按限速复制到冷层存储
+     * 复制并校验完成后登记为冷层再删除热层的压缩包；下载冷层文件时从冷层取回解压，文件回到热层
+     */
+    class BackupTiering
+    {
+    public:
+        using ptr = std::shared_ptr<BackupTiering>;
+
+        BackupTiering();
+        ~BackupTiering();
+
+        // 启动后台迁移线程
+        void start();
+
+    private:
+        // 迁移主循环
+        void tiering_loop() const;
+
+        // 对一轮中到期的压缩包逐个迁移
+        void tiering_pass(const storage::BlobTiers::ptr &tiers, int cold_time) const;
+
+        // 限速复制单个压缩包到冷层并校验CRC32C，登记后删除热层的压缩包，成功返回true
+        bool migrate_one(const storage::BlobTiers::ptr &tiers, const info::BackupInfo &bi) const;
+
+    private:
+        std::atomic<bool> stop_;            // 停止标志
+        mutable util::RateLimiter limiter_; // 复制限速（字节/秒）
+        std::thread tiering_thread_;        // 迁移线程，析构时等待退出
+    };
+}
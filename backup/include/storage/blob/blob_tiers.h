@@ -0,0 +1,36 @@
+#pragma once
+#include "interfaces/blob_store_interface.h"
+#include "info/backup_info.h"
+
+namespace zbackup::storage
+{
+    // 压缩包的两个存储层：热层存放新打包的压缩包，冷层存放长期未访问后迁移的压缩包
+    // 压缩包总是先写到本地的 pack_path_，热层的键是它在 pack_dir 下的相对路径
+    class BlobTiers
+    {
+    public:
+        using ptr = std::shared_ptr<BlobTiers>;
+
+        BlobTiers(std::string pack_dir, interfaces::IBlobStore::ptr hot, interfaces::IBlobStore::ptr cold);
+
+        [[nodiscard]] const interfaces::IBlobStore::ptr &hot() const { return hot_; }
+        [[nodiscard]] const interfaces::IBlobStore::ptr &cold() const { return cold_; }
+
+        // 压缩包在热层中的键
+        [[nodiscard]] std::string hot_key(const std::string &pack_path) const;
+        // 压缩包当前所在层的存储与键，该层未配置时返回空
+        interfaces::IBlobStore::ptr locate(const info::BackupInfo &info, std::string *key) const;
+
+        // 打包完成后把 pack_path_ 处的压缩包存入热层；远程存储上传成功后删除本地文件
+        bool store_pack(const info::BackupInfo &info) const;
+        // 取得可直接读取的本地压缩包：本地存储返回原路径，远程存储下载到临时文件（*temporary 为true，用完由调用方删除）
+        bool fetch_pack(const info::BackupInfo &info, std::string *local, bool *temporary) const;
+        // 从所在层删除压缩包，不存在视为成功
+        bool remove_pack(const info::BackupInfo &info) const;
+
+    private:
+        std::string pack_dir_;
+        interfaces::IBlobStore::ptr hot_;
+        interfaces::IBlobStore::ptr cold_;
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "interfaces/blob_store_interface.h"
+#include "util/reed_solomon.h"
+#include <vector>
+
+namespace zbackup::storage
+{
+    // 纠删码参数
+    struct ErasureOptions
+    {
+        int data_shards = 6;          // 数据分片数 k
+        int parity_shards = 3;        // 校验分片数 m，最多容忍 m 个分片（磁盘）同时丢失
+        size_t chunk_size = 256 << 10; // 每个分片在一个条带中的块大小
+    };
+
+    // 多磁盘纠删码对象存储：对象按条带切成 k 个数据块，Reed-Solomon 生成 m 个校验块，
+    // k+m 个分片文件分布在不同的目录（磁盘）上；每块带CRC32C，读取时块损坏或磁盘缺失则用其余分片解码（降级读）
+    // 分片文件：32字节头部（magic "ZBEC"、版本、k、m、分片序号、块大小、对象大小、写入代号、头部CRC），
+    // 之后每个条带一块：4字节CRC32C + chunk_size 字节（最后一个条带补零）
+    class ErasureBlobStore : public zbackup::interfaces::IBlobStore
+    {
+    public:
+        enum class RepairResult
+        {
+            HEALTHY,       // 全部分片完好
+            REPAIRED,      // 重建了缺失或损坏的分片
+            UNRECOVERABLE, // 某个条带可用的块少于 k，数据已丢失
+            MISSING        // 没有任何有效分片（对象不存在）
+        };
+
+        // dirs 为各磁盘上的根目录，少于 k+m 个时同一磁盘会存放多个分片，容错能力下降
+        ErasureBlobStore(std::vector<std::string> dirs, ErasureOptions options);
+
+        bool put_file(const std::string &key, const std::string &local_path,
+                      const ChunkCallback &on_chunk = nullptr) override;
+        bool get_file(const std::string &key, const std::string &local_path) override;
+        bool read_range(const std::string &key, uint64_t offset, size_t len, char *data) override;
+        bool stat(const std::string &key, uint64_t *size, time_t *mtime = nullptr) override;
+        bool remove(const std::string &key) override;
+        std::string local_path(const std::string &) const override { return {}; }
+        const char *name() const override { return "erasure"; }
+
+        // 校验对象的全部分片并重建缺失或损坏的分片；每读出一块回调一次（用于限速）
+        RepairResult repair(const std::string &key, const std::function<void(size_t)> &on_read = nullptr);
+
+    private:
+        struct ShardSet;
+
+        // 第 index 个分片的路径：按键的哈希轮转起始磁盘，各对象的分片均匀分布
+        [[nodiscard]] std::string shard_path(const std::string &key, int index) const;
+        // 打开对象的全部分片并校验头部，写入代号与多数分片不一致的视为无效；没有有效分片返回false
+        bool open_shards(const std::string &key, ShardSet *set) const;
+        // 读取一个块并校验CRC
+        bool read_block(ShardSet *set, int index, uint64_t stripe, uint8_t *out) const;
+        // 读取条带中 [first, last] 范围的数据块，不可读时读取其余分片解码；可用块少于 k 时返回false
+        bool read_stripe(ShardSet *set, uint64_t stripe, int first, int last) const;
+        // 生成分片文件头部
+        void make_header(int index, uint64_t size, uint64_t generation, uint8_t *out) const;
+
+    private:
+        std::vector<std::string> dirs_;
+        ErasureOptions options_;
+        util::ReedSolomon codec_;
+    };
+}
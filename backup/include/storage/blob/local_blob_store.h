@@ -0,0 +1,27 @@
+#pragma once
+#include "interfaces/blob_store_interface.h"
+
+namespace zbackup::storage
+{
+    // 本地文件系统对象存储：键即根目录下的相对路径
+    class LocalBlobStore : public zbackup::interfaces::IBlobStore
+    {
+    public:
+        explicit LocalBlobStore(std::string root);
+
+        bool put_file(const std::string &key, const std::string &local_path,
+                      const ChunkCallback &on_chunk = nullptr) override;
+        bool get_file(const std::string &key, const std::string &local_path) override;
+        bool read_range(const std::string &key, uint64_t offset, size_t len, char *data) override;
+        bool stat(const std::string &key, uint64_t *size, time_t *mtime = nullptr) override;
+        bool remove(const std::string &key) override;
+        std::string local_path(const std::string &key) const override;
+        const char *name() const override { return "local"; }
+
+        // 分块复制文件到临时路径，fsync后改名为 dst；读过的页不留在页缓存中
+        static bool copy_file(const std::string &src, const std::string &dst, const ChunkCallback &on_chunk = nullptr);
+
+    private:
+        std::string root_; // 根目录，以 '/' 结尾
+    };
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "interfaces/blob_store_interface.h"
+#include <map>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace zbackup::storage
+{
+    // S3兼容对象存储的连接参数
+    struct S3Options
+    {
+        std::string endpoint = "http://127.0.0.1:9000"; // scheme://host[:port]，https 时使用TLS
+        std::string bucket;
+        std::string region = "us-east-1";
+        std::string access_key;
+        std::string secret_key;
+        std::string prefix;              // 键前缀，同一个桶可分给热层与冷层
+        std::string storage_class;       // 上传时的存储类型，为空时使用桶的默认类型
+        size_t part_size = 16 << 20;     // 分段上传与分段下载的块大小，S3要求分段不小于5MiB
+        size_t pool_size = 8;            // 保持的空闲连接数上限
+        int timeout_ms = 30000;          // 连接与单次读写超时
+    };
+
+    // S3兼容对象存储（AWS S3、MinIO等）：路径风格的URL，SigV4签名
+    // 大文件分段上传，下载按块发起范围请求；连接保持复用，复用的连接失效时重连重试一次
+    class S3BlobStore : public zbackup::interfaces::IBlobStore
+    {
+    public:
+        explicit S3BlobStore(S3Options options);
+        ~S3BlobStore() override;
+
+        S3BlobStore(const S3BlobStore &) = delete;
+        S3BlobStore &operator=(const S3BlobStore &) = delete;
+
+        bool put_file(const std::string &key, const std::string &local_path,
+                      const ChunkCallback &on_chunk = nullptr) override;
+        bool get_file(const std::string &key, const std::string &local_path) override;
+        bool read_range(const std::string &key, uint64_t offset, size_t len, char *data) override;
+        bool stat(const std::string &key, uint64_t *size, time_t *mtime = nullptr) override;
+        bool remove(const std::string &key) override;
+        std::string local_path(const std::string &) const override { return {}; }
+        const char *name() const override { return "s3"; }
+
+    private:
+        struct Connection;
+
+        struct Request
+        {
+            std::string method;
+            std::string key;
+            std::vector<std::pair<std::string, std::string>> query;
+            std::vector<std::pair<std::string, std::string>> headers; // 不参与签名的头部（Range）
+            std::string storage_class;                                 // 非空时发送并签名 x-amz-storage-class
+            const char *body = nullptr;
+            size_t body_len = 0;
+            // 2xx响应的正文交给回调（返回false中止）；为空或非2xx时正文保存在 Response::body
+            std::function<bool(const char *, size_t)> on_body;
+        };
+
+        struct Response
+        {
+            int status = 0;
+            std::map<std::string, std::string> headers; // 头部名小写
+            std::string body;
+        };
+
+        // 签名并发送请求，读取完整响应；网络错误返回false
+        bool execute(const Request &req, Response *rsp);
+        bool round_trip(Connection *conn, const std::string &head, const Request &req, Response *rsp, bool *reusable);
+        std::string build_head(const Request &req) const;
+
+        std::unique_ptr<Connection> acquire();
+        void release(std::unique_ptr<Connection> conn);
+        std::unique_ptr<Connection> connect();
+
+        bool put_single(const std::string &key, int fd, size_t size, const ChunkCallback &on_chunk);
+        bool put_multipart(const std::string &key, int fd, uint64_t size, const ChunkCallback &on_chunk);
+        void abort_multipart(const std::string &key, const std::string &upload_id);
+
+        std::string object_path(const std::string &key) const;
+        static std::string uri_encode(const std::string &str, bool keep_slash);
+        static std::string canonical_query(const std::vector<std::pair<std::string, std::string>> &query);
+        static std::string xml_value(const std::string &body, const std::string &tag);
+        static void log_failure(const char *operation, const std::string &key, const Response &rsp);
+
+    private:
+        S3Options options_;
+        bool tls_ = false;
+        std::string host_;          // 主机名，用于连接与TLS SNI
+        std::string port_;
+        std::string host_header_;   // Host 头部（含非默认端口）
+        SSL_CTX *ssl_ctx_ = nullptr;
+
+        std::mutex pool_mutex_;
+        std::vector<std::unique_ptr<Connection>> idle_;
+    };
+}
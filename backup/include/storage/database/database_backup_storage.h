@@ -25,8 +25,29 @@ namespace zbackup::storage
         bool get_one_by_real_path(const std::string &real_path, info::BackupInfo *info) override;
         bool delete_by_url(const std::string &url) override;
         bool delete_by_real_path(const std::string &real_path) override;
+        void get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry) override;
+        void get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry) override;
+        bool insert_versions(std::vector<info::BackupInfo> *infos) override;
+        bool delete_batch(const std::vector<info::BackupInfo> &infos) override;
+        bool update_verify(const std::string &url, bool corrupt_flag, time_t verify_time) override;
+        bool record_checksum(const std::string &url, bool pack, const std::string &checksum) override;
+        bool mark_cold(const std::string &url, const std::string &pack_path, const std::string &cold_path,
+                       const std::string &pack_checksum) override;
+        bool mark_unpacked(const info::BackupInfo &expected) override;
 
     private:
         bool create_table_if_not_exists();
+        // 整批语句在同一连接的一个事务中执行，出错时回滚
+        template <typename Conn, typename Body>
+        bool run_transaction(Conn &conn, const char *operation, const Body &body);
+        // 表已存在但缺少某列时通过ALTER TABLE补齐
+        template <typename Conn>
+        bool ensure_column(Conn &conn, const std::string &column, const std::string &definition);
+        // 旧表中长度不足的 VARCHAR 列加宽到 width（保留 NOT NULL 与原有索引）
+        // 表已存在但缺少某个索引时补建
+        template <typename Conn>
+        bool ensure_index(Conn &conn, const std::string &index, const std::string &columns);
+        template <typename Conn>
+        bool widen_column(Conn &conn, const std::string &column, int width);
     };
 }
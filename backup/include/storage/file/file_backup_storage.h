@@ -1,7 +1,9 @@
 #pragma once
 #include "interfaces/backup_storage_interface.h"
 #include "info/backup_info.h"
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 
 namespace zbackup::storage
@@ -26,12 +28,28 @@ namespace zbackup::storage
         bool get_one_by_real_path(const std::string &real_path, info::BackupInfo *info) override;
         bool delete_by_url(const std::string &url) override;
         bool delete_by_real_path(const std::string &real_path) override;
+        void get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry) override;
+        void get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry) override;
+        bool insert_versions(std::vector<info::BackupInfo> *infos) override;
+        bool delete_batch(const std::vector<info::BackupInfo> &infos) override;
+        bool update_verify(const std::string &url, bool corrupt_flag, time_t verify_time) override;
+        bool record_checksum(const std::string &url, bool pack, const std::string &checksum) override;
+        bool mark_cold(const std::string &url, const std::string &pack_path, const std::string &cold_path,
+                       const std::string &pack_checksum) override;
+        bool mark_unpacked(const info::BackupInfo &expected) override;
 
     private:
         bool init_load(); // 从文件加载数据
         bool save_to_file(); // 保存数据到文件
+        // 维护所有者与版本索引，调用时需持有 file_mutex_
+        void index_entry(const info::BackupInfo &info);
+        void unindex_entry(const info::BackupInfo &info);
 
         std::unordered_map<std::string, info::BackupInfo> tables_; // 内存存储表
+        std::unordered_map<std::string, std::unordered_set<std::string> > owner_index_; // 所有者 -> URL集合
+        std::unordered_map<std::string, std::map<uint32_t, std::string> > version_index_; // base_url -> 版本号 -> URL
+        // base_url -> 已分配的最大版本号，版本（包括最新版本）删除后仍保留，版本号不复用
+        std::unordered_map<std::string, uint32_t> last_version_;
         std::string backup_file_; // 备份文件路径
         mutable std::mutex file_mutex_; // 文件操作互斥锁
     };
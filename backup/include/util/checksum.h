@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <functional>
+
+namespace zbackup::util
+{
+    // CRC32C（Castagnoli）校验，支持SSE4.2硬件指令，不支持时回退到查表实现
+    class Crc32c
+    {
+    public:
+        Crc32c() = default;
+
+        void update(const char *data, size_t len);
+        void update(const std::string &data) { update(data.data(), data.size()); }
+        void reset() { crc_ = 0xFFFFFFFFu; }
+
+        [[nodiscard]] uint32_t value() const { return crc_ ^ 0xFFFFFFFFu; }
+        [[nodiscard]] std::string hex() const; // 8位小写十六进制
+
+        static uint32_t compute(const char *data, size_t len);
+        static bool hardware_supported();
+
+    private:
+        uint32_t crc_ = 0xFFFFFFFFu;
+    };
+
+    // SHA-256摘要，基于OpenSSL EVP接口
+    class Sha256
+    {
+    public:
+        Sha256();
+        ~Sha256();
+
+        Sha256(const Sha256 &) = delete;
+        Sha256 &operator=(const Sha256 &) = delete;
+
+        void update(const char *data, size_t len);
+        void update(const std::string &data) { update(data.data(), data.size()); }
+        std::string hex_digest(); // 结束计算并返回64位小写十六进制
+
+    private:
+        struct Context;
+        std::unique_ptr<Context> ctx_;
+    };
+
+    // 校验值编码辅助
+    class ChecksumUtil
+    {
+    public:
+        static std::string to_hex(const unsigned char *data, size_t len);
+        // 标准Base64解码，格式非法返回false
+        static bool base64_decode(const std::string &input, std::string *output);
+        // 流式计算文件CRC32C，每读完一块回调一次（可用于限速）；读取后丢弃页缓存，避免挤占前台热数据
+        static bool file_crc32c(const std::string &path, std::string *hex,
+                                const std::function<void(size_t)> &on_read = nullptr);
+    };
+}
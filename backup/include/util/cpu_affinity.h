@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+namespace zbackup::util
+{
+    // CPU亲和性与NUMA拓扑辅助工具
+    class CpuAffinity
+    {
+    public:
+        // 解析CPU列表，格式同taskset/cgroup cpuset，如 "0-7,16-23"；空串表示不绑定
+        static bool parse_cpu_list(const std::string &spec, std::vector<int> *cpus);
+
+        // 将线程绑定到给定CPU集合
+        static bool set_thread_affinity(pthread_t thread, const std::vector<int> &cpus);
+        // 将当前线程绑定到给定CPU集合（之后由该线程创建的线程继承此掩码）
+        static bool set_current_affinity(const std::vector<int> &cpus);
+
+        // 查询CPU所在的NUMA节点，未知时返回0
+        static int numa_node_of_cpu(int cpu);
+    };
+}
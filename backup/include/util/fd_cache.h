@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace zbackup::util
+{
+    // 已打开的只读文件及打开时的stat结果，最后一个使用者释放时关闭描述符
+    class OpenFile
+    {
+    public:
+        OpenFile(int fd, int64_t size, time_t mtime) : fd_(fd), size_(size), mtime_(mtime) {}
+        ~OpenFile();
+
+        OpenFile(const OpenFile &) = delete;
+        OpenFile &operator=(const OpenFile &) = delete;
+
+        [[nodiscard]] int fd() const { return fd_; }
+        [[nodiscard]] int64_t size() const { return size_; }
+        [[nodiscard]] time_t mtime() const { return mtime_; }
+
+        // 读取指定位置和长度的内容，越界或读取失败返回false
+        bool read(char *data, size_t pos, size_t len) const;
+
+    private:
+        int fd_;
+        int64_t size_;
+        time_t mtime_;
+    };
+
+    // 热点文件描述符缓存：按路径缓存已打开的文件与stat结果，容量有界，按LRU淘汰
+    // 文件经由FileUtil删除、重命名或重写时失效，下载同一文件的多次范围请求只需一次读取系统调用
+    class FdCache
+    {
+    public:
+        using FilePtr = std::shared_ptr<const OpenFile>;
+
+        static constexpr size_t DEFAULT_CAPACITY = 256;
+
+        static FdCache &get_instance();
+
+        // 设置缓存容量，0表示不缓存（每次都重新打开）
+        void set_capacity(size_t capacity);
+        [[nodiscard]] size_t get_capacity() const;
+
+        // 获取路径对应的已打开文件，未命中时打开并加入缓存；失败返回空并保留errno
+        FilePtr acquire(const std::string &path);
+        // 删除、重命名或重写文件之后调用，使该路径的缓存失效
+        void invalidate(const std::string &path);
+        // 删除目录之后调用，使目录及其下所有路径的缓存失效
+        void invalidate_tree(const std::string &dir);
+
+    private:
+        FdCache() = default;
+
+        struct Entry
+        {
+            std::string path;
+            FilePtr file;
+        };
+
+        void evict_locked();
+
+    private:
+        mutable std::mutex mtx_;
+        size_t capacity_ = DEFAULT_CAPACITY;
+        std::list<Entry> lru_;                                               // 表头为最近使用
+        std::unordered_map<std::string, std::list<Entry>::iterator> index_; // 路径到链表节点
+        uint64_t generation_ = 0; // 每次失效递增，防止并发打开的旧文件在失效后被放回缓存
+    };
+}
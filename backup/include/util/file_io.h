@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace zbackup::util
+{
+    // 文件I/O后端配置
+    struct FileIOOptions
+    {
+        bool use_io_uring = true;      // 是否使用io_uring，内核不支持时自动退回pread/pwrite
+        unsigned queue_depth = 32;     // 每个线程的提交队列深度（一次批量提交的最大请求数）
+        size_t chunk_size = 1 << 20;   // 单个读写请求的最大长度
+        size_t direct_threshold = 0;   // 单次传输不小于该长度时使用O_DIRECT绕过页缓存，0表示不使用
+    };
+
+    // 文件读写后端：每个线程持有一个io_uring实例，大块传输拆成多个请求一次提交
+    // O_DIRECT传输经由注册到内核的对齐缓冲区（READ_FIXED/WRITE_FIXED），省去每次请求的页面映射
+    // io_uring不可用（内核过旧、被seccomp禁止）时使用pread/pwrite，接口行为不变
+    class FileIO
+    {
+    public:
+        using ChunkCallback = std::function<void(const char *, size_t)>;
+
+        // 启动时调用一次，之后新建的线程按此配置初始化io_uring
+        static void configure(const FileIOOptions &options);
+        static const FileIOOptions &options();
+        // 当前线程实际使用的后端名称（"io_uring" 或 "pread"）
+        static const char *backend_name();
+
+        // 打开只读文件并返回文件大小，失败返回-1并保留errno
+        static int open_read(const std::string &path, int64_t *size);
+        // 打开写入文件（不存在则创建，存在则截断），失败返回-1并保留errno
+        static int open_write(const std::string &path);
+
+        // 从offset处读取len字节，读满才返回true
+        static bool read_at(int fd, char *data, size_t len, uint64_t offset);
+        // 从文件开头顺序写入全部内容；每一块提交后回调一次，回调与内核写盘重叠执行
+        static bool write_all(int fd, const char *data, size_t len, const ChunkCallback &on_chunk = nullptr);
+    };
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ctime>
+#include "http/http_request.h"
+#include "http/http_response.h"
+
+namespace zbackup::util
+{
+    // HTTP协议辅助工具类：日期格式、ETag比较、条件请求、内容协商
+    class HttpUtil
+    {
+    public:
+        // RFC 7231 IMF-fixdate 格式，如 "Sun, 06 Nov 1994 08:49:37 GMT"
+        static std::string format_http_date(time_t timestamp);
+        // 解析HTTP日期，失败返回-1
+        static time_t parse_http_date(const std::string &date);
+
+        // 为ETag值加上双引号（已带引号则原样返回）
+        static std::string quote_etag(const std::string &etag);
+        // 判断If-None-Match/If-Range等头部中是否包含指定ETag（弱比较，支持列表与"*"）
+        static bool etag_match(const std::string &header, const std::string &etag);
+        // 强比较：header 必须是单个强ETag（不接受 W/ 前缀、列表与"*"）且与指定ETag完全一致
+        static bool etag_match_strong(const std::string &header, const std::string &etag);
+        // If-Range 判断：ETag形式按强比较，HTTP日期形式要求与 mtime 一致且 mtime 早于当前至少1秒（强校验）
+        static bool if_range_match(const std::string &header, const std::string &etag, time_t mtime);
+
+        // 条件请求判断：资源未变化时返回true（If-None-Match优先于If-Modified-Since）
+        static bool is_not_modified(const zhttp::HttpRequest &req, const std::string &etag, time_t mtime);
+
+        // 根据Accept-Encoding从supported（按服务端偏好排序）中选择编码，均不可接受时返回空串（identity）
+        static std::string choose_encoding(const std::string &accept_encoding,
+                                           const std::vector<std::string> &supported);
+
+        // 转义HTML文本与属性值中的 & < > " '
+        static std::string html_escape(const std::string &text);
+
+        // 设置缓存校验相关响应头
+        static void set_cache_headers(zhttp::HttpResponse *rsp, const std::string &etag, time_t mtime,
+                                      const std::string &cache_control);
+        // 生成304响应
+        static void set_not_modified(zhttp::HttpResponse *rsp, const std::string &etag, time_t mtime,
+                                     const std::string &cache_control);
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+namespace zbackup::util
+{
+    // NUMA本地缓冲区：内存从当前线程所在节点分配，供绑核的编解码线程复用
+    // 有libnuma时使用numa_alloc_local；否则用匿名映射，由首次写入的线程触发本地缺页
+    class LocalBuffer
+    {
+    public:
+        LocalBuffer() = default;
+        ~LocalBuffer();
+
+        LocalBuffer(const LocalBuffer &) = delete;
+        LocalBuffer &operator=(const LocalBuffer &) = delete;
+
+        // 保证容量不小于size，容量不足时重新分配（不保留原有内容）
+        bool reserve(size_t size);
+        // 释放内存
+        void release();
+
+        [[nodiscard]] char *data() const { return data_; }
+        [[nodiscard]] size_t capacity() const { return capacity_; }
+
+    private:
+        char *data_ = nullptr;
+        size_t capacity_ = 0;
+    };
+}
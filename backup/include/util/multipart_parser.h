@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace zbackup::util
+{
+    // multipart/form-data 增量解析器（RFC 7578）：单遍状态机，可分多次输入
+    // 分隔符用 Boyer-Moore-Horspool 查找，分片内容以 string_view 直接交给 Sink，不复制正文
+    class MultipartParser
+    {
+    public:
+        // 一个分片的头部
+        struct PartHeaders
+        {
+            std::string name;         // Content-Disposition 的 name 参数
+            std::string filename;     // Content-Disposition 的 filename 参数，非文件字段为空
+            std::string content_type; // Content-Type 头部
+        };
+
+        // 解析结果的接收方；回调返回false时中止解析
+        // on_part_data 的 data 只在回调期间有效，同一分片的内容可能分多次给出
+        class Sink
+        {
+        public:
+            virtual ~Sink() = default;
+            virtual bool on_part_begin(const PartHeaders &headers) = 0;
+            virtual bool on_part_data(std::string_view data) = 0;
+            virtual bool on_part_end() = 0;
+        };
+
+        static constexpr size_t MAX_HEADER_SIZE = 16 * 1024; // 单个分片头部的最大长度
+        static constexpr size_t MAX_BOUNDARY_SIZE = 70;      // RFC 2046 规定的分隔符最大长度
+
+        explicit MultipartParser(const std::string &boundary);
+
+        // 从 Content-Type 中取出 boundary 参数（支持带引号），不存在或非法时返回false
+        static bool extract_boundary(std::string_view content_type, std::string *boundary);
+
+        // 输入一段数据，可多次调用；格式错误或 Sink 中止时返回false，之后不应再输入
+        bool feed(std::string_view data, Sink *sink);
+        // 是否已读到结束分隔符
+        [[nodiscard]] bool done() const { return state_ == State::DONE; }
+        [[nodiscard]] const std::string &error() const { return error_; }
+
+    private:
+        enum class State
+        {
+            PREAMBLE,       // 查找第一个分隔符
+            AFTER_BOUNDARY, // 分隔符之后：结束标记"--"或换行
+            HEADERS,        // 分片头部
+            BODY,           // 分片内容
+            DONE,           // 已结束，忽略其后的内容
+            FAILED
+        };
+
+        // 尽可能处理输入，返回已处理的字节数；剩余部分需要更多数据才能继续
+        size_t consume(std::string_view input, Sink *sink);
+        // 在 input 的 from 位置之后查找 "\r\n--boundary"
+        [[nodiscard]] size_t find_delimiter(std::string_view input, size_t from) const;
+        bool parse_headers(std::string_view block);
+        size_t fail(const std::string &reason);
+
+    private:
+        std::string dash_boundary_;         // "--" + boundary
+        std::string delimiter_;             // "\r\n--" + boundary
+        std::array<size_t, 256> skip_{};    // Horspool 跳转表
+        State state_ = State::PREAMBLE;
+        PartHeaders part_;
+        std::string carry_;                 // 上次输入末尾未处理完的部分（不完整的分隔符或头部）
+        std::string error_;
+    };
+}
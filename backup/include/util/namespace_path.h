@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+
+namespace zbackup::util
+{
+    // 备份命名空间：目录中的键为 <用户>/<主机>/<客户端相对路径>，下载URL为下载前缀加键
+    // 磁盘上按键的哈希分两级子目录存放（256×256），单个目录的条目数不随备份总数增长
+    class NamespacePath
+    {
+    public:
+        static constexpr size_t MAX_KEY_SIZE = 700;     // 键的最大长度，受目录表 url 列宽度限制
+        static constexpr size_t MAX_SEGMENT_SIZE = 255; // 单个路径段的最大长度
+
+        // 规范化客户端相对路径：'\\' 视为分隔符，去掉空段与 "."；含 ".." 或结果为空时返回false
+        static bool normalize(const std::string &path, std::string *normalized);
+        // 用户名、主机名作为单个路径段：字母、数字和 "._-" 原样保留，其余字节（含 '%'）按 %XX 编码，
+        // 不同的输入得到不同的段（如中文用户名互不冲突）；为空时使用 fallback，恰好等于 fallback 的输入首字符编码，
+        // 与空输入区分；编码后超长时截断并附加原文的哈希
+        static std::string sanitize_segment(const std::string &segment, const std::string &fallback);
+        // 百分号编码：字母、数字和 "._-" 原样保留，其余字节按 %XX 编码，可用于URL查询参数
+        static std::string percent_encode(const std::string &value);
+        // 组合命名空间键，超过最大长度时返回false
+        static bool make_key(const std::string &user, const std::string &host, const std::string &relative_path,
+                             std::string *key);
+        // 键在存储目录下的分片相对路径：<2位>/<2位>/<16位哈希>_<文件名>
+        static std::string shard_path(const std::string &key);
+        // 一次上传的存储相对路径：分片路径加进程内唯一的后缀，同一键的多个版本互不覆盖
+        static std::string version_shard_path(const std::string &key);
+    };
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+namespace zbackup::util
+{
+    // 令牌桶限速器：按固定速率补充令牌，桶容量限制突发量；rate为0表示不限速
+    class RateLimiter
+    {
+    public:
+        explicit RateLimiter(size_t rate, size_t burst = 0);
+
+        // 获取n个令牌，不足时阻塞等待（允许单次请求超过桶容量，超出部分以等待时间偿还）
+        void acquire(size_t n);
+        // 非阻塞获取，令牌不足返回false
+        bool try_acquire(size_t n);
+
+        void set_rate(size_t rate, size_t burst = 0);
+        [[nodiscard]] size_t get_rate() const;
+
+    private:
+        void refill(std::chrono::steady_clock::time_point now);
+
+    private:
+        mutable std::mutex mutex_;
+        size_t rate_;     // 每秒补充的令牌数
+        double capacity_; // 桶容量
+        double tokens_;   // 当前令牌数（可为负，表示欠账）
+        std::chrono::steady_clock::time_point last_refill_;
+    };
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zbackup::util
+{
+    // GF(2^8) 运算（本原多项式 x^8+x^4+x^3+x^2+1），纠删码的区域乘加按CPU特性选择实现
+    namespace gf256
+    {
+        // dst ^= c * src，逐字节
+        using MulAddFunc = void (*)(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len);
+
+        struct Kernel
+        {
+            const char *name;
+            MulAddFunc mul_add;
+        };
+
+        uint8_t mul(uint8_t a, uint8_t b);
+        uint8_t inv(uint8_t a);
+
+        // 当前CPU可用的全部实现，第一个为查表实现，最后一个最快（用于基准测试对比）
+        const std::vector<Kernel> &kernels();
+        // 进程启动时选定的实现：AVX2 > SSSE3 > 查表
+        const Kernel &best_kernel();
+    }
+
+    // 系统 Reed-Solomon 编码：k 个数据分片原样保存，m 个校验分片由柯西矩阵生成
+    // 任意 k 个分片即可恢复全部数据；要求 k >= 1，m >= 0，k + m <= 256
+    class ReedSolomon
+    {
+    public:
+        // kernel 为空时使用 best_kernel()；参数非法时抛出 std::invalid_argument
+        ReedSolomon(int data_shards, int parity_shards, const gf256::Kernel *kernel = nullptr);
+
+        [[nodiscard]] int data_shards() const { return k_; }
+        [[nodiscard]] int parity_shards() const { return m_; }
+        [[nodiscard]] int total_shards() const { return k_ + m_; }
+
+        // 由 k 个数据分片计算 m 个校验分片，每个分片长度均为 len
+        void encode(const uint8_t *const *data, uint8_t *const *parity, size_t len) const;
+
+        // shards 为全部 k+m 个分片的缓冲区，present 标记其中内容可用的分片
+        // 恢复缺失的数据分片；rebuild_parity 为true时同时重算缺失的校验分片；可用分片少于 k 时返回false
+        bool reconstruct(uint8_t *const *shards, const bool *present, size_t len, bool rebuild_parity = false) const;
+
+    private:
+        // out = sum(coefs[i] * srcs[i])
+        void combine(const uint8_t *coefs, const uint8_t *const *srcs, int count, uint8_t *out, size_t len) const;
+
+    private:
+        int k_;
+        int m_;
+        std::vector<uint8_t> parity_matrix_; // m 行 k 列，第 i 行为第 i 个校验分片的系数
+        const gf256::Kernel *kernel_;
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "util/checksum.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace zbackup::util
+{
+    // 快照清单的头部：一个快照是某个主机命名空间在某一时刻的全部文件
+    struct SnapshotHeader
+    {
+        std::string id;    // 快照ID，按创建时间排序
+        std::string owner; // 创建者用户名
+        std::string host;  // 主机名
+        std::string base;  // 主机命名空间的URL前缀：<下载前缀><用户>/<主机>/
+        time_t created = 0;
+    };
+
+    // 清单中的一个文件：不可变的版本，恢复时不需要再查询目录
+    struct SnapshotEntry
+    {
+        std::string path;      // 相对 base 的路径，加上 base 即为不带版本的URL
+        uint32_t version = 0;
+        uint64_t size = 0;
+        time_t mtime = 0;
+        std::string checksum;  // CRC32C 小写十六进制，为空表示未计算
+        std::string real_path; // 数据文件
+        std::string pack_path; // 压缩包，打包后数据文件被删除
+    };
+
+    // 清单结尾的汇总信息，定长，不读完整个清单即可取得
+    struct SnapshotTrailer
+    {
+        uint64_t files = 0;
+        uint64_t bytes = 0;
+    };
+
+    // 快照清单二进制格式：头部 + 按路径排序的条目流 + 定长结尾，可以边写边输出、边读边处理
+    // 整数为 LEB128 变长编码；路径与存储路径只记录与上一条目不同的后缀，同目录下的文件名几乎不重复存储
+    // 结尾记录条目数、总字节数与此前全部内容的 CRC32C
+    class ManifestWriter
+    {
+    public:
+        ManifestWriter() = default;
+        ~ManifestWriter();
+
+        ManifestWriter(const ManifestWriter &) = delete;
+        ManifestWriter &operator=(const ManifestWriter &) = delete;
+
+        // 在 path 的临时文件上开始写入，finish 成功后才改名为 path
+        bool open(const std::string &path, const SnapshotHeader &header);
+        // 追加条目，调用方保证按 path 升序
+        bool add(const SnapshotEntry &entry);
+        // 写入结尾并落盘改名；失败时删除临时文件
+        bool finish(SnapshotTrailer *trailer);
+
+    private:
+        bool flush();
+        void abort();
+
+    private:
+        int fd_ = -1;
+        std::string path_;
+        std::string temp_path_;
+        std::string buffer_;
+        SnapshotEntry last_; // 上一个条目，用于前缀压缩
+        SnapshotTrailer trailer_;
+        Crc32c crc_;
+        bool failed_ = false;
+    };
+
+    class ManifestReader
+    {
+    public:
+        ManifestReader() = default;
+        ~ManifestReader();
+
+        ManifestReader(const ManifestReader &) = delete;
+        ManifestReader &operator=(const ManifestReader &) = delete;
+
+        // 打开清单并读取头部，格式错误返回false
+        bool open(const std::string &path, SnapshotHeader *header);
+        // 读取下一个条目；读到结尾时返回false，此时 done() 为true表示结尾校验通过
+        bool next(SnapshotEntry *entry);
+        [[nodiscard]] bool done() const { return done_; }
+        [[nodiscard]] const SnapshotTrailer &trailer() const { return trailer_; }
+
+        // 只读取头部与结尾（不校验条目内容），用于启动时建立快照索引
+        static bool read_summary(const std::string &path, SnapshotHeader *header, SnapshotTrailer *trailer);
+
+    private:
+        // 保证缓冲区中至少有 n 个未读字节，文件已读完时返回false
+        bool fill(size_t n);
+        bool read_byte(uint8_t *value);
+        bool read_varint(uint64_t *value);
+        bool read_string(std::string *value);
+        bool read_delta(std::string *value);
+        bool read_trailer();
+
+    private:
+        int fd_ = -1;
+        std::string buffer_;
+        size_t pos_ = 0;
+        bool eof_ = false;
+        bool done_ = false;
+        SnapshotEntry last_;
+        SnapshotTrailer trailer_;
+        uint64_t count_ = 0;
+        Crc32c crc_; // 已移出缓冲区的字节的校验值
+    };
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace zbackup::util
+{
+    // POSIX ustar 归档格式：每个成员一个512字节头部，内容补齐到整块，归档以两个全零块结尾
+    // 所有长度在写入前即可算出，调用方可以预先分配整个归档并把成员内容直接读到对应位置
+    class TarWriter
+    {
+    public:
+        static constexpr size_t BLOCK_SIZE = 512;
+        static constexpr size_t END_SIZE = 2 * BLOCK_SIZE; // 结尾的两个全零块
+
+        // 成员头部占用的字节数；名字放不进 ustar 的 name/prefix 字段时额外带一个 PAX 扩展头
+        static size_t header_size(const std::string &name);
+        // 内容补齐到整块后的字节数
+        static size_t padded_size(uint64_t size) { return (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE; }
+        // 在 out 处写入普通文件成员的头部，out 至少有 header_size(name) 字节
+        static void write_header(char *out, const std::string &name, uint64_t size, time_t mtime);
+
+    private:
+        // 能否拆成 prefix/name 放进 ustar 头部，可以时返回拆分位置（npos 表示不需要拆分）
+        static bool split_name(const std::string &name, size_t *split);
+        static std::string pax_records(const std::string &name);
+        static void write_block(char *block, const std::string &name, const std::string &prefix, uint64_t size,
+                                time_t mtime, char type);
+    };
+}
@@ -4,6 +4,7 @@
 #include <cerrno>
 #include <fstream>
 #include <filesystem>
+#include <functional>
 #include <sys/stat.h>
 #include <nlohmann/json.hpp>
 #include "core/config_service.h"
@@ -35,11 +36,17 @@ namespace zbackup::util
 
         // 文件内容操作
         bool get_pos_len(std::string *body, size_t pos, size_t len); // 读取指定位置和长度
+        bool get_pos_len(char *data, size_t pos, size_t len);        // 读取到调用方提供的缓冲区
         bool get_content(std::string *body);                         // 读取整个文件内容
         bool set_content(const std::string &body);                   // 写入文件内容
+        bool set_content(const char *data, size_t len);              // 写入缓冲区内容
+        // 分块写入文件内容，每写完一块回调一次（用于写入同时计算校验值）
+        bool set_content(const std::string &body, const std::function<void(const char *, size_t)> &on_chunk);
+        bool set_content(const char *data, size_t len, const std::function<void(const char *, size_t)> &on_chunk);
+        bool rename_to(const std::string &new_path);                 // 重命名/移动文件
 
         // 目录操作
-        void scan_directory(std::vector<std::string> *arry); // 扫描目录中的文件
+        void scan_directory(std::vector<std::string> *arry, bool recursive = false); // 扫描目录中的文件，可递归子目录
 
     private:
         std::string pathname_; // 文件路径
@@ -64,5 +71,6 @@ namespace zbackup::util
     
     // 工具函数
     std::string time_to_str(time_t timestamp);
+    std::string get_etag(const std::string &path, size_t fsize, time_t mtime);
     std::string get_etag(const info::BackupInfo &info);
 }
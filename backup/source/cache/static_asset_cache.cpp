@@ -0,0 +1,260 @@
+#include "cache/static_asset_cache.h"
+#include "compress/content_codec.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <filesystem>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+
+namespace zbackup::cache
+{
+    namespace fs = std::filesystem;
+
+    // 监听的目录事件：文件写入完成、创建、删除、移动
+    static constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                           IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+    // 事件合并窗口，编辑器保存时通常会产生一串事件
+    static constexpr int RELOAD_DEBOUNCE_MS = 200;
+
+    StaticAssetCache::StaticAssetCache(std::string root_dir, size_t min_compress_size)
+        : root_dir_(std::move(root_dir)), min_compress_size_(min_compress_size),
+          assets_(std::make_shared<const AssetMap>()), stop_(true), inotify_fd_(-1), wakeup_fd_(-1)
+    {
+        if (!root_dir_.empty() && root_dir_.back() != '/')
+        {
+            root_dir_ += '/';
+        }
+    }
+
+    StaticAssetCache::~StaticAssetCache()
+    {
+        stop_watch();
+    }
+
+    bool StaticAssetCache::load()
+    {
+        if (!fs::is_directory(root_dir_))
+        {
+            ZBACKUP_LOG_ERROR("Static resource directory not found: {}", root_dir_);
+            return false;
+        }
+
+        auto assets = build_assets();
+        std::atomic_store(&assets_, assets);
+        ZBACKUP_LOG_INFO("Static assets loaded from {}: {} files", root_dir_, assets->size());
+        return true;
+    }
+
+    StaticAssetCache::AssetPtr StaticAssetCache::find(const std::string &path) const
+    {
+        auto assets = std::atomic_load(&assets_);
+        auto it = assets->find(path);
+        return it != assets->end() ? it->second : nullptr;
+    }
+
+    size_t StaticAssetCache::size() const
+    {
+        return std::atomic_load(&assets_)->size();
+    }
+
+    std::shared_ptr<const StaticAsset> StaticAssetCache::build_asset(const std::string &file_path) const
+    {
+        util::FileUtil fu(file_path);
+        auto asset = std::make_shared<StaticAsset>();
+        if (!fu.get_content(&asset->content))
+        {
+            ZBACKUP_LOG_WARN("Failed to load static asset: {}", file_path);
+            return nullptr;
+        }
+
+        size_t dot_pos = file_path.find_last_of('.');
+        std::string extension = (dot_pos != std::string::npos) ? file_path.substr(dot_pos) : "";
+        asset->mime_type = get_mime_type(extension);
+        asset->mtime = fu.get_last_mtime();
+        asset->etag = util::get_etag(file_path, asset->content.size(), asset->mtime);
+        asset->gzip_etag = asset->etag + "-gz";
+        asset->br_etag = asset->etag + "-br";
+
+        // 预压缩文本类资源，压缩后没有变小则不保留
+        if (asset->content.size() >= min_compress_size_ && is_compressible(asset->mime_type))
+        {
+            if (!ContentCodec::gzip(asset->content, &asset->gzip_content, 9) ||
+                asset->gzip_content.size() >= asset->content.size())
+            {
+                asset->gzip_content.clear();
+            }
+            if (!ContentCodec::brotli(asset->content, &asset->br_content, 11) ||
+                asset->br_content.size() >= asset->content.size())
+            {
+                asset->br_content.clear();
+            }
+        }
+
+        ZBACKUP_LOG_DEBUG("Static asset cached: {} ({} bytes, gzip {}, br {})", file_path,
+                          asset->content.size(), asset->gzip_content.size(), asset->br_content.size());
+        return asset;
+    }
+
+    std::shared_ptr<const StaticAssetCache::AssetMap> StaticAssetCache::build_assets() const
+    {
+        auto assets = std::make_shared<AssetMap>();
+        try
+        {
+            for (const auto &entry : fs::recursive_directory_iterator(root_dir_))
+            {
+                if (!entry.is_regular_file())
+                    continue;
+
+                std::string file_path = entry.path().string();
+                auto asset = build_asset(file_path);
+                if (asset)
+                {
+                    (*assets)[fs::relative(entry.path(), root_dir_).generic_string()] = std::move(asset);
+                }
+            }
+        }
+        catch (const std::exception &e)
+        {
+            ZBACKUP_LOG_ERROR("Failed to scan static resource directory [{}]: {}", root_dir_, e.what());
+        }
+        return assets;
+    }
+
+    bool StaticAssetCache::start_watch()
+    {
+        if (!stop_)
+        {
+            return true;
+        }
+
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotify_fd_ < 0 || wakeup_fd_ < 0 || !add_watches())
+        {
+            ZBACKUP_LOG_ERROR("Failed to watch static resource directory [{}]: {}", root_dir_, strerror(errno));
+            stop_watch();
+            return false;
+        }
+
+        stop_ = false;
+        watch_thread_ = std::thread([this] { watch_loop(); });
+        ZBACKUP_LOG_INFO("Watching static resource directory for changes: {}", root_dir_);
+        return true;
+    }
+
+    void StaticAssetCache::stop_watch()
+    {
+        stop_ = true;
+        if (wakeup_fd_ >= 0)
+        {
+            uint64_t one = 1;
+            ssize_t ret = write(wakeup_fd_, &one, sizeof(one));
+            (void)ret;
+        }
+        if (watch_thread_.joinable())
+        {
+            watch_thread_.join();
+        }
+        if (inotify_fd_ >= 0)
+        {
+            close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+        if (wakeup_fd_ >= 0)
+        {
+            close(wakeup_fd_);
+            wakeup_fd_ = -1;
+        }
+    }
+
+    bool StaticAssetCache::add_watches()
+    {
+        // inotify不递归，需要为每个子目录单独添加监听（重复添加同一目录是安全的）
+        if (inotify_add_watch(inotify_fd_, root_dir_.c_str(), WATCH_MASK) < 0)
+        {
+            return false;
+        }
+        try
+        {
+            for (const auto &entry : fs::recursive_directory_iterator(root_dir_))
+            {
+                if (entry.is_directory())
+                {
+                    inotify_add_watch(inotify_fd_, entry.path().c_str(), WATCH_MASK);
+                }
+            }
+        }
+        catch (const std::exception &e)
+        {
+            ZBACKUP_LOG_WARN("Failed to watch static resource subdirectories: {}", e.what());
+        }
+        return true;
+    }
+
+    void StaticAssetCache::watch_loop()
+    {
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        struct pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wakeup_fd_, POLLIN, 0}};
+
+        while (!stop_)
+        {
+            int ret = poll(fds, 2, -1);
+            if (ret < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                ZBACKUP_LOG_ERROR("Static asset watcher poll failed: {}", strerror(errno));
+                return;
+            }
+            if (stop_ || (fds[1].revents & POLLIN))
+            {
+                return;
+            }
+
+            // 读空事件，并在合并窗口内继续吸收后续事件，随后整体重新加载一次
+            do
+            {
+                while (read(inotify_fd_, buffer, sizeof(buffer)) > 0)
+                {
+                }
+            } while (!stop_ && poll(fds, 1, RELOAD_DEBOUNCE_MS) > 0);
+
+            if (stop_)
+            {
+                return;
+            }
+            ZBACKUP_LOG_INFO("Static resource directory changed, reloading: {}", root_dir_);
+            load();
+            add_watches();
+        }
+    }
+
+    std::string StaticAssetCache::get_mime_type(const std::string &extension)
+    {
+        static const std::unordered_map<std::string, std::string> mime_types = {
+            {".html", "text/html; charset=UTF-8"},
+            {".css", "text/css"},
+            {".js", "application/javascript"},
+            {".json", "application/json"},
+            {".svg", "image/svg+xml"},
+            {".png", "image/png"},
+            {".jpg", "image/jpeg"},
+            {".jpeg", "image/jpeg"},
+            {".gif", "image/gif"},
+            {".ico", "image/x-icon"}};
+
+        auto it = mime_types.find(extension);
+        return (it != mime_types.end()) ? it->second : "application/octet-stream";
+    }
+
+    bool StaticAssetCache::is_compressible(const std::string &mime_type)
+    {
+        return mime_type.compare(0, 5, "text/") == 0 ||
+               mime_type == "application/javascript" ||
+               mime_type == "application/json" ||
+               mime_type == "image/svg+xml";
+    }
+}
@@ -0,0 +1,89 @@
+#include "compress/content_codec.h"
+#include "log/backup_logger.h"
+#include <zlib.h>
+#include <brotli/encode.h>
+
+namespace zbackup
+{
+    bool ContentCodec::gzip(const std::string &input, std::string *output, int level)
+    {
+        // windowBits + 16 输出gzip头和尾
+        return zlib_compress(input, output, level, MAX_WBITS + 16);
+    }
+
+    bool ContentCodec::deflate(const std::string &input, std::string *output, int level)
+    {
+        // HTTP的deflate编码为zlib格式
+        return zlib_compress(input, output, level, MAX_WBITS);
+    }
+
+    bool ContentCodec::brotli(const std::string &input, std::string *output, int quality)
+    {
+        if (quality == DEFAULT_LEVEL)
+        {
+            quality = BROTLI_DEFAULT_QUALITY;
+        }
+
+        size_t encoded_size = BrotliEncoderMaxCompressedSize(input.size());
+        if (encoded_size == 0)
+        {
+            ZBACKUP_LOG_ERROR("Brotli input too large: {} bytes", input.size());
+            return false;
+        }
+
+        output->resize(encoded_size);
+        if (!BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_GENERIC,
+                                   input.size(), reinterpret_cast<const uint8_t *>(input.data()),
+                                   &encoded_size, reinterpret_cast<uint8_t *>(&(*output)[0])))
+        {
+            ZBACKUP_LOG_ERROR("Brotli compression failed for {} bytes", input.size());
+            return false;
+        }
+        output->resize(encoded_size);
+        return true;
+    }
+
+    bool ContentCodec::encode(const std::string &encoding, const std::string &input, std::string *output, int level)
+    {
+        if (encoding == "br")
+            return brotli(input, output, level);
+        if (encoding == "gzip")
+            return gzip(input, output, level);
+        if (encoding == "deflate")
+            return deflate(input, output, level);
+        return false;
+    }
+
+    bool ContentCodec::zlib_compress(const std::string &input, std::string *output, int level, int window_bits)
+    {
+        if (level == DEFAULT_LEVEL)
+        {
+            level = Z_DEFAULT_COMPRESSION;
+        }
+
+        z_stream stream{};
+        if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            ZBACKUP_LOG_ERROR("deflateInit2 failed: {}", stream.msg ? stream.msg : "unknown");
+            return false;
+        }
+
+        output->resize(deflateBound(&stream, input.size()));
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef *>(&(*output)[0]);
+        stream.avail_out = static_cast<uInt>(output->size());
+
+        int ret = ::deflate(&stream, Z_FINISH);
+        if (ret != Z_STREAM_END)
+        {
+            ZBACKUP_LOG_ERROR("deflate failed with code {}", ret);
+            deflateEnd(&stream);
+            return false;
+        }
+
+        output->resize(stream.total_out);
+        deflateEnd(&stream);
+        return true;
+    }
+}
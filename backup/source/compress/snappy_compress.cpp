@@ -6,9 +6,50 @@
 #include "compress/snappy_compress.h"
 #include "log/backup_logger.h"
 #include "util/util.h"
+#include "util/local_buffer.h"
 
 namespace zbackup
 {
+    namespace
+    {
+        // 超过该大小的缓冲区用完即释放，避免每个工作线程长期占用大量内存
+        constexpr size_t MAX_RETAINED_BUFFER = 64 * 1024 * 1024;
+
+        // 每个编解码线程复用的输入/输出缓冲区，线程绑核后内存位于本地NUMA节点
+        struct CodecBuffers
+        {
+            util::LocalBuffer input;
+            util::LocalBuffer output;
+
+            void trim()
+            {
+                if (input.capacity() > MAX_RETAINED_BUFFER)
+                    input.release();
+                if (output.capacity() > MAX_RETAINED_BUFFER)
+                    output.release();
+            }
+        };
+
+        CodecBuffers &local_buffers()
+        {
+            thread_local CodecBuffers buffers;
+            return buffers;
+        }
+
+        // 读取整个文件到线程本地输入缓冲区
+        bool read_file(const std::string &path, util::LocalBuffer *buffer, size_t *len)
+        {
+            util::FileUtil fu(path);
+            int64_t size = fu.get_size();
+            if (size < 0 || !buffer->reserve(size))
+            {
+                return false;
+            }
+            *len = static_cast<size_t>(size);
+            return fu.get_pos_len(buffer->data(), 0, *len);
+        }
+    }
+
     /**
      * @brief 压缩文件
      * @param source_path 源文件路径
@@ -18,34 +59,37 @@ namespace zbackup
     bool SnappyCompress::compress(const std::string& source_path, const std::string& target_path)
     {
         // 1. 读取源文件内容
-        util::FileUtil tu(source_path);
-        std::string body;
-        if (tu.get_content(&body) == false)
+        auto &buffers = local_buffers();
+        size_t body_len = 0;
+        if (!read_file(source_path, &buffers.input, &body_len))
         {
             ZBACKUP_LOG_ERROR("Failed to read file for compression: {}", source_path);
+            buffers.trim();
             return false;
         }
 
         // 2. 执行Snappy压缩
-        std::string packed;
-        packed.resize(body.size());
-
-        if (!snappy::Compress(body.data(), body.size(), &packed))
+        size_t packed_len = 0;
+        if (!buffers.output.reserve(snappy::MaxCompressedLength(body_len)))
         {
-            ZBACKUP_LOG_ERROR("Snappy compression failed for: {}", source_path);
+            ZBACKUP_LOG_ERROR("Failed to allocate compression buffer for: {}", source_path);
+            buffers.trim();
             return false;
         }
+        snappy::RawCompress(buffers.input.data(), body_len, buffers.output.data(), &packed_len);
 
         // 3. 写入压缩后的数据
         util::FileUtil fu(target_path);
-        if (!fu.set_content(packed))
+        bool ok = fu.set_content(buffers.output.data(), packed_len);
+        buffers.trim();
+        if (!ok)
         {
             ZBACKUP_LOG_ERROR("Failed to write compressed data to: {}", target_path);
             return false;
         }
 
         ZBACKUP_LOG_INFO("File compressed: {} -> {} ({} -> {} bytes)",
-                         source_path, target_path, body.size(), packed.size());
+                         source_path, target_path, body_len, packed_len);
         return true;
     }
 
@@ -58,42 +102,77 @@ namespace zbackup
     bool SnappyCompress::un_compress(const std::string& target_path, const std::string& source_path)
     {
         // 1. 读取压缩文件内容
-        util::FileUtil tu(source_path);
-        std::string body;
-        if (tu.get_content(&body) == false)
+        auto &buffers = local_buffers();
+        size_t body_len = 0;
+        if (!read_file(source_path, &buffers.input, &body_len))
         {
             ZBACKUP_LOG_ERROR("Failed to read compressed file: {}", source_path);
+            buffers.trim();
             return false;
         }
 
         // 2. 获取解压后的数据长度
         size_t uncompressed_len = 0;
-        if (!snappy::GetUncompressedLength(body.data(), body.size(), &uncompressed_len))
+        if (!snappy::GetUncompressedLength(buffers.input.data(), body_len, &uncompressed_len))
         {
             ZBACKUP_LOG_ERROR("Failed to get uncompressed length for: {}", source_path);
+            buffers.trim();
             return false;
         }
 
         // 3. 执行Snappy解压缩
-        std::string unpacked;
-        unpacked.resize(uncompressed_len);
-
-        if (!snappy::Uncompress(body.data(), body.size(), &unpacked))
+        if (!buffers.output.reserve(uncompressed_len) ||
+            !snappy::RawUncompress(buffers.input.data(), body_len, buffers.output.data()))
         {
             ZBACKUP_LOG_ERROR("Snappy decompression failed for: {}", source_path);
+            buffers.trim();
             return false;
         }
 
         // 4. 写入解压后的数据
         util::FileUtil fu(target_path);
-        if (!fu.set_content(unpacked))
+        bool ok = fu.set_content(buffers.output.data(), uncompressed_len);
+        buffers.trim();
+        if (!ok)
         {
             ZBACKUP_LOG_ERROR("Failed to write decompressed data to: {}", target_path);
             return false;
         }
 
         ZBACKUP_LOG_INFO("File decompressed: {} -> {} ({} -> {} bytes)",
-                         source_path, target_path, body.size(), unpacked.size());
+                         source_path, target_path, body_len, uncompressed_len);
+        return true;
+    }
+
+    /**
+     * @brief 解压缩文件到内存
+     * @param source_path 源压缩文件路径
+     * @param data 输出缓冲区
+     * @param len 输出缓冲区长度，必须等于解压后的长度
+     * @return 解压成功返回true，失败返回false
+     */
+    bool SnappyCompress::un_compress_to(const std::string& source_path, char* data, size_t len)
+    {
+        auto &buffers = local_buffers();
+        size_t body_len = 0;
+        if (!read_file(source_path, &buffers.input, &body_len))
+        {
+            ZBACKUP_LOG_ERROR("Failed to read compressed file: {}", source_path);
+            buffers.trim();
+            return false;
+        }
+
+        // 直接解压到调用方缓冲区，不经过线程本地输出缓冲区
+        size_t uncompressed_len = 0;
+        bool ok = snappy::GetUncompressedLength(buffers.input.data(), body_len, &uncompressed_len) &&
+                  uncompressed_len == len && snappy::RawUncompress(buffers.input.data(), body_len, data);
+        buffers.trim();
+        if (!ok)
+        {
+            ZBACKUP_LOG_ERROR("Snappy decompression failed for: {} (expected {} bytes, got {})",
+                              source_path, len, uncompressed_len);
+            return false;
+        }
         return true;
     }
 }
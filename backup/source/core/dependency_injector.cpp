@@ -11,9 +11,15 @@
 #include "storage/database/database_user_storage.h"
 #include "storage/file/file_backup_storage.h"
 #include "storage/file/file_user_storage.h"
+#include "storage/blob/local_blob_store.h"
+#include "storage/blob/s3_blob_store.h"
+#include "storage/blob/erasure_blob_store.h"
 #include "compress/snappy_compress.h"
 #include "util/util.h"
 #include "log/backup_logger.h"
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 namespace zbackup::core
 {
@@ -36,6 +42,7 @@ namespace zbackup::core
             step5_create_and_register_compressor();
             step6_create_and_register_auth_layer();
             step7_create_and_register_factory_and_registry();
+            step8_create_and_register_static_cache();
             
             ZBACKUP_LOG_INFO("Dependency injection completed successfully");
         }
@@ -86,6 +93,7 @@ namespace zbackup::core
         auto& container = ServiceContainer::get_instance();
         container.register_instance<interfaces::IBackupStorage>(backup_storage_);
         container.register_instance<interfaces::IUserStorage>(user_storage_);
+        container.register_instance<storage::BlobTiers>(blob_tiers_);
         
         ZBACKUP_LOG_DEBUG("Storage layer registered to container");
     }
@@ -99,6 +107,7 @@ namespace zbackup::core
         auto& container = ServiceContainer::get_instance();
         container.register_instance<interfaces::IDataManager>(data_manager_);
         container.register_instance<interfaces::IUserManager>(user_manager_);
+        container.register_instance<SnapshotManager>(snapshot_manager_);
         
         ZBACKUP_LOG_DEBUG("Manager layer registered to container");
     }
@@ -141,6 +150,25 @@ namespace zbackup::core
         ZBACKUP_LOG_DEBUG("Factory and registry registered to container");
     }
 
+    void DependencyInjector::step8_create_and_register_static_cache()
+    {
+        ZBACKUP_LOG_DEBUG("Step 8: Creating and registering static asset cache");
+
+        static_cache_ = std::make_shared<cache::StaticAssetCache>(
+            config_manager_->get_string("resource_dir", "../resource/"),
+            config_manager_->get_int("static_compress_min_size", 256));
+        if (!static_cache_->load())
+        {
+            throw std::runtime_error("Failed to load static resources");
+        }
+        static_cache_->start_watch();
+
+        auto& container = ServiceContainer::get_instance();
+        container.register_instance<cache::StaticAssetCache>(static_cache_);
+
+        ZBACKUP_LOG_DEBUG("Static asset cache registered to container");
+    }
+
     void DependencyInjector::create_config_manager()
     {
         config_manager_ = std::make_shared<ConfigService>(config_.config_file);
@@ -156,12 +184,82 @@ namespace zbackup::core
             backup_storage_ = std::make_shared<storage::FileBackupStorage>();
             user_storage_ = std::make_shared<storage::FileUserStorage>();
         }
+
+        // 压缩包的热层与冷层："local" 为本地目录，"s3" 为S3兼容对象存储，"erasure" 为多磁盘纠删码存储
+        std::string pack_dir = config_manager_->get_string("pack_dir", "./pack/");
+        auto hot = create_blob_store(config_manager_->get_string("pack_store", "local"), pack_dir,
+                                     config_manager_->get_string("s3_pack_prefix", "pack/"), "");
+        auto cold = create_blob_store(config_manager_->get_string("cold_store", "local"),
+                                      config_manager_->get_string("cold_dir", "../colddir/"),
+                                      config_manager_->get_string("s3_cold_prefix", "cold/"),
+                                      config_manager_->get_string("s3_cold_storage_class", ""));
+        blob_tiers_ = std::make_shared<storage::BlobTiers>(pack_dir, hot, cold);
+        ZBACKUP_LOG_INFO("Pack storage: hot tier {}, cold tier {}", hot->name(), cold->name());
+    }
+
+    interfaces::IBlobStore::ptr DependencyInjector::create_blob_store(const std::string &kind, const std::string &local_root,
+                                                                       const std::string &prefix,
+                                                                       const std::string &storage_class) const
+    {
+        if (kind == "local")
+        {
+            return std::make_shared<storage::LocalBlobStore>(local_root);
+        }
+        if (kind == "erasure")
+        {
+            // ec_dirs 为逗号分隔的目录列表，每个目录位于一块独立的磁盘上
+            std::vector<std::string> dirs;
+            std::stringstream list(config_manager_->get_string("ec_dirs", ""));
+            std::string dir;
+            while (std::getline(list, dir, ','))
+            {
+                if (!dir.empty())
+                    dirs.push_back(dir + (dir.back() == '/' ? "" : "/") + prefix);
+            }
+            storage::ErasureOptions options;
+            options.data_shards = config_manager_->get_int("ec_data_shards", options.data_shards);
+            options.parity_shards = config_manager_->get_int("ec_parity_shards", options.parity_shards);
+            options.chunk_size = static_cast<size_t>(std::max(config_manager_->get_int("ec_chunk_kb", 256), 4)) << 10;
+            if (dirs.empty())
+            {
+                throw std::runtime_error("ec_dirs is required for the erasure blob store");
+            }
+            return std::make_shared<storage::ErasureBlobStore>(std::move(dirs), options);
+        }
+        if (kind != "s3")
+        {
+            throw std::runtime_error("Unknown blob store: " + kind);
+        }
+
+        storage::S3Options options;
+        options.endpoint = config_manager_->get_string("s3_endpoint", options.endpoint);
+        options.bucket = config_manager_->get_string("s3_bucket", "");
+        options.region = config_manager_->get_string("s3_region", options.region);
+        options.access_key = config_manager_->get_string("s3_access_key", "");
+        options.secret_key = config_manager_->get_string("s3_secret_key", "");
+        options.prefix = prefix;
+        options.storage_class = storage_class;
+        options.part_size = static_cast<size_t>(std::max(config_manager_->get_int("s3_part_size_mb", 16), 5)) << 20;
+        options.pool_size = static_cast<size_t>(std::max(config_manager_->get_int("s3_pool_size", 8), 1));
+        options.timeout_ms = std::max(config_manager_->get_int("s3_timeout_ms", 30000), 1000);
+        if (options.bucket.empty())
+        {
+            throw std::runtime_error("s3_bucket is required for the s3 blob store");
+        }
+        return std::make_shared<storage::S3BlobStore>(std::move(options));
     }
 
     void DependencyInjector::create_manager_components()
     {
         data_manager_ = std::make_shared<DataManager>(backup_storage_);
         user_manager_ = std::make_shared<UserManager>(user_storage_);
+
+        snapshot_manager_ = std::make_shared<SnapshotManager>(
+            config_manager_->get_string("snapshot_dir", "../snapshot/"));
+        if (!snapshot_manager_->load())
+        {
+            throw std::runtime_error("Failed to load snapshots");
+        }
     }
 
     void DependencyInjector::create_auth_components()
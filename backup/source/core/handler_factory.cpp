@@ -1,7 +1,10 @@
 #include "core/handler_factory.h"
 #include "handlers/upload_handler.h"
 #include "handlers/download_handler.h"
+#include "handlers/archive_handler.h"
 #include "handlers/listshow_handler.h"
+#include "handlers/versions_handler.h"
+#include "handlers/snapshot_handler.h"
 #include "handlers/delete_handler.h"
 #include "handlers/static_handler.h"
 #include "handlers/login_handler.h"
@@ -16,11 +19,41 @@ namespace zbackup::core
         return std::make_shared<UploadHandler>();
     }
 
+    HandlerFactory::HandlerPtr HandlerFactory::create_batch_upload_handler()
+    {
+        return std::make_shared<UploadHandler>(true);
+    }
+
     HandlerFactory::HandlerPtr HandlerFactory::create_download_handler()
     {
         return std::make_shared<DownloadHandler>();
     }
 
+    HandlerFactory::HandlerPtr HandlerFactory::create_archive_handler()
+    {
+        return std::make_shared<ArchiveHandler>();
+    }
+
+    HandlerFactory::HandlerPtr HandlerFactory::create_versions_handler()
+    {
+        return std::make_shared<VersionsHandler>();
+    }
+
+    HandlerFactory::HandlerPtr HandlerFactory::create_snapshot_create_handler()
+    {
+        return std::make_shared<SnapshotHandler>(SnapshotHandler::Action::CREATE);
+    }
+
+    HandlerFactory::HandlerPtr HandlerFactory::create_snapshot_show_handler()
+    {
+        return std::make_shared<SnapshotHandler>(SnapshotHandler::Action::SHOW);
+    }
+
+    HandlerFactory::HandlerPtr HandlerFactory::create_snapshot_delete_handler()
+    {
+        return std::make_shared<SnapshotHandler>(SnapshotHandler::Action::REMOVE);
+    }
+
     HandlerFactory::HandlerPtr HandlerFactory::create_list_handler()
     {
         return std::make_shared<ListShowHandler>();
@@ -3,14 +3,37 @@
 #include "core/service_container.h"
 #include "interfaces/auth_manager_interface.h"
 #include "interfaces/session_manager_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "handlers/async_handler.h"
+#include "log/backup_logger.h"
 #include <nlohmann/json.hpp>
 
 namespace zbackup::core
 {
+    // 把回调函数包装为路由处理器，以便交给异步处理器
+    class CallbackHandler final : public BaseHandler
+    {
+    public:
+        explicit CallbackHandler(std::function<void(const zhttp::HttpRequest &, zhttp::HttpResponse *)> callback)
+            : callback_(std::move(callback))
+        {
+        }
+
+        void handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) override
+        {
+            callback_(req, rsp);
+        }
+
+    private:
+        std::function<void(const zhttp::HttpRequest &, zhttp::HttpResponse *)> callback_;
+    };
+
     DefaultRouteRegistry::DefaultRouteRegistry(interfaces::IHandlerFactory::ptr handler_factory,
                                                interfaces::IConfigManager::ptr config_manager)
         : handler_factory_(std::move(handler_factory)), config_manager_(std::move(config_manager))
     {
+        int ttl = std::max(config_manager_->get_int("async_job_ttl_sec", 600), 1);
+        async_jobs_ = std::make_shared<AsyncJobRegistry>(std::chrono::seconds(ttl));
     }
 
     void DefaultRouteRegistry::register_routes(zhttp::HttpServer *server)
@@ -47,25 +70,59 @@ namespace zbackup::core
     void DefaultRouteRegistry::register_business_routes(zhttp::HttpServer *server)
     {
         auto static_handler = handler_factory_->create_static_handler();
-        auto upload_handler = handler_factory_->create_upload_handler();
-        auto list_handler = handler_factory_->create_list_handler();
-        auto download_handler = handler_factory_->create_download_handler();
-        auto delete_handler = handler_factory_->create_delete_handler();
+        // 上传与下载包含大文件读写和解压，列表需要查询数据库，都不在事件循环线程中执行
+        auto upload_handler = make_async(handler_factory_->create_upload_handler(), false);
+        auto batch_upload_handler = make_async(handler_factory_->create_batch_upload_handler(), false);
+        auto list_handler = make_async(handler_factory_->create_list_handler(), true);
+        // 共享键不含 file 参数，版本列表不共享进行中的请求
+        auto versions_handler = make_async(handler_factory_->create_versions_handler(), false);
+        // 快照的创建与读取清单都涉及文件读写
+        auto snapshot_create_handler = make_async(handler_factory_->create_snapshot_create_handler(), false);
+        auto snapshot_show_handler = make_async(handler_factory_->create_snapshot_show_handler(), false);
+        auto snapshot_delete_handler = make_async(handler_factory_->create_snapshot_delete_handler(), false);
+        auto download_handler = make_async(handler_factory_->create_download_handler(), true);
+        auto archive_handler = make_async(handler_factory_->create_archive_handler(), false);
+        // 删除会同步删除数据文件与对象存储中的压缩包
+        auto delete_handler = make_async(handler_factory_->create_delete_handler(), false);
         auto logout_handler = handler_factory_->create_logout_handler();
+        // 校验报告需要扫描当前用户的全部条目
+        auto scrub_report_handler = make_async(std::make_shared<CallbackHandler>(create_scrub_report_handler()), true);
 
         // 注册业务功能路由
         server->Get("/index.html", static_handler);
         server->Get("/index", static_handler);
         server->Post("/upload", upload_handler);
+        server->Post("/upload/batch", batch_upload_handler);
         server->Get("/listshow", list_handler);
+        server->Get("/versions", versions_handler);
+        server->Post("/snapshots", snapshot_create_handler);
+        server->Get("/snapshots", snapshot_show_handler);
+        server->Delete("/snapshots", snapshot_delete_handler);
+        server->Get("/archive", archive_handler);
+        server->Post("/archive", archive_handler);
         server->Delete("/delete", delete_handler);
         server->Post("/logout", logout_handler);
+        server->Get("/api/scrub", scrub_report_handler);
+        server->Get("/api/usage", create_usage_handler());
+        server->Get(AsyncJobRegistry::STATUS_PATH, std::make_shared<AsyncJobHandler>(async_jobs_));
 
-        // 注册下载路由
-        std::string download_url = config_manager_->get_download_prefix() + ":filename";
+        // 注册下载路由：命名空间中的URL包含多级路径（<用户>/<主机>/<相对路径>），匹配前缀之后的全部内容
+        std::string download_url = config_manager_->get_download_prefix() + "(.+)";
         server->add_regex_route(zhttp::HttpRequest::Method::GET, download_url, download_handler);
     }
 
+    interfaces::IHandlerFactory::HandlerPtr
+    DefaultRouteRegistry::make_async(interfaces::IHandlerFactory::HandlerPtr handler, bool share_inflight)
+    {
+        if (!config_manager_->get_bool("async_handler_enabled", true))
+        {
+            return handler;
+        }
+        int wait_ms = config_manager_->get_int("async_handler_wait_ms", 1000);
+        return std::make_shared<AsyncHandler>(std::move(handler), std::chrono::milliseconds(std::max(wait_ms, 0)),
+                                              share_inflight, async_jobs_);
+    }
+
     std::function<void(const zhttp::HttpRequest &, zhttp::HttpResponse *)>
     DefaultRouteRegistry::create_status_handler()
     {
@@ -106,6 +163,93 @@ namespace zbackup::core
         };
     }
 
+    std::function<void(const zhttp::HttpRequest &, zhttp::HttpResponse *)>
+    DefaultRouteRegistry::create_scrub_report_handler()
+    {
+        return [](const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) {
+            auto &container = ServiceContainer::get_instance();
+            auto data_manager = container.resolve<interfaces::IDataManager>();
+            auto session_service = container.resolve<interfaces::ISessionManager>();
+            if (!data_manager || !session_service)
+            {
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+                rsp->set_status_message("Internal Server Error");
+                rsp->set_body("Service unavailable");
+                return;
+            }
+
+            // 只报告当前用户的条目
+            std::vector<info::BackupInfo> arry;
+            data_manager->get_by_owner(session_service->get_username(req), &arry);
+
+            // 汇总后台校验结果，列出损坏或缺失的条目；不返回服务器上的存储路径
+            nlohmann::json report;
+            nlohmann::json corrupt = nlohmann::json::array();
+            size_t verified = 0;
+            for (const auto &bi : arry)
+            {
+                if (bi.verify_time_ > 0)
+                    verified++;
+                if (!bi.corrupt_flag_)
+                    continue;
+                nlohmann::json item;
+                item["url"] = bi.url_;
+                item["pack_flag"] = bi.pack_flag_;
+                item["cold"] = bi.pack_flag_ && bi.tier_ == info::StorageTier::COLD;
+                item["verify_time"] = util::time_to_str(bi.verify_time_);
+                corrupt.push_back(item);
+            }
+            report["total"] = arry.size();
+            report["verified"] = verified;
+            report["corrupt"] = corrupt;
+
+            std::string response_body;
+            util::JsonUtil::serialize(report, &response_body);
+
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
+            rsp->set_status_message("OK");
+            rsp->set_content_type("application/json");
+            rsp->set_header("Cache-Control", "no-store");
+            rsp->set_body(response_body);
+        };
+    }
+
+    std::function<void(const zhttp::HttpRequest &, zhttp::HttpResponse *)>
+    DefaultRouteRegistry::create_usage_handler()
+    {
+        return [config = config_manager_](const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp) {
+            auto &container = ServiceContainer::get_instance();
+            auto data_manager = container.resolve<interfaces::IDataManager>();
+            auto session_service = container.resolve<interfaces::ISessionManager>();
+            if (!data_manager || !session_service)
+            {
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+                rsp->set_status_message("Internal Server Error");
+                rsp->set_body("Service unavailable");
+                return;
+            }
+
+            // 当前用户的用量与配额，配额为0表示不限制
+            std::string owner = session_service->get_username(req);
+            auto usage = data_manager->get_usage(owner);
+            nlohmann::json report;
+            report["owner"] = owner;
+            report["bytes"] = usage.bytes;
+            report["files"] = usage.files;
+            report["quota_bytes"] = static_cast<uint64_t>(std::max(config->get_int("user_quota_mb", 0), 0)) << 20;
+            report["quota_files"] = std::max(config->get_int("user_quota_files", 0), 0);
+
+            std::string response_body;
+            util::JsonUtil::serialize(report, &response_body);
+
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
+            rsp->set_status_message("OK");
+            rsp->set_content_type("application/json");
+            rsp->set_header("Cache-Control", "no-store");
+            rsp->set_body(response_body);
+        };
+    }
+
     std::function<void(const zhttp::HttpRequest &, zhttp::HttpResponse *)>
     DefaultRouteRegistry::create_redirect_handler()
     {
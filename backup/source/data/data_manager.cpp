@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <utility>
 #include "data/data_manager.h"
 #include "log/backup_logger.h"
@@ -11,9 +12,134 @@ namespace zbackup
             ZBACKUP_LOG_ERROR("DataManager initialized with null storage");
             throw std::invalid_argument("Storage cannot be null");
         }
+        load_usage();
         ZBACKUP_LOG_INFO("DataManager initialized successfully");
     }
 
+    void DataManager::load_usage()
+    {
+        std::vector<info::BackupInfo> arry;
+        storage_->get_all(&arry);
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        usage_.clear();
+        for (const auto &info : arry)
+        {
+            if (!info.owner_.empty())
+            {
+                usage_[info.owner_].bytes += info.fsize_;
+                usage_[info.owner_].files++;
+            }
+        }
+        ZBACKUP_LOG_INFO("DataManager usage loaded: {} entries, {} owners", arry.size(), usage_.size());
+    }
+
+    void DataManager::add_usage(const info::BackupInfo &info)
+    {
+        if (info.owner_.empty())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        auto &usage = usage_[info.owner_];
+        usage.bytes += info.fsize_;
+        usage.files++;
+    }
+
+    void DataManager::remove_usage(const info::BackupInfo &info)
+    {
+        if (info.owner_.empty())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        auto it = usage_.find(info.owner_);
+        if (it == usage_.end())
+        {
+            return;
+        }
+        it->second.bytes -= std::min<uint64_t>(it->second.bytes, info.fsize_);
+        it->second.files -= std::min<uint64_t>(it->second.files, 1);
+        if (it->second.files == 0)
+        {
+            usage_.erase(it);
+        }
+    }
+
+    void DataManager::commit_usage(const info::BackupInfo &info)
+    {
+        if (info.owner_.empty())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        auto &usage = usage_[info.owner_];
+        usage.bytes += info.fsize_;
+        usage.files++;
+        auto it = reserved_.find(info.owner_);
+        if (it != reserved_.end())
+        {
+            it->second.bytes -= std::min<uint64_t>(it->second.bytes, info.fsize_);
+            it->second.files -= std::min<uint64_t>(it->second.files, 1);
+            if (it->second.bytes == 0 && it->second.files == 0)
+            {
+                reserved_.erase(it);
+            }
+        }
+    }
+
+    interfaces::IDataManager::Usage DataManager::get_usage(const std::string &owner)
+    {
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        auto it = usage_.find(owner);
+        return it == usage_.end() ? Usage() : it->second;
+    }
+
+    bool DataManager::try_reserve(const std::string &owner, const Usage &request, const Usage &quota, Usage *usage)
+    {
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        Usage current;
+        auto used = usage_.find(owner);
+        if (used != usage_.end())
+        {
+            current = used->second;
+        }
+        auto reserved = reserved_.find(owner);
+        if (reserved != reserved_.end())
+        {
+            current.bytes += reserved->second.bytes;
+            current.files += reserved->second.files;
+        }
+        if (usage)
+        {
+            *usage = current;
+        }
+        if ((quota.bytes > 0 && current.bytes + request.bytes > quota.bytes) ||
+            (quota.files > 0 && current.files + request.files > quota.files))
+        {
+            return false;
+        }
+        auto &slot = reserved_[owner];
+        slot.bytes += request.bytes;
+        slot.files += request.files;
+        return true;
+    }
+
+    void DataManager::release_reserved(const std::string &owner, const Usage &amount)
+    {
+        std::lock_guard<std::mutex> lock(usage_mutex_);
+        auto it = reserved_.find(owner);
+        if (it == reserved_.end())
+        {
+            return;
+        }
+        it->second.bytes -= std::min(it->second.bytes, amount.bytes);
+        it->second.files -= std::min(it->second.files, amount.files);
+        if (it->second.bytes == 0 && it->second.files == 0)
+        {
+            reserved_.erase(it);
+        }
+    }
+
     bool DataManager::insert(const info::BackupInfo &info)
     {
         if (!storage_)
@@ -21,7 +147,35 @@ namespace zbackup
             ZBACKUP_LOG_ERROR("DataManager storage not available");
             return false;
         }
-        return storage_->insert(info);
+        bool result = storage_->insert(info);
+        if (result)
+        {
+            add_usage(info);
+        }
+        return result;
+    }
+
+    bool DataManager::insert_versions(std::vector<info::BackupInfo> *infos)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return false;
+        }
+        bool result = storage_->insert_versions(infos);
+        if (result)
+        {
+            for (const auto &info : *infos)
+            {
+                commit_usage(info);
+            }
+            ZBACKUP_LOG_DEBUG("DataManager version insert success: {} entries", infos->size());
+        }
+        else
+        {
+            ZBACKUP_LOG_WARN("DataManager version insert failed: {} entries", infos->size());
+        }
+        return result;
     }
 
     bool DataManager::update(const info::BackupInfo &info)
@@ -31,7 +185,57 @@ namespace zbackup
             ZBACKUP_LOG_ERROR("DataManager storage not available");
             return false;
         }
-        return storage_->update(info);
+        // 更新可能改变文件大小，按旧条目扣除后重新计入
+        info::BackupInfo old;
+        bool found = storage_->get_one_by_url(info.url_, &old);
+        bool result = storage_->update(info);
+        if (result && found)
+        {
+            remove_usage(old);
+            add_usage(info);
+        }
+        return result;
+    }
+
+    bool DataManager::update_verify(const std::string &url, bool corrupt_flag, time_t verify_time)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return false;
+        }
+        return storage_->update_verify(url, corrupt_flag, verify_time);
+    }
+
+    bool DataManager::record_checksum(const std::string &url, bool pack, const std::string &checksum)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return false;
+        }
+        return storage_->record_checksum(url, pack, checksum);
+    }
+
+    bool DataManager::mark_cold(const std::string &url, const std::string &pack_path, const std::string &cold_path,
+                                const std::string &pack_checksum)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return false;
+        }
+        return storage_->mark_cold(url, pack_path, cold_path, pack_checksum);
+    }
+
+    bool DataManager::mark_unpacked(const info::BackupInfo &expected)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return false;
+        }
+        return storage_->mark_unpacked(expected);
     }
 
     bool DataManager::get_one_by_url(const std::string &url, info::BackupInfo *info)
@@ -64,6 +268,16 @@ namespace zbackup
         storage_->get_all(arry);
     }
 
+    void DataManager::get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return;
+        }
+        storage_->get_by_owner(owner, arry);
+    }
+
     bool DataManager::delete_one(const info::BackupInfo &info)
     {
         if (!storage_)
@@ -71,9 +285,13 @@ namespace zbackup
             ZBACKUP_LOG_ERROR("DataManager storage not available");
             return false;
         }
+        // 用量按目录中的条目扣除，调用方传入的可能只有URL
+        info::BackupInfo old;
+        bool found = storage_->get_one_by_url(info.url_, &old);
         bool result = storage_->delete_one(info);
         if (result)
         {
+            remove_usage(found ? old : info);
             ZBACKUP_LOG_DEBUG("DataManager delete backup info success for url: {}", info.url_);
         }
         else
@@ -90,9 +308,15 @@ namespace zbackup
             ZBACKUP_LOG_ERROR("DataManager storage not available");
             return false;
         }
+        info::BackupInfo old;
+        bool found = storage_->get_one_by_url(url, &old);
         bool result = storage_->delete_by_url(url);
         if (result)
         {
+            if (found)
+            {
+                remove_usage(old);
+            }
             ZBACKUP_LOG_DEBUG("DataManager delete backup info by URL success: {}", url);
         }
         else
@@ -109,9 +333,15 @@ namespace zbackup
             ZBACKUP_LOG_ERROR("DataManager storage not available");
             return false;
         }
+        info::BackupInfo old;
+        bool found = storage_->get_one_by_real_path(real_path, &old);
         bool result = storage_->delete_by_real_path(real_path);
         if (result)
         {
+            if (found)
+            {
+                remove_usage(old);
+            }
             ZBACKUP_LOG_DEBUG("DataManager delete backup info by real path success: {}", real_path);
         }
         else
@@ -121,6 +351,68 @@ namespace zbackup
         return result;
     }
 
+    bool DataManager::delete_batch(const std::vector<info::BackupInfo> &infos)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return false;
+        }
+        bool result = storage_->delete_batch(infos);
+        if (result)
+        {
+            for (const auto &info : infos)
+            {
+                remove_usage(info);
+            }
+            ZBACKUP_LOG_DEBUG("DataManager batch delete success: {} entries", infos.size());
+        }
+        else
+        {
+            ZBACKUP_LOG_WARN("DataManager batch delete failed: {} entries", infos.size());
+        }
+        return result;
+    }
+
+    void DataManager::get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            return;
+        }
+        storage_->get_versions(base_url, arry);
+    }
+
+    bool DataManager::get_version(const std::string &base_url, uint32_t version, info::BackupInfo *info)
+    {
+        std::vector<info::BackupInfo> versions;
+        get_versions(base_url, &versions);
+        return pick_version(&versions, version, info);
+    }
+
+    bool DataManager::pick_version(std::vector<info::BackupInfo> *versions, uint32_t version, info::BackupInfo *info)
+    {
+        if (versions->empty())
+        {
+            return false;
+        }
+        if (version == 0)
+        {
+            *info = std::move(versions->back());
+            return true;
+        }
+        for (auto &candidate : *versions)
+        {
+            if (candidate.version_ == version)
+            {
+                *info = std::move(candidate);
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool DataManager::persistence()
     {
         if (!storage_)
@@ -133,4 +425,179 @@ namespace zbackup
         ZBACKUP_LOG_DEBUG("DataManager persistence completed");
         return true;
     }
-}
\ No newline at end of file
+
+    core::Async<bool> DataManager::insert_async(info::BackupInfo info)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return false;
+        }
+        info::BackupInfo inserted = info;
+        bool result = co_await storage_->insert_async(std::move(info));
+        if (result)
+        {
+            add_usage(inserted);
+        }
+        co_return result;
+    }
+
+    core::Async<bool> DataManager::update_async(info::BackupInfo info)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return false;
+        }
+        info::BackupInfo old;
+        bool found = co_await storage_->get_one_by_url_async(info.url_, &old);
+        info::BackupInfo updated = info;
+        bool result = co_await storage_->update_async(std::move(info));
+        if (result && found)
+        {
+            remove_usage(old);
+            add_usage(updated);
+        }
+        co_return result;
+    }
+
+    core::Async<bool> DataManager::get_one_by_url_async(std::string url, info::BackupInfo *info)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return false;
+        }
+        co_return co_await storage_->get_one_by_url_async(std::move(url), info);
+    }
+
+    core::Async<bool> DataManager::get_one_by_real_path_async(std::string real_path, info::BackupInfo *info)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return false;
+        }
+        co_return co_await storage_->get_one_by_real_path_async(std::move(real_path), info);
+    }
+
+    core::Async<void> DataManager::get_all_async(std::vector<info::BackupInfo> *arry)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return;
+        }
+        co_await storage_->get_all_async(arry);
+    }
+
+    core::Async<void> DataManager::get_by_owner_async(std::string owner, std::vector<info::BackupInfo> *arry)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return;
+        }
+        co_await storage_->get_by_owner_async(std::move(owner), arry);
+    }
+
+    core::Async<void> DataManager::get_versions_async(std::string base_url, std::vector<info::BackupInfo> *arry)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return;
+        }
+        co_await storage_->get_versions_async(std::move(base_url), arry);
+    }
+
+    core::Async<bool> DataManager::get_version_async(std::string base_url, uint32_t version, info::BackupInfo *info)
+    {
+        std::vector<info::BackupInfo> versions;
+        co_await get_versions_async(std::move(base_url), &versions);
+        co_return pick_version(&versions, version, info);
+    }
+
+    core::Async<bool> DataManager::delete_one_async(info::BackupInfo info)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return false;
+        }
+        std::string url = info.url_;
+        info::BackupInfo old;
+        bool found = co_await storage_->get_one_by_url_async(url, &old);
+        if (!found)
+        {
+            old = info;
+        }
+        bool result = co_await storage_->delete_one_async(std::move(info));
+        if (result)
+        {
+            remove_usage(old);
+            ZBACKUP_LOG_DEBUG("DataManager delete backup info success for url: {}", url);
+        }
+        else
+        {
+            ZBACKUP_LOG_WARN("DataManager delete backup info failed for url: {}", url);
+        }
+        co_return result;
+    }
+
+    core::Async<bool> DataManager::delete_by_url_async(std::string url)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return false;
+        }
+        info::BackupInfo old;
+        bool found = co_await storage_->get_one_by_url_async(url, &old);
+        bool result = co_await storage_->delete_by_url_async(url);
+        if (result)
+        {
+            if (found)
+            {
+                remove_usage(old);
+            }
+            ZBACKUP_LOG_DEBUG("DataManager delete backup info by URL success: {}", url);
+        }
+        else
+        {
+            ZBACKUP_LOG_WARN("DataManager delete backup info by URL failed: {}", url);
+        }
+        co_return result;
+    }
+
+    core::Async<bool> DataManager::delete_by_real_path_async(std::string real_path)
+    {
+        if (!storage_)
+        {
+            ZBACKUP_LOG_ERROR("DataManager storage not available");
+            co_return false;
+        }
+        info::BackupInfo old;
+        bool found = co_await storage_->get_one_by_real_path_async(real_path, &old);
+        bool result = co_await storage_->delete_by_real_path_async(real_path);
+        if (result)
+        {
+            if (found)
+            {
+                remove_usage(old);
+            }
+            ZBACKUP_LOG_DEBUG("DataManager delete backup info by real path success: {}", real_path);
+        }
+        else
+        {
+            ZBACKUP_LOG_WARN("DataManager delete backup info by real path failed: {}", real_path);
+        }
+        co_return result;
+    }
+
+    // 持久化不涉及阻塞操作，直接完成
+    core::Async<bool> DataManager::persistence_async()
+    {
+        co_return persistence();
+    }
+}
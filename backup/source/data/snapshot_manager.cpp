@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include "data/snapshot_manager.h"
+#include "util/namespace_path.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+
+namespace zbackup
+{
+    static constexpr const char *MANIFEST_SUFFIX = ".snap";
+
+    SnapshotManager::SnapshotManager(std::string snapshot_dir)
+        : snapshot_dir_(std::move(snapshot_dir))
+    {
+        if (!snapshot_dir_.empty() && snapshot_dir_.back() != '/')
+        {
+            snapshot_dir_ += '/';
+        }
+    }
+
+    bool SnapshotManager::load()
+    {
+        util::FileUtil dir(snapshot_dir_);
+        if (!dir.create_directory())
+        {
+            ZBACKUP_LOG_ERROR("Failed to create snapshot directory: {}", snapshot_dir_);
+            return false;
+        }
+
+        std::vector<std::string> files;
+        dir.scan_directory(&files, true);
+
+        std::unordered_map<std::string, std::vector<Summary> > index;
+        std::unordered_map<std::string, uint32_t> references;
+        size_t suffix_size = strlen(MANIFEST_SUFFIX);
+        for (const auto &file : files)
+        {
+            if (file.size() > 4 && file.compare(file.size() - 4, 4, ".tmp") == 0)
+            {
+                // 创建过程中被中断的清单
+                util::FileUtil(file).remove_file();
+                continue;
+            }
+            if (file.size() <= suffix_size || file.compare(file.size() - suffix_size, suffix_size, MANIFEST_SUFFIX) != 0)
+            {
+                continue;
+            }
+
+            Summary summary;
+            util::ManifestReader reader;
+            if (!reader.open(file, &summary.header))
+            {
+                continue;
+            }
+            std::vector<std::string> urls;
+            util::SnapshotEntry entry;
+            while (reader.next(&entry))
+            {
+                urls.push_back(entry_url(summary.header, entry));
+            }
+            if (!reader.done())
+            {
+                ZBACKUP_LOG_ERROR("Skipping corrupt snapshot manifest: {}", file);
+                continue;
+            }
+            summary.trailer = reader.trailer();
+            for (const auto &url : urls)
+            {
+                references[url]++;
+            }
+            index[namespace_dir(summary.header.owner, summary.header.host)].push_back(std::move(summary));
+        }
+
+        size_t count = 0;
+        for (auto &[dir_key, summaries] : index)
+        {
+            std::sort(summaries.begin(), summaries.end(), [](const Summary &a, const Summary &b) {
+                return a.header.id < b.header.id;
+            });
+            count += summaries.size();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_ = std::move(index);
+        references_ = std::move(references);
+        ZBACKUP_LOG_INFO("SnapshotManager loaded {} snapshots referencing {} versions", count, references_.size());
+        return true;
+    }
+
+    bool SnapshotManager::create(const std::string &owner, const std::string &host, const std::string &base,
+                                 const std::vector<info::BackupInfo> &files, Summary *summary)
+    {
+        Summary created;
+        created.header.owner = owner;
+        created.header.host = host;
+        created.header.base = base;
+        created.header.created = time(nullptr);
+        created.header.id = make_id(created.header.created);
+
+        std::vector<util::SnapshotEntry> entries;
+        entries.reserve(files.size());
+        for (const auto &info : files)
+        {
+            if (info.base_url_.compare(0, base.size(), base) != 0)
+            {
+                continue;
+            }
+            util::SnapshotEntry entry;
+            entry.path = info.base_url_.substr(base.size());
+            entry.version = info.version_;
+            entry.size = info.fsize_;
+            entry.mtime = info.mtime_;
+            entry.checksum = info.checksum_;
+            entry.real_path = info.real_path_;
+            entry.pack_path = info.pack_path_;
+            entries.push_back(std::move(entry));
+        }
+        std::sort(entries.begin(), entries.end(), [](const util::SnapshotEntry &a, const util::SnapshotEntry &b) {
+            return a.path < b.path;
+        });
+
+        // 先登记引用再写清单，写入期间保留器不会清除这些版本
+        std::vector<std::string> urls;
+        urls.reserve(entries.size());
+        for (const auto &entry : entries)
+        {
+            urls.push_back(entry_url(created.header, entry));
+        }
+        add_references(urls);
+
+        std::string path = manifest_path(created.header);
+        while (util::FileUtil(path).exists())
+        {
+            // 重启后序号从头开始，同一秒内的ID可能与已有快照相同
+            created.header.id = make_id(created.header.created);
+            path = manifest_path(created.header);
+        }
+        util::ManifestWriter writer;
+        bool ok = util::FileUtil(util::fs::path(path).parent_path().string()).create_directory() &&
+                  writer.open(path, created.header);
+        for (size_t i = 0; ok && i < entries.size(); i++)
+        {
+            ok = writer.add(entries[i]);
+        }
+        ok = ok && writer.finish(&created.trailer);
+        if (!ok)
+        {
+            release_references(urls);
+            ZBACKUP_LOG_ERROR("Failed to create snapshot for {}/{}", owner, host);
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            index_[namespace_dir(owner, host)].push_back(created);
+        }
+        ZBACKUP_LOG_INFO("Snapshot {} created for {}/{}: {} files, {} bytes", created.header.id, owner, host,
+                         created.trailer.files, created.trailer.bytes);
+        *summary = std::move(created);
+        return true;
+    }
+
+    std::vector<SnapshotManager::Summary> SnapshotManager::list(const std::string &owner,
+                                                                const std::string &host) const
+    {
+        std::vector<Summary> result;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(namespace_dir(owner, host));
+        if (it != index_.end())
+        {
+            // 同一目录可能属于清洗后同名的其他用户
+            for (const auto &summary : it->second)
+            {
+                if (summary.header.owner == owner)
+                    result.push_back(summary);
+            }
+        }
+        return result;
+    }
+
+    bool SnapshotManager::find(const std::string &owner, const std::string &host, const std::string &id, time_t at,
+                               Summary *summary) const
+    {
+        auto summaries = list(owner, host);
+        for (auto it = summaries.rbegin(); it != summaries.rend(); ++it)
+        {
+            if (id.empty() ? it->header.created <= at : it->header.id == id)
+            {
+                *summary = std::move(*it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool SnapshotManager::read_entries(const Summary &summary, std::vector<util::SnapshotEntry> *entries) const
+    {
+        std::string path = manifest_path(summary.header);
+        util::SnapshotHeader header;
+        util::ManifestReader reader;
+        if (!reader.open(path, &header))
+        {
+            return false;
+        }
+
+        entries->clear();
+        entries->reserve(summary.trailer.files);
+        util::SnapshotEntry entry;
+        while (reader.next(&entry))
+        {
+            entries->push_back(entry);
+        }
+        if (!reader.done())
+        {
+            ZBACKUP_LOG_ERROR("Snapshot manifest is corrupt: {}", path);
+            return false;
+        }
+        return true;
+    }
+
+    bool SnapshotManager::remove(const std::string &owner, const std::string &host, const std::string &id)
+    {
+        Summary summary;
+        if (!find(owner, host, id, 0, &summary))
+        {
+            return false;
+        }
+        // 清单损坏时无法得知引用了哪些版本，引用保留到重启时重建
+        std::vector<util::SnapshotEntry> entries;
+        bool readable = read_entries(summary, &entries);
+
+        if (!util::FileUtil(manifest_path(summary.header)).remove_file())
+        {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &summaries = index_[namespace_dir(owner, host)];
+            summaries.erase(std::remove_if(summaries.begin(), summaries.end(), [&](const Summary &s) {
+                return s.header.id == id && s.header.owner == owner;
+            }), summaries.end());
+        }
+        if (readable)
+        {
+            std::vector<std::string> urls;
+            urls.reserve(entries.size());
+            for (const auto &entry : entries)
+            {
+                urls.push_back(entry_url(summary.header, entry));
+            }
+            release_references(urls);
+        }
+        ZBACKUP_LOG_INFO("Snapshot {} of {}/{} deleted", id, owner, host);
+        return true;
+    }
+
+    bool SnapshotManager::is_referenced(const std::string &url) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return references_.count(url) > 0;
+    }
+
+    std::string SnapshotManager::entry_url(const util::SnapshotHeader &header, const util::SnapshotEntry &entry)
+    {
+        return info::BackupInfo::version_url(header.base + entry.path, entry.version);
+    }
+
+    std::string SnapshotManager::namespace_dir(const std::string &owner, const std::string &host)
+    {
+        return util::NamespacePath::sanitize_segment(owner, "anonymous") + "/" +
+               util::NamespacePath::sanitize_segment(host, "default");
+    }
+
+    std::string SnapshotManager::manifest_path(const util::SnapshotHeader &header) const
+    {
+        return snapshot_dir_ + namespace_dir(header.owner, header.host) + "/" + header.id + MANIFEST_SUFFIX;
+    }
+
+    std::string SnapshotManager::make_id(time_t created)
+    {
+        static std::atomic<uint32_t> sequence{0};
+        struct tm utc{};
+        gmtime_r(&created, &utc);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &utc);
+        char id[48];
+        snprintf(id, sizeof(id), "%s-%04x", stamp, sequence.fetch_add(1, std::memory_order_relaxed) & 0xffff);
+        return id;
+    }
+
+    void SnapshotManager::add_references(const std::vector<std::string> &urls)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &url : urls)
+        {
+            references_[url]++;
+        }
+    }
+
+    void SnapshotManager::release_references(const std::vector<std::string> &urls)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &url : urls)
+        {
+            auto it = references_.find(url);
+            if (it != references_.end() && --it->second == 0)
+            {
+                references_.erase(it);
+            }
+        }
+    }
+}
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "handlers/archive_handler.h"
+#include "handlers/snapshot_handler.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/session_manager_interface.h"
+#include "core/service_container.h"
+#include "util/util.h"
+#include "util/fd_cache.h"
+#include "util/tar_writer.h"
+#include <nlohmann/json.hpp>
+#include "log/backup_logger.h"
+
+namespace zbackup
+{
+    core::Async<void> ArchiveHandler::handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    {
+        auto &container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+        auto compressor = container.resolve<interfaces::ICompress>();
+        auto session_manager = container.resolve<interfaces::ISessionManager>();
+        auto tiers = container.resolve<storage::BlobTiers>();
+
+        if (!config || !data_manager || !compressor || !session_manager || !tiers)
+        {
+            ZBACKUP_LOG_ERROR("Required services not available for archive download");
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Service unavailable");
+            co_return;
+        }
+
+        std::vector<Member> members;
+        bool by_snapshot = req.get_method() != zhttp::HttpRequest::Method::POST &&
+                           (!req.get_query_parameters("snapshot").empty() || !req.get_query_parameters("at").empty());
+        if (by_snapshot)
+        {
+            auto snapshots = container.resolve<SnapshotManager>();
+            if (!snapshots)
+            {
+                ZBACKUP_LOG_ERROR("SnapshotManager not available for archive download");
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+                rsp->set_status_message("Internal Server Error");
+                rsp->set_body("Service unavailable");
+                co_return;
+            }
+            std::string download_prefix = config->get_download_prefix();
+            std::string owner = session_manager->get_username(req);
+            bool selected = co_await core::offload_io([&]()
+            {
+                return select_snapshot(req, rsp, snapshots, data_manager, download_prefix, owner, &members);
+            });
+            if (!selected)
+            {
+                co_return;
+            }
+        }
+        else if (!co_await select_members(req, rsp, data_manager, config->get_download_prefix(),
+                                          session_manager->get_username(req), &members))
+        {
+            co_return;
+        }
+
+        // 归档布局在读取前即可确定：每个成员的头部与内容写到固定位置
+        size_t total = 0;
+        for (auto &member : members)
+        {
+            member.header_offset = total;
+            member.data_offset = total + util::TarWriter::header_size(member.name);
+            total = member.data_offset + util::TarWriter::padded_size(member.info.fsize_);
+        }
+        total += util::TarWriter::END_SIZE;
+
+        size_t max_size = static_cast<size_t>(std::max(config->get_int("archive_max_mb", 2048), 0)) << 20;
+        if (total > max_size)
+        {
+            ZBACKUP_LOG_WARN("Archive too large: {} files, {} bytes (limit {} bytes)", members.size(), total,
+                             max_size);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::PayloadTooLarge);
+            rsp->set_status_message("Payload Too Large");
+            rsp->set_body("Archive exceeds size limit, please select fewer files");
+            co_return;
+        }
+
+        ZBACKUP_LOG_INFO("Archive download started: {} files ({} bytes)", members.size(), total);
+        std::string archive(total, '\0');
+        for (const auto &member : members)
+        {
+            util::TarWriter::write_header(&archive[member.header_offset], member.name, member.info.fsize_,
+                                          member.info.mtime_);
+        }
+
+        // 成员内容并行填充：未压缩的在IO线程池读盘，已压缩的在CPU线程池解压，同时在途的成员数有上限
+        // 各成员写入归档中互不重叠的区域；出错后不再提交新成员，但要等已提交的全部结束才能释放归档
+        size_t window = static_cast<size_t>(std::max(config->get_int("archive_parallelism", 8), 1));
+        std::vector<core::TaskFuture<bool> > pending(members.size());
+        std::string failed;
+        size_t submitted = 0;
+        for (; submitted < members.size() && failed.empty(); submitted++)
+        {
+            if (submitted >= window)
+            {
+                size_t done = submitted - window;
+                if (pending[done].valid() && !co_await wait_member(pending[done]))
+                {
+                    failed = members[done].info.url_;
+                    break;
+                }
+            }
+
+            const Member &member = members[submitted];
+            if (member.info.fsize_ == 0)
+            {
+                continue;
+            }
+            char *data = &archive[member.data_offset];
+            core::TaskLane lane = member.info.pack_flag_ ? core::TaskLane::CPU : core::TaskLane::IO;
+            pending[submitted] = core::offload(lane, core::TaskPriority::HIGH, [compressor, tiers, &member, data]()
+            {
+                return fill_member(compressor, tiers, member, data);
+            });
+        }
+        for (size_t i = submitted > window ? submitted - window : 0; i < submitted; i++)
+        {
+            if (pending[i].valid() && !co_await wait_member(pending[i]) && failed.empty())
+            {
+                failed = members[i].info.url_;
+            }
+        }
+
+        if (!failed.empty())
+        {
+            ZBACKUP_LOG_ERROR("Archive download failed at member: {}", failed);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Read file failed: " + failed);
+            co_return;
+        }
+
+        rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
+        rsp->set_status_message("OK");
+        rsp->set_content_type("application/x-tar");
+        rsp->set_header("Content-Disposition", "attachment; filename=\"backup.tar\"");
+        rsp->set_header("Cache-Control", "no-store");
+        // 归档最大可达 archive_max_mb，移交给响应而不是再复制一份
+        size_t archive_size = archive.size();
+        rsp->set_body(std::move(archive));
+        rsp->set_content_length(archive_size);
+        ZBACKUP_LOG_INFO("Archive download completed: {} files ({} bytes)", members.size(), archive_size);
+    }
+
+    core::Async<bool> ArchiveHandler::select_members(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                                     interfaces::IDataManager::ptr data_manager,
+                                                     std::string download_prefix, std::string owner,
+                                                     std::vector<Member> *members)
+    {
+        // 参数既可以是完整URL，也可以是去掉下载前缀的名字
+        auto to_url = [&download_prefix](const std::string &name) {
+            if (name.compare(0, download_prefix.size(), download_prefix) == 0)
+                return name;
+            size_t start = name.find_first_not_of('/');
+            return download_prefix + (start == std::string::npos ? std::string() : name.substr(start));
+        };
+
+        std::vector<std::string> urls;
+        std::string prefix;
+        bool by_prefix = true;
+        if (req.get_method() == zhttp::HttpRequest::Method::POST)
+        {
+            nlohmann::json body;
+            bool valid = util::JsonUtil::deserialize(&body, req.get_content()) && body.is_object();
+            if (valid && body.contains("urls") && body["urls"].is_array())
+            {
+                by_prefix = false;
+                for (const auto &url : body["urls"])
+                {
+                    valid = valid && url.is_string();
+                    if (valid)
+                        urls.push_back(to_url(url.get<std::string>()));
+                }
+            }
+            else if (valid && body.contains("prefix") && body["prefix"].is_string())
+            {
+                prefix = body["prefix"].get<std::string>();
+            }
+            else
+            {
+                valid = false;
+            }
+            if (!valid)
+            {
+                ZBACKUP_LOG_WARN("Invalid archive request body");
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+                rsp->set_status_message("Bad Request");
+                rsp->set_body(R"(Expected {"urls": [...]} or {"prefix": "..."})");
+                co_return false;
+            }
+        }
+        else
+        {
+            prefix = req.get_query_parameters("prefix");
+        }
+
+        std::vector<info::BackupInfo> infos;
+        if (by_prefix)
+        {
+            std::string url_prefix = to_url(prefix);
+            std::vector<info::BackupInfo> all;
+            if (!owner.empty())
+            {
+                co_await data_manager->get_by_owner_async(owner, &all);
+            }
+            std::vector<info::BackupInfo> ownerless;
+            co_await data_manager->get_by_owner_async(std::string(), &ownerless);
+            all.insert(all.end(), std::make_move_iterator(ownerless.begin()),
+                       std::make_move_iterator(ownerless.end()));
+            // 前缀按路径段匹配：a/doc 匹配 a/doc 本身与 a/doc/ 下的文件，不匹配 a/docs_private/...
+            auto under_prefix = [&url_prefix](const std::string &base_url) {
+                if (base_url.compare(0, url_prefix.size(), url_prefix) != 0)
+                    return false;
+                return base_url.size() == url_prefix.size() || url_prefix.back() == '/' ||
+                       base_url[url_prefix.size()] == '/';
+            };
+            // 每个文件只打包最新版本
+            std::unordered_map<std::string, info::BackupInfo> latest;
+            for (auto &info : all)
+            {
+                if (!under_prefix(info.base_url_))
+                {
+                    continue;
+                }
+                auto it = latest.find(info.base_url_);
+                if (it == latest.end() || info.version_ > it->second.version_)
+                {
+                    latest[info.base_url_] = std::move(info);
+                }
+            }
+            for (auto &entry : latest)
+            {
+                infos.push_back(std::move(entry.second));
+            }
+        }
+        else
+        {
+            std::unordered_set<std::string> seen;
+            for (const auto &url : urls)
+            {
+                if (!seen.insert(url).second)
+                {
+                    continue;
+                }
+                // 不带版本的URL取最新版本，带版本的URL取该版本
+                info::BackupInfo info;
+                bool found = co_await data_manager->get_version_async(url, 0, &info);
+                if (!found)
+                {
+                    found = co_await data_manager->get_one_by_url_async(url, &info);
+                }
+                if (!found || (!info.owner_.empty() && info.owner_ != owner))
+                {
+                    ZBACKUP_LOG_WARN("File not found for archive: {}", url);
+                    rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
+                    rsp->set_status_message("Not Found");
+                    rsp->set_body("Not Found: " + url);
+                    co_return false;
+                }
+                infos.push_back(std::move(info));
+            }
+        }
+
+        if (infos.empty())
+        {
+            ZBACKUP_LOG_WARN("No backups matched archive request, prefix: {}", prefix);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
+            rsp->set_status_message("Not Found");
+            rsp->set_body("No matching files");
+            co_return false;
+        }
+
+        std::sort(infos.begin(), infos.end(), [](const info::BackupInfo &a, const info::BackupInfo &b) {
+            return a.base_url_ != b.base_url_ ? a.base_url_ < b.base_url_ : a.version_ < b.version_;
+        });
+        members->clear();
+        members->reserve(infos.size());
+        for (auto &info : infos)
+        {
+            Member member;
+            const std::string &base_url = info.base_url_;
+            member.name = base_url.substr(base_url.compare(0, download_prefix.size(), download_prefix) == 0
+                                              ? download_prefix.size()
+                                              : base_url.find_first_not_of('/'));
+            member.info = std::move(info);
+            members->push_back(std::move(member));
+        }
+        co_return true;
+    }
+
+    bool ArchiveHandler::select_snapshot(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                         const SnapshotManager::ptr &snapshots,
+                                         const interfaces::IDataManager::ptr &data_manager,
+                                         const std::string &download_prefix,
+                                         const std::string &owner, std::vector<Member> *members)
+    {
+        SnapshotManager::Summary summary;
+        if (!SnapshotHandler::resolve(req, snapshots, owner, &summary, rsp))
+        {
+            return false;
+        }
+        std::vector<util::SnapshotEntry> entries;
+        if (!snapshots->read_entries(summary, &entries))
+        {
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Snapshot manifest is unreadable");
+            return false;
+        }
+
+        // 清单已按路径排序；数据文件不存在说明已打包，压缩包不在本地（远程存储或冷层）时才需要查询目录
+        const std::string &base = summary.header.base;
+        std::string name_prefix = base.compare(0, download_prefix.size(), download_prefix) == 0
+                                      ? base.substr(download_prefix.size())
+                                      : base;
+        members->clear();
+        members->reserve(entries.size());
+        for (auto &entry : entries)
+        {
+            Member member;
+            member.name = name_prefix + entry.path;
+            member.info.base_url_ = base + entry.path;
+            member.info.url_ = SnapshotManager::entry_url(summary.header, entry);
+            member.info.version_ = entry.version;
+            member.info.fsize_ = entry.size;
+            member.info.mtime_ = entry.mtime;
+            member.info.checksum_ = std::move(entry.checksum);
+            member.info.real_path_ = std::move(entry.real_path);
+            member.info.pack_path_ = std::move(entry.pack_path);
+            member.info.owner_ = summary.header.owner;
+            member.info.pack_flag_ = !util::FileUtil(member.info.real_path_).exists();
+            if (member.info.pack_flag_ && !util::FileUtil(member.info.pack_path_).exists())
+            {
+                // 压缩包所在的层只记录在目录中
+                info::BackupInfo current;
+                if (data_manager->get_one_by_url(member.info.url_, &current))
+                {
+                    member.info.tier_ = current.tier_;
+                    member.info.cold_path_ = current.cold_path_;
+                }
+            }
+            members->push_back(std::move(member));
+        }
+        if (members->empty())
+        {
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
+            rsp->set_status_message("Not Found");
+            rsp->set_body("Snapshot is empty");
+            return false;
+        }
+        ZBACKUP_LOG_INFO("Restoring snapshot {} of {}/{}: {} files", summary.header.id, owner, summary.header.host,
+                         members->size());
+        return true;
+    }
+
+    bool ArchiveHandler::fill_member(const interfaces::ICompress::ptr &compressor, const storage::BlobTiers::ptr &tiers,
+                                     const Member &member, char *data)
+    {
+        const auto &info = member.info;
+        // 已压缩的成员解压到内存，不解包到备份目录；远程存储的压缩包取回到临时文件，用完删除
+        auto unpack = [&]()
+        {
+            std::string pack_file;
+            bool temporary = false;
+            if (!tiers->fetch_pack(info, &pack_file, &temporary))
+            {
+                return false;
+            }
+            bool unpacked = compressor->un_compress_to(pack_file, data, info.fsize_);
+            if (temporary)
+            {
+                util::FileUtil(pack_file).remove_file();
+            }
+            return unpacked;
+        };
+        if (info.pack_flag_)
+        {
+            return unpack();
+        }
+
+        auto file = util::FdCache::get_instance().acquire(info.real_path_);
+        if (!file && errno == ENOENT && !info.pack_path_.empty())
+        {
+            // 选出成员之后才被打包，数据文件已删除
+            return unpack();
+        }
+        if (!file)
+        {
+            ZBACKUP_LOG_ERROR("Failed to open file for archive: {}: {}", info.real_path_, strerror(errno));
+            return false;
+        }
+        // 头部中的长度来自备份信息，文件被改动过时不能继续
+        if (static_cast<size_t>(file->size()) != info.fsize_)
+        {
+            ZBACKUP_LOG_ERROR("File size changed since backup: {} ({} != {})", info.real_path_, file->size(),
+                              info.fsize_);
+            return false;
+        }
+        return file->read(data, 0, info.fsize_);
+    }
+
+    core::Async<bool> ArchiveHandler::wait_member(core::TaskFuture<bool> pending)
+    {
+        try
+        {
+            co_return co_await pending;
+        }
+        catch (const std::exception &e)
+        {
+            ZBACKUP_LOG_ERROR("Archive member task failed: {}", e.what());
+            co_return false;
+        }
+    }
+}
@@ -0,0 +1,294 @@
+#include "handlers/async_handler.h"
+#include "core/service_container.h"
+#include "interfaces/session_manager_interface.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <utility>
+
+namespace zbackup
+{
+    // StatusCode 未定义 202，按数值转换
+    static const auto STATUS_ACCEPTED = static_cast<zhttp::HttpResponse::StatusCode>(202);
+
+    // 协程入口：参数持有处理器、请求与响应，保证协程挂起期间它们一直有效
+    static core::Async<void> run_coroutine(std::shared_ptr<CoroHandler> handler,
+                                           std::shared_ptr<const zhttp::HttpRequest> request,
+                                           std::shared_ptr<zhttp::HttpResponse> response)
+    {
+        co_await handler->handle(*request, response.get());
+    }
+
+    // 当前请求的用户名，会话服务不可用时为空
+    static std::string request_owner(const zhttp::HttpRequest &req)
+    {
+        auto session_manager = core::ServiceContainer::get_instance().resolve<interfaces::ISessionManager>();
+        return session_manager ? session_manager->get_username(req) : std::string();
+    }
+
+    AsyncJobRegistry::AsyncJobRegistry(std::chrono::seconds ttl)
+        : ttl_(ttl), rng_(std::random_device{}())
+    {
+    }
+
+    std::string AsyncJobRegistry::add(std::shared_ptr<AsyncJob> job, std::string owner)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 清理到期未取走的结果；仍在执行的任务保留，完成后还能取走
+        for (auto it = jobs_.begin(); it != jobs_.end();)
+        {
+            if (it->second.expire <= now && it->second.job->done.is_ready())
+            {
+                it = jobs_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // 随机编号，不可猜测
+        std::string id;
+        do
+        {
+            char hex[33];
+            snprintf(hex, sizeof(hex), "%016llx%016llx", static_cast<unsigned long long>(rng_()),
+                     static_cast<unsigned long long>(rng_()));
+            id = hex;
+        } while (jobs_.count(id) > 0);
+        jobs_.emplace(id, Entry{std::move(job), std::move(owner), now + ttl_});
+        return id;
+    }
+
+    std::shared_ptr<AsyncJob> AsyncJobRegistry::take(const std::string &id, const std::string &owner)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end() || it->second.owner != owner)
+        {
+            return nullptr;
+        }
+        auto job = it->second.job;
+        if (job->done.is_ready())
+        {
+            jobs_.erase(it);
+        }
+        return job;
+    }
+
+    void AsyncJobRegistry::reply_accepted(const std::string &id, zhttp::HttpResponse *rsp)
+    {
+        std::string location = std::string(STATUS_PATH) + "?id=" + id;
+        nlohmann::json body;
+        body["job"] = id;
+        body["status_url"] = location;
+        std::string response_body;
+        util::JsonUtil::serialize(body, &response_body);
+
+        rsp->set_status_code(STATUS_ACCEPTED);
+        rsp->set_status_message("Accepted");
+        rsp->set_header("Location", location);
+        rsp->set_header("Retry-After", "1");
+        rsp->set_header("Cache-Control", "no-store");
+        rsp->set_content_type("application/json");
+        rsp->set_body(response_body);
+    }
+
+    AsyncHandler::AsyncHandler(HandlerPtr inner, std::chrono::milliseconds wait_budget, bool share_inflight,
+                               AsyncJobRegistry::ptr jobs)
+        : inner_(std::move(inner)), coro_(std::dynamic_pointer_cast<CoroHandler>(inner_)),
+          wait_budget_(wait_budget), share_inflight_(share_inflight), jobs_(std::move(jobs))
+    {
+    }
+
+    void AsyncHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    {
+        // 请求会被移入任务，先取出后续需要的字段
+        std::string path = req.get_path();
+        std::string owner = share_inflight_ ? std::string() : request_owner(req);
+        auto job = acquire_job(req, *rsp);
+        if (!job)
+        {
+            ZBACKUP_LOG_WARN("Request worker queue full, rejecting: {}", path);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::ServiceUnavailable);
+            rsp->set_status_message("Service Unavailable");
+            rsp->set_header("Retry-After", "1");
+            rsp->set_body("Server busy, please retry");
+            return;
+        }
+
+        // 事件循环只等待有限时间，超时后释放循环，任务在工作线程中继续执行
+        if (!job->done.wait_for(wait_budget_))
+        {
+            if (share_inflight_)
+            {
+                release_waiter(*job);
+                ZBACKUP_LOG_INFO("Request still processing after {} ms, asking client to retry: {}",
+                                 wait_budget_.count(), path);
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::ServiceUnavailable);
+                rsp->set_status_message("Service Unavailable");
+                rsp->set_header("Retry-After", "1");
+                rsp->set_body("Request is still being processed, please retry");
+                return;
+            }
+
+            // 不可共享的请求（上传、删除等）重试会重复执行，登记后由客户端凭编号取得最终结果
+            std::string id = jobs_->add(job, std::move(owner));
+            ZBACKUP_LOG_INFO("Request still processing after {} ms, accepted as job {}: {}",
+                             wait_budget_.count(), id, path);
+            AsyncJobRegistry::reply_accepted(id, rsp);
+            return;
+        }
+
+        deliver(*job, release_waiter(*job), rsp);
+    }
+
+    void AsyncHandler::deliver(AsyncJob &job, bool last, zhttp::HttpResponse *rsp)
+    {
+        if (job.done.status() != core::TaskStatus::SUCCEEDED)
+        {
+            ZBACKUP_LOG_ERROR("Request processing failed on worker thread: {}", job.request->get_path());
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Request processing failed");
+            return;
+        }
+
+        // 工作线程生成的响应交回本次请求，由所属事件循环发送；
+        // 最后一个等待者直接移交正文（如归档下载），共享任务的其他等待者才需要复制
+        if (last)
+        {
+            *rsp = std::move(*job.response);
+        }
+        else
+        {
+            *rsp = *job.response;
+        }
+    }
+
+    bool AsyncHandler::release_waiter(AsyncJob &job)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--job.waiters == 0 && job.done.is_ready())
+        {
+            job.taken = true;
+            return true;
+        }
+        return false;
+    }
+
+    std::shared_ptr<AsyncJob> AsyncHandler::acquire_job(const zhttp::HttpRequest &req,
+                                                        const zhttp::HttpResponse &rsp)
+    {
+        std::string key;
+        if (share_inflight_)
+        {
+            key = inflight_key(req);
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = inflight_.find(key);
+            if (it != inflight_.end() && !it->second->taken)
+            {
+                ZBACKUP_LOG_DEBUG("Attaching to in-flight request: {}", req.get_path());
+                it->second->waiters++;
+                return it->second;
+            }
+        }
+
+        auto job = std::make_shared<AsyncJob>();
+        job->waiters = 1;
+        // 事件循环的请求对象在处理器返回后即被重置，移入任务而不复制正文（上传内容可能很大）
+        job->request = std::make_shared<const zhttp::HttpRequest>(std::move(const_cast<zhttp::HttpRequest &>(req)));
+        // 从本次请求的响应对象拷贝（尚无正文），保留事件循环已设置的连接属性
+        job->response = std::make_shared<zhttp::HttpResponse>(rsp);
+        if (coro_)
+        {
+            job->done = core::spawn_coroutine(core::TaskLane::REQUEST, core::TaskPriority::HIGH,
+                                              run_coroutine(coro_, job->request, job->response));
+        }
+        else
+        {
+            job->done = core::spawn(core::TaskLane::REQUEST, core::TaskPriority::HIGH,
+                                    [inner = inner_, request = job->request, response = job->response]()
+                                    {
+                                        inner->handle_request(*request, response.get());
+                                    });
+        }
+        if (job->done.status() == core::TaskStatus::REJECTED)
+        {
+            return nullptr;
+        }
+
+        if (share_inflight_)
+        {
+            bool inserted;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto [it, added] = inflight_.try_emplace(key, job);
+                // 已移交响应的旧任务不再共享，由新任务替换
+                if (!added && it->second->taken)
+                {
+                    it->second = job;
+                    added = true;
+                }
+                inserted = added;
+            }
+            // 任务结束后移出共享表（可能在此处立即执行，因此不能持锁注册）
+            if (inserted)
+            {
+                job->done.finally([this, key, id = job.get()](core::TaskStatus)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    auto it = inflight_.find(key);
+                    if (it != inflight_.end() && it->second.get() == id)
+                    {
+                        inflight_.erase(it);
+                    }
+                });
+            }
+        }
+        return job;
+    }
+
+    std::string AsyncHandler::inflight_key(const zhttp::HttpRequest &req)
+    {
+        std::string key = req.get_path();
+        for (const char *header: {"Range", "If-Range", "If-None-Match", "If-Modified-Since", "Cookie",
+                                  "Authorization"})
+        {
+            key += '\n';
+            key += req.get_header(header);
+        }
+        // 同一路径的不同版本是不同的资源
+        key += '\n';
+        key += req.get_query_parameters("version");
+        return key;
+    }
+
+    AsyncJobHandler::AsyncJobHandler(AsyncJobRegistry::ptr jobs)
+        : jobs_(std::move(jobs))
+    {
+    }
+
+    void AsyncJobHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    {
+        std::string id = req.get_query_parameters("id");
+        auto job = id.empty() ? nullptr : jobs_->take(id, request_owner(req));
+        if (!job)
+        {
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
+            rsp->set_status_message("Not Found");
+            rsp->set_body("Job not found");
+            return;
+        }
+
+        if (!job->done.is_ready())
+        {
+            AsyncJobRegistry::reply_accepted(id, rsp);
+            return;
+        }
+        // 已移出登记表，只有本次请求持有结果
+        AsyncHandler::deliver(*job, true, rsp);
+    }
+}
@@ -0,0 +1,30 @@
+#include "handlers/coro_handler.h"
+#include "log/backup_logger.h"
+
+namespace zbackup
+{
+    // 同步入口：协程在REQUEST线程池中执行，当前线程等待其结束（不要在线程池的工作线程中调用）
+    void CoroHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    {
+        auto done = core::spawn_coroutine(core::TaskLane::REQUEST, core::TaskPriority::HIGH, handle(req, rsp));
+        done.wait();
+        switch (done.status())
+        {
+        case core::TaskStatus::SUCCEEDED:
+            return;
+        case core::TaskStatus::REJECTED:
+            ZBACKUP_LOG_WARN("Request worker queue full, rejecting: {}", req.get_path());
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::ServiceUnavailable);
+            rsp->set_status_message("Service Unavailable");
+            rsp->set_header("Retry-After", "1");
+            rsp->set_body("Server busy, please retry");
+            return;
+        default:
+            ZBACKUP_LOG_ERROR("Request coroutine failed: {}", req.get_path());
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Request processing failed");
+            return;
+        }
+    }
+}
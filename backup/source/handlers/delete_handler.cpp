@@ -1,18 +1,23 @@
+#include <algorithm>
 #include <utility>
 #include "handlers/delete_handler.h"
 #include "util/util.h"
 #include <nlohmann/json.hpp>
 #include "log/backup_logger.h"
 #include "interfaces/data_manager_interface.h"
+#include "interfaces/session_manager_interface.h"
 #include "core/service_container.h"
+#include "data/snapshot_manager.h"
+#include "storage/blob/blob_tiers.h"
 namespace zbackup
 {
     void DeleteHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
     {
         auto &container = core::ServiceContainer::get_instance();
         auto data_manager = container.resolve<interfaces::IDataManager>();
+        auto session_manager = container.resolve<interfaces::ISessionManager>();
 
-        if (!data_manager)
+        if (!data_manager || !session_manager)
         {
             ZBACKUP_LOG_ERROR("DataManager not available for delete operation");
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
@@ -37,8 +42,34 @@ namespace zbackup
         
         ZBACKUP_LOG_INFO("Delete request for file: {}", file_url);
 
+        // file 为不带版本的URL时删除该文件的所有版本，指定 version 参数或带版本的URL时只删除该版本
+        uint32_t version = 0;
+        if (!info::BackupInfo::parse_version(req.get_query_parameters("version"), &version))
+        {
+            ZBACKUP_LOG_WARN("Invalid version parameter for deletion: {}", file_url);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+            rsp->set_status_message("Bad Request");
+            rsp->set_body("Invalid version");
+            return;
+        }
+        std::vector<info::BackupInfo> targets;
+        data_manager->get_versions(file_url, &targets);
+        if (version > 0)
+        {
+            std::erase_if(targets, [version](const info::BackupInfo &bi) { return bi.version_ != version; });
+        }
         info::BackupInfo info;
-        if (!data_manager->get_one_by_url(file_url, &info))
+        if (targets.empty() && version == 0 && data_manager->get_one_by_url(file_url, &info))
+        {
+            targets.push_back(info);
+        }
+
+        // 其他用户的文件按不存在处理，不暴露文件是否存在；无主的旧条目不限制
+        std::string owner = session_manager->get_username(req);
+        bool visible = std::all_of(targets.begin(), targets.end(), [&owner](const info::BackupInfo &bi) {
+            return bi.owner_.empty() || bi.owner_ == owner;
+        });
+        if (targets.empty() || !visible)
         {
             ZBACKUP_LOG_WARN("File not found for deletion: {}", file_url);
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
@@ -47,26 +78,41 @@ namespace zbackup
             return;
         }
 
-        util::FileUtil fu(info.real_path_);
-        if (!fu.remove_file())
+        auto tiers = container.resolve<storage::BlobTiers>();
+        // 快照是不可变的，被引用的版本要先删除引用它的快照
+        auto snapshots = container.resolve<SnapshotManager>();
+        auto referenced = std::find_if(targets.begin(), targets.end(), [&snapshots](const info::BackupInfo &bi) {
+            return snapshots && snapshots->is_referenced(bi.url_);
+        });
+        if (referenced != targets.end())
         {
-            ZBACKUP_LOG_ERROR("Failed to delete file: {}", info.real_path_);
-            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
-            rsp->set_status_message("Internal Server Error");
-            rsp->set_body("Failed to delete file");
+            ZBACKUP_LOG_WARN("Refusing to delete version referenced by snapshot: {}", referenced->url_);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::Conflict);
+            rsp->set_status_message("Conflict");
+            rsp->set_body("Version " + std::to_string(referenced->version_) +
+                          " is referenced by a snapshot, delete the snapshot first");
             return;
         }
 
-        if (info.pack_flag_)
+        for (const auto &target : targets)
         {
-            util::FileUtil pack_fu(info.pack_path_);
-            if (!pack_fu.remove_file())
+            util::FileUtil fu(target.real_path_);
+            if (!fu.remove_file())
+            {
+                ZBACKUP_LOG_ERROR("Failed to delete file: {}", target.real_path_);
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+                rsp->set_status_message("Internal Server Error");
+                rsp->set_body("Failed to delete file");
+                return;
+            }
+
+            if (target.pack_flag_ && (!tiers || !tiers->remove_pack(target)))
             {
-                ZBACKUP_LOG_WARN("Failed to delete pack file: {}", info.pack_path_);
+                ZBACKUP_LOG_WARN("Failed to delete pack file: {}", target.pack_path_);
             }
         }
 
-        if (!data_manager->delete_one(info))
+        if (!data_manager->delete_batch(targets))
         {
             ZBACKUP_LOG_ERROR("Failed to delete backup info from database: {}", file_url);
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
@@ -80,11 +126,15 @@ namespace zbackup
             ZBACKUP_LOG_ERROR("Failed to persist data after deletion: {}", file_url);
         }
 
-        ZBACKUP_LOG_INFO("File deleted successfully: {}", info.real_path_);
+        ZBACKUP_LOG_INFO("File deleted successfully: {} ({} versions)", file_url, targets.size());
+        nlohmann::json body;
+        body["success"] = true;
+        body["message"] = "File deleted successfully";
+        body["deleted"] = targets.size();
         rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
         rsp->set_status_message("OK");
         rsp->set_content_type("application/json");
-        rsp->set_body(R"({"success": true, "message": "File deleted successfully"})");
+        rsp->set_body(body.dump());
     }
 }
 
@@ -2,15 +2,21 @@
 
 #include "handlers/download_handler.h"
 #include "compress/snappy_compress.h"
+#include "util/http_util.h"
 #include "log/backup_logger.h"
 #include "interfaces/data_manager_interface.h"
+#include "interfaces/session_manager_interface.h"
+#include "storage/blob/blob_tiers.h"
 #include "core/service_container.h"
+#include "core/async.h"
 
 namespace zbackup
 {
+    // 下载内容需登录访问，允许私有缓存但每次使用前必须校验
+    static const char *DOWNLOAD_CACHE_CONTROL = "private, no-cache";
 
-    // 处理文件下载请求，支持断点续传
-    void DownloadHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    // 处理文件下载请求，支持断点续传；数据库查询、解压和读盘期间协程挂起，不占用REQUEST线程
+    core::Async<void> DownloadHandler::handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
     {
         std::string url_path = req.get_path();
         ZBACKUP_LOG_DEBUG("Download request: {}", url_path);
@@ -18,85 +24,197 @@ namespace zbackup
         auto &container = core::ServiceContainer::get_instance();
         auto data_manager = container.resolve<interfaces::IDataManager>();
         auto compressor = container.resolve<interfaces::ICompress>();
+        auto tiers = container.resolve<storage::BlobTiers>();
+        auto session_manager = container.resolve<interfaces::ISessionManager>();
 
-        if (!data_manager || !compressor)
+        if (!data_manager || !compressor || !tiers || !session_manager)
         {
             ZBACKUP_LOG_ERROR("Required services not available for download");
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
             rsp->set_status_message("Internal Server Error");
             rsp->set_body("Service unavailable");
-            return;
+            co_return;
+        }
+
+        // 路径为不带版本的URL，?version=N 取指定版本，缺省取最新版本
+        uint32_t version = 0;
+        if (!info::BackupInfo::parse_version(req.get_query_parameters("version"), &version))
+        {
+            ZBACKUP_LOG_WARN("Invalid version parameter for download: {}", url_path);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+            rsp->set_status_message("Bad Request");
+            rsp->set_body("Invalid version");
+            co_return;
         }
 
-        // 根据URL获取文件备份信息
+        // 其他用户的文件按不存在处理，与列表、归档和删除的归属检查一致
         info::BackupInfo info;
-        if (data_manager->get_one_by_url(url_path, &info) == false)
+        if (co_await data_manager->get_version_async(url_path, version, &info) == false ||
+            (!info.owner_.empty() && info.owner_ != session_manager->get_username(req)))
         {
-            ZBACKUP_LOG_WARN("File not found for download: {}", url_path);
+            ZBACKUP_LOG_WARN("File not found for download: {} (version {})", url_path, version);
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
             rsp->set_status_message("Not Found");
             rsp->set_body("Not Found");
-            return;
+            co_return;
+        }
+
+        // 条件请求：ETag与修改时间均来自备份信息，命中时无需解压和读盘
+        std::string etag = util::get_etag(info);
+        if (util::HttpUtil::is_not_modified(req, etag, info.mtime_))
+        {
+            ZBACKUP_LOG_DEBUG("Download not modified: {}", url_path);
+            util::HttpUtil::set_not_modified(rsp, etag, info.mtime_, DOWNLOAD_CACHE_CONTROL);
+            co_return;
         }
 
-        // 如果文件被压缩，先解压缩
+        // 如果文件被压缩，先解压缩；压缩包在远程存储时先取回到本地，解压后文件回到热层
         if (info.pack_flag_ == true)
         {
-            ZBACKUP_LOG_INFO("Decompressing file for download: {}", info.real_path_);
-            // 解压缩文件
-            if (compressor->un_compress(info.real_path_, info.pack_path_) == false)
+            ZBACKUP_LOG_INFO("Decompressing file for download: {} (from {} tier)", info.real_path_,
+                             info.tier_ == info::StorageTier::COLD ? "cold" : "hot");
+            std::string pack_file;
+            bool temporary = false;
+            bool fetched = co_await core::offload(core::TaskLane::IO, core::TaskPriority::HIGH, [&]()
+            {
+                return tiers->fetch_pack(info, &pack_file, &temporary);
+            });
+            if (fetched == false)
+            {
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+                rsp->set_status_message("Internal Server Error");
+                rsp->set_body("Fetch pack failed");
+                co_return;
+            }
+
+            // 解压缩文件：交给CPU线程池高优先级执行，优先于排队中的后台压缩任务；队列满时不等待，直接提示重试
+            bool unpacked = false;
+            bool accepted = true;
+            try
+            {
+                unpacked = co_await core::spawn(core::TaskLane::CPU, core::TaskPriority::HIGH,
+                                                [compressor, real_path = info.real_path_, pack_file]()
+                {
+                    return compressor->un_compress(real_path, pack_file);
+                });
+            }
+            catch (const core::TaskAbortedError &)
+            {
+                accepted = false;
+            }
+            if (temporary)
+            {
+                co_await core::offload(core::TaskLane::IO, core::TaskPriority::HIGH, [&pack_file]()
+                {
+                    return util::FileUtil(pack_file).remove_file();
+                });
+            }
+            if (!accepted)
+            {
+                ZBACKUP_LOG_WARN("Worker queue full, rejecting download that needs decompression: {}", url_path);
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::ServiceUnavailable);
+                rsp->set_status_message("Service Unavailable");
+                rsp->set_header("Retry-After", "1");
+                rsp->set_body("Server busy, please retry");
+                co_return;
+            }
+            if (unpacked == false)
             {
                 ZBACKUP_LOG_ERROR("Failed to decompress file: {}", info.pack_path_);
                 rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
                 rsp->set_status_message("Internal Server Error");
                 rsp->set_body("Uncompress failed");
-                return;
+                co_return;
             }
 
-            // 删除压缩包并更新备份信息
-            util::FileUtil fu_pack(info.pack_path_);
-            if (fu_pack.remove_file() == false)
+            // 先按读取时的压缩状态登记解压结果，再删除目录原来指向的压缩包；
+            // 解压期间条目被迁移到冷层时按最新状态重试，删除的是迁移后的冷层副本，不会留下无人引用的对象
+            info::BackupInfo packed = info;
+            bool recorded = false;
+            for (int attempt = 0; attempt < 3; attempt++)
             {
-                ZBACKUP_LOG_WARN("Failed to remove pack file after decompression: {}", info.pack_path_);
+                bool retry = false;
+                recorded = co_await core::offload(core::TaskLane::IO, core::TaskPriority::HIGH, [&]()
+                {
+                    if (data_manager->mark_unpacked(packed))
+                    {
+                        return true;
+                    }
+                    // 已被删除或已由其他下载解压时不再重试
+                    retry = data_manager->get_one_by_url(info.url_, &packed) && packed.pack_flag_;
+                    return false;
+                });
+                if (recorded || !retry)
+                {
+                    break;
+                }
             }
-
-            info.pack_flag_ = false;
-            if (data_manager->update(info) == false)
+            if (recorded)
             {
-                ZBACKUP_LOG_WARN("Failed to update backup info after decompression: {}", info.real_path_);
+                bool removed = co_await core::offload(core::TaskLane::IO, core::TaskPriority::HIGH, [&packed, &tiers]()
+                {
+                    return tiers->remove_pack(packed);
+                });
+                if (removed == false)
+                {
+                    ZBACKUP_LOG_WARN("Failed to remove pack file after decompression: {}", packed.pack_path_);
+                }
             }
-            if (data_manager->persistence() == false)
+            else
+            {
+                ZBACKUP_LOG_WARN("Backup info changed during decompression, pack removal skipped: {}", info.url_);
+            }
+
+            info.pack_flag_ = false;
+            info.tier_ = info::StorageTier::HOT;
+            info.cold_path_.clear();
+            if (co_await data_manager->persistence_async() == false)
             {
                 ZBACKUP_LOG_ERROR("Failed to persist backup info after decompression: {}", info.real_path_);
                 rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
                 rsp->set_status_message("Internal Server Error");
                 rsp->set_body("Persistence failed");
-                return;
+                co_return;
             }
         }
 
-        // 检查是否需要断点续传
-        util::FileUtil fu(info.real_path_);
-        int64_t file_size = fu.get_size();
-        std::string range_header = req.get_header("Range");
-        std::string old_etag = req.get_header("If-Range");
-
-        // 处理断点续传请求
-        if (!range_header.empty() && range_header.find("bytes=") == 0 && old_etag == util::get_etag(info))
+        // 读盘在IO线程池执行，协程挂起期间 req、rsp 与 info 都保持有效
+        co_await core::offload(core::TaskLane::IO, core::TaskPriority::HIGH, [this, &req, rsp, &info, &etag]()
         {
-            handle_range_request(req, rsp, info, fu, file_size, range_header);
-            return;
-        }
+            // 同一文件的多次范围请求复用缓存的描述符与文件大小，每次只需一次读取
+            auto file = util::FdCache::get_instance().acquire(info.real_path_);
+            if (!file)
+            {
+                ZBACKUP_LOG_ERROR("Failed to open file for download: {}: {}", info.real_path_, strerror(errno));
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+                rsp->set_status_message("Internal Server Error");
+                rsp->set_body("Read file failed");
+                return;
+            }
+
+            // 检查是否需要断点续传
+            std::string range_header = req.get_header("Range");
+            std::string old_etag = req.get_header("If-Range");
+
+            // 处理断点续传请求
+            if (!range_header.empty() && range_header.find("bytes=") == 0 &&
+                util::HttpUtil::if_range_match(old_etag, etag, info.mtime_))
+            {
+                handle_range_request(req, rsp, info, *file, range_header);
+                return;
+            }
 
-        // 返回完整文件内容
-        handle_full_request(rsp, info, fu);
+            // 返回完整文件内容
+            handle_full_request(rsp, info, *file);
+        });
     }
 
     // 处理断点续传请求
     void DownloadHandler::handle_range_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
-                                               const info::BackupInfo &info, util::FileUtil &fu, int64_t file_size,
+                                               const info::BackupInfo &info, const util::OpenFile &file,
                                                const std::string &range_header)
     {
+        int64_t file_size = file.size();
         ZBACKUP_LOG_DEBUG("Range request: {}", range_header);
 
         // 解析 Range: bytes=start-end
@@ -141,8 +259,8 @@ namespace zbackup
         }
 
         size_t len = end - start + 1;
-        std::string file_content;
-        if (!fu.get_pos_len(&file_content, start, len))
+        std::string file_content(len, '\0');
+        if (!file.read(&file_content[0], start, len))
         {
             ZBACKUP_LOG_ERROR("Failed to read file range [{}-{}] for: {}", start, end, info.real_path_);
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
@@ -156,7 +274,7 @@ namespace zbackup
         rsp->set_content_type("application/octet-stream");
         rsp->set_body(file_content);
         rsp->set_header("Accept-Ranges", "bytes");
-        rsp->set_header("ETag", util::get_etag(info));
+        util::HttpUtil::set_cache_headers(rsp, util::get_etag(info), info.mtime_, DOWNLOAD_CACHE_CONTROL);
         rsp->set_header("Content-Range",
                         "bytes " + std::to_string(start) + "-" + std::to_string(end) + "/" + std::to_string(file_size));
         rsp->set_content_length(len);
@@ -164,10 +282,11 @@ namespace zbackup
     }
 
     // 处理完整文件下载请求
-    void DownloadHandler::handle_full_request(zhttp::HttpResponse *rsp, const info::BackupInfo &info, util::FileUtil &fu)
+    void DownloadHandler::handle_full_request(zhttp::HttpResponse *rsp, const info::BackupInfo &info,
+                                              const util::OpenFile &file)
     {
-        std::string file_content;
-        if (!fu.get_content(&file_content))
+        std::string file_content(file.size(), '\0');
+        if (!file.read(&file_content[0], 0, file_content.size()))
         {
             ZBACKUP_LOG_ERROR("Failed to read file for download: {}", info.real_path_);
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
@@ -181,7 +300,7 @@ namespace zbackup
         rsp->set_content_type("application/octet-stream");
         rsp->set_body(file_content);
         rsp->set_header("Accept-Ranges", "bytes");
-        rsp->set_header("ETag", util::get_etag(info));
+        util::HttpUtil::set_cache_headers(rsp, util::get_etag(info), info.mtime_, DOWNLOAD_CACHE_CONTROL);
         rsp->set_content_length(file_content.size());
 
         ZBACKUP_LOG_INFO("Full download completed: {} ({} bytes)", info.real_path_, file_content.size());
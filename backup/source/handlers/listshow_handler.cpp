@@ -1,45 +1,82 @@
+#include <iterator>
+#include <map>
 #include <utility>
 #include "core/service_container.h"
 #include "handlers/listshow_handler.h"
 #include "util/util.h"
+#include "util/http_util.h"
+#include "util/namespace_path.h"
 #include <nlohmann/json.hpp>
 #include "log/backup_logger.h"
 #include "interfaces/data_manager_interface.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/session_manager_interface.h"
 #include "core/service_container.h"
 namespace zbackup
 {
 
-    // 处理文件列表展示请求，生成HTML页面
-    void ListShowHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    // 处理文件列表展示请求，生成HTML页面；查询数据库期间协程挂起
+    core::Async<void> ListShowHandler::handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
     {
         auto &container = core::ServiceContainer::get_instance();
         auto data_manager = container.resolve<interfaces::IDataManager>();
+        auto config = container.resolve<interfaces::IConfigManager>();
+        auto session_manager = container.resolve<interfaces::ISessionManager>();
 
-        if (!data_manager)
+        if (!data_manager || !config || !session_manager)
         {
             ZBACKUP_LOG_ERROR("DataManager not available for list display");
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
             rsp->set_status_message("Internal Server Error");
             rsp->set_body("Service unavailable");
-            return;
+            co_return;
         }
 
-        // 获取所有备份文件信息
+        // 只列出当前用户的文件，以及旧版本登记的无主文件，两次查询都走所有者索引
+        std::string owner = session_manager->get_username(req);
         std::vector<info::BackupInfo> arry;
-        data_manager->get_all(&arry);
-        ZBACKUP_LOG_DEBUG("Retrieved {} backup entries for list display", arry.size());
+        if (!owner.empty())
+        {
+            co_await data_manager->get_by_owner_async(owner, &arry);
+        }
+        std::vector<info::BackupInfo> ownerless;
+        co_await data_manager->get_by_owner_async(std::string(), &ownerless);
+        arry.insert(arry.end(), std::make_move_iterator(ownerless.begin()), std::make_move_iterator(ownerless.end()));
+        ZBACKUP_LOG_DEBUG("Retrieved {} backup entries for list display, owner: {}", arry.size(), owner);
+
+        // 每个文件只显示最新版本，链接指向不带版本的URL（下载时取最新版本）
+        std::map<std::string, std::pair<info::BackupInfo, size_t> > latest;
+        for (auto &a: arry)
+        {
+            auto &slot = latest[a.base_url_];
+            slot.second++;
+            if (slot.second == 1 || a.version_ > slot.first.version_)
+            {
+                slot.first = std::move(a);
+            }
+        }
 
         // 生成HTML表格展示文件列表
+        // 显示命名空间中的路径（<用户>/<主机>/<相对路径>），即URL去掉下载前缀的部分
+        std::string download_prefix = config->get_download_prefix();
         std::stringstream ss;
         ss << "<html><head><title>Download</title></head>";
         ss << "<body><h1>Download</h1><table>";
-        for (auto &a: arry)
+        for (auto &[base_url, slot]: latest)
         {
+            const auto &a = slot.first;
             ss << "<tr>";
-            std::string filename = util::FileUtil(a.real_path_).get_name();
-            ss << "<td><a href='" << a.url_ << "'>" << filename << "</a></td>";
+            std::string filename = base_url.compare(0, download_prefix.size(), download_prefix) == 0
+                                       ? base_url.substr(download_prefix.size())
+                                       : util::FileUtil(a.real_path_).get_name();
+            // 路径来自客户端，写入页面前转义；作为查询参数时先做百分号编码
+            std::string versions_url = "/versions?file=" + util::NamespacePath::percent_encode(filename);
+            ss << "<td><a href='" << util::HttpUtil::html_escape(base_url) << "'>"
+               << util::HttpUtil::html_escape(filename) << "</a></td>";
             ss << "<td align='right'>" << util::time_to_str(a.mtime_) << "</td>";
             ss << "<td align='right'>" << a.fsize_ / 1024 << "k</td>";
+            ss << "<td align='right'><a href='" << util::HttpUtil::html_escape(versions_url) << "'>v" << a.version_
+               << " (" << slot.second << ")</a></td>";
             ss << "</tr>";
         }
         ss << "</table></body></html>";
@@ -50,6 +87,6 @@ namespace zbackup
         rsp->set_content_type("text/html; charset=UTF-8");
         rsp->set_body(ss.str());
 
-        ZBACKUP_LOG_INFO("ListShowHandler processed request, generated HTML with {} entries", arry.size());
+        ZBACKUP_LOG_INFO("ListShowHandler processed request, generated HTML with {} entries", latest.size());
     }
 }
@@ -0,0 +1,271 @@
+#include <cerrno>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "handlers/snapshot_handler.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "interfaces/session_manager_interface.h"
+#include "core/service_container.h"
+#include "util/namespace_path.h"
+#include "util/util.h"
+#include <nlohmann/json.hpp>
+#include "log/backup_logger.h"
+
+namespace zbackup
+{
+    namespace
+    {
+        nlohmann::json summary_json(const SnapshotManager::Summary &summary)
+        {
+            nlohmann::json item;
+            item["id"] = summary.header.id;
+            item["host"] = summary.header.host;
+            item["created"] = util::time_to_str(summary.header.created);
+            item["created_at"] = static_cast<int64_t>(summary.header.created);
+            item["files"] = summary.trailer.files;
+            item["bytes"] = summary.trailer.bytes;
+            return item;
+        }
+
+        void set_json(zhttp::HttpResponse *rsp, zhttp::HttpResponse::StatusCode code, const std::string &message,
+                      const nlohmann::json &body)
+        {
+            rsp->set_status_code(code);
+            rsp->set_status_message(message);
+            rsp->set_content_type("application/json");
+            rsp->set_header("Cache-Control", "no-store");
+            rsp->set_body(body.dump());
+        }
+
+        void set_error(zhttp::HttpResponse *rsp, zhttp::HttpResponse::StatusCode code, const std::string &message,
+                       const std::string &body)
+        {
+            rsp->set_status_code(code);
+            rsp->set_status_message(message);
+            rsp->set_body(body);
+        }
+    }
+
+    core::Async<void> SnapshotHandler::handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    {
+        auto &container = core::ServiceContainer::get_instance();
+        auto snapshots = container.resolve<SnapshotManager>();
+        auto config = container.resolve<interfaces::IConfigManager>();
+        auto session_manager = container.resolve<interfaces::ISessionManager>();
+
+        if (!snapshots || !config || !session_manager)
+        {
+            ZBACKUP_LOG_ERROR("Required services not available for snapshots");
+            set_error(rsp, zhttp::HttpResponse::StatusCode::InternalServerError, "Internal Server Error",
+                      "Service unavailable");
+            co_return;
+        }
+
+        std::string owner = session_manager->get_username(req);
+        switch (action_)
+        {
+        case Action::CREATE:
+            co_await create(req, rsp, snapshots, owner, config->get_download_prefix());
+            break;
+        case Action::SHOW:
+            co_await show(req, rsp, snapshots, owner);
+            break;
+        case Action::REMOVE:
+            co_await remove(req, rsp, snapshots, owner);
+            break;
+        }
+    }
+
+    std::string SnapshotHandler::request_host(const zhttp::HttpRequest &req)
+    {
+        std::string host = req.get_query_parameters("host");
+        if (host.empty())
+        {
+            host = req.get_header("X-Host");
+        }
+        return util::NamespacePath::sanitize_segment(host, "default");
+    }
+
+    bool SnapshotHandler::resolve(const zhttp::HttpRequest &req, const SnapshotManager::ptr &snapshots,
+                                  const std::string &owner, SnapshotManager::Summary *summary,
+                                  zhttp::HttpResponse *rsp)
+    {
+        std::string host = request_host(req);
+        std::string id = req.get_query_parameters("id");
+        if (id.empty())
+        {
+            id = req.get_query_parameters("snapshot");
+        }
+        std::string at_text = req.get_query_parameters("at");
+
+        time_t at = time(nullptr);
+        if (id.empty() && !at_text.empty())
+        {
+            char *end = nullptr;
+            errno = 0;
+            long long parsed = strtoll(at_text.c_str(), &end, 10);
+            if (errno != 0 || end != at_text.c_str() + at_text.size() || parsed < 0)
+            {
+                ZBACKUP_LOG_WARN("Invalid snapshot time: {}", at_text);
+                set_error(rsp, zhttp::HttpResponse::StatusCode::BadRequest, "Bad Request",
+                          "Invalid at parameter, expected Unix time in seconds");
+                return false;
+            }
+            at = static_cast<time_t>(parsed);
+        }
+
+        if (!snapshots->find(owner, host, id, at, summary))
+        {
+            ZBACKUP_LOG_WARN("Snapshot not found for {}/{}: id={}, at={}", owner, host, id, at_text);
+            set_error(rsp, zhttp::HttpResponse::StatusCode::NotFound, "Not Found", "Snapshot not found");
+            return false;
+        }
+        return true;
+    }
+
+    core::Async<void> SnapshotHandler::create(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                              SnapshotManager::ptr snapshots, std::string owner,
+                                              std::string download_prefix)
+    {
+        auto data_manager = core::ServiceContainer::get_instance().resolve<interfaces::IDataManager>();
+        if (!data_manager)
+        {
+            ZBACKUP_LOG_ERROR("DataManager not available for snapshot creation");
+            set_error(rsp, zhttp::HttpResponse::StatusCode::InternalServerError, "Internal Server Error",
+                      "Service unavailable");
+            co_return;
+        }
+
+        // 与上传相同的命名空间前缀：<下载前缀><用户>/<主机>/
+        std::string host = request_host(req);
+        std::string base = download_prefix + util::NamespacePath::sanitize_segment(owner, "anonymous") + "/" + host +
+                           "/";
+
+        std::vector<info::BackupInfo> all;
+        co_await data_manager->get_by_owner_async(owner, &all);
+        std::unordered_map<std::string, info::BackupInfo> latest;
+        for (auto &info : all)
+        {
+            if (info.base_url_.compare(0, base.size(), base) != 0)
+            {
+                continue;
+            }
+            auto it = latest.find(info.base_url_);
+            if (it == latest.end() || info.version_ > it->second.version_)
+            {
+                latest[info.base_url_] = std::move(info);
+            }
+        }
+        if (latest.empty())
+        {
+            ZBACKUP_LOG_WARN("No files to snapshot for {}/{}", owner, host);
+            set_error(rsp, zhttp::HttpResponse::StatusCode::NotFound, "Not Found", "No files uploaded for host");
+            co_return;
+        }
+
+        std::vector<info::BackupInfo> files;
+        files.reserve(latest.size());
+        for (auto &entry : latest)
+        {
+            files.push_back(std::move(entry.second));
+        }
+
+        SnapshotManager::Summary summary;
+        bool created = co_await core::offload_io([&]()
+        {
+            return snapshots->create(owner, host, base, files, &summary);
+        });
+        if (!created)
+        {
+            set_error(rsp, zhttp::HttpResponse::StatusCode::InternalServerError, "Internal Server Error",
+                      "Failed to create snapshot");
+            co_return;
+        }
+
+        rsp->set_header("X-Snapshot-Id", summary.header.id);
+        set_json(rsp, zhttp::HttpResponse::StatusCode::Created, "Created", summary_json(summary));
+    }
+
+    core::Async<void> SnapshotHandler::show(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                            SnapshotManager::ptr snapshots, std::string owner)
+    {
+        // 不带 id 与 at 时只列出汇总，不读取清单
+        if (req.get_query_parameters("id").empty() && req.get_query_parameters("at").empty())
+        {
+            std::string host = request_host(req);
+            nlohmann::json list = nlohmann::json::array();
+            for (const auto &summary : snapshots->list(owner, host))
+            {
+                list.push_back(summary_json(summary));
+            }
+            nlohmann::json body;
+            body["host"] = host;
+            body["snapshots"] = list;
+            set_json(rsp, zhttp::HttpResponse::StatusCode::OK, "OK", body);
+            co_return;
+        }
+
+        SnapshotManager::Summary summary;
+        if (!resolve(req, snapshots, owner, &summary, rsp))
+        {
+            co_return;
+        }
+        std::vector<util::SnapshotEntry> entries;
+        bool readable = co_await core::offload_io([&]()
+        {
+            return snapshots->read_entries(summary, &entries);
+        });
+        if (!readable)
+        {
+            set_error(rsp, zhttp::HttpResponse::StatusCode::InternalServerError, "Internal Server Error",
+                      "Snapshot manifest is unreadable");
+            co_return;
+        }
+
+        nlohmann::json files = nlohmann::json::array();
+        for (const auto &entry : entries)
+        {
+            nlohmann::json item;
+            item["path"] = entry.path;
+            item["url"] = SnapshotManager::entry_url(summary.header, entry);
+            item["version"] = entry.version;
+            item["size"] = entry.size;
+            item["mtime"] = util::time_to_str(entry.mtime);
+            item["crc32c"] = entry.checksum;
+            files.push_back(item);
+        }
+        nlohmann::json body = summary_json(summary);
+        body["base"] = summary.header.base;
+        body["entries"] = files;
+        set_json(rsp, zhttp::HttpResponse::StatusCode::OK, "OK", body);
+        ZBACKUP_LOG_DEBUG("Snapshot {} listed: {} files", summary.header.id, entries.size());
+    }
+
+    core::Async<void> SnapshotHandler::remove(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp,
+                                              SnapshotManager::ptr snapshots, std::string owner)
+    {
+        std::string id = req.get_query_parameters("id");
+        if (id.empty())
+        {
+            set_error(rsp, zhttp::HttpResponse::StatusCode::BadRequest, "Bad Request", "Missing id parameter");
+            co_return;
+        }
+
+        std::string host = request_host(req);
+        bool removed = co_await core::offload_io([&]()
+        {
+            return snapshots->remove(owner, host, id);
+        });
+        if (!removed)
+        {
+            set_error(rsp, zhttp::HttpResponse::StatusCode::NotFound, "Not Found", "Snapshot not found");
+            co_return;
+        }
+
+        nlohmann::json body;
+        body["id"] = id;
+        body["deleted"] = true;
+        set_json(rsp, zhttp::HttpResponse::StatusCode::OK, "OK", body);
+    }
+}
@@ -1,28 +1,34 @@
 #include <utility>
 
 #include "handlers/static_handler.h"
+#include "core/service_container.h"
 #include "util/util.h"
+#include "util/http_util.h"
 #include "log/backup_logger.h"
 
 namespace zbackup
 {
+    // 页面可被缓存，但使用前需向服务器校验，保证页面更新后及时生效
+    static const char *STATIC_CACHE_CONTROL = "no-cache";
+
     StaticHandler::StaticHandler()
     {
-        // 设置MIME类型映射
-        mime_types_[".html"] = "text/html; charset=UTF-8";
-        mime_types_[".css"] = "text/css";
-        mime_types_[".js"] = "application/javascript";
-        mime_types_[".png"] = "image/png";
-        mime_types_[".jpg"] = "image/jpeg";
-        mime_types_[".jpeg"] = "image/jpeg";
-        mime_types_[".gif"] = "image/gif";
-        mime_types_[".ico"] = "image/x-icon";
-
-        ZBACKUP_LOG_DEBUG("StaticHandler initialized with {} MIME types", mime_types_.size());
+        auto &container = core::ServiceContainer::get_instance();
+        cache_ = container.resolve<cache::StaticAssetCache>();
+        ZBACKUP_LOG_DEBUG("StaticHandler initialized with {} cached assets", cache_ ? cache_->size() : 0);
     }
 
     void StaticHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
     {
+        if (!cache_)
+        {
+            ZBACKUP_LOG_ERROR("StaticAssetCache not available for static request");
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Service unavailable");
+            return;
+        }
+
         std::string path = req.get_path();
         ZBACKUP_LOG_DEBUG("Static file request: {}", path);
 
@@ -38,44 +44,58 @@ namespace zbackup
             path = path.substr(1);
         }
 
-        // 构建web根文件路径
-        std::string file_path = "../resource/" + path;
-        util::FileUtil fu(file_path);
-
-        if (!fu.exists())
+        auto asset = cache_->find(path);
+        if (!asset)
         {
-            ZBACKUP_LOG_WARN("Static file not found: {}", file_path);
+            ZBACKUP_LOG_WARN("Static file not found: {}", path);
             rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
             rsp->set_status_message("Not Found");
             rsp->set_body("File not found");
             return;
         }
 
-        std::string content;
-        if (!fu.get_content(&content))
+        // 按Accept-Encoding选择预压缩版本，ETag随所选内容一起确定
+        const std::string *body = &asset->content;
+        const std::string *etag = &asset->etag;
+        std::string encoding;
+        std::vector<std::string> encodings;
+        if (!asset->br_content.empty())
+            encodings.emplace_back("br");
+        if (!asset->gzip_content.empty())
+            encodings.emplace_back("gzip");
+        if (!encodings.empty())
         {
-            ZBACKUP_LOG_ERROR("Failed to read static file: {}", file_path);
-            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
-            rsp->set_status_message("Internal Server Error");
-            rsp->set_body("Failed to read file");
-            return;
+            encoding = util::HttpUtil::choose_encoding(req.get_header("Accept-Encoding"), encodings);
+            if (encoding == "br")
+            {
+                body = &asset->br_content;
+                etag = &asset->br_etag;
+            }
+            else if (encoding == "gzip")
+            {
+                body = &asset->gzip_content;
+                etag = &asset->gzip_etag;
+            }
+            // 304响应同样随编码变化，缓存需按Accept-Encoding区分
+            rsp->set_header("Vary", "Accept-Encoding");
         }
 
-        size_t dot_pos = path.find_last_of('.');
-        std::string extension = (dot_pos != std::string::npos) ? path.substr(dot_pos) : "";
-        std::string mime_type = get_mime_type(extension);
+        // 条件请求：资源未变化时直接返回304
+        if (util::HttpUtil::is_not_modified(req, *etag, asset->mtime))
+        {
+            ZBACKUP_LOG_DEBUG("Static file not modified: {}", path);
+            util::HttpUtil::set_not_modified(rsp, *etag, asset->mtime, STATIC_CACHE_CONTROL);
+            return;
+        }
 
+        if (!encoding.empty())
+            rsp->set_header("Content-Encoding", encoding);
         rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
         rsp->set_status_message("OK");
-        rsp->set_content_type(mime_type);
-        rsp->set_body(content);
-
-        ZBACKUP_LOG_DEBUG("Static file served: {} ({} bytes, {})", file_path, content.size(), mime_type);
-    }
+        rsp->set_content_type(asset->mime_type);
+        util::HttpUtil::set_cache_headers(rsp, *etag, asset->mtime, STATIC_CACHE_CONTROL);
+        rsp->set_body(*body);
 
-    std::string StaticHandler::get_mime_type(const std::string &extension)
-    {
-        auto it = mime_types_.find(extension);
-        return (it != mime_types_.end()) ? it->second : "application/octet-stream";
+        ZBACKUP_LOG_DEBUG("Static file served: {} ({} bytes, {})", path, body->size(), asset->mime_type);
     }
 }
@@ -6,24 +6,29 @@
 #include "handlers/upload_handler.h"
 #include "core/service_container.h"
 #include "util/util.h"
+#include "util/checksum.h"
+#include "util/multipart_parser.h"
+#include "util/namespace_path.h"
+#include "interfaces/session_manager_interface.h"
+#include "core/task_graph.h"
 #include <nlohmann/json.hpp>
 #include "log/backup_logger.h"
-#include <regex>
+#include <algorithm>
+#include <unordered_set>
 #include "interfaces/data_manager_interface.h"
 
 namespace zbackup
 {
     void UploadHandler::handle_request(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
     {
-        std::string filename;
-        std::string file_content;
+        std::vector<UploadedFile> files;
 
         std::string content_type = req.get_header("Content-Type");
         ZBACKUP_LOG_DEBUG("Upload request received, Content-Type: {}", content_type);
 
         if (content_type.find("multipart/form-data") != std::string::npos)
         {
-            if (!parse_multipart_data(req, filename, file_content))
+            if (!parse_multipart_data(req, &files))
             {
                 ZBACKUP_LOG_WARN("Failed to parse multipart upload data");
                 rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
@@ -34,9 +39,10 @@ namespace zbackup
         }
         else
         {
-            filename = req.get_header("X-Filename");
-            file_content = req.get_content();
-            if (filename.empty())
+            UploadedFile file;
+            file.filename = req.get_header("X-Filename");
+            file.content = req.get_content();
+            if (file.filename.empty())
             {
                 ZBACKUP_LOG_WARN("Upload request missing X-Filename header");
                 rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
@@ -44,83 +50,563 @@ namespace zbackup
                 rsp->set_body("Missing X-Filename header");
                 return;
             }
+            files.push_back(std::move(file));
         }
 
-        ZBACKUP_LOG_INFO("File upload started: {} ({} bytes)", filename, file_content.size());
+        ExpectedDigest expected;
+        if (!parse_expected_digest(req, &expected))
+        {
+            ZBACKUP_LOG_WARN("Upload request with malformed digest header: {}", files.front().filename);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+            rsp->set_status_message("Bad Request");
+            rsp->set_body("Malformed Content-Digest or X-Checksum header");
+            return;
+        }
+        // 校验头部只描述一个文件的内容
+        if ((batch_ || files.size() > 1) && (!expected.crc32c.empty() || !expected.sha256.empty()))
+        {
+            ZBACKUP_LOG_WARN("Digest header sent with {} uploaded files", files.size());
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+            rsp->set_status_message("Bad Request");
+            rsp->set_body("Digest headers are only allowed for single file uploads");
+            return;
+        }
 
-        if (!save_file(filename, file_content))
+        QuotaReservation reservation;
+        if (!assign_keys(req, &files, rsp) || !reserve_quota(files, &reservation, rsp))
         {
-            ZBACKUP_LOG_ERROR("Failed to save uploaded file: {}", filename);
-            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
-            rsp->set_status_message("Internal Server Error");
-            rsp->set_body("Write file failed");
             return;
         }
 
-        ZBACKUP_LOG_INFO("File uploaded successfully: {}", filename);
+        if (batch_)
+        {
+            handle_batch(&files, &reservation, rsp);
+            return;
+        }
+
+        // 多个文件按顺序保存，遇到失败即返回；已保存的文件保留，并在错误正文中列出，客户端只需重传其余文件
+        nlohmann::json saved = nlohmann::json::array();
+        info::BackupInfo info;
+        for (auto &file : files)
+        {
+            const std::string &filename = file.filename;
+            size_t file_size = file.content.size();
+            ZBACKUP_LOG_INFO("File upload started: {} -> {} ({} bytes)", filename, file.key, file_size);
+
+            SaveResult result = save_file(file, std::make_shared<const std::string>(std::move(file.content)),
+                                          expected, &info);
+            if (result != SaveResult::OK)
+            {
+                set_failure(result, filename, rsp);
+                if (!saved.empty())
+                {
+                    nlohmann::json body;
+                    body["success"] = false;
+                    body["error"] = result_name(result);
+                    body["failed_file"] = filename;
+                    body["files"] = saved;
+                    rsp->set_content_type("application/json");
+                    rsp->set_body(body.dump());
+                }
+                return;
+            }
+
+            reservation.committed(file_size);
+            ZBACKUP_LOG_INFO("File uploaded successfully: {} (crc32c={})", info.url_, info.checksum_);
+            saved.push_back({{"filename", filename}, {"url", info.url_}, {"version", info.version_},
+                             {"crc32c", info.checksum_}});
+        }
+
         rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
         rsp->set_status_message("OK");
-        rsp->set_body("The file was uploaded successfully");
+        if (files.size() == 1)
+        {
+            rsp->set_header("X-Checksum", "crc32c=" + info.checksum_);
+            rsp->set_header("X-Backup-Url", info.url_);
+            rsp->set_header("X-Backup-Version", std::to_string(info.version_));
+            rsp->set_body("The file was uploaded successfully");
+            return;
+        }
+        nlohmann::json body;
+        body["success"] = true;
+        body["files"] = saved;
+        rsp->set_content_type("application/json");
+        rsp->set_body(body.dump());
     }
 
-    bool UploadHandler::parse_multipart_data(const zhttp::HttpRequest &req, std::string &filename,
-                                             std::string &file_content)
+    void UploadHandler::handle_batch(std::vector<UploadedFile> *files, QuotaReservation *reservation,
+                                     zhttp::HttpResponse *rsp) const
     {
-        std::string content_type = req.get_header("Content-Type");
+        // 同一路径在一批中出现多次时版本先后没有意义，整批拒绝
+        std::unordered_set<std::string> keys;
+        for (const auto &file : *files)
+        {
+            if (!keys.insert(file.key).second)
+            {
+                ZBACKUP_LOG_WARN("Batch upload contains duplicate file name: {}", file.filename);
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+                rsp->set_status_message("Bad Request");
+                rsp->set_body("Duplicate file name in batch: " + file.filename);
+                return;
+            }
+        }
 
-        std::smatch match;
-        std::regex boundary_re("boundary=([^\r\n;]+)");
-        if (!std::regex_search(content_type, match, boundary_re) || match.size() < 2)
+        size_t total_size = 0;
+        for (const auto &file : *files)
         {
-            ZBACKUP_LOG_WARN("Multipart boundary not found in Content-Type: {}", content_type);
-            return false;
+            total_size += file.content.size();
         }
+        ZBACKUP_LOG_INFO("Batch upload started: {} files ({} bytes)", files->size(), total_size);
 
-        std::string boundary = "--" + match[1].str();
-        const std::string &body = req.get_content();
-        ZBACKUP_LOG_DEBUG("Parsing multipart data with boundary: {}", boundary);
+        std::vector<StagedFile> results;
+        save_batch(files, &results);
 
-        size_t pos = 0;
-        while ((pos = body.find(boundary, pos)) != std::string::npos)
+        nlohmann::json list = nlohmann::json::array();
+        size_t failed = 0;
+        size_t first_failure = files->size();
+        for (size_t i = 0; i < results.size(); i++)
         {
-            size_t part_start = pos + boundary.size();
-            if (body.substr(part_start, 2) == "--")
-                break;
+            nlohmann::json item;
+            item["filename"] = (*files)[i].filename;
+            item["status"] = result_name(results[i].result);
+            if (results[i].result == SaveResult::OK)
+            {
+                reservation->committed(results[i].info.fsize_);
+                item["url"] = results[i].info.url_;
+                item["version"] = results[i].info.version_;
+                item["crc32c"] = results[i].info.checksum_;
+            }
+            else
+            {
+                failed++;
+                first_failure = std::min(first_failure, i);
+            }
+            list.push_back(item);
+        }
+        ZBACKUP_LOG_INFO("Batch upload finished: {} saved, {} failed", results.size() - failed, failed);
 
-            size_t header_end = body.find("\r\n\r\n", part_start);
-            if (header_end == std::string::npos)
-                break;
+        // 全部失败时状态码取第一个失败文件的结果；部分成功时已有文件登记为新版本，返回200，
+        // 由正文中每个文件的结果告知客户端只重传失败的文件，避免整批重试产生重复版本
+        if (failed > 0 && failed == results.size())
+        {
+            set_failure(results[first_failure].result, (*files)[first_failure].filename, rsp);
+        }
+        else
+        {
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
+            rsp->set_status_message("OK");
+        }
+        nlohmann::json body;
+        body["success"] = failed == 0;
+        body["saved"] = results.size() - failed;
+        body["failed"] = failed;
+        body["files"] = list;
+        rsp->set_content_type("application/json");
+        rsp->set_body(body.dump());
+    }
 
-            std::string headers = body.substr(part_start, header_end - part_start);
-            size_t content_start = header_end + 4;
-            size_t next_boundary = body.find(boundary, content_start);
-            if (next_boundary == std::string::npos)
-                break;
+    void UploadHandler::set_failure(SaveResult result, const std::string &filename, zhttp::HttpResponse *rsp)
+    {
+        switch (result)
+        {
+        case SaveResult::BUSY:
+            ZBACKUP_LOG_WARN("Worker queue full, rejecting upload: {}", filename);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::ServiceUnavailable);
+            rsp->set_status_message("Service Unavailable");
+            rsp->set_header("Retry-After", "1");
+            rsp->set_body("Server busy, please retry");
+            return;
+        case SaveResult::DIGEST_MISMATCH:
+            ZBACKUP_LOG_WARN("Uploaded file rejected, checksum mismatch: {}", filename);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+            rsp->set_status_message("Bad Request");
+            rsp->set_body("Checksum mismatch");
+            return;
+        default:
+            ZBACKUP_LOG_ERROR("Failed to save uploaded file: {}", filename);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Write file failed");
+            return;
+        }
+    }
+
+    const char *UploadHandler::result_name(SaveResult result)
+    {
+        switch (result)
+        {
+        case SaveResult::OK:
+            return "ok";
+        case SaveResult::WRITE_FAILED:
+            return "write_failed";
+        case SaveResult::DIGEST_MISMATCH:
+            return "checksum_mismatch";
+        case SaveResult::CATALOG_FAILED:
+            return "catalog_failed";
+        case SaveResult::BUSY:
+            return "busy";
+        }
+        return "unknown";
+    }
 
-            size_t content_len = next_boundary - content_start;
-            std::string part_content = body.substr(content_start, content_len);
+    bool UploadHandler::parse_expected_digest(const zhttp::HttpRequest &req, ExpectedDigest *digest)
+    {
+        auto trim = [](const std::string &str) {
+            size_t begin = str.find_first_not_of(" \t");
+            size_t end = str.find_last_not_of(" \t");
+            return begin == std::string::npos ? std::string() : str.substr(begin, end - begin + 1);
+        };
+        auto lower = [](std::string str) {
+            for (auto &c : str)
+                c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            return str;
+        };
+        // 逐项解析 "算法=值" 列表
+        auto for_each_item = [&](const std::string &header, const auto &handle) {
+            size_t pos = 0;
+            while (pos < header.size())
+            {
+                size_t comma = header.find(',', pos);
+                if (comma == std::string::npos)
+                    comma = header.size();
+                std::string item = trim(header.substr(pos, comma - pos));
+                pos = comma + 1;
+                if (item.empty())
+                    continue;
+                size_t eq = item.find('=');
+                if (eq == std::string::npos || !handle(lower(trim(item.substr(0, eq))), trim(item.substr(eq + 1))))
+                    return false;
+            }
+            return true;
+        };
+
+        // RFC 9530: Content-Digest: sha-256=:<base64>:, crc32c=:<base64>:
+        bool ok = for_each_item(req.get_header("Content-Digest"), [&](const std::string &algo, const std::string &value) {
+            if (algo != "sha-256" && algo != "crc32c")
+                return true; // 忽略不支持的算法
+            std::string raw;
+            if (value.size() < 2 || value.front() != ':' || value.back() != ':' ||
+                !util::ChecksumUtil::base64_decode(value.substr(1, value.size() - 2), &raw))
+                return false;
+            std::string hex = util::ChecksumUtil::to_hex(reinterpret_cast<const unsigned char *>(raw.data()), raw.size());
+            if (algo == "sha-256" && raw.size() == 32)
+                digest->sha256 = hex;
+            else if (algo == "crc32c" && raw.size() == 4)
+                digest->crc32c = hex;
+            else
+                return false;
+            return true;
+        });
+
+        // X-Checksum: crc32c=<hex>, sha256=<hex>
+        ok = ok && for_each_item(req.get_header("X-Checksum"), [&](const std::string &algo, const std::string &value) {
+            std::string hex = lower(value);
+            if (hex.find_first_not_of("0123456789abcdef") != std::string::npos)
+                return false;
+            if (algo == "crc32c" && hex.size() == 8)
+                digest->crc32c = digest->crc32c.empty() ? hex : digest->crc32c;
+            else if ((algo == "sha256" || algo == "sha-256") && hex.size() == 64)
+                digest->sha256 = digest->sha256.empty() ? hex : digest->sha256;
+            else if (algo == "crc32c" || algo == "sha256" || algo == "sha-256")
+                return false;
+            return true;
+        });
+        return ok;
+    }
+
+    bool UploadHandler::parse_multipart_data(const zhttp::HttpRequest &req, std::vector<UploadedFile> *files)
+    {
+        // 收集所有文件分片的内容，普通表单字段忽略
+        class FileSink final : public util::MultipartParser::Sink
+        {
+        public:
+            explicit FileSink(std::vector<UploadedFile> *files) : files_(files) {}
+
+            bool on_part_begin(const util::MultipartParser::PartHeaders &headers) override
+            {
+                current_ = nullptr;
+                if (!headers.filename.empty())
+                {
+                    files_->emplace_back();
+                    current_ = &files_->back();
+                    current_->filename = headers.filename;
+                }
+                return true;
+            }
 
-            // 查找文件字段
-            std::smatch fname_match;
-            std::regex fname_re("name=\"file\".*filename=\"([^\"]*)\"");
-            if (std::regex_search(headers, fname_match, fname_re))
+            bool on_part_data(std::string_view data) override
             {
-                if (fname_match.size() > 1)
+                if (current_)
                 {
-                    filename = fname_match[1].str();
+                    current_->content.append(data.data(), data.size());
                 }
-                // 去除结尾换行
-                while (!part_content.empty() && (part_content.back() == '\r' || part_content.back() == '\n'))
-                    part_content.pop_back();
-                file_content = part_content;
                 return true;
             }
-            pos = next_boundary;
+
+            bool on_part_end() override
+            {
+                current_ = nullptr;
+                return true;
+            }
+
+        private:
+            std::vector<UploadedFile> *files_;
+            UploadedFile *current_ = nullptr;
+        };
+
+        std::string content_type = req.get_header("Content-Type");
+        std::string boundary;
+        if (!util::MultipartParser::extract_boundary(content_type, &boundary))
+        {
+            ZBACKUP_LOG_WARN("Multipart boundary not found in Content-Type: {}", content_type);
+            return false;
+        }
+        ZBACKUP_LOG_DEBUG("Parsing multipart data with boundary: {}", boundary);
+
+        util::MultipartParser parser(boundary);
+        FileSink sink(files);
+        if (!parser.feed(req.get_content(), &sink))
+        {
+            ZBACKUP_LOG_WARN("Malformed multipart body: {}", parser.error());
+            return false;
+        }
+        if (!parser.done())
+        {
+            ZBACKUP_LOG_WARN("Multipart body ended without closing boundary");
+            return false;
+        }
+        return !files->empty();
+    }
+
+    bool UploadHandler::assign_keys(const zhttp::HttpRequest &req, std::vector<UploadedFile> *files,
+                                    zhttp::HttpResponse *rsp)
+    {
+        // 命名空间：登录用户 + 客户端通过 X-Host 声明的主机名
+        auto session_manager = core::ServiceContainer::get_instance().resolve<interfaces::ISessionManager>();
+        std::string owner = session_manager ? session_manager->get_username(req) : std::string();
+        std::string user = util::NamespacePath::sanitize_segment(owner, "anonymous");
+        std::string host = util::NamespacePath::sanitize_segment(req.get_header("X-Host"), "default");
+
+        for (auto &file : *files)
+        {
+            std::string relative_path;
+            if (!util::NamespacePath::normalize(file.filename, &relative_path) ||
+                !util::NamespacePath::make_key(user, host, relative_path, &file.key))
+            {
+                ZBACKUP_LOG_WARN("Upload rejected, invalid file path: {}", file.filename);
+                rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+                rsp->set_status_message("Bad Request");
+                rsp->set_body("Invalid file path: " + file.filename);
+                return false;
+            }
+            file.owner = owner;
+            file.shard = util::NamespacePath::version_shard_path(file.key);
+        }
+        return true;
+    }
+
+    UploadHandler::QuotaReservation::~QuotaReservation()
+    {
+        if (data_manager_ && (remaining_.bytes > 0 || remaining_.files > 0))
+        {
+            data_manager_->release_reserved(owner_, remaining_);
         }
-        return false;
     }
 
-    bool UploadHandler::save_file(const std::string &filename, const std::string &file_content) const
+    void UploadHandler::QuotaReservation::hold(interfaces::IDataManager::ptr data_manager, std::string owner,
+                                               const interfaces::IDataManager::Usage &amount)
+    {
+        data_manager_ = std::move(data_manager);
+        owner_ = std::move(owner);
+        remaining_ = amount;
+    }
+
+    void UploadHandler::QuotaReservation::committed(uint64_t bytes)
+    {
+        remaining_.bytes -= std::min(remaining_.bytes, bytes);
+        remaining_.files -= std::min<uint64_t>(remaining_.files, 1);
+    }
+
+    bool UploadHandler::reserve_quota(const std::vector<UploadedFile> &files, QuotaReservation *reservation,
+                                      zhttp::HttpResponse *rsp)
+    {
+        auto &container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+        const std::string &owner = files.front().owner;
+        if (!config || !data_manager || owner.empty())
+        {
+            return true;
+        }
+
+        // 配额为0表示不限制；用量取自增量维护的计数，检查不访问目录
+        interfaces::IDataManager::Usage quota;
+        quota.bytes = static_cast<uint64_t>(std::max(config->get_int("user_quota_mb", 0), 0)) << 20;
+        quota.files = static_cast<uint64_t>(std::max(config->get_int("user_quota_files", 0), 0));
+        if (quota.bytes == 0 && quota.files == 0)
+        {
+            return true;
+        }
+
+        // 检查与预留是原子的，并发上传各自计入对方的预留，合计不会超出配额
+        interfaces::IDataManager::Usage request;
+        for (const auto &file : files)
+        {
+            request.bytes += file.content.size();
+        }
+        request.files = files.size();
+        interfaces::IDataManager::Usage usage;
+        if (!data_manager->try_reserve(owner, request, quota, &usage))
+        {
+            ZBACKUP_LOG_WARN("Upload rejected, quota exceeded for {}: {} bytes / {} files used or reserved, "
+                             "{} bytes / {} files requested", owner, usage.bytes, usage.files, request.bytes,
+                             request.files);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::PayloadTooLarge);
+            rsp->set_status_message("Payload Too Large");
+            rsp->set_body("Quota exceeded");
+            return false;
+        }
+        reservation->hold(data_manager, owner, request);
+        return true;
+    }
+
+    std::string UploadHandler::real_path_of(const std::string &back_dir, const std::string &shard)
+    {
+        return back_dir + shard;
+    }
+
+    std::string UploadHandler::temp_path_of(const std::string &back_dir, const std::string &shard)
+    {
+        // 以'.'开头，热点扫描会跳过
+        std::string real_path = real_path_of(back_dir, shard);
+        size_t slash = real_path.find_last_of('/');
+        return real_path.substr(0, slash + 1) + ".upload_" + real_path.substr(slash + 1);
+    }
+
+    core::TaskFuture<UploadHandler::StagedFile> UploadHandler::stage_file(
+        const std::string &back_dir, const UploadedFile &file, std::shared_ptr<const std::string> file_content,
+        const ExpectedDigest &expected)
+    {
+        const std::string &key = file.key;
+        const std::string &owner = file.owner;
+        const std::string &shard = file.shard;
+        std::string real_path = real_path_of(back_dir, shard);
+        // 先写入同一分片目录下的临时文件，校验通过后再改名；每次上传的路径不同，并发上传同一路径互不覆盖
+        std::string temp_path = temp_path_of(back_dir, shard);
+
+        // 1. 写入临时文件并同步计算CRC32C（IO线程池）
+        auto write = core::spawn_for(core::SUBMIT_TIME, core::TaskLane::IO, core::TaskPriority::HIGH,
+                                     [file_content, temp_path]()
+                                     {
+                                         util::FileUtil(util::fs::path(temp_path).parent_path().string())
+                                             .create_directory();
+                                         util::FileUtil fu(temp_path);
+                                         util::Crc32c crc;
+                                         if (!fu.set_content(*file_content, [&crc](const char *data, size_t len) {
+                                                 crc.update(data, len);
+                                             }))
+                                         {
+                                             return std::string();
+                                         }
+                                         return crc.hex();
+                                     });
+
+        // 2. 客户端提供了SHA-256时，与写盘并行计算（CPU线程池）
+        core::TaskFuture<std::string> sha;
+        if (!expected.sha256.empty() && write.status() != core::TaskStatus::REJECTED)
+        {
+            sha = core::spawn_for(core::SUBMIT_TIME, core::TaskLane::CPU, core::TaskPriority::HIGH,
+                                  [file_content]()
+                                  {
+                                      util::Sha256 hasher;
+                                      hasher.update(file_content->data(), file_content->size());
+                                      return hasher.hex_digest();
+                                  }, write.token());
+        }
+
+        // 3. 两路结果汇合后校验、改名并生成备份信息（IO线程池）
+        auto stages = sha.valid() ? core::when_all(write, sha) : core::when_all(write);
+        return stages.then(core::TaskLane::IO, core::TaskPriority::HIGH,
+                           [write, sha, expected, key, owner, shard, temp_path, real_path]()
+                           {
+                               StagedFile staged;
+                               util::FileUtil fu(temp_path);
+                               std::string crc = write.get();
+                               if (crc.empty())
+                               {
+                                   ZBACKUP_LOG_ERROR("Failed to write file content: {}", real_path);
+                                   fu.remove_file();
+                                   staged.result = SaveResult::WRITE_FAILED;
+                                   return staged;
+                               }
+                               if (!expected.crc32c.empty() && expected.crc32c != crc)
+                               {
+                                   ZBACKUP_LOG_WARN("CRC32C mismatch for {}: expected {}, actual {}", real_path,
+                                                    expected.crc32c, crc);
+                                   fu.remove_file();
+                                   staged.result = SaveResult::DIGEST_MISMATCH;
+                                   return staged;
+                               }
+                               if (sha.valid() && expected.sha256 != sha.get())
+                               {
+                                   ZBACKUP_LOG_WARN("SHA-256 mismatch for {}: expected {}, actual {}", real_path,
+                                                    expected.sha256, sha.get());
+                                   fu.remove_file();
+                                   staged.result = SaveResult::DIGEST_MISMATCH;
+                                   return staged;
+                               }
+
+                               if (fu.rename_to(real_path) == false)
+                               {
+                                   fu.remove_file();
+                                   staged.result = SaveResult::WRITE_FAILED;
+                                   return staged;
+                               }
+
+                               if (staged.info.new_backup_info(real_path, key, shard) == false)
+                               {
+                                   ZBACKUP_LOG_ERROR("Failed to create backup info for: {}", real_path);
+                                   fu.remove_file();
+                                   staged.result = SaveResult::CATALOG_FAILED;
+                                   return staged;
+                               }
+                               staged.info.checksum_ = crc;
+                               staged.info.owner_ = owner;
+                               staged.result = SaveResult::OK;
+                               return staged;
+                           });
+    }
+
+    UploadHandler::StagedFile UploadHandler::finish_stage(const core::TaskFuture<StagedFile> &staged,
+                                                          const std::string &temp_path)
+    {
+        staged.wait();
+        if (staged.status() == core::TaskStatus::SUCCEEDED)
+        {
+            return staged.get();
+        }
+
+        StagedFile failed;
+        if (staged.status() == core::TaskStatus::REJECTED)
+        {
+            failed.result = SaveResult::BUSY;
+        }
+        else
+        {
+            ZBACKUP_LOG_ERROR("Upload pipeline aborted for: {}", temp_path);
+            failed.result = SaveResult::WRITE_FAILED;
+        }
+        // 某一路未被接纳时另一路可能已写出临时文件
+        if (util::FileUtil(temp_path).exists())
+        {
+            util::FileUtil(temp_path).remove_file();
+        }
+        return failed;
+    }
+
+    UploadHandler::SaveResult UploadHandler::save_file(const UploadedFile &file,
+                                                       std::shared_ptr<const std::string> file_content,
+                                                       const ExpectedDigest &expected, info::BackupInfo *saved) const
     {
         auto &container = core::ServiceContainer::get_instance();
         auto config = container.resolve<interfaces::IConfigManager>();
@@ -129,32 +615,108 @@ namespace zbackup
         if (!config || !data_manager)
         {
             ZBACKUP_LOG_ERROR("Required services not available for file save");
-            return false;
+            return SaveResult::WRITE_FAILED;
         }
 
         std::string back_dir = config->get_string("back_dir", "./backup/");
-        std::string real_path = back_dir + util::FileUtil(filename).get_name();
-        util::FileUtil fu(real_path);
+        // 校验、改名后在IO线程池登记为该路径的新版本；登记失败时删除已写入的文件
+        auto cataloged = stage_file(back_dir, file, std::move(file_content), expected)
+            .then(core::TaskLane::IO, core::TaskPriority::HIGH, [data_manager](StagedFile staged)
+            {
+                if (staged.result != SaveResult::OK)
+                {
+                    return staged;
+                }
+                std::vector<info::BackupInfo> infos{staged.info};
+                if (data_manager->insert_versions(&infos) == false)
+                {
+                    ZBACKUP_LOG_ERROR("Failed to insert backup info for: {}", staged.info.real_path_);
+                    util::FileUtil(staged.info.real_path_).remove_file();
+                    staged.result = SaveResult::CATALOG_FAILED;
+                    return staged;
+                }
+                staged.info = std::move(infos.front());
+                return staged;
+            });
 
-        if (fu.set_content(file_content) == false)
+        // HTTP线程只等待最终结果，不参与写盘与哈希计算
+        StagedFile staged = finish_stage(cataloged, temp_path_of(back_dir, file.shard));
+        if (staged.result == SaveResult::OK)
         {
-            ZBACKUP_LOG_ERROR("Failed to write file content: {}", real_path);
-            return false;
+            *saved = std::move(staged.info);
         }
+        return staged.result;
+    }
 
-        info::BackupInfo info;
-        if (info.new_backup_info(real_path) == false)
+    void UploadHandler::save_batch(std::vector<UploadedFile> *files, std::vector<StagedFile> *results) const
+    {
+        auto &container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        results->assign(files->size(), StagedFile());
+        if (!config || !data_manager)
         {
-            ZBACKUP_LOG_ERROR("Failed to create backup info for: {}", real_path);
-            return false;
+            ZBACKUP_LOG_ERROR("Required services not available for file save");
+            return;
         }
 
-        if (data_manager->insert(info) == false)
+        std::string back_dir = config->get_string("back_dir", "./backup/");
+        // 同时在途的文件数有上限，避免大批量请求占满IO队列后其余文件被拒绝
+        size_t window = static_cast<size_t>(std::max(config->get_int("batch_upload_parallelism", 16), 1));
+
+        std::vector<core::TaskFuture<StagedFile> > stages(files->size());
+        auto finish = [&](size_t index)
         {
-            ZBACKUP_LOG_ERROR("Failed to insert backup info for: {}", real_path);
-            return false;
+            (*results)[index] = finish_stage(stages[index], temp_path_of(back_dir, (*files)[index].shard));
+        };
+        for (size_t i = 0; i < files->size(); i++)
+        {
+            if (i >= window)
+            {
+                finish(i - window);
+            }
+            auto &file = (*files)[i];
+            stages[i] = stage_file(back_dir, file,
+                                   std::make_shared<const std::string>(std::move(file.content)), ExpectedDigest());
+        }
+        for (size_t i = files->size() > window ? files->size() - window : 0; i < files->size(); i++)
+        {
+            finish(i);
         }
 
-        return true;
+        // 成功写入的文件整批登记为新版本，目录只持久化一次
+        std::vector<info::BackupInfo> infos;
+        for (const auto &staged : *results)
+        {
+            if (staged.result == SaveResult::OK)
+            {
+                infos.push_back(staged.info);
+            }
+        }
+        if (infos.empty())
+        {
+            return;
+        }
+        bool cataloged = data_manager->insert_versions(&infos);
+        if (!cataloged)
+        {
+            ZBACKUP_LOG_ERROR("Failed to insert backup info batch: {} entries", infos.size());
+        }
+        size_t next = 0;
+        for (auto &staged : *results)
+        {
+            if (staged.result != SaveResult::OK)
+            {
+                continue;
+            }
+            if (cataloged)
+            {
+                staged.info = std::move(infos[next++]);
+                continue;
+            }
+            util::FileUtil(staged.info.real_path_).remove_file();
+            staged.result = SaveResult::CATALOG_FAILED;
+        }
     }
 }
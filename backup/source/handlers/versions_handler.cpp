@@ -0,0 +1,85 @@
+#include <algorithm>
+#include "handlers/versions_handler.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "interfaces/session_manager_interface.h"
+#include "core/service_container.h"
+#include "util/util.h"
+#include <nlohmann/json.hpp>
+#include "log/backup_logger.h"
+
+namespace zbackup
+{
+    core::Async<void> VersionsHandler::handle(const zhttp::HttpRequest &req, zhttp::HttpResponse *rsp)
+    {
+        auto &container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+        auto config = container.resolve<interfaces::IConfigManager>();
+        auto session_manager = container.resolve<interfaces::ISessionManager>();
+
+        if (!data_manager || !config || !session_manager)
+        {
+            ZBACKUP_LOG_ERROR("Required services not available for version listing");
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::InternalServerError);
+            rsp->set_status_message("Internal Server Error");
+            rsp->set_body("Service unavailable");
+            co_return;
+        }
+
+        std::string file = req.get_query_parameters("file");
+        if (file.empty())
+        {
+            ZBACKUP_LOG_WARN("Version listing request missing file parameter");
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::BadRequest);
+            rsp->set_status_message("Bad Request");
+            rsp->set_body("Missing file parameter");
+            co_return;
+        }
+        // 参数既可以是完整URL，也可以是去掉下载前缀的路径
+        std::string download_prefix = config->get_download_prefix();
+        std::string base_url = file.compare(0, download_prefix.size(), download_prefix) == 0
+                                   ? file
+                                   : download_prefix + file.substr(std::min(file.find_first_not_of('/'), file.size()));
+
+        std::vector<info::BackupInfo> versions;
+        co_await data_manager->get_versions_async(base_url, &versions);
+        // 其他用户的版本按不存在处理，逐个版本检查归属
+        std::string owner = session_manager->get_username(req);
+        versions.erase(std::remove_if(versions.begin(), versions.end(), [&owner](const info::BackupInfo &info)
+        {
+            return !info.owner_.empty() && info.owner_ != owner;
+        }), versions.end());
+        if (versions.empty())
+        {
+            ZBACKUP_LOG_WARN("File not found for version listing: {}", base_url);
+            rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotFound);
+            rsp->set_status_message("Not Found");
+            rsp->set_body("File not found");
+            co_return;
+        }
+
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto &info : versions)
+        {
+            nlohmann::json item;
+            item["version"] = info.version_;
+            item["url"] = info.url_;
+            item["size"] = info.fsize_;
+            item["mtime"] = util::time_to_str(info.mtime_);
+            item["crc32c"] = info.checksum_;
+            item["tier"] = info.tier_ == info::StorageTier::COLD ? "cold" : "hot";
+            list.push_back(item);
+        }
+        nlohmann::json body;
+        body["file"] = base_url;
+        body["latest"] = versions.back().version_;
+        body["versions"] = list;
+
+        rsp->set_status_code(zhttp::HttpResponse::StatusCode::OK);
+        rsp->set_status_message("OK");
+        rsp->set_content_type("application/json");
+        rsp->set_header("Cache-Control", "no-store");
+        rsp->set_body(body.dump());
+        ZBACKUP_LOG_DEBUG("Listed {} versions of {}", versions.size(), base_url);
+    }
+}
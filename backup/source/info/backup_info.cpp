@@ -35,11 +35,53 @@ namespace zbackup::info
         real_path_ = real_path;
         pack_path_ = pack_dir + fu.get_name() + pack_suffix;
         url_ = down_str + fu.get_name();
+        base_url_ = url_;
+        version_ = 1;
 
         ZBACKUP_LOG_DEBUG("Backup info created: {} -> {}", real_path, url_);
         return true;
     }
 
+    bool BackupInfo::new_backup_info(const std::string &real_path, const std::string &key, const std::string &shard)
+    {
+        if (!new_backup_info(real_path))
+        {
+            return false;
+        }
+
+        auto &container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+
+        std::string pack_dir = config->get_string("pack_dir", "./pack/");
+        std::string pack_suffix = config->get_string("packfile_suffix", ".pack");
+        pack_path_ = pack_dir + shard + pack_suffix;
+        url_ = config->get_download_prefix() + key;
+        base_url_ = url_;
+
+        ZBACKUP_LOG_DEBUG("Backup info namespaced: {} -> {}", real_path, url_);
+        return true;
+    }
+
+    std::string BackupInfo::version_url(const std::string &base_url, uint32_t version)
+    {
+        return base_url + "?version=" + std::to_string(version);
+    }
+
+    bool BackupInfo::parse_version(const std::string &text, uint32_t *version)
+    {
+        *version = 0;
+        if (text.empty())
+        {
+            return true;
+        }
+        if (text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        *version = static_cast<uint32_t>(std::stoul(text));
+        return *version > 0;
+    }
+
     std::string BackupInfo::serialize() const
     {
         nlohmann::json j;
@@ -50,6 +92,15 @@ namespace zbackup::info
         j["real_path"] = real_path_;
         j["pack_path"] = pack_path_;
         j["url"] = url_;
+        j["checksum"] = checksum_;
+        j["pack_checksum"] = pack_checksum_;
+        j["verify_time"] = verify_time_;
+        j["corrupt_flag"] = corrupt_flag_;
+        j["owner"] = owner_;
+        j["base_url"] = base_url_;
+        j["version"] = version_;
+        j["tier"] = static_cast<int>(tier_);
+        j["cold_path"] = cold_path_;
         return j.dump();
     }
 
@@ -65,6 +116,15 @@ namespace zbackup::info
             real_path_ = j.value("real_path", "");
             pack_path_ = j.value("pack_path", "");
             url_ = j.value("url", "");
+            checksum_ = j.value("checksum", "");
+            pack_checksum_ = j.value("pack_checksum", "");
+            verify_time_ = j.value("verify_time", 0);
+            corrupt_flag_ = j.value("corrupt_flag", false);
+            owner_ = j.value("owner", "");
+            base_url_ = j.value("base_url", url_);
+            version_ = j.value("version", 1u);
+            tier_ = static_cast<StorageTier>(j.value("tier", 0));
+            cold_path_ = j.value("cold_path", "");
             return true;
         }
         catch (const std::exception &e)
@@ -84,6 +144,15 @@ namespace zbackup::info
         cloned->real_path_ = real_path_;
         cloned->pack_path_ = pack_path_;
         cloned->url_ = url_;
+        cloned->checksum_ = checksum_;
+        cloned->pack_checksum_ = pack_checksum_;
+        cloned->verify_time_ = verify_time_;
+        cloned->corrupt_flag_ = corrupt_flag_;
+        cloned->owner_ = owner_;
+        cloned->base_url_ = base_url_;
+        cloned->version_ = version_;
+        cloned->tier_ = tier_;
+        cloned->cold_path_ = cold_path_;
         return cloned;
     }
 }
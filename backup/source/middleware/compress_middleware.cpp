@@ -0,0 +1,86 @@
+#include "middleware/compress_middleware.h"
+#include "compress/content_codec.h"
+#include "util/http_util.h"
+#include "log/backup_logger.h"
+
+namespace zbackup
+{
+    // 动态内容使用的brotli质量，高质量级别对实时压缩来说太慢
+    static constexpr int DYNAMIC_BROTLI_QUALITY = 4;
+
+    // after()接口拿不到请求对象；同一连接的请求在所属I/O线程上顺序处理，
+    // 因此在before()中把Accept-Encoding暂存到线程局部变量
+    static thread_local std::string tls_accept_encoding;
+
+    CompressMiddleware::CompressMiddleware(size_t min_size, int level)
+        : min_size_(min_size), level_(level)
+    {
+        ZBACKUP_LOG_DEBUG("CompressMiddleware initialized, min_size={}, level={}", min_size_, level_);
+    }
+
+    void CompressMiddleware::before(zhttp::HttpRequest &request)
+    {
+        tls_accept_encoding = request.get_header("Accept-Encoding");
+    }
+
+    void CompressMiddleware::after(zhttp::HttpResponse &response)
+    {
+        std::string accept_encoding;
+        accept_encoding.swap(tls_accept_encoding);
+        if (accept_encoding.empty())
+        {
+            return;
+        }
+
+        // 已编码（如预压缩静态资源）、部分内容、无内容的响应不处理
+        auto status = response.get_status_code();
+        if (status == zhttp::HttpResponse::StatusCode::PartialContent ||
+            status == zhttp::HttpResponse::StatusCode::NotModified ||
+            status == zhttp::HttpResponse::StatusCode::NoContent ||
+            !response.get_header("Content-Encoding").empty())
+        {
+            return;
+        }
+
+        const std::string &body = response.get_body();
+        if (body.size() < min_size_ || !is_compressible(response.get_header("Content-Type")))
+        {
+            return;
+        }
+
+        std::string encoding = util::HttpUtil::choose_encoding(accept_encoding, {"br", "gzip", "deflate"});
+        if (encoding.empty())
+        {
+            return;
+        }
+
+        std::string encoded;
+        int level = (encoding == "br") ? DYNAMIC_BROTLI_QUALITY : level_;
+        if (!ContentCodec::encode(encoding, body, &encoded, level) || encoded.size() >= body.size())
+        {
+            return;
+        }
+
+        ZBACKUP_LOG_DEBUG("Response compressed with {}: {} -> {} bytes", encoding, body.size(), encoded.size());
+
+        // 强ETag标识的是未编码的表示，编码后降级为弱ETag
+        std::string etag = response.get_header("ETag");
+        if (!etag.empty() && etag.compare(0, 2, "W/") != 0)
+        {
+            response.set_header("ETag", "W/" + etag);
+        }
+        response.set_header("Content-Encoding", encoding);
+        response.set_header("Vary", "Accept-Encoding");
+        response.set_body(encoded);
+    }
+
+    bool CompressMiddleware::is_compressible(const std::string &content_type)
+    {
+        // 二进制下载内容（application/octet-stream）通常已压缩或无压缩价值
+        return content_type.compare(0, 5, "text/") == 0 ||
+               content_type.find("application/json") == 0 ||
+               content_type.find("application/javascript") == 0 ||
+               content_type.find("application/xml") == 0 ||
+               content_type.find("image/svg+xml") == 0;
+    }
+}
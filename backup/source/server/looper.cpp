@@ -4,7 +4,9 @@
 #include "core/threadpool.h"
 #include "interfaces/config_manager_interface.h"
 #include "util/util.h"
+#include "util/checksum.h"
 #include "data/data_manager.h"
+#include "storage/blob/blob_tiers.h"
 #include "log/backup_logger.h"
 
 namespace zbackup
@@ -16,19 +18,25 @@ namespace zbackup
         ZBACKUP_LOG_INFO("BackupLooper initialized with compressor");
     }
 
-    void BackupLooper::start() const
+    void BackupLooper::start()
     {
-        core::ThreadPool::get_instance()->submit_task([this]()
+        // 监控循环常驻不退出，使用独立线程，不占用线程池中处理上传与打包步骤的工作线程
+        monitor_thread_ = std::thread([this]()
         {
             hot_monitor();
         });
         ZBACKUP_LOG_INFO("BackupLooper started monitoring for hot files");
     }
 
-    // 析构函数，停止监控循环
+    // 析构函数，停止监控循环并等待监控线程退出
     BackupLooper::~BackupLooper()
     {
         stop_ = true;
+        cancel_.cancel();
+        if (monitor_thread_.joinable())
+        {
+            monitor_thread_.join();
+        }
         ZBACKUP_LOG_INFO("BackupLooper stopped");
     }
 
@@ -51,43 +59,63 @@ namespace zbackup
         // 持续监控循环
         while (!stop_)
         {
-            // 1. 遍历备份目录，获取所有文件名
+            // 1. 遍历备份目录（包括命名空间的分片子目录），获取所有文件名
             util::FileUtil fu(back_dir);
             std::vector<std::string> arry;
-            fu.scan_directory(&arry);
+            fu.scan_directory(&arry, true);
 
             int hot_file_count = 0;
+            int deferred_count = 0;
+            auto pool = core::ThreadPool::get_instance(core::TaskLane::CPU);
             // 2. 判断是否为热点文件
             for (auto &str: arry)
             {
-                if (hot_judge(str, hot_time) == false)
+                // 跳过以'.'开头的临时文件（如未完成的上传）
+                if (util::FileUtil(str).get_name().compare(0, 1, ".") == 0)
                     continue;
 
-                hot_file_count++;
-                core::ThreadPool::get_instance()->submit_task([this, str]()
+                if (hot_judge(str, hot_time) == false || mark_inflight(str) == false)
+                    continue;
+
+                // 压缩属于后台任务，以低优先级进入线程池，不阻塞交互请求
+                // 队列已满时不等待，剩余文件留到下一轮扫描
+                if (!deal_task(str))
                 {
-                    this->deal_task(str);
-                });
+                    clear_inflight(str);
+                    deferred_count++;
+                    break;
+                }
+                hot_file_count++;
             }
 
             if (hot_file_count > 0)
             {
                 ZBACKUP_LOG_INFO("Found {} hot files to compress", hot_file_count);
             }
+            if (deferred_count > 0)
+            {
+                auto stats = pool->get_stats();
+                ZBACKUP_LOG_WARN("Task queue full (depth {}, rejected {}), deferring remaining hot files to next scan",
+                                 stats.queue_depth, stats.rejected);
+            }
 
             std::this_thread::sleep_for(std::chrono::seconds(1));
         }
     }
 
-    // 处理热点文件的压缩任务
-    void BackupLooper::deal_task(const std::string &str) const
+    // 提交热点文件的打包流水线：
+    //   Snappy压缩（CPU） ─────────┐
+    //                              ├─> 压缩包校验值、删除源文件、更新目录（IO）
+    //   补算源文件校验值（IO，可选）┘
+    // 压缩与读取源文件校验值并行执行；返回true后由流水线结束时清除inflight标记
+    bool BackupLooper::deal_task(const std::string &str) const
     {
         auto& container = core::ServiceContainer::get_instance();
         auto data_manager = container.resolve<interfaces::IDataManager>();
         
         if (!data_manager) {
             ZBACKUP_LOG_ERROR("DataManager not available for task processing");
-            return;
+            return false;
         }
 
         // 3. 获取文件信息
@@ -99,20 +127,98 @@ namespace zbackup
         }
 
         // 4. 对热点文件进行压缩
-        if (!comp_->compress(str, bi.pack_path_))
+        auto token = cancel_.child();
+        auto compressed = core::spawn(core::TaskLane::CPU, core::TaskPriority::LOW,
+                                      [this, str, pack_path = bi.pack_path_]()
+                                      {
+                                          // 压缩包与源文件使用相同的分片子目录
+                                          util::FileUtil(util::fs::path(pack_path).parent_path().string())
+                                              .create_directory();
+                                          return comp_->compress(str, pack_path);
+                                      }, token);
+        if (compressed.status() == core::TaskStatus::REJECTED)
+        {
+            return false;
+        }
+
+        // 没有上传校验值的文件（如直接放入备份目录），与压缩并行补算原始文件校验值
+        core::TaskFuture<std::string> source_sum;
+        if (bi.checksum_.empty())
+        {
+            source_sum = core::spawn(core::TaskLane::IO, core::TaskPriority::LOW, [str]()
+            {
+                std::string checksum;
+                if (!util::ChecksumUtil::file_crc32c(str, &checksum))
+                {
+                    ZBACKUP_LOG_WARN("Failed to compute checksum for hot file: {}", str);
+                }
+                return checksum;
+            }, token);
+        }
+
+        auto branches = source_sum.valid() ? core::when_all(compressed, source_sum) : core::when_all(compressed);
+        auto packed = branches.then(core::TaskLane::IO, core::TaskPriority::LOW,
+                                    [this, str, bi, compressed, source_sum]()
+                                    {
+                                        if (!compressed.get())
+                                        {
+                                            ZBACKUP_LOG_ERROR("Failed to compress hot file: {}", str);
+                                            return;
+                                        }
+                                        info::BackupInfo packed_info = bi;
+                                        if (source_sum.valid())
+                                        {
+                                            packed_info.checksum_ = source_sum.get();
+                                        }
+                                        finish_pack(str, std::move(packed_info));
+                                    });
+        packed.finally([this, str](core::TaskStatus status)
         {
-            ZBACKUP_LOG_ERROR("Failed to compress hot file: {}", str);
+            if (status == core::TaskStatus::CANCELLED)
+            {
+                ZBACKUP_LOG_INFO("Packing cancelled for hot file: {}", str);
+            }
+            else if (status != core::TaskStatus::SUCCEEDED)
+            {
+                ZBACKUP_LOG_WARN("Packing pipeline aborted for hot file: {}", str);
+            }
+            clear_inflight(str);
+        });
+        return true;
+    }
+
+    void BackupLooper::finish_pack(const std::string &str, info::BackupInfo bi) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        if (!data_manager) {
+            ZBACKUP_LOG_ERROR("DataManager not available for task processing");
+            return;
+        }
+
+        // 记录压缩包校验值，供后台校验器检测压缩包损坏
+        if (!util::ChecksumUtil::file_crc32c(bi.pack_path_, &bi.pack_checksum_))
+        {
+            ZBACKUP_LOG_WARN("Failed to compute checksum for pack file: {}", bi.pack_path_);
+        }
+
+        // 5. 压缩包存入热层（远程存储时上传），失败则保留源文件，下一轮重新打包
+        auto tiers = container.resolve<storage::BlobTiers>();
+        if (!tiers || !tiers->store_pack(bi))
+        {
+            ZBACKUP_LOG_ERROR("Failed to store pack file: {}", bi.pack_path_);
+            util::FileUtil(bi.pack_path_).remove_file();
             return;
         }
 
         util::FileUtil tmp(str);
-        // 5. 删除源文件
+        // 6. 删除源文件
         if (!tmp.remove_file())
         {
             ZBACKUP_LOG_ERROR("Failed to remove source file after compression: {}", str);
             // 如果删除源文件失败，也删除压缩文件
-            util::FileUtil pack_tmp(bi.pack_path_);
-            pack_tmp.remove_file();
+            tiers->remove_pack(bi);
             return;
         }
 
@@ -126,6 +232,18 @@ namespace zbackup
         ZBACKUP_LOG_INFO("Hot file compressed successfully: {}", str);
     }
 
+    bool BackupLooper::mark_inflight(const std::string &str) const
+    {
+        std::lock_guard<std::mutex> lock(inflight_mtx_);
+        return inflight_.insert(str).second;
+    }
+
+    void BackupLooper::clear_inflight(const std::string &str) const
+    {
+        std::lock_guard<std::mutex> lock(inflight_mtx_);
+        inflight_.erase(str);
+    }
+
     // 判断文件是否为热点文件（长时间未访问）
     bool BackupLooper::hot_judge(const std::string &filename, const int hot_time)
     {
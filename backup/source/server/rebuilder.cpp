@@ -0,0 +1,149 @@
+#include "server/rebuilder.h"
+#include "core/service_container.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "storage/blob/erasure_blob_store.h"
+#include "log/backup_logger.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace zbackup
+{
+    // 停止标志的检查间隔
+    static constexpr int REBUILD_CHECK_PERIOD_SEC = 1;
+
+    BackupRebuilder::BackupRebuilder()
+        : stop_(false), limiter_(0)
+    {
+        ZBACKUP_LOG_INFO("BackupRebuilder initialized");
+    }
+
+    BackupRebuilder::~BackupRebuilder()
+    {
+        stop_ = true;
+        if (rebuild_thread_.joinable())
+        {
+            rebuild_thread_.join();
+        }
+        ZBACKUP_LOG_INFO("BackupRebuilder stopped");
+    }
+
+    void BackupRebuilder::start()
+    {
+        // 重建循环常驻不退出，使用独立线程，不占用IO线程池
+        rebuild_thread_ = std::thread([this]()
+        {
+            rebuild_loop();
+        });
+        ZBACKUP_LOG_INFO("BackupRebuilder started");
+    }
+
+    void BackupRebuilder::rebuild_loop() const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+
+        if (!config) {
+            ZBACKUP_LOG_FATAL("ConfigManager not available for BackupRebuilder");
+            return;
+        }
+
+        auto tiers = container.resolve<storage::BlobTiers>();
+        if (!tiers || (!std::dynamic_pointer_cast<storage::ErasureBlobStore>(tiers->hot()) &&
+                       !std::dynamic_pointer_cast<storage::ErasureBlobStore>(tiers->cold())))
+        {
+            ZBACKUP_LOG_INFO("No erasure-coded store configured, rebuilder idle");
+            return;
+        }
+
+        int interval = std::max(config->get_int("ec_rebuild_interval", 86400), 1);
+        int rate_mb = config->get_int("ec_rebuild_rate_limit_mb", 50);
+        limiter_.set_rate(static_cast<size_t>(std::max(rate_mb, 0)) * 1024 * 1024);
+        ZBACKUP_LOG_INFO("Rebuilder started, checking erasure-coded packs every {}s at {} MiB/s", interval, rate_mb);
+
+        while (!stop_)
+        {
+            rebuild_pass(tiers);
+
+            for (int i = 0; i < interval && !stop_; i += REBUILD_CHECK_PERIOD_SEC)
+            {
+                std::this_thread::sleep_for(std::chrono::seconds(REBUILD_CHECK_PERIOD_SEC));
+            }
+        }
+    }
+
+    void BackupRebuilder::rebuild_pass(const storage::BlobTiers::ptr &tiers) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        if (!data_manager) {
+            ZBACKUP_LOG_ERROR("DataManager not available for rebuilding");
+            return;
+        }
+
+        std::vector<info::BackupInfo> arry;
+        data_manager->get_all(&arry);
+
+        int healthy = 0, repaired = 0, lost = 0;
+        for (const auto &bi : arry)
+        {
+            if (stop_)
+                break;
+            if (!bi.pack_flag_)
+                continue;
+            std::string key;
+            auto store = std::dynamic_pointer_cast<storage::ErasureBlobStore>(tiers->locate(bi, &key));
+            if (!store)
+                continue;
+
+            switch (store->repair(key, [this](size_t n) { limiter_.acquire(n); }))
+            {
+            case storage::ErasureBlobStore::RepairResult::HEALTHY:
+                healthy++;
+                record_result(bi, false);
+                break;
+            case storage::ErasureBlobStore::RepairResult::REPAIRED:
+                repaired++;
+                record_result(bi, false);
+                break;
+            case storage::ErasureBlobStore::RepairResult::UNRECOVERABLE:
+            case storage::ErasureBlobStore::RepairResult::MISSING:
+                lost++;
+                record_result(bi, true);
+                break;
+            }
+        }
+
+        if (repaired + lost > 0)
+        {
+            ZBACKUP_LOG_INFO("Rebuild pass finished: {} healthy, {} repaired, {} unrecoverable", healthy, repaired,
+                             lost);
+        }
+    }
+
+    void BackupRebuilder::record_result(const info::BackupInfo &bi, bool lost) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        // 重建期间条目可能被下载解压、迁移或删除，以最新记录为准
+        info::BackupInfo latest;
+        if (!data_manager->get_one_by_url(bi.url_, &latest) || !latest.pack_flag_ || latest.tier_ != bi.tier_ ||
+            latest.pack_path_ != bi.pack_path_ || latest.corrupt_flag_ == lost)
+        {
+            return;
+        }
+        if (lost)
+        {
+            ZBACKUP_LOG_ERROR("Erasure-coded pack unrecoverable for {}", bi.url_);
+        }
+        // 只写校验结果两列，重新读取之后发生的迁移或解压不会被旧记录覆盖
+        if (!data_manager->update_verify(bi.url_, lost, time(nullptr)))
+        {
+            ZBACKUP_LOG_WARN("Failed to record rebuild result for {}", bi.url_);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+#include "server/retention.h"
+#include "core/service_container.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "data/snapshot_manager.h"
+#include "storage/blob/blob_tiers.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <unordered_map>
+
+namespace zbackup
+{
+    // 停止标志的检查间隔
+    static constexpr int RETENTION_CHECK_PERIOD_SEC = 1;
+
+    BackupRetention::BackupRetention()
+        : stop_(false)
+    {
+        ZBACKUP_LOG_INFO("BackupRetention initialized");
+    }
+
+    BackupRetention::~BackupRetention()
+    {
+        stop_ = true;
+        if (retention_thread_.joinable())
+        {
+            retention_thread_.join();
+        }
+        ZBACKUP_LOG_INFO("BackupRetention stopped");
+    }
+
+    void BackupRetention::start()
+    {
+        // 清理循环常驻不退出，使用独立线程，不占用IO线程池
+        retention_thread_ = std::thread([this]()
+        {
+            retention_loop();
+        });
+        ZBACKUP_LOG_INFO("BackupRetention started");
+    }
+
+    std::vector<bool> BackupRetention::select_keep(const std::vector<info::BackupInfo> &versions,
+                                                   const RetentionPolicy &policy)
+    {
+        std::vector<bool> keep(versions.size(), !policy.enabled());
+        if (versions.empty() || !policy.enabled())
+        {
+            return keep;
+        }
+        keep.back() = true;
+
+        // 每种周期：从新到旧，遇到一个新的周期且名额未用完时保留该周期内最新的版本
+        struct Bucket
+        {
+            const char *format;
+            int limit;
+            std::string last;
+            int used = 0;
+        };
+        Bucket buckets[] = {
+            {"%Y-%m-%d", policy.keep_daily, {}},
+            {"%G-W%V", policy.keep_weekly, {}},
+            {"%Y-%m", policy.keep_monthly, {}},
+        };
+
+        int last_kept = 0;
+        for (size_t i = versions.size(); i-- > 0;)
+        {
+            if (last_kept < policy.keep_last)
+            {
+                keep[i] = true;
+                last_kept++;
+            }
+
+            time_t mtime = versions[i].mtime_;
+            struct tm local{};
+            localtime_r(&mtime, &local);
+            for (auto &bucket : buckets)
+            {
+                if (bucket.used >= bucket.limit)
+                    continue;
+                char period[32];
+                strftime(period, sizeof(period), bucket.format, &local);
+                if (bucket.used > 0 && bucket.last == period)
+                    continue;
+                bucket.last = period;
+                bucket.used++;
+                keep[i] = true;
+            }
+        }
+        return keep;
+    }
+
+    void BackupRetention::retention_loop() const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+
+        if (!config) {
+            ZBACKUP_LOG_FATAL("ConfigManager not available for BackupRetention");
+            return;
+        }
+
+        RetentionPolicy policy;
+        policy.keep_last = std::max(config->get_int("retention_keep_last", 0), 0);
+        policy.keep_daily = std::max(config->get_int("retention_keep_daily", 0), 0);
+        policy.keep_weekly = std::max(config->get_int("retention_keep_weekly", 0), 0);
+        policy.keep_monthly = std::max(config->get_int("retention_keep_monthly", 0), 0);
+        int interval = std::max(config->get_int("retention_interval", 3600), 1);
+        size_t batch_size = static_cast<size_t>(std::max(config->get_int("retention_batch_size", 100), 1));
+
+        if (!policy.enabled())
+        {
+            ZBACKUP_LOG_INFO("Retention policy keeps all versions, pruning disabled");
+            return;
+        }
+        ZBACKUP_LOG_INFO("Retention started every {}s: keep last {}, daily {}, weekly {}, monthly {}", interval,
+                         policy.keep_last, policy.keep_daily, policy.keep_weekly, policy.keep_monthly);
+
+        while (!stop_)
+        {
+            retention_pass(policy, batch_size);
+
+            for (int i = 0; i < interval && !stop_; i += RETENTION_CHECK_PERIOD_SEC)
+            {
+                std::this_thread::sleep_for(std::chrono::seconds(RETENTION_CHECK_PERIOD_SEC));
+            }
+        }
+    }
+
+    void BackupRetention::retention_pass(const RetentionPolicy &policy, size_t batch_size) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+        auto snapshots = container.resolve<SnapshotManager>();
+
+        if (!data_manager || !snapshots) {
+            ZBACKUP_LOG_ERROR("DataManager not available for retention");
+            return;
+        }
+
+        std::vector<info::BackupInfo> arry;
+        data_manager->get_all(&arry);
+
+        // 按文件分组，只有多个版本的文件需要判断
+        std::unordered_map<std::string, std::vector<info::BackupInfo> > files;
+        for (auto &bi : arry)
+        {
+            files[bi.base_url_].push_back(std::move(bi));
+        }
+
+        std::vector<info::BackupInfo> batch;
+        size_t pruned = 0;
+        for (auto &[base_url, versions] : files)
+        {
+            if (stop_)
+                break;
+            if (versions.size() < 2)
+                continue;
+
+            std::sort(versions.begin(), versions.end(), [](const info::BackupInfo &a, const info::BackupInfo &b) {
+                return a.version_ < b.version_;
+            });
+            auto keep = select_keep(versions, policy);
+            for (size_t i = 0; i < versions.size(); i++)
+            {
+                // 快照引用的版本不受保留策略影响
+                if (keep[i] || snapshots->is_referenced(versions[i].url_))
+                    continue;
+                batch.push_back(std::move(versions[i]));
+                if (batch.size() >= batch_size)
+                {
+                    pruned += batch.size();
+                    prune_batch(&batch);
+                }
+            }
+        }
+        if (!batch.empty())
+        {
+            pruned += batch.size();
+            prune_batch(&batch);
+        }
+
+        if (pruned > 0)
+        {
+            ZBACKUP_LOG_INFO("Retention pass finished: {} files, {} versions pruned", files.size(), pruned);
+        }
+    }
+
+    void BackupRetention::prune_batch(std::vector<info::BackupInfo> *batch) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        // 先删目录条目，下载与列表不会再看到这些版本；目录删除失败时保留文件，下一轮重试
+        if (!data_manager->delete_batch(*batch))
+        {
+            ZBACKUP_LOG_ERROR("Failed to delete {} expired versions from catalog", batch->size());
+            batch->clear();
+            return;
+        }
+        if (!data_manager->persistence())
+        {
+            ZBACKUP_LOG_ERROR("Failed to persist catalog after pruning {} versions", batch->size());
+        }
+
+        auto tiers = container.resolve<storage::BlobTiers>();
+        for (const auto &bi : *batch)
+        {
+            // 本地的压缩包可能在打包流水线结束前已写出，不论 pack_flag 都尝试删除；已打包的再从所在层删除
+            if (!util::FileUtil(bi.real_path_).remove_file() || !util::FileUtil(bi.pack_path_).remove_file() ||
+                (bi.pack_flag_ && (!tiers || !tiers->remove_pack(bi))))
+            {
+                ZBACKUP_LOG_WARN("Failed to remove data of expired version: {}", bi.url_);
+                continue;
+            }
+            ZBACKUP_LOG_DEBUG("Expired version pruned: {}", bi.url_);
+        }
+        batch->clear();
+    }
+}
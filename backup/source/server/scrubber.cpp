@@ -0,0 +1,199 @@
+#include "server/scrubber.h"
+#include "core/service_container.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "storage/blob/blob_tiers.h"
+#include "util/checksum.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <algorithm>
+
+namespace zbackup
+{
+    // 每轮之间的检查间隔，到期条目由 scrub_interval 决定
+    static constexpr int SCRUB_CHECK_PERIOD_SEC = 60;
+
+    BackupScrubber::BackupScrubber()
+        : stop_(false), limiter_(0)
+    {
+        ZBACKUP_LOG_INFO("BackupScrubber initialized");
+    }
+
+    BackupScrubber::~BackupScrubber()
+    {
+        stop_ = true;
+        if (scrub_thread_.joinable())
+        {
+            scrub_thread_.join();
+        }
+        ZBACKUP_LOG_INFO("BackupScrubber stopped");
+    }
+
+    void BackupScrubber::start()
+    {
+        // 校验循环常驻不退出，使用独立线程，不占用IO线程池
+        scrub_thread_ = std::thread([this]()
+        {
+            scrub_loop();
+        });
+        ZBACKUP_LOG_INFO("BackupScrubber started");
+    }
+
+    void BackupScrubber::scrub_loop() const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+
+        if (!config) {
+            ZBACKUP_LOG_FATAL("ConfigManager not available for BackupScrubber");
+            return;
+        }
+
+        int verify_interval = config->get_int("scrub_interval", 86400);
+        int rate_mb = config->get_int("scrub_rate_limit_mb", 20);
+        limiter_.set_rate(static_cast<size_t>(std::max(rate_mb, 0)) * 1024 * 1024);
+        lower_io_priority();
+
+        ZBACKUP_LOG_INFO("Scrubber started, re-verifying entries every {}s at {} MiB/s", verify_interval, rate_mb);
+
+        while (!stop_)
+        {
+            scrub_pass(verify_interval);
+
+            for (int i = 0; i < SCRUB_CHECK_PERIOD_SEC && !stop_; i++)
+            {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+        }
+    }
+
+    void BackupScrubber::scrub_pass(int verify_interval) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        if (!data_manager) {
+            ZBACKUP_LOG_ERROR("DataManager not available for scrubbing");
+            return;
+        }
+
+        std::vector<info::BackupInfo> arry;
+        data_manager->get_all(&arry);
+
+        time_t now = time(nullptr);
+        int verified = 0, corrupt = 0, missing = 0;
+        for (const auto &bi : arry)
+        {
+            if (stop_)
+                break;
+            if (now - bi.verify_time_ < verify_interval)
+                continue;
+
+            switch (verify_one(bi))
+            {
+            case VerifyResult::OK:
+            case VerifyResult::RECORDED:
+                verified++;
+                break;
+            case VerifyResult::CORRUPT:
+                corrupt++;
+                break;
+            case VerifyResult::MISSING:
+                missing++;
+                break;
+            case VerifyResult::CHANGED:
+            case VerifyResult::REMOTE:
+                break;
+            }
+        }
+
+        if (verified + corrupt + missing > 0)
+        {
+            ZBACKUP_LOG_INFO("Scrub pass finished: {} verified, {} corrupt, {} missing", verified, corrupt, missing);
+        }
+    }
+
+    BackupScrubber::VerifyResult BackupScrubber::verify_one(const info::BackupInfo &bi) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        // 已压缩的条目校验压缩包，否则校验原始文件
+        std::string path = bi.real_path_;
+        if (bi.pack_flag_)
+        {
+            auto tiers = container.resolve<storage::BlobTiers>();
+            std::string key;
+            auto store = tiers ? tiers->locate(bi, &key) : nullptr;
+            path = store ? store->local_path(key) : std::string();
+            if (path.empty())
+            {
+                return VerifyResult::REMOTE;
+            }
+        }
+        const std::string &expected = bi.pack_flag_ ? bi.pack_checksum_ : bi.checksum_;
+
+        std::string actual;
+        bool read_ok = util::ChecksumUtil::file_crc32c(path, &actual, [this](size_t n) {
+            limiter_.acquire(n);
+        });
+
+        // 读取期间热点压缩、下载解压或冷层迁移可能已改变条目状态，以最新记录为准
+        info::BackupInfo latest;
+        if (!data_manager->get_one_by_url(bi.url_, &latest) || latest.pack_flag_ != bi.pack_flag_ ||
+            latest.tier_ != bi.tier_ ||
+            (bi.pack_flag_ ? latest.pack_checksum_ : latest.checksum_) != expected)
+        {
+            return VerifyResult::CHANGED;
+        }
+
+        VerifyResult result;
+        if (!read_ok)
+        {
+            ZBACKUP_LOG_ERROR("Scrub failed to read {} for {}: {}", path, bi.url_, strerror(errno));
+            result = VerifyResult::MISSING;
+        }
+        else if (expected.empty())
+        {
+            // 旧数据没有校验值，以当前内容为基准记录下来
+            ZBACKUP_LOG_INFO("Scrub recorded missing checksum for {}: {}", path, actual);
+            if (!data_manager->record_checksum(bi.url_, bi.pack_flag_, actual))
+            {
+                ZBACKUP_LOG_WARN("Failed to record checksum for {}", bi.url_);
+            }
+            result = VerifyResult::RECORDED;
+        }
+        else if (expected != actual)
+        {
+            ZBACKUP_LOG_ERROR("Scrub detected corruption in {} for {}: expected {}, actual {}",
+                              path, bi.url_, expected, actual);
+            result = VerifyResult::CORRUPT;
+        }
+        else
+        {
+            result = VerifyResult::OK;
+        }
+
+        // 只写校验结果两列，重新读取之后发生的迁移、解压或改名不会被旧记录覆盖
+        bool corrupt = (result == VerifyResult::CORRUPT || result == VerifyResult::MISSING);
+        if (!data_manager->update_verify(bi.url_, corrupt, time(nullptr)))
+        {
+            ZBACKUP_LOG_WARN("Failed to record scrub result for {}", bi.url_);
+        }
+        return result;
+    }
+
+    void BackupScrubber::lower_io_priority()
+    {
+        // ioprio_set(IOPRIO_WHO_PROCESS, 当前线程, IOPRIO_CLASS_IDLE)，仅在磁盘空闲时调度校验读取
+        constexpr int IOPRIO_WHO_PROCESS = 1;
+        constexpr int IOPRIO_CLASS_IDLE = 3;
+        constexpr int IOPRIO_CLASS_SHIFT = 13;
+        if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) != 0)
+        {
+            ZBACKUP_LOG_WARN("Failed to lower scrubber I/O priority: {}", strerror(errno));
+        }
+    }
+}
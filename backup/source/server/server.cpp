@@ -1,7 +1,11 @@
 #include "server/server.h"
 #include "core/service_container.h"
 #include "middleware/auth_middleware.h"
+#include "middleware/compress_middleware.h"
 #include "core/threadpool.h"
+#include "util/cpu_affinity.h"
+#include "util/file_io.h"
+#include "util/fd_cache.h"
 #include "log/backup_logger.h"
 
 
@@ -41,6 +45,7 @@ namespace zbackup
         {
             inject_dependencies();
             resolve_dependencies();
+            configure_file_io();
             initialize_server();
             setup_routes();
             return true;
@@ -80,11 +85,122 @@ namespace zbackup
         running_ = true;
         ZBACKUP_LOG_INFO("BackupServer starting on port {}", config_manager_->get_port());
 
-        core::ThreadPool::get_instance()->start();
+        start_thread_pools();
         looper_->start();
+        if (scrubber_)
+        {
+            scrubber_->start();
+        }
+        if (retention_)
+        {
+            retention_->start();
+        }
+        if (tiering_)
+        {
+            tiering_->start();
+        }
+        if (rebuilder_)
+        {
+            rebuilder_->start();
+        }
+        bind_http_threads();
         server_->start();
     }
 
+    bool BackupServer::load_cpu_list(const std::string &key, std::vector<int> *cpus)
+    {
+        std::string spec = config_manager_->get_string(key, "");
+        if (!util::CpuAffinity::parse_cpu_list(spec, cpus))
+        {
+            ZBACKUP_LOG_WARN("Invalid CPU list for {}: \"{}\", affinity disabled", key, spec);
+            return false;
+        }
+        return !cpus->empty();
+    }
+
+    void BackupServer::bind_http_threads()
+    {
+        // 事件循环线程在server_->start()中创建并继承主线程的CPU掩码，因此在此之前绑定主线程
+        // 线程池工作线程已各自绑定，不受影响
+        std::vector<int> cpus;
+        if (!load_cpu_list("http_cpu_affinity", &cpus))
+        {
+            return;
+        }
+        if (!util::CpuAffinity::set_current_affinity(cpus))
+        {
+            ZBACKUP_LOG_WARN("Failed to bind HTTP threads to CPUs: {}", config_manager_->get_string("http_cpu_affinity"));
+            return;
+        }
+        ZBACKUP_LOG_INFO("HTTP threads bound to CPUs: {} (NUMA node {})",
+                         config_manager_->get_string("http_cpu_affinity"),
+                         util::CpuAffinity::numa_node_of_cpu(cpus.front()));
+    }
+
+    void BackupServer::start_thread_pools()
+    {
+        auto cpu_pool = core::ThreadPool::get_instance(core::TaskLane::CPU);
+        auto io_pool = core::ThreadPool::get_instance(core::TaskLane::IO);
+        auto request_pool = core::ThreadPool::get_instance(core::TaskLane::REQUEST);
+        // 线程数不大于0时使用默认值；绑核需在启动前设置
+        std::vector<int> cpus;
+        if (load_cpu_list("cpu_pool_affinity", &cpus))
+        {
+            cpu_pool->set_cpu_affinity(cpus);
+        }
+        if (load_cpu_list("io_pool_affinity", &cpus))
+        {
+            io_pool->set_cpu_affinity(cpus);
+        }
+        if (load_cpu_list("request_pool_affinity", &cpus))
+        {
+            request_pool->set_cpu_affinity(cpus);
+        }
+        int cpu_threads = config_manager_->get_int("cpu_thread_num", 0);
+        int io_threads = config_manager_->get_int("io_thread_num", 0);
+        int request_threads = config_manager_->get_int("request_thread_num", 0);
+        cpu_pool->start(cpu_threads > 0 ? cpu_threads : core::DEFAULT_THREAD_NUM);
+        io_pool->start(io_threads > 0 ? io_threads : core::DEFAULT_IO_THREAD_NUM);
+        request_pool->start(request_threads > 0 ? request_threads : core::DEFAULT_REQUEST_THREAD_NUM);
+
+        // 后台任务同时占用的CPU线程数有上限，保证交互请求总有线程可用
+        size_t background_limit = config_manager_->get_int("background_task_limit", 0);
+        if (background_limit == 0)
+        {
+            background_limit = std::max<size_t>(1, cpu_pool->get_max_count() / 2);
+        }
+        cpu_pool->set_concurrency_limit(core::TaskPriority::LOW, background_limit);
+
+        ZBACKUP_LOG_INFO("Thread pools started - CPU: {} threads (background limit {}, {} pinned CPUs), "
+                         "IO: {} threads ({} pinned CPUs), Request: {} threads ({} pinned CPUs)",
+                         cpu_pool->get_max_count(), background_limit, cpu_pool->get_cpu_affinity().size(),
+                         io_pool->get_max_count(), io_pool->get_cpu_affinity().size(),
+                         request_pool->get_max_count(), request_pool->get_cpu_affinity().size());
+    }
+
+    void BackupServer::configure_file_io()
+    {
+        // 各线程首次读写文件时按此配置创建自己的io_uring实例
+        util::FileIOOptions options;
+        options.use_io_uring = config_manager_->get_bool("io_uring_enabled", true);
+        options.queue_depth = std::max(config_manager_->get_int("io_uring_queue_depth", 32), 0);
+        options.chunk_size = static_cast<size_t>(std::max(config_manager_->get_int("io_chunk_kb", 1024), 0)) * 1024;
+        options.direct_threshold =
+            static_cast<size_t>(std::max(config_manager_->get_int("io_direct_threshold_mb", 0), 0)) << 20;
+        util::FileIO::configure(options);
+
+        // 下载文件的描述符缓存，0表示不缓存
+        int fd_cache_capacity = config_manager_->get_int("fd_cache_capacity",
+                                                         static_cast<int>(util::FdCache::DEFAULT_CAPACITY));
+        util::FdCache::get_instance().set_capacity(std::max(fd_cache_capacity, 0));
+
+        const auto &applied = util::FileIO::options();
+        ZBACKUP_LOG_INFO("File I/O backend: {} (queue depth {}, chunk {} KB, O_DIRECT threshold {} MB), "
+                         "fd cache capacity {}",
+                         util::FileIO::backend_name(), applied.queue_depth, applied.chunk_size >> 10,
+                         applied.direct_threshold >> 20, util::FdCache::get_instance().get_capacity());
+    }
+
     void BackupServer::inject_dependencies()
     {
         ZBACKUP_LOG_DEBUG("Injecting dependencies...");
@@ -111,6 +227,30 @@ namespace zbackup
         // 创建BackupLooper
         looper_ = std::make_shared<BackupLooper>(compressor_);
 
+        // 创建后台数据校验器
+        if (config_manager_->get_bool("scrub_enabled", true))
+        {
+            scrubber_ = std::make_shared<BackupScrubber>();
+        }
+
+        // 创建版本保留器
+        if (config_manager_->get_bool("retention_enabled", true))
+        {
+            retention_ = std::make_shared<BackupRetention>();
+        }
+
+        // 创建冷层迁移器
+        if (config_manager_->get_bool("tiering_enabled", false))
+        {
+            tiering_ = std::make_shared<BackupTiering>();
+        }
+
+        // 创建纠删码重建器，未配置纠删码存储时空闲退出
+        if (config_manager_->get_bool("ec_rebuild_enabled", true))
+        {
+            rebuilder_ = std::make_shared<BackupRebuilder>();
+        }
+
         ZBACKUP_LOG_INFO("BackupServer dependencies resolved, will run on {}:{}",
                          config_manager_->get_ip(), config_manager_->get_port());
     }
@@ -124,12 +264,23 @@ namespace zbackup
         builder->build_port(config_manager_->get_port());
         builder->build_name("BackupServer");
         builder->build_middleware(std::make_shared<AuthMiddleware>());
-        builder->build_thread_num(4);
+        if (config_manager_->get_bool("compress_enabled", true))
+        {
+            builder->build_middleware(std::make_shared<CompressMiddleware>(
+                config_manager_->get_int("compress_min_size", 1024),
+                config_manager_->get_int("compress_level", 6)));
+        }
+        int http_threads = config_manager_->get_int("http_thread_num", DEFAULT_HTTP_THREAD_NUM);
+        if (http_threads <= 0)
+        {
+            http_threads = DEFAULT_HTTP_THREAD_NUM;
+        }
+        builder->build_thread_num(http_threads);
         server_ = builder->build();
-        ZBACKUP_LOG_INFO("BackupServer initialized with SSL: {}, Port: {}, Name: {}",
+        ZBACKUP_LOG_INFO("BackupServer initialized with SSL: {}, Port: {}, Name: {}, HTTP threads: {}",
                          config_manager_->get_bool("use_ssl"),
                          config_manager_->get_port(),
-                         "BackupServer");
+                         "BackupServer", http_threads);
     }
 
     void BackupServer::setup_routes()
@@ -0,0 +1,179 @@
+#include "server/tiering.h"
+#include "core/service_container.h"
+#include "interfaces/config_manager_interface.h"
+#include "interfaces/data_manager_interface.h"
+#include "util/checksum.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace zbackup
+{
+    // 停止标志的检查间隔
+    static constexpr int TIERING_CHECK_PERIOD_SEC = 1;
+
+    BackupTiering::BackupTiering()
+        : stop_(false), limiter_(0)
+    {
+        ZBACKUP_LOG_INFO("BackupTiering initialized");
+    }
+
+    BackupTiering::~BackupTiering()
+    {
+        stop_ = true;
+        if (tiering_thread_.joinable())
+        {
+            tiering_thread_.join();
+        }
+        ZBACKUP_LOG_INFO("BackupTiering stopped");
+    }
+
+    void BackupTiering::start()
+    {
+        // 迁移循环常驻不退出，使用独立线程，不占用IO线程池
+        tiering_thread_ = std::thread([this]()
+        {
+            tiering_loop();
+        });
+        ZBACKUP_LOG_INFO("BackupTiering started");
+    }
+
+    void BackupTiering::tiering_loop() const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto config = container.resolve<interfaces::IConfigManager>();
+
+        if (!config) {
+            ZBACKUP_LOG_FATAL("ConfigManager not available for BackupTiering");
+            return;
+        }
+
+        auto tiers = container.resolve<storage::BlobTiers>();
+        if (!tiers || !tiers->cold())
+        {
+            ZBACKUP_LOG_ERROR("Cold storage not available, tiering disabled");
+            return;
+        }
+
+        int cold_time = std::max(config->get_int("cold_time", 2592000), 0);
+        int interval = std::max(config->get_int("tier_interval", 3600), 1);
+        int rate_mb = config->get_int("tier_rate_limit_mb", 50);
+        limiter_.set_rate(static_cast<size_t>(std::max(rate_mb, 0)) * 1024 * 1024);
+        ZBACKUP_LOG_INFO("Tiering started, moving packs idle > {}s from {} to {} store at {} MiB/s", cold_time,
+                         tiers->hot()->name(), tiers->cold()->name(), rate_mb);
+
+        while (!stop_)
+        {
+            tiering_pass(tiers, cold_time);
+
+            for (int i = 0; i < interval && !stop_; i += TIERING_CHECK_PERIOD_SEC)
+            {
+                std::this_thread::sleep_for(std::chrono::seconds(TIERING_CHECK_PERIOD_SEC));
+            }
+        }
+    }
+
+    void BackupTiering::tiering_pass(const storage::BlobTiers::ptr &tiers, int cold_time) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        if (!data_manager) {
+            ZBACKUP_LOG_ERROR("DataManager not available for tiering");
+            return;
+        }
+
+        std::vector<info::BackupInfo> arry;
+        data_manager->get_all(&arry);
+
+        // 下载会解压并删除压缩包，压缩包的写入时间即最后一次访问之后的打包时间
+        time_t now = time(nullptr);
+        int migrated = 0, failed = 0;
+        for (const auto &bi : arry)
+        {
+            if (stop_)
+                break;
+            if (!bi.pack_flag_ || bi.tier_ != info::StorageTier::HOT || bi.corrupt_flag_)
+                continue;
+            uint64_t size = 0;
+            time_t packed_time = 0;
+            if (!tiers->hot()->stat(tiers->hot_key(bi.pack_path_), &size, &packed_time) ||
+                now - packed_time < cold_time)
+                continue;
+
+            if (migrate_one(tiers, bi))
+                migrated++;
+            else
+                failed++;
+        }
+
+        if (migrated > 0 && !data_manager->persistence())
+        {
+            ZBACKUP_LOG_ERROR("Failed to persist catalog after tiering");
+        }
+        if (migrated + failed > 0)
+        {
+            ZBACKUP_LOG_INFO("Tiering pass finished: {} packs moved to cold storage, {} failed", migrated, failed);
+        }
+    }
+
+    bool BackupTiering::migrate_one(const storage::BlobTiers::ptr &tiers, const info::BackupInfo &bi) const
+    {
+        auto& container = core::ServiceContainer::get_instance();
+        auto data_manager = container.resolve<interfaces::IDataManager>();
+
+        // 冷层沿用热层中的相对路径作为键；远程热层先取回到本地临时文件
+        std::string key = tiers->hot_key(bi.pack_path_);
+        std::string source;
+        bool temporary = false;
+        if (!tiers->fetch_pack(bi, &source, &temporary))
+        {
+            return false;
+        }
+        util::Crc32c checksum;
+        bool copied = tiers->cold()->put_file(key, source, [this, &checksum](const char *data, size_t len)
+        {
+            limiter_.acquire(len);
+            checksum.update(data, len);
+        });
+        if (temporary)
+        {
+            util::FileUtil(source).remove_file();
+        }
+        if (!copied)
+        {
+            ZBACKUP_LOG_ERROR("Failed to copy pack to {} cold store: {}", tiers->cold()->name(), key);
+            return false;
+        }
+        std::string crc = checksum.hex();
+
+        // 复制内容与打包时记录的校验值不一致时不迁移，留给校验器处理
+        if (!bi.pack_checksum_.empty() && crc != bi.pack_checksum_)
+        {
+            ZBACKUP_LOG_ERROR("Pack checksum mismatch while tiering {}: expected {}, actual {}", bi.url_,
+                              bi.pack_checksum_, crc);
+            tiers->cold()->remove(key);
+            return false;
+        }
+
+        // 复制期间条目可能被下载解压或删除：仅当条目仍指向热层中的同一压缩包时登记为冷层，
+        // 否则删除冷层副本，不留下无人引用的对象
+        if (!data_manager->mark_cold(bi.url_, bi.pack_path_, key, crc))
+        {
+            ZBACKUP_LOG_DEBUG("Entry changed during tiering, skipped: {}", bi.url_);
+            tiers->cold()->remove(key);
+            return false;
+        }
+
+        // 目录已指向冷层，热层的压缩包可以删除
+        if (!tiers->hot()->remove(tiers->hot_key(bi.pack_path_)))
+        {
+            ZBACKUP_LOG_WARN("Failed to remove hot pack after tiering: {}", bi.pack_path_);
+        }
+        ZBACKUP_LOG_DEBUG("Pack moved to cold storage: {} -> {}", bi.pack_path_, key);
+        return true;
+    }
+}
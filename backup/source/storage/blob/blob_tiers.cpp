@@ -0,0 +1,85 @@
+#include "storage/blob/blob_tiers.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <atomic>
+
+namespace zbackup::storage
+{
+    BlobTiers::BlobTiers(std::string pack_dir, interfaces::IBlobStore::ptr hot, interfaces::IBlobStore::ptr cold)
+        : pack_dir_(std::move(pack_dir)), hot_(std::move(hot)), cold_(std::move(cold))
+    {
+        if (!pack_dir_.empty() && pack_dir_.back() != '/')
+        {
+            pack_dir_ += '/';
+        }
+    }
+
+    std::string BlobTiers::hot_key(const std::string &pack_path) const
+    {
+        if (pack_path.compare(0, pack_dir_.size(), pack_dir_) == 0)
+        {
+            return pack_path.substr(pack_dir_.size());
+        }
+        return util::fs::path(pack_path).filename().string();
+    }
+
+    interfaces::IBlobStore::ptr BlobTiers::locate(const info::BackupInfo &info, std::string *key) const
+    {
+        if (info.tier_ == info::StorageTier::COLD)
+        {
+            *key = info.cold_path_;
+            return cold_;
+        }
+        *key = hot_key(info.pack_path_);
+        return hot_;
+    }
+
+    bool BlobTiers::store_pack(const info::BackupInfo &info) const
+    {
+        std::string key = hot_key(info.pack_path_);
+        if (!hot_->put_file(key, info.pack_path_))
+        {
+            ZBACKUP_LOG_ERROR("Failed to store pack in {} store: {}", hot_->name(), key);
+            return false;
+        }
+        if (hot_->local_path(key) != info.pack_path_ && !util::FileUtil(info.pack_path_).remove_file())
+        {
+            ZBACKUP_LOG_WARN("Failed to remove local pack after upload: {}", info.pack_path_);
+        }
+        return true;
+    }
+
+    bool BlobTiers::fetch_pack(const info::BackupInfo &info, std::string *local, bool *temporary) const
+    {
+        std::string key;
+        auto store = locate(info, &key);
+        if (!store)
+        {
+            ZBACKUP_LOG_ERROR("Storage tier of pack not configured: {}", info.url_);
+            return false;
+        }
+        *local = store->local_path(key);
+        *temporary = local->empty();
+        if (!*temporary)
+        {
+            return true;
+        }
+
+        // 同一压缩包可能被并发读取，每次使用独立的临时文件
+        static std::atomic<uint64_t> sequence{0};
+        *local = info.pack_path_ + ".fetch" + std::to_string(sequence++);
+        if (!store->get_file(key, *local))
+        {
+            ZBACKUP_LOG_ERROR("Failed to fetch pack from {} store: {}", store->name(), key);
+            return false;
+        }
+        return true;
+    }
+
+    bool BlobTiers::remove_pack(const info::BackupInfo &info) const
+    {
+        std::string key;
+        auto store = locate(info, &key);
+        return store && store->remove(key);
+    }
+}
@@ -0,0 +1,656 @@
+#include "storage/blob/erasure_blob_store.h"
+#include "util/checksum.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+namespace zbackup::storage
+{
+    // 分片文件头部
+    static constexpr size_t EC_HEADER_SIZE = 32;
+    static constexpr char EC_MAGIC[4] = {'Z', 'B', 'E', 'C'};
+    static constexpr uint8_t EC_VERSION = 1;
+    // 顺序读取时提前预读的条带数，各磁盘上的分片同时预读
+    static constexpr uint64_t EC_PREFETCH_STRIPES = 4;
+
+    namespace
+    {
+        void put_le32(uint8_t *p, uint32_t v)
+        {
+            for (int i = 0; i < 4; i++)
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+
+        void put_le64(uint8_t *p, uint64_t v)
+        {
+            for (int i = 0; i < 8; i++)
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+
+        uint32_t get_le32(const uint8_t *p)
+        {
+            uint32_t v = 0;
+            for (int i = 3; i >= 0; i--)
+                v = (v << 8) | p[i];
+            return v;
+        }
+
+        uint64_t get_le64(const uint8_t *p)
+        {
+            uint64_t v = 0;
+            for (int i = 7; i >= 0; i--)
+                v = (v << 8) | p[i];
+            return v;
+        }
+
+        bool read_full(int fd, void *data, size_t len)
+        {
+            auto p = static_cast<char *>(data);
+            while (len > 0)
+            {
+                ssize_t n = ::read(fd, p, len);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                p += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        bool write_full(int fd, const void *data, size_t len)
+        {
+            auto p = static_cast<const char *>(data);
+            while (len > 0)
+            {
+                ssize_t n = ::write(fd, p, len);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                p += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        // 以临时文件写出一组分片，全部落盘后才改名，失败时删除已写的临时文件
+        class ShardWriter
+        {
+        public:
+            ~ShardWriter()
+            {
+                for (size_t i = 0; i < fds_.size(); i++)
+                {
+                    if (fds_[i] >= 0)
+                        ::close(fds_[i]);
+                    if (!committed_)
+                        ::unlink(temps_[i].c_str());
+                }
+            }
+
+            bool open(const std::string &path)
+            {
+                std::string parent = util::fs::path(path).parent_path().string();
+                if (!parent.empty() && !util::FileUtil(parent).create_directory())
+                {
+                    ZBACKUP_LOG_ERROR("Failed to create shard directory for {}", path);
+                    return false;
+                }
+                paths_.push_back(path);
+                temps_.push_back(path + ".tmp");
+                fds_.push_back(::open(temps_.back().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+                if (fds_.back() < 0)
+                {
+                    ZBACKUP_LOG_ERROR("Failed to create shard {}: {}", temps_.back(), strerror(errno));
+                    return false;
+                }
+                return true;
+            }
+
+            // 写出一块并立即发起回写，各磁盘的写盘同时进行，不等到 fsync 才集中刷盘
+            bool write(size_t i, const uint8_t *data, size_t len, off_t offset)
+            {
+                if (!write_full(fds_[i], data, len))
+                {
+                    ZBACKUP_LOG_ERROR("Failed to write shard {}: {}", temps_[i], strerror(errno));
+                    return false;
+                }
+                sync_file_range(fds_[i], offset, static_cast<off_t>(len), SYNC_FILE_RANGE_WRITE);
+                return true;
+            }
+
+            bool commit()
+            {
+                for (size_t i = 0; i < fds_.size(); i++)
+                {
+                    if (::fsync(fds_[i]) != 0)
+                    {
+                        ZBACKUP_LOG_ERROR("Failed to sync shard {}: {}", temps_[i], strerror(errno));
+                        return false;
+                    }
+                }
+                for (size_t i = 0; i < fds_.size(); i++)
+                {
+                    if (::rename(temps_[i].c_str(), paths_[i].c_str()) != 0)
+                    {
+                        ZBACKUP_LOG_ERROR("Failed to rename shard {}: {}", temps_[i], strerror(errno));
+                        return false;
+                    }
+                }
+                committed_ = true;
+                return true;
+            }
+
+        private:
+            std::vector<std::string> paths_;
+            std::vector<std::string> temps_;
+            std::vector<int> fds_;
+            bool committed_ = false;
+        };
+    }
+
+    // 一次读取中打开的全部分片与一个条带的缓冲区
+    struct ErasureBlobStore::ShardSet
+    {
+        std::vector<int> fds;          // -1 表示分片缺失或头部无效
+        uint64_t size = 0;             // 对象大小
+        uint64_t generation = 0;       // 写入代号
+        uint64_t stripes = 0;          // 条带数
+        std::vector<uint8_t> buffer;   // k+m 个块，第 i 块位于 i * chunk_size
+        std::vector<uint8_t *> blocks;
+        std::vector<bool> present;     // 本条带中各块是否可用（读取或解码得到）
+        uint64_t degraded = 0;         // 需要解码的条带数
+        std::function<void(size_t)> on_read;
+
+        ~ShardSet()
+        {
+            for (int fd : fds)
+            {
+                if (fd >= 0)
+                    ::close(fd);
+            }
+        }
+    };
+
+    ErasureBlobStore::ErasureBlobStore(std::vector<std::string> dirs, ErasureOptions options)
+        : dirs_(std::move(dirs)), options_(options), codec_(options.data_shards, options.parity_shards)
+    {
+        if (dirs_.empty() || options_.chunk_size == 0)
+        {
+            throw std::invalid_argument("erasure store needs at least one directory and a non-zero chunk size");
+        }
+        for (auto &dir : dirs_)
+        {
+            if (dir.back() != '/')
+                dir += '/';
+        }
+        if (static_cast<int>(dirs_.size()) < codec_.total_shards())
+        {
+            ZBACKUP_LOG_WARN("Erasure store has {} directories for {} shards, a single disk failure may lose "
+                             "more than one shard", dirs_.size(), codec_.total_shards());
+        }
+        ZBACKUP_LOG_INFO("Erasure store: RS({}+{}) over {} directories, {} KiB blocks, GF kernel {}",
+                         codec_.data_shards(), codec_.parity_shards(), dirs_.size(), options_.chunk_size >> 10,
+                         util::gf256::best_kernel().name);
+    }
+
+    std::string ErasureBlobStore::shard_path(const std::string &key, int index) const
+    {
+        uint32_t start = util::Crc32c::compute(key.data(), key.size());
+        return dirs_[(start + static_cast<uint32_t>(index)) % dirs_.size()] + key + ".ec" + std::to_string(index);
+    }
+
+    void ErasureBlobStore::make_header(int index, uint64_t size, uint64_t generation, uint8_t *out) const
+    {
+        memset(out, 0, EC_HEADER_SIZE);
+        memcpy(out, EC_MAGIC, sizeof(EC_MAGIC));
+        out[4] = EC_VERSION;
+        out[5] = static_cast<uint8_t>(codec_.data_shards());
+        out[6] = static_cast<uint8_t>(codec_.parity_shards());
+        out[7] = static_cast<uint8_t>(index);
+        put_le32(out + 8, static_cast<uint32_t>(options_.chunk_size));
+        put_le64(out + 12, size);
+        put_le64(out + 20, generation);
+        put_le32(out + 28, util::Crc32c::compute(reinterpret_cast<const char *>(out), 28));
+    }
+
+    bool ErasureBlobStore::open_shards(const std::string &key, ShardSet *set) const
+    {
+        int n = codec_.total_shards();
+        set->fds.assign(n, -1);
+        std::vector<uint64_t> generations(n), sizes(n);
+        std::map<uint64_t, int> votes;
+        for (int i = 0; i < n; i++)
+        {
+            int fd = ::open(shard_path(key, i).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                continue;
+            uint8_t header[EC_HEADER_SIZE];
+            uint8_t expected[EC_HEADER_SIZE];
+            bool valid = ::pread(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+            if (valid)
+            {
+                sizes[i] = get_le64(header + 12);
+                generations[i] = get_le64(header + 20);
+                make_header(i, sizes[i], generations[i], expected);
+                valid = memcmp(header, expected, sizeof(header)) == 0;
+            }
+            if (!valid)
+            {
+                ZBACKUP_LOG_WARN("Invalid erasure shard header: {}", shard_path(key, i));
+                ::close(fd);
+                continue;
+            }
+            set->fds[i] = fd;
+            votes[generations[i]]++;
+        }
+        if (votes.empty())
+        {
+            return false;
+        }
+
+        // 写入中断或重写时可能残留旧分片，以多数分片的写入代号为准
+        auto winner = std::max_element(votes.begin(), votes.end(),
+                                       [](const auto &a, const auto &b) { return a.second < b.second; });
+        for (int i = 0; i < n; i++)
+        {
+            if (set->fds[i] >= 0 && generations[i] != winner->first)
+            {
+                ::close(set->fds[i]);
+                set->fds[i] = -1;
+            }
+            else if (set->fds[i] >= 0)
+            {
+                set->size = sizes[i];
+                posix_fadvise(set->fds[i], 0, 0, POSIX_FADV_SEQUENTIAL);
+            }
+        }
+        set->generation = winner->first;
+        uint64_t stripe_bytes = static_cast<uint64_t>(codec_.data_shards()) * options_.chunk_size;
+        set->stripes = (set->size + stripe_bytes - 1) / stripe_bytes;
+        set->buffer.assign(static_cast<size_t>(n) * options_.chunk_size, 0);
+        set->blocks.resize(n);
+        for (int i = 0; i < n; i++)
+        {
+            set->blocks[i] = set->buffer.data() + static_cast<size_t>(i) * options_.chunk_size;
+        }
+        return true;
+    }
+
+    bool ErasureBlobStore::read_block(ShardSet *set, int index, uint64_t stripe, uint8_t *out) const
+    {
+        int fd = set->fds[index];
+        if (fd < 0)
+        {
+            return false;
+        }
+        uint8_t crc[4];
+        struct iovec iov[2] = {{crc, sizeof(crc)}, {out, options_.chunk_size}};
+        auto offset = static_cast<off_t>(EC_HEADER_SIZE + stripe * (sizeof(crc) + options_.chunk_size));
+        ssize_t n = ::preadv(fd, iov, 2, offset);
+        if (set->on_read)
+        {
+            set->on_read(sizeof(crc) + options_.chunk_size);
+        }
+        return n == static_cast<ssize_t>(sizeof(crc) + options_.chunk_size) &&
+               get_le32(crc) == util::Crc32c::compute(reinterpret_cast<const char *>(out), options_.chunk_size);
+    }
+
+    bool ErasureBlobStore::read_stripe(ShardSet *set, uint64_t stripe, int first, int last) const
+    {
+        int n = codec_.total_shards();
+        set->present.assign(n, false);
+        bool complete = true;
+        for (int i = first; i <= last; i++)
+        {
+            set->present[i] = read_block(set, i, stripe, set->blocks[i]);
+            complete = complete && set->present[i];
+        }
+        if (complete)
+        {
+            return true;
+        }
+
+        // 降级读：读取其余分片直到凑够 k 个可用块，再解码出缺失的数据块
+        int count = static_cast<int>(std::count(set->present.begin(), set->present.end(), true));
+        for (int i = 0; i < n && count < codec_.data_shards(); i++)
+        {
+            if (i >= first && i <= last)
+                continue;
+            if (read_block(set, i, stripe, set->blocks[i]))
+            {
+                set->present[i] = true;
+                count++;
+            }
+        }
+        if (count < codec_.data_shards())
+        {
+            return false;
+        }
+        set->degraded++;
+        std::unique_ptr<bool[]> present(new bool[n]);
+        std::copy(set->present.begin(), set->present.end(), present.get());
+        return codec_.reconstruct(set->blocks.data(), present.get(), options_.chunk_size);
+    }
+
+    bool ErasureBlobStore::put_file(const std::string &key, const std::string &local_path, const ChunkCallback &on_chunk)
+    {
+        int in = ::open(local_path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st{};
+        if (in < 0 || ::fstat(in, &st) != 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to open file for erasure coding: {}: {}", local_path, strerror(errno));
+            if (in >= 0)
+                ::close(in);
+            return false;
+        }
+        posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        int k = codec_.data_shards();
+        int n = codec_.total_shards();
+        auto size = static_cast<uint64_t>(st.st_size);
+        std::random_device rd;
+        uint64_t generation = (static_cast<uint64_t>(rd()) << 32) ^ rd() ^ static_cast<uint64_t>(time(nullptr));
+
+        bool ok = true;
+        ShardWriter writer;
+        uint8_t header[EC_HEADER_SIZE];
+        for (int i = 0; ok && i < n; i++)
+        {
+            make_header(i, size, generation, header);
+            ok = writer.open(shard_path(key, i)) && writer.write(i, header, sizeof(header), 0);
+        }
+
+        // 每个条带读入 k 个连续的数据块，计算校验块后各分片写一块
+        size_t chunk = options_.chunk_size;
+        uint64_t stripe_bytes = static_cast<uint64_t>(k) * chunk;
+        std::vector<uint8_t> buffer(static_cast<size_t>(n) * chunk);
+        std::vector<uint8_t *> blocks(n);
+        for (int i = 0; i < n; i++)
+        {
+            blocks[i] = buffer.data() + static_cast<size_t>(i) * chunk;
+        }
+        for (uint64_t offset = 0; ok && offset < size; offset += stripe_bytes)
+        {
+            auto want = static_cast<size_t>(std::min(stripe_bytes, size - offset));
+            if (!read_full(in, buffer.data(), want))
+            {
+                ZBACKUP_LOG_ERROR("Failed to read file for erasure coding: {}", local_path);
+                ok = false;
+                break;
+            }
+            if (on_chunk)
+            {
+                on_chunk(reinterpret_cast<const char *>(buffer.data()), want);
+            }
+            memset(buffer.data() + want, 0, stripe_bytes - want);
+            codec_.encode(blocks.data(), blocks.data() + k, chunk);
+
+            auto block_offset = static_cast<off_t>(EC_HEADER_SIZE + offset / stripe_bytes * (sizeof(uint32_t) + chunk));
+            for (int i = 0; ok && i < n; i++)
+            {
+                uint8_t crc[4];
+                put_le32(crc, util::Crc32c::compute(reinterpret_cast<const char *>(blocks[i]), chunk));
+                ok = writer.write(i, crc, sizeof(crc), block_offset) &&
+                     writer.write(i, blocks[i], chunk, block_offset + static_cast<off_t>(sizeof(crc)));
+            }
+        }
+        posix_fadvise(in, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(in);
+        return ok && writer.commit();
+    }
+
+    bool ErasureBlobStore::get_file(const std::string &key, const std::string &local_path)
+    {
+        ShardSet set;
+        if (!open_shards(key, &set))
+        {
+            ZBACKUP_LOG_ERROR("Erasure-coded object not found: {}", key);
+            return false;
+        }
+        std::string parent = util::fs::path(local_path).parent_path().string();
+        if (!parent.empty() && !util::FileUtil(parent).create_directory())
+        {
+            ZBACKUP_LOG_ERROR("Failed to create directory for {}", local_path);
+            return false;
+        }
+        std::string temp_path = local_path + ".tmp";
+        int out = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (out < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to create file for erasure decoding: {}: {}", temp_path, strerror(errno));
+            return false;
+        }
+
+        int k = codec_.data_shards();
+        size_t chunk = options_.chunk_size;
+        uint64_t stripe_bytes = static_cast<uint64_t>(k) * chunk;
+        auto block_span = static_cast<off_t>(sizeof(uint32_t) + chunk);
+        bool ok = true;
+        for (uint64_t stripe = 0; ok && stripe < set.stripes; stripe++)
+        {
+            // 每个条带开始时让各磁盘预读后面的条带，读取在各磁盘上并行进行
+            if (stripe % EC_PREFETCH_STRIPES == 0)
+            {
+                for (int i = 0; i < k; i++)
+                {
+                    if (set.fds[i] >= 0)
+                        posix_fadvise(set.fds[i], static_cast<off_t>(EC_HEADER_SIZE) + static_cast<off_t>(stripe) * block_span,
+                                      block_span * static_cast<off_t>(EC_PREFETCH_STRIPES), POSIX_FADV_WILLNEED);
+                }
+            }
+            auto want = static_cast<size_t>(std::min(stripe_bytes, set.size - stripe * stripe_bytes));
+            if (!read_stripe(&set, stripe, 0, static_cast<int>((want - 1) / chunk)))
+            {
+                ZBACKUP_LOG_ERROR("Erasure-coded object unrecoverable at stripe {}: {}", stripe, key);
+                ok = false;
+                break;
+            }
+            // 数据块在缓冲区中连续存放
+            ok = write_full(out, set.buffer.data(), want);
+        }
+        ok = ok && ::fsync(out) == 0;
+        ::close(out);
+        if (set.degraded > 0)
+        {
+            ZBACKUP_LOG_WARN("Degraded read of {}: {} of {} stripes decoded from parity", key, set.degraded,
+                             set.stripes);
+        }
+
+        if (!ok || ::rename(temp_path.c_str(), local_path.c_str()) != 0)
+        {
+            ::unlink(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool ErasureBlobStore::read_range(const std::string &key, uint64_t offset, size_t len, char *data)
+    {
+        ShardSet set;
+        if (!open_shards(key, &set))
+        {
+            ZBACKUP_LOG_ERROR("Erasure-coded object not found: {}", key);
+            return false;
+        }
+        if (offset > set.size || len > set.size - offset)
+        {
+            return false;
+        }
+
+        size_t chunk = options_.chunk_size;
+        uint64_t stripe_bytes = static_cast<uint64_t>(codec_.data_shards()) * chunk;
+        size_t done = 0;
+        while (done < len)
+        {
+            uint64_t pos = offset + done;
+            uint64_t stripe = pos / stripe_bytes;
+            auto begin = static_cast<size_t>(pos % stripe_bytes);
+            auto n = static_cast<size_t>(std::min<uint64_t>(len - done, stripe_bytes - begin));
+            // 只读取范围覆盖的数据块
+            if (!read_stripe(&set, stripe, static_cast<int>(begin / chunk), static_cast<int>((begin + n - 1) / chunk)))
+            {
+                ZBACKUP_LOG_ERROR("Erasure-coded object unrecoverable at stripe {}: {}", stripe, key);
+                return false;
+            }
+            memcpy(data + done, set.buffer.data() + begin, n);
+            done += n;
+        }
+        if (set.degraded > 0)
+        {
+            ZBACKUP_LOG_WARN("Degraded read of {}: {} stripes decoded from parity", key, set.degraded);
+        }
+        return true;
+    }
+
+    bool ErasureBlobStore::stat(const std::string &key, uint64_t *size, time_t *mtime)
+    {
+        ShardSet set;
+        if (!open_shards(key, &set))
+        {
+            return false;
+        }
+        *size = set.size;
+        if (mtime)
+        {
+            auto fd = std::find_if(set.fds.begin(), set.fds.end(), [](int f) { return f >= 0; });
+            struct stat st{};
+            *mtime = ::fstat(*fd, &st) == 0 ? st.st_mtime : time(nullptr);
+        }
+        return true;
+    }
+
+    bool ErasureBlobStore::remove(const std::string &key)
+    {
+        bool ok = true;
+        for (int i = 0; i < codec_.total_shards(); i++)
+        {
+            std::string path = shard_path(key, i);
+            if (::unlink(path.c_str()) != 0 && errno != ENOENT)
+            {
+                ZBACKUP_LOG_ERROR("Failed to remove shard {}: {}", path, strerror(errno));
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    ErasureBlobStore::RepairResult ErasureBlobStore::repair(const std::string &key,
+                                                            const std::function<void(size_t)> &on_read)
+    {
+        ShardSet set;
+        set.on_read = on_read;
+        if (!open_shards(key, &set))
+        {
+            return RepairResult::MISSING;
+        }
+
+        // 第一遍：读取全部块，找出缺失或有损坏块的分片
+        int k = codec_.data_shards();
+        int n = codec_.total_shards();
+        std::vector<bool> bad(n);
+        for (int i = 0; i < n; i++)
+        {
+            bad[i] = set.fds[i] < 0;
+        }
+        for (uint64_t stripe = 0; stripe < set.stripes; stripe++)
+        {
+            int good = 0;
+            for (int i = 0; i < n; i++)
+            {
+                if (read_block(&set, i, stripe, set.blocks[i]))
+                    good++;
+                else
+                    bad[i] = true;
+            }
+            if (good < k)
+            {
+                ZBACKUP_LOG_ERROR("Erasure-coded object unrecoverable at stripe {}: {} ({} of {} blocks readable)",
+                                  stripe, key, good, n);
+                return RepairResult::UNRECOVERABLE;
+            }
+        }
+        if (std::find(bad.begin(), bad.end(), true) == bad.end())
+        {
+            return RepairResult::HEALTHY;
+        }
+
+        // 第二遍：逐条带用完好的分片解码，重写损坏的分片
+        ShardWriter writer;
+        std::vector<int> targets;
+        uint8_t header[EC_HEADER_SIZE];
+        for (int i = 0; i < n; i++)
+        {
+            if (!bad[i])
+                continue;
+            make_header(i, set.size, set.generation, header);
+            if (!writer.open(shard_path(key, i)) || !writer.write(targets.size(), header, sizeof(header), 0))
+            {
+                return RepairResult::UNRECOVERABLE;
+            }
+            targets.push_back(i);
+        }
+        std::unique_ptr<bool[]> present(new bool[n]);
+        auto block_span = static_cast<off_t>(sizeof(uint32_t) + options_.chunk_size);
+        for (uint64_t stripe = 0; stripe < set.stripes; stripe++)
+        {
+            int count = 0;
+            for (int i = 0; i < n; i++)
+            {
+                present[i] = !bad[i] && read_block(&set, i, stripe, set.blocks[i]);
+                count += present[i] ? 1 : 0;
+            }
+            // 完好的分片在两遍之间又出错时，用损坏分片中本条带仍可读的块补足
+            for (int i = 0; i < n && count < k; i++)
+            {
+                if (bad[i] && read_block(&set, i, stripe, set.blocks[i]))
+                {
+                    present[i] = true;
+                    count++;
+                }
+            }
+            if (!codec_.reconstruct(set.blocks.data(), present.get(), options_.chunk_size, true))
+            {
+                ZBACKUP_LOG_ERROR("Erasure-coded object unrecoverable at stripe {}: {}", stripe, key);
+                return RepairResult::UNRECOVERABLE;
+            }
+            off_t offset = static_cast<off_t>(EC_HEADER_SIZE) + static_cast<off_t>(stripe) * block_span;
+            for (size_t t = 0; t < targets.size(); t++)
+            {
+                const uint8_t *block = set.blocks[targets[t]];
+                uint8_t crc[4];
+                put_le32(crc, util::Crc32c::compute(reinterpret_cast<const char *>(block), options_.chunk_size));
+                if (!writer.write(t, crc, sizeof(crc), offset) ||
+                    !writer.write(t, block, options_.chunk_size, offset + static_cast<off_t>(sizeof(crc))))
+                {
+                    return RepairResult::UNRECOVERABLE;
+                }
+            }
+        }
+
+        // 重建期间对象可能被删除或重写，此时放弃重建结果
+        ShardSet latest;
+        if (!open_shards(key, &latest) || latest.generation != set.generation)
+        {
+            ZBACKUP_LOG_DEBUG("Erasure-coded object changed during repair, skipped: {}", key);
+            return RepairResult::HEALTHY;
+        }
+        if (!writer.commit())
+        {
+            return RepairResult::UNRECOVERABLE;
+        }
+        ZBACKUP_LOG_INFO("Rebuilt {} shards of {}", targets.size(), key);
+        return RepairResult::REPAIRED;
+    }
+}
@@ -0,0 +1,141 @@
+#include "storage/blob/local_blob_store.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+namespace zbackup::storage
+{
+    // 复制时每次读写的长度
+    static constexpr size_t BLOB_COPY_CHUNK = 1 << 20;
+
+    LocalBlobStore::LocalBlobStore(std::string root)
+        : root_(std::move(root))
+    {
+        if (!root_.empty() && root_.back() != '/')
+        {
+            root_ += '/';
+        }
+    }
+
+    bool LocalBlobStore::put_file(const std::string &key, const std::string &local_path,
+                                  const ChunkCallback &on_chunk)
+    {
+        std::string path = root_ + key;
+        if (path == local_path && !on_chunk)
+        {
+            // 文件已在存储位置（压缩包直接写在 pack_dir 中）
+            return util::FileUtil(path).exists();
+        }
+        return copy_file(local_path, path, on_chunk);
+    }
+
+    bool LocalBlobStore::get_file(const std::string &key, const std::string &local_path)
+    {
+        return copy_file(root_ + key, local_path);
+    }
+
+    bool LocalBlobStore::read_range(const std::string &key, uint64_t offset, size_t len, char *data)
+    {
+        return util::FileUtil(root_ + key).get_pos_len(data, offset, len);
+    }
+
+    bool LocalBlobStore::stat(const std::string &key, uint64_t *size, time_t *mtime)
+    {
+        util::FileUtil file(root_ + key);
+        if (!file.exists())
+        {
+            return false;
+        }
+        *size = static_cast<uint64_t>(std::max<int64_t>(file.get_size(), 0));
+        if (mtime)
+        {
+            *mtime = file.get_last_mtime();
+        }
+        return true;
+    }
+
+    bool LocalBlobStore::remove(const std::string &key)
+    {
+        util::FileUtil file(root_ + key);
+        return !file.exists() || file.remove_file();
+    }
+
+    std::string LocalBlobStore::local_path(const std::string &key) const
+    {
+        return root_ + key;
+    }
+
+    bool LocalBlobStore::copy_file(const std::string &src, const std::string &dst, const ChunkCallback &on_chunk)
+    {
+        std::string parent = util::fs::path(dst).parent_path().string();
+        if (!parent.empty() && !util::FileUtil(parent).create_directory())
+        {
+            ZBACKUP_LOG_ERROR("Failed to create blob directory for {}", dst);
+            return false;
+        }
+
+        int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to open blob source: {}: {}", src, strerror(errno));
+            return false;
+        }
+        std::string temp_path = dst + ".tmp";
+        int out = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (out < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to create blob: {}: {}", temp_path, strerror(errno));
+            ::close(in);
+            return false;
+        }
+
+        // 顺序读取，读过的页不留在页缓存中挤占热数据
+        posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+        std::vector<char> buffer(BLOB_COPY_CHUNK);
+        bool ok = true;
+        off_t offset = 0;
+        while (ok)
+        {
+            ssize_t n = ::read(in, buffer.data(), buffer.size());
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                ok = (n == 0);
+                break;
+            }
+            if (on_chunk)
+            {
+                on_chunk(buffer.data(), static_cast<size_t>(n));
+            }
+            for (ssize_t written = 0; ok && written < n;)
+            {
+                ssize_t w = ::write(out, buffer.data() + written, static_cast<size_t>(n - written));
+                if (w < 0 && errno == EINTR)
+                    continue;
+                ok = (w > 0);
+                written += std::max<ssize_t>(w, 0);
+            }
+            posix_fadvise(in, offset, n, POSIX_FADV_DONTNEED);
+            offset += n;
+        }
+        ok = ok && ::fsync(out) == 0;
+        if (!ok)
+        {
+            ZBACKUP_LOG_ERROR("Failed to copy blob: {} -> {}: {}", src, temp_path, strerror(errno));
+        }
+        ::close(in);
+        ::close(out);
+
+        if (!ok || ::rename(temp_path.c_str(), dst.c_str()) != 0)
+        {
+            ::unlink(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,850 @@
+#include "storage/blob/s3_blob_store.h"
+#include "util/checksum.h"
+#include "util/util.h"
+#include "log/backup_logger.h"
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/ssl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <strings.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+namespace zbackup::storage
+{
+    // 单次接收的最大长度
+    static constexpr size_t S3_RECV_CHUNK = 64 * 1024;
+    // 响应头部的最大长度
+    static constexpr size_t S3_MAX_HEADER_SIZE = 64 * 1024;
+    // 非流式响应正文（错误信息、分段上传的XML）的最大长度
+    static constexpr size_t S3_MAX_BODY_SIZE = 1 << 20;
+    // S3 分段上传的分段数上限
+    static constexpr uint64_t S3_MAX_PARTS = 10000;
+
+    namespace
+    {
+        std::string hmac_sha256(const std::string &key, const std::string &data)
+        {
+            unsigned char out[EVP_MAX_MD_SIZE];
+            unsigned int len = 0;
+            HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+                 reinterpret_cast<const unsigned char *>(data.data()), data.size(), out, &len);
+            return std::string(reinterpret_cast<char *>(out), len);
+        }
+
+        std::string sha256_hex(const char *data, size_t len)
+        {
+            util::Sha256 sha;
+            sha.update(data, len);
+            return sha.hex_digest();
+        }
+
+        bool read_full(int fd, char *data, size_t len)
+        {
+            while (len > 0)
+            {
+                ssize_t n = ::read(fd, data, len);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                data += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        bool pwrite_full(int fd, const char *data, size_t len, uint64_t offset)
+        {
+            while (len > 0)
+            {
+                ssize_t n = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                data += n;
+                len -= static_cast<size_t>(n);
+                offset += static_cast<uint64_t>(n);
+            }
+            return true;
+        }
+    }
+
+    // 一个保持的HTTP/1.1连接，https 时在套接字上建立TLS
+    struct S3BlobStore::Connection
+    {
+        int fd = -1;
+        SSL *ssl = nullptr;
+        std::string inbuf; // 已接收未处理的数据
+
+        ~Connection()
+        {
+            if (ssl)
+                SSL_free(ssl);
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        bool send_all(const char *data, size_t len)
+        {
+            while (len > 0)
+            {
+                ssize_t n;
+                if (ssl)
+                {
+                    n = SSL_write(ssl, data, static_cast<int>(std::min<size_t>(len, INT32_MAX)));
+                }
+                else
+                {
+                    n = ::send(fd, data, len, MSG_NOSIGNAL);
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                }
+                if (n <= 0)
+                    return false;
+                data += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        // 再接收一批数据追加到 inbuf，对端关闭或出错返回false
+        bool fill()
+        {
+            char buffer[S3_RECV_CHUNK];
+            while (true)
+            {
+                ssize_t n;
+                if (ssl)
+                {
+                    n = SSL_read(ssl, buffer, sizeof(buffer));
+                }
+                else
+                {
+                    n = ::recv(fd, buffer, sizeof(buffer), 0);
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                }
+                if (n <= 0)
+                    return false;
+                inbuf.append(buffer, static_cast<size_t>(n));
+                return true;
+            }
+        }
+    };
+
+    S3BlobStore::S3BlobStore(S3Options options)
+        : options_(std::move(options))
+    {
+        std::string authority = options_.endpoint;
+        if (authority.compare(0, 8, "https://") == 0)
+        {
+            tls_ = true;
+            authority.erase(0, 8);
+        }
+        else if (authority.compare(0, 7, "http://") == 0)
+        {
+            authority.erase(0, 7);
+        }
+        authority = authority.substr(0, authority.find('/'));
+        host_header_ = authority;
+
+        // host[:port]，IPv6 地址写在方括号内
+        size_t colon = authority.rfind(':');
+        size_t bracket = authority.rfind(']');
+        if (colon != std::string::npos && (bracket == std::string::npos || colon > bracket))
+        {
+            host_ = authority.substr(0, colon);
+            port_ = authority.substr(colon + 1);
+        }
+        else
+        {
+            host_ = authority;
+            port_ = tls_ ? "443" : "80";
+        }
+        if (host_.size() >= 2 && host_.front() == '[' && host_.back() == ']')
+        {
+            host_ = host_.substr(1, host_.size() - 2);
+        }
+        options_.part_size = std::max<size_t>(options_.part_size, 5 << 20);
+
+        if (tls_)
+        {
+            ssl_ctx_ = SSL_CTX_new(TLS_client_method());
+            if (ssl_ctx_)
+            {
+                SSL_CTX_set_default_verify_paths(ssl_ctx_);
+                SSL_CTX_set_verify(ssl_ctx_, SSL_VERIFY_PEER, nullptr);
+            }
+            else
+            {
+                ZBACKUP_LOG_ERROR("Failed to create TLS context for S3 endpoint {}", options_.endpoint);
+            }
+        }
+        ZBACKUP_LOG_INFO("S3 blob store: {} bucket={} prefix={}", options_.endpoint, options_.bucket, options_.prefix);
+    }
+
+    S3BlobStore::~S3BlobStore()
+    {
+        idle_.clear();
+        if (ssl_ctx_)
+        {
+            SSL_CTX_free(ssl_ctx_);
+        }
+    }
+
+    bool S3BlobStore::put_file(const std::string &key, const std::string &local_path, const ChunkCallback &on_chunk)
+    {
+        int fd = ::open(local_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to open file for S3 upload: {}: {}", local_path, strerror(errno));
+            return false;
+        }
+        struct stat st{};
+        bool ok = ::fstat(fd, &st) == 0;
+        if (ok)
+        {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            auto size = static_cast<uint64_t>(st.st_size);
+            ok = size <= options_.part_size ? put_single(key, fd, size, on_chunk)
+                                            : put_multipart(key, fd, size, on_chunk);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    bool S3BlobStore::put_single(const std::string &key, int fd, size_t size, const ChunkCallback &on_chunk)
+    {
+        std::string data(size, '\0');
+        if (!read_full(fd, data.data(), size))
+        {
+            ZBACKUP_LOG_ERROR("Failed to read file for S3 upload: {}", key);
+            return false;
+        }
+        if (on_chunk && size > 0)
+        {
+            on_chunk(data.data(), size);
+        }
+
+        Request req;
+        req.method = "PUT";
+        req.key = key;
+        req.storage_class = options_.storage_class;
+        req.body = data.data();
+        req.body_len = size;
+        Response rsp;
+        if (!execute(req, &rsp) || rsp.status != 200)
+        {
+            log_failure("PUT", key, rsp);
+            return false;
+        }
+        return true;
+    }
+
+    bool S3BlobStore::put_multipart(const std::string &key, int fd, uint64_t size, const ChunkCallback &on_chunk)
+    {
+        Request init;
+        init.method = "POST";
+        init.key = key;
+        init.query = {{"uploads", ""}};
+        init.storage_class = options_.storage_class;
+        Response rsp;
+        std::string upload_id;
+        if (!execute(init, &rsp) || rsp.status != 200 || (upload_id = xml_value(rsp.body, "UploadId")).empty())
+        {
+            log_failure("CreateMultipartUpload", key, rsp);
+            return false;
+        }
+
+        // 分段数不能超过上限，超大文件自动放大分段
+        size_t part_size = static_cast<size_t>(std::max<uint64_t>(options_.part_size, (size + S3_MAX_PARTS - 1) / S3_MAX_PARTS));
+        std::string buffer(part_size, '\0');
+        std::string complete = "<CompleteMultipartUpload>";
+        uint64_t offset = 0;
+        for (int part = 1; offset < size; part++)
+        {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(part_size, size - offset));
+            if (!read_full(fd, buffer.data(), n))
+            {
+                ZBACKUP_LOG_ERROR("Failed to read file for S3 upload: {}", key);
+                abort_multipart(key, upload_id);
+                return false;
+            }
+            if (on_chunk)
+            {
+                on_chunk(buffer.data(), n);
+            }
+
+            Request req;
+            req.method = "PUT";
+            req.key = key;
+            req.query = {{"partNumber", std::to_string(part)}, {"uploadId", upload_id}};
+            req.body = buffer.data();
+            req.body_len = n;
+            auto etag = rsp.headers.end();
+            if (!execute(req, &rsp) || rsp.status != 200 || (etag = rsp.headers.find("etag")) == rsp.headers.end())
+            {
+                log_failure("UploadPart", key, rsp);
+                abort_multipart(key, upload_id);
+                return false;
+            }
+            complete += "<Part><PartNumber>" + std::to_string(part) + "</PartNumber><ETag>" + etag->second +
+                        "</ETag></Part>";
+            offset += n;
+        }
+        complete += "</CompleteMultipartUpload>";
+
+        // 合并请求即使返回200也可能在正文中报告错误
+        Request done;
+        done.method = "POST";
+        done.key = key;
+        done.query = {{"uploadId", upload_id}};
+        done.body = complete.data();
+        done.body_len = complete.size();
+        if (!execute(done, &rsp) || rsp.status != 200 || rsp.body.find("<Error>") != std::string::npos)
+        {
+            log_failure("CompleteMultipartUpload", key, rsp);
+            abort_multipart(key, upload_id);
+            return false;
+        }
+        return true;
+    }
+
+    void S3BlobStore::abort_multipart(const std::string &key, const std::string &upload_id)
+    {
+        Request req;
+        req.method = "DELETE";
+        req.key = key;
+        req.query = {{"uploadId", upload_id}};
+        Response rsp;
+        if (!execute(req, &rsp) || (rsp.status != 204 && rsp.status != 200 && rsp.status != 404))
+        {
+            log_failure("AbortMultipartUpload", key, rsp);
+        }
+    }
+
+    bool S3BlobStore::get_file(const std::string &key, const std::string &local_path)
+    {
+        uint64_t size = 0;
+        if (!stat(key, &size, nullptr))
+        {
+            ZBACKUP_LOG_ERROR("S3 object not found: {}", key);
+            return false;
+        }
+        std::string parent = util::fs::path(local_path).parent_path().string();
+        if (!parent.empty() && !util::FileUtil(parent).create_directory())
+        {
+            ZBACKUP_LOG_ERROR("Failed to create directory for {}", local_path);
+            return false;
+        }
+        std::string temp_path = local_path + ".tmp";
+        int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to create file for S3 download: {}: {}", temp_path, strerror(errno));
+            return false;
+        }
+
+        // 按块发起范围请求，单个请求失败只重传该块
+        bool ok = true;
+        for (uint64_t offset = 0; ok && offset < size; offset += options_.part_size)
+        {
+            uint64_t len = std::min<uint64_t>(options_.part_size, size - offset);
+            Request req;
+            req.method = "GET";
+            req.key = key;
+            req.headers = {{"Range", "bytes=" + std::to_string(offset) + "-" + std::to_string(offset + len - 1)}};
+            ok = false;
+            for (int attempt = 0; attempt < 2 && !ok; attempt++)
+            {
+                uint64_t received = 0;
+                req.on_body = [&](const char *data, size_t n)
+                {
+                    if (n > len - received || !pwrite_full(fd, data, n, offset + received))
+                        return false;
+                    received += n;
+                    return true;
+                };
+                Response rsp;
+                ok = execute(req, &rsp) && rsp.status == 206 && received == len;
+                if (!ok)
+                {
+                    log_failure("GET", key, rsp);
+                }
+            }
+        }
+        ok = ok && ::fsync(fd) == 0;
+        ::close(fd);
+
+        if (!ok || ::rename(temp_path.c_str(), local_path.c_str()) != 0)
+        {
+            ::unlink(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool S3BlobStore::read_range(const std::string &key, uint64_t offset, size_t len, char *data)
+    {
+        if (len == 0)
+        {
+            return true;
+        }
+        size_t received = 0;
+        Request req;
+        req.method = "GET";
+        req.key = key;
+        req.headers = {{"Range", "bytes=" + std::to_string(offset) + "-" + std::to_string(offset + len - 1)}};
+        req.on_body = [&](const char *chunk, size_t n)
+        {
+            if (n > len - received)
+                return false;
+            memcpy(data + received, chunk, n);
+            received += n;
+            return true;
+        };
+        Response rsp;
+        if (!execute(req, &rsp) || rsp.status != 206 || received != len)
+        {
+            log_failure("GET", key, rsp);
+            return false;
+        }
+        return true;
+    }
+
+    bool S3BlobStore::stat(const std::string &key, uint64_t *size, time_t *mtime)
+    {
+        Request req;
+        req.method = "HEAD";
+        req.key = key;
+        Response rsp;
+        if (!execute(req, &rsp))
+        {
+            log_failure("HEAD", key, rsp);
+            return false;
+        }
+        if (rsp.status == 404)
+        {
+            return false;
+        }
+        auto length = rsp.headers.find("content-length");
+        if (rsp.status != 200 || length == rsp.headers.end())
+        {
+            log_failure("HEAD", key, rsp);
+            return false;
+        }
+        *size = std::strtoull(length->second.c_str(), nullptr, 10);
+        if (mtime)
+        {
+            // Last-Modified 为 RFC 7231 日期，对象写入完成的时间
+            struct tm tm_utc{};
+            auto modified = rsp.headers.find("last-modified");
+            bool parsed = modified != rsp.headers.end() &&
+                          strptime(modified->second.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm_utc) != nullptr;
+            *mtime = parsed ? timegm(&tm_utc) : time(nullptr);
+        }
+        return true;
+    }
+
+    bool S3BlobStore::remove(const std::string &key)
+    {
+        Request req;
+        req.method = "DELETE";
+        req.key = key;
+        Response rsp;
+        if (!execute(req, &rsp) || (rsp.status != 204 && rsp.status != 200 && rsp.status != 404))
+        {
+            log_failure("DELETE", key, rsp);
+            return false;
+        }
+        return true;
+    }
+
+    bool S3BlobStore::execute(const Request &req, Response *rsp)
+    {
+        std::string head = build_head(req);
+        for (int attempt = 0; attempt < 2; attempt++)
+        {
+            auto conn = acquire();
+            bool reused = conn != nullptr;
+            if (!conn && !(conn = connect()))
+            {
+                return false;
+            }
+            *rsp = Response();
+            bool reusable = false;
+            if (round_trip(conn.get(), head, req, rsp, &reusable))
+            {
+                if (reusable)
+                {
+                    release(std::move(conn));
+                }
+                return true;
+            }
+            // 空闲连接可能已被服务端关闭：尚未收到响应时换新连接重试一次
+            if (!reused || rsp->status != 0)
+            {
+                break;
+            }
+        }
+        ZBACKUP_LOG_WARN("S3 {} request failed for {}: connection error", req.method, req.key);
+        return false;
+    }
+
+    bool S3BlobStore::round_trip(Connection *conn, const std::string &head, const Request &req, Response *rsp,
+                                 bool *reusable)
+    {
+        if (!conn->send_all(head.data(), head.size()) || (req.body_len > 0 && !conn->send_all(req.body, req.body_len)))
+        {
+            return false;
+        }
+
+        // 状态行与头部
+        size_t header_end;
+        while ((header_end = conn->inbuf.find("\r\n\r\n")) == std::string::npos)
+        {
+            if (conn->inbuf.size() > S3_MAX_HEADER_SIZE || !conn->fill())
+                return false;
+        }
+        std::string_view block(conn->inbuf.data(), header_end);
+        size_t eol = block.find("\r\n");
+        std::string_view status_line = block.substr(0, eol);
+        if (status_line.size() < 12 || status_line.compare(0, 5, "HTTP/") != 0)
+        {
+            return false;
+        }
+        rsp->status = std::atoi(std::string(status_line.substr(9, 3)).c_str());
+        bool keep_alive = status_line.compare(0, 8, "HTTP/1.1") == 0;
+        while (eol != std::string_view::npos && eol < block.size())
+        {
+            size_t start = eol + 2;
+            eol = block.find("\r\n", start);
+            std::string_view line = block.substr(start, eol == std::string_view::npos ? std::string_view::npos : eol - start);
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos)
+                continue;
+            std::string name(line.substr(0, colon));
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+            std::string_view value = line.substr(colon + 1);
+            size_t begin = value.find_first_not_of(" \t");
+            size_t end = value.find_last_not_of(" \t");
+            rsp->headers[name] = begin == std::string_view::npos ? "" : std::string(value.substr(begin, end - begin + 1));
+        }
+        conn->inbuf.erase(0, header_end + 4);
+        auto connection = rsp->headers.find("connection");
+        if (connection != rsp->headers.end() && strcasecmp(connection->second.c_str(), "close") == 0)
+        {
+            keep_alive = false;
+        }
+
+        // 2xx 响应交给调用方的回调，其余保存下来用于错误信息
+        bool stream = req.on_body && rsp->status >= 200 && rsp->status < 300;
+        auto deliver = [&](const char *data, size_t len)
+        {
+            if (stream)
+                return req.on_body(data, len);
+            if (rsp->body.size() + len > S3_MAX_BODY_SIZE)
+                return false;
+            rsp->body.append(data, len);
+            return true;
+        };
+        // 从连接中读取恰好 len 字节正文
+        auto read_body = [&](uint64_t len)
+        {
+            while (len > 0)
+            {
+                if (conn->inbuf.empty() && !conn->fill())
+                    return false;
+                size_t n = static_cast<size_t>(std::min<uint64_t>(len, conn->inbuf.size()));
+                if (!deliver(conn->inbuf.data(), n))
+                    return false;
+                conn->inbuf.erase(0, n);
+                len -= n;
+            }
+            return true;
+        };
+
+        if (req.method == "HEAD" || rsp->status == 204 || rsp->status == 304 || rsp->status / 100 == 1)
+        {
+            *reusable = keep_alive;
+            return true;
+        }
+        auto encoding = rsp->headers.find("transfer-encoding");
+        if (encoding != rsp->headers.end() && strcasecmp(encoding->second.c_str(), "chunked") == 0)
+        {
+            while (true)
+            {
+                size_t line_end;
+                while ((line_end = conn->inbuf.find("\r\n")) == std::string::npos)
+                {
+                    if (conn->inbuf.size() > S3_MAX_HEADER_SIZE || !conn->fill())
+                        return false;
+                }
+                uint64_t chunk = std::strtoull(conn->inbuf.c_str(), nullptr, 16);
+                conn->inbuf.erase(0, line_end + 2);
+                if (chunk == 0)
+                {
+                    // 跳过尾部头部，直到空行
+                    while ((line_end = conn->inbuf.find("\r\n")) != 0)
+                    {
+                        if (line_end != std::string::npos)
+                            conn->inbuf.erase(0, line_end + 2);
+                        else if (conn->inbuf.size() > S3_MAX_HEADER_SIZE || !conn->fill())
+                            return false;
+                    }
+                    conn->inbuf.erase(0, 2);
+                    break;
+                }
+                if (!read_body(chunk))
+                    return false;
+                while (conn->inbuf.size() < 2)
+                {
+                    if (!conn->fill())
+                        return false;
+                }
+                conn->inbuf.erase(0, 2);
+            }
+        }
+        else
+        {
+            auto length = rsp->headers.find("content-length");
+            if (length != rsp->headers.end())
+            {
+                if (!read_body(std::strtoull(length->second.c_str(), nullptr, 10)))
+                    return false;
+            }
+            else
+            {
+                // 没有长度信息：读到连接关闭为止
+                while (conn->fill())
+                {
+                    if (!deliver(conn->inbuf.data(), conn->inbuf.size()))
+                        return false;
+                    conn->inbuf.clear();
+                }
+                keep_alive = false;
+            }
+        }
+        *reusable = keep_alive && conn->inbuf.empty();
+        return true;
+    }
+
+    std::string S3BlobStore::build_head(const Request &req) const
+    {
+        std::string path = object_path(req.key);
+        std::string query = canonical_query(req.query);
+
+        char amz_date[20];
+        time_t now = time(nullptr);
+        struct tm tm_utc{};
+        gmtime_r(&now, &tm_utc);
+        strftime(amz_date, sizeof(amz_date), "%Y%m%dT%H%M%SZ", &tm_utc);
+        std::string date(amz_date, 8);
+        std::string payload_hash = sha256_hex(req.body ? req.body : "", req.body_len);
+
+        // SigV4：规范请求 -> 待签字符串 -> 派生密钥签名
+        std::string canonical_headers = "host:" + host_header_ + "\n" +
+                                        "x-amz-content-sha256:" + payload_hash + "\n" +
+                                        "x-amz-date:" + amz_date + "\n";
+        std::string signed_headers = "host;x-amz-content-sha256;x-amz-date";
+        if (!req.storage_class.empty())
+        {
+            canonical_headers += "x-amz-storage-class:" + req.storage_class + "\n";
+            signed_headers += ";x-amz-storage-class";
+        }
+        std::string canonical = req.method + "\n" + path + "\n" + query + "\n" + canonical_headers + "\n" +
+                                signed_headers + "\n" + payload_hash;
+        std::string scope = date + "/" + options_.region + "/s3/aws4_request";
+        std::string string_to_sign = "AWS4-HMAC-SHA256\n" + std::string(amz_date) + "\n" + scope + "\n" +
+                                     sha256_hex(canonical.data(), canonical.size());
+        std::string key = hmac_sha256("AWS4" + options_.secret_key, date);
+        key = hmac_sha256(key, options_.region);
+        key = hmac_sha256(key, "s3");
+        key = hmac_sha256(key, "aws4_request");
+        std::string signature = hmac_sha256(key, string_to_sign);
+
+        std::string head = req.method + " " + path + (query.empty() ? "" : "?" + query) + " HTTP/1.1\r\n";
+        head += "Host: " + host_header_ + "\r\n";
+        head += "x-amz-content-sha256: " + payload_hash + "\r\n";
+        head += "x-amz-date: " + std::string(amz_date) + "\r\n";
+        if (!req.storage_class.empty())
+        {
+            head += "x-amz-storage-class: " + req.storage_class + "\r\n";
+        }
+        head += "Authorization: AWS4-HMAC-SHA256 Credential=" + options_.access_key + "/" + scope +
+                ", SignedHeaders=" + signed_headers + ", Signature=" +
+                util::ChecksumUtil::to_hex(reinterpret_cast<const unsigned char *>(signature.data()), signature.size()) +
+                "\r\n";
+        if (req.body_len > 0 || req.method == "PUT" || req.method == "POST")
+        {
+            head += "Content-Length: " + std::to_string(req.body_len) + "\r\n";
+        }
+        for (const auto &[name, value] : req.headers)
+        {
+            head += name + ": " + value + "\r\n";
+        }
+        head += "\r\n";
+        return head;
+    }
+
+    std::unique_ptr<S3BlobStore::Connection> S3BlobStore::acquire()
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (idle_.empty())
+        {
+            return nullptr;
+        }
+        auto conn = std::move(idle_.back());
+        idle_.pop_back();
+        return conn;
+    }
+
+    void S3BlobStore::release(std::unique_ptr<Connection> conn)
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (idle_.size() < options_.pool_size)
+        {
+            idle_.push_back(std::move(conn));
+        }
+    }
+
+    std::unique_ptr<S3BlobStore::Connection> S3BlobStore::connect()
+    {
+        struct addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo *result = nullptr;
+        int rc = getaddrinfo(host_.c_str(), port_.c_str(), &hints, &result);
+        if (rc != 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to resolve S3 endpoint {}: {}", host_, gai_strerror(rc));
+            return nullptr;
+        }
+
+        auto conn = std::make_unique<Connection>();
+        struct timeval timeout{};
+        timeout.tv_sec = options_.timeout_ms / 1000;
+        timeout.tv_usec = (options_.timeout_ms % 1000) * 1000;
+        for (auto *ai = result; ai != nullptr; ai = ai->ai_next)
+        {
+            int fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd < 0)
+                continue;
+            // 阻塞套接字的发送超时同样限制 connect 的等待时间
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            {
+                conn->fd = fd;
+                break;
+            }
+            ::close(fd);
+        }
+        freeaddrinfo(result);
+        if (conn->fd < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to connect to S3 endpoint {}:{}: {}", host_, port_, strerror(errno));
+            return nullptr;
+        }
+        int one = 1;
+        setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (tls_)
+        {
+            if (!ssl_ctx_ || !(conn->ssl = SSL_new(ssl_ctx_)))
+            {
+                return nullptr;
+            }
+            SSL_set_fd(conn->ssl, conn->fd);
+            SSL_set_tlsext_host_name(conn->ssl, host_.c_str());
+            SSL_set1_host(conn->ssl, host_.c_str());
+            if (SSL_connect(conn->ssl) != 1)
+            {
+                ZBACKUP_LOG_ERROR("TLS handshake with S3 endpoint {} failed", host_);
+                return nullptr;
+            }
+        }
+        return conn;
+    }
+
+    std::string S3BlobStore::object_path(const std::string &key) const
+    {
+        return "/" + uri_encode(options_.bucket, false) + "/" + uri_encode(options_.prefix + key, true);
+    }
+
+    std::string S3BlobStore::uri_encode(const std::string &str, bool keep_slash)
+    {
+        static const char HEX[] = "0123456789ABCDEF";
+        std::string out;
+        out.reserve(str.size());
+        for (unsigned char c : str)
+        {
+            if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' || (keep_slash && c == '/'))
+            {
+                out += static_cast<char>(c);
+            }
+            else
+            {
+                out += '%';
+                out += HEX[c >> 4];
+                out += HEX[c & 0x0F];
+            }
+        }
+        return out;
+    }
+
+    std::string S3BlobStore::canonical_query(const std::vector<std::pair<std::string, std::string>> &query)
+    {
+        std::vector<std::pair<std::string, std::string>> encoded;
+        encoded.reserve(query.size());
+        for (const auto &[name, value] : query)
+        {
+            encoded.emplace_back(uri_encode(name, false), uri_encode(value, false));
+        }
+        std::sort(encoded.begin(), encoded.end());
+        std::string out;
+        for (const auto &[name, value] : encoded)
+        {
+            if (!out.empty())
+                out += '&';
+            out += name + "=" + value;
+        }
+        return out;
+    }
+
+    std::string S3BlobStore::xml_value(const std::string &body, const std::string &tag)
+    {
+        std::string open = "<" + tag + ">";
+        size_t begin = body.find(open);
+        if (begin == std::string::npos)
+        {
+            return {};
+        }
+        begin += open.size();
+        size_t end = body.find("</" + tag + ">", begin);
+        return end == std::string::npos ? std::string() : body.substr(begin, end - begin);
+    }
+
+    void S3BlobStore::log_failure(const char *operation, const std::string &key, const Response &rsp)
+    {
+        if (rsp.status == 0)
+        {
+            ZBACKUP_LOG_ERROR("S3 {} failed for {}: no response", operation, key);
+            return;
+        }
+        ZBACKUP_LOG_ERROR("S3 {} failed for {}: HTTP {} {} {}", operation, key, rsp.status,
+                          xml_value(rsp.body, "Code"), xml_value(rsp.body, "Message"));
+    }
+}
@@ -1,9 +1,35 @@
 #include "storage/database/database_backup_storage.h"
 #include "log/backup_logger.h"
+#include <algorithm>
+#include <stdexcept>
 
 
 namespace zbackup::storage
 {
+    // 查询备份信息时统一使用的列顺序，与 row_to_info 对应
+    static const std::string BACKUP_COLUMNS = "url, real_path, pack_path, file_size, modify_time, pack_flag, checksum, "
+                                               "pack_checksum, verify_time, corrupt_flag, owner, base_url, version, tier, cold_path";
+
+    template <typename Row>
+    static void row_to_info(const Row &row, info::BackupInfo *info)
+    {
+        info->url_ = row[0];
+        info->real_path_ = row[1];
+        info->pack_path_ = row[2];
+        info->fsize_ = std::stoll(row[3]);
+        info->mtime_ = std::stoll(row[4]);
+        info->pack_flag_ = (row[5] == "1");
+        info->checksum_ = row[6];
+        info->pack_checksum_ = row[7];
+        info->verify_time_ = std::stoll(row[8]);
+        info->corrupt_flag_ = (row[9] == "1");
+        info->owner_ = row[10];
+        info->base_url_ = row[11];
+        info->version_ = static_cast<uint32_t>(std::stoul(row[12]));
+        info->tier_ = static_cast<info::StorageTier>(std::stoi(row[13]));
+        info->cold_path_ = row[14];
+    }
+
     DatabaseBackupStorage::DatabaseBackupStorage()
     {
         create_table_if_not_exists();
@@ -22,9 +48,11 @@ namespace zbackup::storage
 
         try
         {
-            std::string sql = "INSERT INTO backup_files (url, real_path, pack_path, file_size, modify_time, pack_flag) VALUES (?, ?, ?, ?, ?, ?)";
+            std::string sql = "INSERT INTO backup_files (" + BACKUP_COLUMNS + ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
             auto result = conn->execute_update(sql, info.url_, info.real_path_, info.pack_path_, 
-                                             info.fsize_, info.mtime_, info.pack_flag_ ? 1 : 0);
+                                             info.fsize_, info.mtime_, info.pack_flag_ ? 1 : 0, info.checksum_,
+                                             info.pack_checksum_, info.verify_time_, info.corrupt_flag_ ? 1 : 0, info.owner_,
+                                             info.base_url_, info.version_, static_cast<int>(info.tier_), info.cold_path_);
             
             if (result > 0)
             {
@@ -52,9 +80,12 @@ namespace zbackup::storage
 
         try
         {
-            std::string sql = "UPDATE backup_files SET real_path=?, pack_path=?, file_size=?, modify_time=?, pack_flag=? WHERE url=?";
+            std::string sql = "UPDATE backup_files SET real_path=?, pack_path=?, file_size=?, modify_time=?, pack_flag=?, checksum=?, "
+                              "pack_checksum=?, verify_time=?, corrupt_flag=?, owner=?, tier=?, cold_path=? WHERE url=?";
             auto result = conn->execute_update(sql, info.real_path_, info.pack_path_, 
-                                             info.fsize_, info.mtime_, info.pack_flag_ ? 1 : 0, info.url_);
+                                             info.fsize_, info.mtime_, info.pack_flag_ ? 1 : 0, info.checksum_,
+                                             info.pack_checksum_, info.verify_time_, info.corrupt_flag_ ? 1 : 0, info.owner_,
+                                             static_cast<int>(info.tier_), info.cold_path_, info.url_);
             
             if (result > 0)
             {
@@ -70,6 +101,105 @@ namespace zbackup::storage
         }
     }
 
+    bool DatabaseBackupStorage::update_verify(const std::string &url, bool corrupt_flag, time_t verify_time)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for update_verify");
+            return false;
+        }
+
+        try
+        {
+            // 校验时间每次都会变化，匹配到条目时受影响行数总是大于0
+            std::string sql = "UPDATE backup_files SET corrupt_flag=?, verify_time=? WHERE url=?";
+            return conn->execute_update(sql, corrupt_flag ? 1 : 0, verify_time, url) > 0;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Database update_verify failed: {}", e.what());
+            return false;
+        }
+    }
+
+    bool DatabaseBackupStorage::record_checksum(const std::string &url, bool pack, const std::string &checksum)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for record_checksum");
+            return false;
+        }
+
+        try
+        {
+            std::string sql = pack
+                ? "UPDATE backup_files SET pack_checksum=? WHERE url=? AND pack_flag=1 AND pack_checksum=''"
+                : "UPDATE backup_files SET checksum=? WHERE url=? AND pack_flag=0 AND checksum=''";
+            return conn->execute_update(sql, checksum, url) > 0;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Database record_checksum failed: {}", e.what());
+            return false;
+        }
+    }
+
+    bool DatabaseBackupStorage::mark_cold(const std::string &url, const std::string &pack_path,
+                                          const std::string &cold_path, const std::string &pack_checksum)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for mark_cold");
+            return false;
+        }
+
+        try
+        {
+            // 条件与修改在同一条语句中完成，并发的下载解压先生效时不匹配任何行
+            std::string sql = "UPDATE backup_files SET tier=?, cold_path=?, "
+                              "pack_checksum=IF(pack_checksum='', ?, pack_checksum) "
+                              "WHERE url=? AND pack_flag=1 AND pack_path=? AND tier=?";
+            return conn->execute_update(sql, static_cast<int>(info::StorageTier::COLD), cold_path, pack_checksum,
+                                        url, pack_path, static_cast<int>(info::StorageTier::HOT)) > 0;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Database mark_cold failed: {}", e.what());
+            return false;
+        }
+    }
+
+    bool DatabaseBackupStorage::mark_unpacked(const info::BackupInfo &expected)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for mark_unpacked");
+            return false;
+        }
+
+        try
+        {
+            std::string sql = "UPDATE backup_files SET pack_flag=0, tier=?, cold_path='' "
+                              "WHERE url=? AND pack_flag=1 AND pack_path=? AND tier=? AND cold_path=?";
+            return conn->execute_update(sql, static_cast<int>(info::StorageTier::HOT), expected.url_,
+                                        expected.pack_path_, static_cast<int>(expected.tier_),
+                                        expected.cold_path_) > 0;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Database mark_unpacked failed: {}", e.what());
+            return false;
+        }
+    }
+
     bool DatabaseBackupStorage::get_one_by_id(const std::string &id, info::BackupInfo *info)
     {
         return get_one_by_url(id, info);
@@ -87,19 +217,14 @@ namespace zbackup::storage
 
         try
         {
-            std::string sql = "SELECT url, real_path, pack_path, file_size, modify_time, pack_flag FROM backup_files";
+            std::string sql = "SELECT " + BACKUP_COLUMNS + " FROM backup_files";
             auto result = conn->execute_query(sql);
             
             arry->clear();
             for (const auto& row : result)
             {
                 info::BackupInfo info;
-                info.url_ = row[0];
-                info.real_path_ = row[1];
-                info.pack_path_ = row[2];
-                info.fsize_ = std::stoll(row[3]);
-                info.mtime_ = std::stoll(row[4]);
-                info.pack_flag_ = (row[5] == "1");
+                row_to_info(row, &info);
                 arry->push_back(info);
             }
             
@@ -149,19 +274,12 @@ namespace zbackup::storage
 
         try
         {
-            std::string sql = "SELECT url, real_path, pack_path, file_size, modify_time, pack_flag FROM backup_files WHERE url=?";
+            std::string sql = "SELECT " + BACKUP_COLUMNS + " FROM backup_files WHERE url=?";
             auto result = conn->execute_query(sql, url);
             
             if (!result.empty())
             {
-                const auto& row = result[0];
-                info->url_ = row[0];
-                info->real_path_ = row[1];
-                info->pack_path_ = row[2];
-                info->fsize_ = std::stoll(row[3]);
-                info->mtime_ = std::stoll(row[4]);
-                info->pack_flag_ = (row[5] == "1");
-                
+                row_to_info(result[0], info);
                 return true;
             }
             
@@ -186,19 +304,12 @@ namespace zbackup::storage
 
         try
         {
-            std::string sql = "SELECT url, real_path, pack_path, file_size, modify_time, pack_flag FROM backup_files WHERE real_path=?";
+            std::string sql = "SELECT " + BACKUP_COLUMNS + " FROM backup_files WHERE real_path=?";
             auto result = conn->execute_query(sql, real_path);
             
             if (!result.empty())
             {
-                const auto& row = result[0];
-                info->url_ = row[0];
-                info->real_path_ = row[1];
-                info->pack_path_ = row[2];
-                info->fsize_ = std::stoll(row[3]);
-                info->mtime_ = std::stoll(row[4]);
-                info->pack_flag_ = (row[5] == "1");
-                
+                row_to_info(result[0], info);
                 return true;
             }
             
@@ -269,6 +380,184 @@ namespace zbackup::storage
         }
     }
 
+    void DatabaseBackupStorage::get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for get_by_owner");
+            return;
+        }
+
+        try
+        {
+            std::string sql = "SELECT " + BACKUP_COLUMNS + " FROM backup_files WHERE owner=?";
+            auto result = conn->execute_query(sql, owner);
+
+            arry->clear();
+            for (const auto& row : result)
+            {
+                info::BackupInfo info;
+                row_to_info(row, &info);
+                arry->push_back(info);
+            }
+
+            ZBACKUP_LOG_DEBUG("Retrieved backup info for owner '{}' from database: {} entries", owner, arry->size());
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Database get_by_owner failed: {}", e.what());
+        }
+    }
+
+    void DatabaseBackupStorage::get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for get_versions");
+            return;
+        }
+
+        try
+        {
+            std::string sql = "SELECT " + BACKUP_COLUMNS + " FROM backup_files WHERE base_url=? ORDER BY version";
+            auto result = conn->execute_query(sql, base_url);
+
+            arry->clear();
+            for (const auto& row : result)
+            {
+                info::BackupInfo info;
+                row_to_info(row, &info);
+                arry->push_back(info);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Database get_versions failed: {}", e.what());
+        }
+    }
+
+    bool DatabaseBackupStorage::insert_versions(std::vector<info::BackupInfo> *infos)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for insert_versions");
+            return false;
+        }
+
+        // 版本号从每个路径一行的计数器分配：更新计数器行时加行锁，同一路径的并发上传依次分配版本号。
+        // 不对 backup_files 做加锁读取，尚不存在的路径不会加间隙锁，并发上传新路径时不会死锁；url 的唯一约束兜底
+        std::vector<info::BackupInfo> pending = *infos;
+        // 按路径顺序加锁，两批包含相同路径的上传不会交叉等待
+        std::vector<size_t> order(pending.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&pending](size_t a, size_t b)
+        {
+            return pending[a].base_url_ < pending[b].base_url_;
+        });
+        bool result = run_transaction(conn, "insert_versions", [&]()
+        {
+            std::string bump_sql = "INSERT INTO backup_versions (base_url, last_version) VALUES (?, 1) "
+                                   "ON DUPLICATE KEY UPDATE last_version = last_version + 1";
+            std::string counter_sql = "SELECT last_version FROM backup_versions WHERE base_url=?";
+            std::string max_sql = "SELECT COALESCE(MAX(version), 0) FROM backup_files WHERE base_url=?";
+            std::string sync_sql = "UPDATE backup_versions SET last_version=? WHERE base_url=?";
+            std::string sql = "INSERT INTO backup_files (" + BACKUP_COLUMNS + ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+            for (size_t index : order)
+            {
+                auto &info = pending[index];
+                conn->execute_update(bump_sql, info.base_url_);
+                auto counter = conn->execute_query(counter_sql, info.base_url_);
+                if (counter.empty())
+                {
+                    throw std::runtime_error("version counter missing for " + info.base_url_);
+                }
+                info.version_ = static_cast<uint32_t>(std::stoul(counter[0][0]));
+                // 计数器建立之前登记的版本：计数器行锁已串行化同一路径的分配，此处的普通读取只用于对齐旧数据
+                auto max_version = conn->execute_query(max_sql, info.base_url_);
+                auto existing = static_cast<uint32_t>(max_version.empty() ? 0 : std::stoul(max_version[0][0]));
+                if (existing >= info.version_)
+                {
+                    info.version_ = existing + 1;
+                    conn->execute_update(sync_sql, info.version_, info.base_url_);
+                }
+                info.url_ = info::BackupInfo::version_url(info.base_url_, info.version_);
+                auto inserted = conn->execute_update(sql, info.url_, info.real_path_, info.pack_path_,
+                                                     info.fsize_, info.mtime_, info.pack_flag_ ? 1 : 0, info.checksum_,
+                                                     info.pack_checksum_, info.verify_time_, info.corrupt_flag_ ? 1 : 0,
+                                                     info.owner_, info.base_url_, info.version_,
+                                                     static_cast<int>(info.tier_), info.cold_path_);
+                if (inserted <= 0)
+                {
+                    throw std::runtime_error("no row inserted for " + info.url_);
+                }
+            }
+        });
+        if (result)
+        {
+            *infos = std::move(pending);
+            ZBACKUP_LOG_DEBUG("Backup info versions inserted to database: {} entries", infos->size());
+        }
+        return result;
+    }
+
+    bool DatabaseBackupStorage::delete_batch(const std::vector<info::BackupInfo> &infos)
+    {
+        auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
+        auto conn = pool.get_connection();
+        if (!conn)
+        {
+            ZBACKUP_LOG_ERROR("Failed to get database connection for delete_batch");
+            return false;
+        }
+
+        bool result = run_transaction(conn, "delete_batch", [&]()
+        {
+            for (const auto &info : infos)
+            {
+                conn->execute_update("DELETE FROM backup_files WHERE url=?", info.url_);
+            }
+        });
+        if (result)
+        {
+            ZBACKUP_LOG_DEBUG("Backup info batch deleted from database: {} entries", infos.size());
+        }
+        return result;
+    }
+
+    template <typename Conn, typename Body>
+    bool DatabaseBackupStorage::run_transaction(Conn &conn, const char *operation, const Body &body)
+    {
+        try
+        {
+            conn->execute_update("START TRANSACTION");
+            body();
+            conn->execute_update("COMMIT");
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Database {} failed: {}", operation, e.what());
+            try
+            {
+                conn->execute_update("ROLLBACK");
+            }
+            catch (const std::exception& rollback_error)
+            {
+                ZBACKUP_LOG_ERROR("Database rollback failed: {}", rollback_error.what());
+            }
+            return false;
+        }
+    }
+
     bool DatabaseBackupStorage::create_table_if_not_exists()
     {
         auto& pool = zhttp::zdb::MysqlConnectionPool::get_instance();
@@ -284,20 +573,58 @@ namespace zbackup::storage
             std::string sql = R"(
                 CREATE TABLE IF NOT EXISTS backup_files (
                     id INT AUTO_INCREMENT PRIMARY KEY,
-                    url VARCHAR(128) NOT NULL UNIQUE,
-                    real_path VARCHAR(50) NOT NULL,
-                    pack_path VARCHAR(50) NOT NULL,
+                    url VARCHAR(768) NOT NULL UNIQUE,
+                    real_path VARCHAR(768) NOT NULL,
+                    pack_path VARCHAR(768) NOT NULL,
                     file_size BIGINT NOT NULL,
                     modify_time BIGINT NOT NULL,
                     pack_flag BOOLEAN NOT NULL DEFAULT FALSE,
+                    checksum VARCHAR(64) NOT NULL DEFAULT '',
+                    pack_checksum VARCHAR(64) NOT NULL DEFAULT '',
+                    verify_time BIGINT NOT NULL DEFAULT 0,
+                    corrupt_flag BOOLEAN NOT NULL DEFAULT FALSE,
+                    owner VARCHAR(64) NOT NULL DEFAULT '',
+                    base_url VARCHAR(768) NOT NULL DEFAULT '',
+                    version INT UNSIGNED NOT NULL DEFAULT 1,
+                    tier TINYINT UNSIGNED NOT NULL DEFAULT 0,
+                    cold_path VARCHAR(768) NOT NULL DEFAULT '',
                     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
                     updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
                     INDEX idx_url (url),
-                    INDEX idx_real_path (real_path)
+                    INDEX idx_real_path (real_path),
+                    INDEX idx_owner (owner),
+                    INDEX idx_base_url (base_url)
                 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4
             )";
             
             conn->execute_update(sql);
+
+            // 每个路径的版本号计数器，insert_versions 在此分配版本号
+            conn->execute_update(R"(
+                CREATE TABLE IF NOT EXISTS backup_versions (
+                    base_url VARCHAR(768) NOT NULL PRIMARY KEY,
+                    last_version INT UNSIGNED NOT NULL
+                ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4
+            )");
+
+            // 兼容旧版本创建的表：补齐后续新增的列
+            ensure_column(conn, "checksum", "VARCHAR(64) NOT NULL DEFAULT ''");
+            ensure_column(conn, "pack_checksum", "VARCHAR(64) NOT NULL DEFAULT ''");
+            ensure_column(conn, "verify_time", "BIGINT NOT NULL DEFAULT 0");
+            ensure_column(conn, "corrupt_flag", "BOOLEAN NOT NULL DEFAULT FALSE");
+            ensure_column(conn, "owner", "VARCHAR(64) NOT NULL DEFAULT ''");
+            ensure_index(conn, "idx_owner", "owner");
+            ensure_column(conn, "base_url", "VARCHAR(768) NOT NULL DEFAULT ''");
+            ensure_column(conn, "version", "INT UNSIGNED NOT NULL DEFAULT 1");
+            ensure_index(conn, "idx_base_url", "base_url");
+            // 版本化之前登记的条目作为其URL的版本1
+            conn->execute_update("UPDATE backup_files SET base_url=url WHERE base_url=''");
+            ensure_column(conn, "tier", "TINYINT UNSIGNED NOT NULL DEFAULT 0");
+            ensure_column(conn, "cold_path", "VARCHAR(768) NOT NULL DEFAULT ''");
+            // 命名空间路径比平铺的文件名长，旧表的路径列需要加宽
+            widen_column(conn, "url", 768);
+            widen_column(conn, "real_path", 768);
+            widen_column(conn, "pack_path", 768);
             
             ZBACKUP_LOG_INFO("Backup files table ensured in database");
             return true;
@@ -308,4 +635,75 @@ namespace zbackup::storage
             return false;
         }
     }
+
+    template <typename Conn>
+    bool DatabaseBackupStorage::ensure_index(Conn &conn, const std::string &index, const std::string &columns)
+    {
+        try
+        {
+            std::string sql = "SELECT INDEX_NAME FROM information_schema.STATISTICS "
+                              "WHERE TABLE_SCHEMA=DATABASE() AND TABLE_NAME='backup_files' AND INDEX_NAME=?";
+            if (!conn->execute_query(sql, index).empty())
+            {
+                return true;
+            }
+
+            conn->execute_update("ALTER TABLE backup_files ADD INDEX " + index + " (" + columns + ")");
+            ZBACKUP_LOG_INFO("Added index to backup_files table: {}", index);
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Failed to add index {} to backup_files table: {}", index, e.what());
+            return false;
+        }
+    }
+
+    template <typename Conn>
+    bool DatabaseBackupStorage::widen_column(Conn &conn, const std::string &column, int width)
+    {
+        try
+        {
+            std::string sql = "SELECT CHARACTER_MAXIMUM_LENGTH FROM information_schema.COLUMNS "
+                              "WHERE TABLE_SCHEMA=DATABASE() AND TABLE_NAME='backup_files' AND COLUMN_NAME=?";
+            auto result = conn->execute_query(sql, column);
+            if (result.empty() || std::stoll(result[0][0]) >= width)
+            {
+                return true;
+            }
+
+            conn->execute_update("ALTER TABLE backup_files MODIFY COLUMN " + column + " VARCHAR(" +
+                                 std::to_string(width) + ") NOT NULL");
+            ZBACKUP_LOG_INFO("Widened column {} of backup_files table to {}", column, width);
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Failed to widen column {} of backup_files table: {}", column, e.what());
+            return false;
+        }
+    }
+
+    template <typename Conn>
+    bool DatabaseBackupStorage::ensure_column(Conn &conn, const std::string &column, const std::string &definition)
+    {
+        try
+        {
+            std::string sql = "SELECT COLUMN_NAME FROM information_schema.COLUMNS "
+                              "WHERE TABLE_SCHEMA=DATABASE() AND TABLE_NAME='backup_files' AND COLUMN_NAME=?";
+            if (!conn->execute_query(sql, column).empty())
+            {
+                return true;
+            }
+
+            conn->execute_update("ALTER TABLE backup_files ADD COLUMN " + column + " " + definition);
+            ZBACKUP_LOG_INFO("Added column to backup_files table: {}", column);
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            ZBACKUP_LOG_ERROR("Failed to add column {} to backup_files table: {}", column, e.what());
+            return false;
+        }
+    }
 }
@@ -3,6 +3,8 @@
 #include "interfaces/config_manager_interface.h"
 #include "log/backup_logger.h"
 #include "util/util.h"
+#include <algorithm>
+#include <unordered_set>
 
 namespace zbackup::storage
 {
@@ -30,6 +32,7 @@ namespace zbackup::storage
         }
         
         tables_[info.url_] = info;
+        index_entry(info);
         bool result = save_to_file();
         if (result)
         {
@@ -48,7 +51,9 @@ namespace zbackup::storage
             return false;
         }
         
+        unindex_entry(it->second);
         it->second = info;
+        index_entry(info);
         bool result = save_to_file();
         if (result)
         {
@@ -57,6 +62,100 @@ namespace zbackup::storage
         return result;
     }
 
+    bool FileBackupStorage::update_verify(const std::string &url, bool corrupt_flag, time_t verify_time)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        auto it = tables_.find(url);
+        if (it == tables_.end())
+        {
+            return false;
+        }
+
+        // 写文件失败时恢复原值
+        bool old_flag = it->second.corrupt_flag_;
+        time_t old_time = it->second.verify_time_;
+        it->second.corrupt_flag_ = corrupt_flag;
+        it->second.verify_time_ = verify_time;
+        if (!save_to_file())
+        {
+            it->second.corrupt_flag_ = old_flag;
+            it->second.verify_time_ = old_time;
+            return false;
+        }
+        return true;
+    }
+
+    bool FileBackupStorage::record_checksum(const std::string &url, bool pack, const std::string &checksum)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        auto it = tables_.find(url);
+        if (it == tables_.end() || it->second.pack_flag_ != pack)
+        {
+            return false;
+        }
+        std::string &field = pack ? it->second.pack_checksum_ : it->second.checksum_;
+        if (!field.empty())
+        {
+            return false;
+        }
+
+        field = checksum;
+        if (!save_to_file())
+        {
+            field.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool FileBackupStorage::mark_cold(const std::string &url, const std::string &pack_path,
+                                      const std::string &cold_path, const std::string &pack_checksum)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        auto it = tables_.find(url);
+        if (it == tables_.end() || !it->second.pack_flag_ || it->second.pack_path_ != pack_path ||
+            it->second.tier_ != info::StorageTier::HOT)
+        {
+            return false;
+        }
+
+        info::BackupInfo old = it->second;
+        it->second.tier_ = info::StorageTier::COLD;
+        it->second.cold_path_ = cold_path;
+        if (it->second.pack_checksum_.empty())
+        {
+            it->second.pack_checksum_ = pack_checksum;
+        }
+        if (!save_to_file())
+        {
+            it->second = std::move(old);
+            return false;
+        }
+        return true;
+    }
+
+    bool FileBackupStorage::mark_unpacked(const info::BackupInfo &expected)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        auto it = tables_.find(expected.url_);
+        if (it == tables_.end() || !it->second.pack_flag_ || it->second.pack_path_ != expected.pack_path_ ||
+            it->second.tier_ != expected.tier_ || it->second.cold_path_ != expected.cold_path_)
+        {
+            return false;
+        }
+
+        info::BackupInfo old = it->second;
+        it->second.pack_flag_ = false;
+        it->second.tier_ = info::StorageTier::HOT;
+        it->second.cold_path_.clear();
+        if (!save_to_file())
+        {
+            it->second = std::move(old);
+            return false;
+        }
+        return true;
+    }
+
     bool FileBackupStorage::get_one_by_id(const std::string &id, info::BackupInfo *info)
     {
         return get_one_by_url(id, info);
@@ -133,6 +232,7 @@ namespace zbackup::storage
             return false;
         }
         
+        unindex_entry(it->second);
         tables_.erase(it);
         bool result = save_to_file();
         if (result)
@@ -154,6 +254,7 @@ namespace zbackup::storage
             return false;
         }
         
+        unindex_entry(it->second);
         tables_.erase(it);
         bool result = save_to_file();
         if (result)
@@ -163,6 +264,155 @@ namespace zbackup::storage
         return result;
     }
 
+    void FileBackupStorage::get_by_owner(const std::string &owner, std::vector<info::BackupInfo> *arry)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        arry->clear();
+        auto it = owner_index_.find(owner);
+        if (it == owner_index_.end())
+        {
+            return;
+        }
+        for (const auto &url : it->second)
+        {
+            arry->push_back(tables_.at(url));
+        }
+        ZBACKUP_LOG_DEBUG("Retrieved backup info for owner '{}': {} entries", owner, arry->size());
+    }
+
+    void FileBackupStorage::get_versions(const std::string &base_url, std::vector<info::BackupInfo> *arry)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        arry->clear();
+        auto it = version_index_.find(base_url);
+        if (it == version_index_.end())
+        {
+            return;
+        }
+        for (const auto &version : it->second)
+        {
+            arry->push_back(tables_.at(version.second));
+        }
+    }
+
+    void FileBackupStorage::index_entry(const info::BackupInfo &info)
+    {
+        owner_index_[info.owner_].insert(info.url_);
+        version_index_[info.base_url_][info.version_] = info.url_;
+        auto &last = last_version_[info.base_url_];
+        last = std::max(last, info.version_);
+    }
+
+    void FileBackupStorage::unindex_entry(const info::BackupInfo &info)
+    {
+        auto owner = owner_index_.find(info.owner_);
+        if (owner != owner_index_.end())
+        {
+            owner->second.erase(info.url_);
+            if (owner->second.empty())
+            {
+                owner_index_.erase(owner);
+            }
+        }
+
+        auto versions = version_index_.find(info.base_url_);
+        if (versions != version_index_.end())
+        {
+            auto version = versions->second.find(info.version_);
+            if (version != versions->second.end() && version->second == info.url_)
+            {
+                versions->second.erase(version);
+            }
+            if (versions->second.empty())
+            {
+                version_index_.erase(versions);
+            }
+        }
+    }
+
+    bool FileBackupStorage::insert_versions(std::vector<info::BackupInfo> *infos)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        // 逐个分配版本号并加入内存表，同一批中的同名文件依次递增；出错或写文件失败时撤销本批条目与版本计数
+        // 版本号取该路径已分配过的最大版本加一（与数据库存储的计数器一致），已删除的版本号不会再分配
+        size_t inserted = 0;
+        std::unordered_map<std::string, uint32_t> previous_last;
+        auto rollback = [&]()
+        {
+            for (size_t i = 0; i < inserted; i++)
+            {
+                unindex_entry((*infos)[i]);
+                tables_.erase((*infos)[i].url_);
+            }
+            for (const auto &[base_url, last] : previous_last)
+            {
+                if (last == 0)
+                    last_version_.erase(base_url);
+                else
+                    last_version_[base_url] = last;
+            }
+        };
+        for (auto &info : *infos)
+        {
+            auto last = last_version_.find(info.base_url_);
+            uint32_t last_version = last == last_version_.end() ? 0 : last->second;
+            previous_last.emplace(info.base_url_, last_version);
+            info.version_ = last_version + 1;
+            info.url_ = info::BackupInfo::version_url(info.base_url_, info.version_);
+            if (tables_.find(info.url_) != tables_.end())
+            {
+                ZBACKUP_LOG_WARN("Backup info already exists for URL: {}", info.url_);
+                rollback();
+                return false;
+            }
+            tables_[info.url_] = info;
+            index_entry(info);
+            inserted++;
+        }
+
+        if (!save_to_file())
+        {
+            rollback();
+            return false;
+        }
+        ZBACKUP_LOG_DEBUG("Backup info versions inserted: {} entries", infos->size());
+        return true;
+    }
+
+    bool FileBackupStorage::delete_batch(const std::vector<info::BackupInfo> &infos)
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        std::vector<info::BackupInfo> removed;
+        for (const auto &info : infos)
+        {
+            auto it = tables_.find(info.url_);
+            if (it == tables_.end())
+            {
+                continue;
+            }
+            unindex_entry(it->second);
+            removed.push_back(std::move(it->second));
+            tables_.erase(it);
+        }
+        if (removed.empty())
+        {
+            return true;
+        }
+
+        // 整批只写一次文件，写入失败时恢复本批条目
+        if (!save_to_file())
+        {
+            for (auto &info : removed)
+            {
+                index_entry(info);
+                tables_[info.url_] = std::move(info);
+            }
+            return false;
+        }
+        ZBACKUP_LOG_DEBUG("Backup info batch deleted: {} entries", removed.size());
+        return true;
+    }
+
     bool FileBackupStorage::init_load()
     {
         util::FileUtil fu(backup_file_);
@@ -186,7 +436,14 @@ namespace zbackup::storage
             return false;
         }
 
-        for (const auto& item : root)
+        // 旧格式是条目数组；新格式为 {"entries": [...], "versions": {base_url: 已分配的最大版本号}}
+        const nlohmann::json empty = nlohmann::json::array();
+        const nlohmann::json *entries = &root;
+        if (root.is_object())
+        {
+            entries = root.contains("entries") && root["entries"].is_array() ? &root["entries"] : &empty;
+        }
+        for (const auto& item : *entries)
         {
             info::BackupInfo bi;
             bi.url_ = item["url"];
@@ -195,7 +452,25 @@ namespace zbackup::storage
             bi.fsize_ = item["fsize"];
             bi.mtime_ = item["mtime"];
             bi.pack_flag_ = item["pack_flag"];
+            bi.checksum_ = item.value("checksum", "");
+            bi.pack_checksum_ = item.value("pack_checksum", "");
+            bi.verify_time_ = item.value("verify_time", 0);
+            bi.corrupt_flag_ = item.value("corrupt_flag", false);
+            bi.owner_ = item.value("owner", "");
+            bi.base_url_ = item.value("base_url", bi.url_);
+            bi.version_ = item.value("version", 1u);
+            bi.tier_ = static_cast<info::StorageTier>(item.value("tier", 0));
+            bi.cold_path_ = item.value("cold_path", "");
             tables_[bi.url_] = bi;
+            index_entry(bi);
+        }
+        if (root.is_object() && root.contains("versions") && root["versions"].is_object())
+        {
+            for (const auto &[base_url, last] : root["versions"].items())
+            {
+                auto &slot = last_version_[base_url];
+                slot = std::max(slot, last.get<uint32_t>());
+            }
         }
 
         ZBACKUP_LOG_INFO("Loaded {} backup entries from file", tables_.size());
@@ -204,7 +479,7 @@ namespace zbackup::storage
 
     bool FileBackupStorage::save_to_file()
     {
-        nlohmann::json root = nlohmann::json::array();
+        nlohmann::json entries = nlohmann::json::array();
         
         for (const auto& pair : tables_)
         {
@@ -216,9 +491,27 @@ namespace zbackup::storage
             item["fsize"] = bi.fsize_;
             item["mtime"] = bi.mtime_;
             item["pack_flag"] = bi.pack_flag_;
-            root.push_back(item);
+            item["checksum"] = bi.checksum_;
+            item["pack_checksum"] = bi.pack_checksum_;
+            item["verify_time"] = bi.verify_time_;
+            item["corrupt_flag"] = bi.corrupt_flag_;
+            item["owner"] = bi.owner_;
+            item["base_url"] = bi.base_url_;
+            item["version"] = bi.version_;
+            item["tier"] = static_cast<int>(bi.tier_);
+            item["cold_path"] = bi.cold_path_;
+            entries.push_back(item);
         }
 
+        nlohmann::json versions = nlohmann::json::object();
+        for (const auto &[base_url, last] : last_version_)
+        {
+            versions[base_url] = last;
+        }
+        nlohmann::json root;
+        root["entries"] = std::move(entries);
+        root["versions"] = std::move(versions);
+
         std::string body;
         if (!util::JsonUtil::serialize(root, &body))
         {
@@ -0,0 +1,238 @@
+#include "util/checksum.h"
+#include <openssl/evp.h>
+#include <array>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace zbackup::util
+{
+    namespace
+    {
+        // CRC32C反射多项式
+        constexpr uint32_t CRC32C_POLY = 0x82F63B78u;
+
+        std::array<uint32_t, 256> make_crc32c_table()
+        {
+            std::array<uint32_t, 256> table{};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t crc = i;
+                for (int k = 0; k < 8; k++)
+                {
+                    crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : (crc >> 1);
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        uint32_t crc32c_software(uint32_t crc, const char *data, size_t len)
+        {
+            static const std::array<uint32_t, 256> table = make_crc32c_table();
+            auto p = reinterpret_cast<const unsigned char *>(data);
+            while (len--)
+            {
+                crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+#if defined(__x86_64__)
+        __attribute__((target("sse4.2")))
+        uint32_t crc32c_hardware(uint32_t crc, const char *data, size_t len)
+        {
+            auto p = reinterpret_cast<const unsigned char *>(data);
+            uint64_t crc64 = crc;
+            while (len >= sizeof(uint64_t))
+            {
+                uint64_t word;
+                memcpy(&word, p, sizeof(word));
+                crc64 = _mm_crc32_u64(crc64, word);
+                p += sizeof(word);
+                len -= sizeof(word);
+            }
+            crc = static_cast<uint32_t>(crc64);
+            while (len--)
+            {
+                crc = _mm_crc32_u8(crc, *p++);
+            }
+            return crc;
+        }
+#endif
+
+        using Crc32cFunc = uint32_t (*)(uint32_t, const char *, size_t);
+
+        Crc32cFunc select_crc32c()
+        {
+#if defined(__x86_64__)
+            if (__builtin_cpu_supports("sse4.2"))
+            {
+                return crc32c_hardware;
+            }
+#endif
+            return crc32c_software;
+        }
+
+        // 进程启动时确定一次实现，避免每次调用都检测CPU特性
+        const Crc32cFunc crc32c_impl = select_crc32c();
+
+        // 文件校验时每次读取的块大小
+        constexpr size_t FILE_CHUNK_SIZE = 1024 * 1024;
+    }
+
+    void Crc32c::update(const char *data, size_t len)
+    {
+        crc_ = crc32c_impl(crc_, data, len);
+    }
+
+    std::string Crc32c::hex() const
+    {
+        uint32_t crc = value();
+        unsigned char bytes[4] = {static_cast<unsigned char>(crc >> 24), static_cast<unsigned char>(crc >> 16),
+                                  static_cast<unsigned char>(crc >> 8), static_cast<unsigned char>(crc)};
+        return ChecksumUtil::to_hex(bytes, sizeof(bytes));
+    }
+
+    uint32_t Crc32c::compute(const char *data, size_t len)
+    {
+        Crc32c crc;
+        crc.update(data, len);
+        return crc.value();
+    }
+
+    bool Crc32c::hardware_supported()
+    {
+#if defined(__x86_64__)
+        return crc32c_impl == crc32c_hardware;
+#else
+        return false;
+#endif
+    }
+
+    struct Sha256::Context
+    {
+        EVP_MD_CTX *md_ctx = nullptr;
+    };
+
+    Sha256::Sha256() : ctx_(std::make_unique<Context>())
+    {
+        ctx_->md_ctx = EVP_MD_CTX_new();
+        EVP_DigestInit_ex(ctx_->md_ctx, EVP_sha256(), nullptr);
+    }
+
+    Sha256::~Sha256()
+    {
+        EVP_MD_CTX_free(ctx_->md_ctx);
+    }
+
+    void Sha256::update(const char *data, size_t len)
+    {
+        EVP_DigestUpdate(ctx_->md_ctx, data, len);
+    }
+
+    std::string Sha256::hex_digest()
+    {
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digest_len = 0;
+        EVP_DigestFinal_ex(ctx_->md_ctx, digest, &digest_len);
+        return ChecksumUtil::to_hex(digest, digest_len);
+    }
+
+    std::string ChecksumUtil::to_hex(const unsigned char *data, size_t len)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(len * 2, '0');
+        for (size_t i = 0; i < len; i++)
+        {
+            hex[i * 2] = digits[data[i] >> 4];
+            hex[i * 2 + 1] = digits[data[i] & 0x0F];
+        }
+        return hex;
+    }
+
+    bool ChecksumUtil::base64_decode(const std::string &input, std::string *output)
+    {
+        auto decode_char = [](char c) -> int {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+') return 62;
+            if (c == '/') return 63;
+            return -1;
+        };
+
+        output->clear();
+        uint32_t buffer = 0;
+        int bits = 0;
+        size_t padding = 0;
+        for (char c : input)
+        {
+            if (c == '=')
+            {
+                padding++;
+                continue;
+            }
+            int value = decode_char(c);
+            if (value < 0 || padding > 0)
+            {
+                return false;
+            }
+            buffer = (buffer << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                output->push_back(static_cast<char>((buffer >> bits) & 0xFF));
+            }
+        }
+        return padding <= 2 && (input.size() % 4 == 0 || padding == 0);
+    }
+
+    bool ChecksumUtil::file_crc32c(const std::string &path, std::string *hex,
+                                   const std::function<void(size_t)> &on_read)
+    {
+        // 尽量不更新atime，避免后台读取干扰热点判断（非文件属主时O_NOATIME会返回EPERM）
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOATIME);
+        if (fd < 0 && errno == EPERM)
+        {
+            fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if (fd < 0)
+        {
+            return false;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        Crc32c crc;
+        std::vector<char> buffer(FILE_CHUNK_SIZE);
+        bool ok = true;
+        while (true)
+        {
+            ssize_t n = read(fd, buffer.data(), buffer.size());
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                ok = (n == 0);
+                break;
+            }
+            crc.update(buffer.data(), static_cast<size_t>(n));
+            if (on_read)
+                on_read(static_cast<size_t>(n));
+        }
+
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+        if (ok)
+        {
+            *hex = crc.hex();
+        }
+        return ok;
+    }
+}
@@ -0,0 +1,93 @@
+#include "util/cpu_affinity.h"
+#include <filesystem>
+#include <cstdlib>
+#include <sched.h>
+#ifdef ZBACKUP_HAVE_NUMA
+#include <numa.h>
+#endif
+
+namespace zbackup::util
+{
+    namespace fs = std::filesystem;
+
+    bool CpuAffinity::parse_cpu_list(const std::string &spec, std::vector<int> *cpus)
+    {
+        cpus->clear();
+        size_t pos = 0;
+        while (pos < spec.size())
+        {
+            size_t comma = spec.find(',', pos);
+            if (comma == std::string::npos)
+                comma = spec.size();
+            std::string item = spec.substr(pos, comma - pos);
+            pos = comma + 1;
+
+            size_t begin = item.find_first_not_of(" \t");
+            if (begin == std::string::npos)
+                continue;
+            size_t end = item.find_last_not_of(" \t");
+            item = item.substr(begin, end - begin + 1);
+
+            // 单个CPU "3" 或区间 "0-7"
+            char *stop = nullptr;
+            long first = std::strtol(item.c_str(), &stop, 10);
+            long last = first;
+            if (*stop == '-')
+            {
+                last = std::strtol(stop + 1, &stop, 10);
+            }
+            if (stop == item.c_str() || *stop != '\0' || first < 0 || last < first || last >= CPU_SETSIZE)
+            {
+                cpus->clear();
+                return false;
+            }
+            for (long cpu = first; cpu <= last; cpu++)
+            {
+                cpus->push_back(static_cast<int>(cpu));
+            }
+        }
+        return true;
+    }
+
+    bool CpuAffinity::set_thread_affinity(pthread_t thread, const std::vector<int> &cpus)
+    {
+        if (cpus.empty())
+        {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus)
+        {
+            CPU_SET(cpu, &set);
+        }
+        return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+    }
+
+    bool CpuAffinity::set_current_affinity(const std::vector<int> &cpus)
+    {
+        return set_thread_affinity(pthread_self(), cpus);
+    }
+
+    int CpuAffinity::numa_node_of_cpu(int cpu)
+    {
+#ifdef ZBACKUP_HAVE_NUMA
+        if (numa_available() >= 0)
+        {
+            int node = ::numa_node_of_cpu(cpu);
+            return node < 0 ? 0 : node;
+        }
+#endif
+        // 没有libnuma时从sysfs读取：/sys/devices/system/cpu/cpuN/nodeM
+        std::error_code ec;
+        for (const auto &entry : fs::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec))
+        {
+            std::string name = entry.path().filename().string();
+            if (name.size() > 4 && name.compare(0, 4, "node") == 0)
+            {
+                return std::atoi(name.c_str() + 4);
+            }
+        }
+        return 0;
+    }
+}
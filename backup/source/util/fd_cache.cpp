@@ -0,0 +1,137 @@
+#include "util/fd_cache.h"
+#include "util/file_io.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace zbackup::util
+{
+    OpenFile::~OpenFile()
+    {
+        close(fd_);
+    }
+
+    bool OpenFile::read(char *data, size_t pos, size_t len) const
+    {
+        if (pos + len > static_cast<size_t>(size_))
+        {
+            errno = EINVAL;
+            return false;
+        }
+        return FileIO::read_at(fd_, data, len, pos);
+    }
+
+    FdCache &FdCache::get_instance()
+    {
+        static FdCache instance;
+        return instance;
+    }
+
+    void FdCache::set_capacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        capacity_ = capacity;
+        evict_locked();
+    }
+
+    size_t FdCache::get_capacity() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return capacity_;
+    }
+
+    FdCache::FilePtr FdCache::acquire(const std::string &path)
+    {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = index_.find(path);
+            if (it != index_.end())
+            {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return it->second->file;
+            }
+            generation = generation_;
+        }
+
+        // 未命中时在锁外打开文件，避免慢速磁盘阻塞其他路径的查询
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0)
+        {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return nullptr;
+        }
+        auto file = std::make_shared<const OpenFile>(fd, st.st_size, st.st_mtime);
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (capacity_ == 0 || generation != generation_)
+        {
+            return file;
+        }
+        auto it = index_.find(path);
+        if (it != index_.end())
+        {
+            // 其他线程已放入同一路径，使用缓存中的文件
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->file;
+        }
+        lru_.push_front(Entry{path, file});
+        index_[path] = lru_.begin();
+        evict_locked();
+        return file;
+    }
+
+    void FdCache::invalidate(const std::string &path)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        generation_++;
+        auto it = index_.find(path);
+        if (it != index_.end())
+        {
+            lru_.erase(it->second);
+            index_.erase(it);
+        }
+    }
+
+    void FdCache::invalidate_tree(const std::string &dir)
+    {
+        std::string prefix = dir;
+        if (!prefix.empty() && prefix.back() != '/')
+        {
+            prefix += '/';
+        }
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        generation_++;
+        for (auto it = lru_.begin(); it != lru_.end();)
+        {
+            if (it->path == dir || it->path.compare(0, prefix.size(), prefix) == 0)
+            {
+                index_.erase(it->path);
+                it = lru_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    // 超出容量时从表尾淘汰，正在被读取的文件在最后一个使用者释放后才关闭
+    void FdCache::evict_locked()
+    {
+        while (lru_.size() > capacity_)
+        {
+            index_.erase(lru_.back().path);
+            lru_.pop_back();
+        }
+    }
+}
@@ -0,0 +1,677 @@
+#include "util/file_io.h"
+#include "util/local_buffer.h"
+#include "log/backup_logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+namespace zbackup::util
+{
+    namespace
+    {
+        constexpr size_t DIRECT_ALIGN = 4096;       // O_DIRECT 的偏移、长度与缓冲区对齐要求
+        constexpr unsigned STAGING_BUFFERS = 8;     // 每个线程注册的对齐缓冲区个数
+        constexpr unsigned MAX_QUEUE_DEPTH = 4096;
+        constexpr size_t MAX_CHUNK_SIZE = 64 << 20;
+
+        FileIOOptions g_options;
+        std::atomic<bool> g_fallback_logged{false};
+
+        // 一个分块读写请求，完成后由收割线程写入结果
+        struct IoRequest
+        {
+            uint8_t opcode = IORING_OP_NOP;
+            int fd = -1;
+            char *addr = nullptr;
+            uint32_t len = 0;
+            uint64_t offset = 0;
+            int buf_index = -1; // 注册缓冲区下标，-1表示普通缓冲区
+            int result = 0;     // 传输字节数或负的错误码
+            bool done = false;
+        };
+
+        // 线程独占的io_uring实例，直接使用系统调用，不依赖liburing
+        class Uring
+        {
+        public:
+            Uring() = default;
+            ~Uring();
+
+            Uring(const Uring &) = delete;
+            Uring &operator=(const Uring &) = delete;
+
+            // 当前线程的实例，不可用或已失效时返回空
+            static Uring *local();
+
+            [[nodiscard]] unsigned depth() const { return entries_; }
+
+            // 提交一批请求（不等待完成）
+            bool submit(IoRequest *reqs, size_t n);
+            // 等待指定请求全部完成，期间收到的其他请求的完成事件同样记录
+            bool wait(IoRequest *reqs, size_t n);
+            // 出错返回前等待全部已提交的请求完成，避免内核在调用方释放缓冲区后仍写入
+            void drain();
+
+            // 对齐的暂存缓冲区，首次使用时分配并尝试注册到内核
+            char *staging(size_t index);
+            [[nodiscard]] bool registered() const { return registered_; }
+
+        private:
+            bool init(unsigned entries);
+            void reap();
+
+        private:
+            int ring_fd_ = -1;
+            unsigned entries_ = 0;
+            bool broken_ = false;
+            size_t in_flight_ = 0;
+
+            void *sq_ring_ = MAP_FAILED;
+            void *cq_ring_ = MAP_FAILED;
+            size_t sq_ring_size_ = 0;
+            size_t cq_ring_size_ = 0;
+            io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+            size_t sqes_size_ = 0;
+
+            unsigned *sq_tail_ = nullptr;
+            unsigned *sq_mask_ = nullptr;
+            unsigned *sq_array_ = nullptr;
+            unsigned *cq_head_ = nullptr;
+            unsigned *cq_tail_ = nullptr;
+            unsigned *cq_mask_ = nullptr;
+            io_uring_cqe *cqes_ = nullptr;
+
+            LocalBuffer staging_;   // STAGING_BUFFERS 个 chunk_size 大小的缓冲区
+            bool registered_ = false;
+        };
+
+        Uring::~Uring()
+        {
+            if (sqes_ != MAP_FAILED)
+                munmap(sqes_, sqes_size_);
+            if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+                munmap(cq_ring_, cq_ring_size_);
+            if (sq_ring_ != MAP_FAILED)
+                munmap(sq_ring_, sq_ring_size_);
+            // 关闭环时内核自动注销已注册的缓冲区
+            if (ring_fd_ >= 0)
+                close(ring_fd_);
+        }
+
+        Uring *Uring::local()
+        {
+            thread_local std::unique_ptr<Uring> ring;
+            thread_local bool initialized = false;
+            if (!initialized)
+            {
+                initialized = true;
+                if (g_options.use_io_uring)
+                {
+                    auto created = std::make_unique<Uring>();
+                    if (created->init(g_options.queue_depth))
+                    {
+                        ring = std::move(created);
+                    }
+                    else if (!g_fallback_logged.exchange(true))
+                    {
+                        ZBACKUP_LOG_WARN("io_uring unavailable ({}), falling back to pread/pwrite", strerror(errno));
+                    }
+                }
+            }
+            return ring && !ring->broken_ ? ring.get() : nullptr;
+        }
+
+        bool Uring::init(unsigned entries)
+        {
+            io_uring_params params{};
+            ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (ring_fd_ < 0)
+            {
+                return false;
+            }
+            entries_ = params.sq_entries;
+
+            sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap)
+            {
+                sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+            }
+
+            sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                            IORING_OFF_SQ_RING);
+            if (sq_ring_ == MAP_FAILED)
+            {
+                return false;
+            }
+            cq_ring_ = single_mmap
+                           ? sq_ring_
+                           : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED)
+            {
+                return false;
+            }
+            sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                                                     MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+            if (sqes_ == MAP_FAILED)
+            {
+                return false;
+            }
+
+            auto *sq = static_cast<char *>(sq_ring_);
+            auto *cq = static_cast<char *>(cq_ring_);
+            sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+            cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        bool Uring::submit(IoRequest *reqs, size_t n)
+        {
+            // 提交队列只由本线程写入，尾指针无需原子读取
+            unsigned tail = *sq_tail_;
+            for (size_t i = 0; i < n; i++)
+            {
+                unsigned index = tail & *sq_mask_;
+                io_uring_sqe *sqe = &sqes_[index];
+                memset(sqe, 0, sizeof(*sqe));
+                sqe->opcode = reqs[i].opcode;
+                sqe->fd = reqs[i].fd;
+                sqe->addr = reinterpret_cast<uint64_t>(reqs[i].addr);
+                sqe->len = reqs[i].len;
+                sqe->off = reqs[i].offset;
+                if (reqs[i].buf_index >= 0)
+                {
+                    sqe->buf_index = static_cast<uint16_t>(reqs[i].buf_index);
+                }
+                sqe->user_data = reinterpret_cast<uint64_t>(&reqs[i]);
+                sq_array_[index] = index;
+                reqs[i].done = false;
+                tail++;
+            }
+            __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+            // 一次系统调用提交整批请求，内核资源暂时不足时先收割已完成的请求再重试
+            size_t left = n;
+            while (left > 0)
+            {
+                int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, left, 0, 0, nullptr, 0));
+                if (ret < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    if ((errno == EAGAIN || errno == EBUSY) && in_flight_ > 0)
+                    {
+                        syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                        reap();
+                        continue;
+                    }
+                    ZBACKUP_LOG_ERROR("io_uring_enter submit failed: {}", strerror(errno));
+                    broken_ = true;
+                    return false;
+                }
+                left -= ret;
+                in_flight_ += ret;
+            }
+            return true;
+        }
+
+        bool Uring::wait(IoRequest *reqs, size_t n)
+        {
+            while (true)
+            {
+                reap();
+                if (std::all_of(reqs, reqs + n, [](const IoRequest &req) { return req.done; }))
+                {
+                    return true;
+                }
+                int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                                                   nullptr, 0));
+                if (ret < 0 && errno != EINTR)
+                {
+                    ZBACKUP_LOG_ERROR("io_uring_enter wait failed: {}", strerror(errno));
+                    broken_ = true;
+                    return false;
+                }
+            }
+        }
+
+        void Uring::drain()
+        {
+            while (true)
+            {
+                reap();
+                if (in_flight_ == 0)
+                {
+                    return;
+                }
+                // 环已失效时系统调用可能一直失败，但内核仍会把完成事件写入映射的完成队列，轮询收割
+                int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                                                   nullptr, 0));
+                if (ret < 0 && errno != EINTR)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        void Uring::reap()
+        {
+            unsigned head = *cq_head_;
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            while (head != tail)
+            {
+                io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+                auto *req = reinterpret_cast<IoRequest *>(cqe->user_data);
+                req->result = cqe->res;
+                req->done = true;
+                head++;
+                in_flight_--;
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        }
+
+        char *Uring::staging(size_t index)
+        {
+            size_t chunk = g_options.chunk_size;
+            if (staging_.data() == nullptr)
+            {
+                if (!staging_.reserve(STAGING_BUFFERS * chunk))
+                {
+                    return nullptr;
+                }
+                iovec iovs[STAGING_BUFFERS];
+                for (unsigned i = 0; i < STAGING_BUFFERS; i++)
+                {
+                    iovs[i].iov_base = staging_.data() + i * chunk;
+                    iovs[i].iov_len = chunk;
+                }
+                // 注册失败（如 RLIMIT_MEMLOCK 过小）时仍可作为普通对齐缓冲区使用
+                registered_ = syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, iovs,
+                                      STAGING_BUFFERS) == 0;
+                if (!registered_)
+                {
+                    ZBACKUP_LOG_DEBUG("io_uring buffer registration failed: {}", strerror(errno));
+                }
+            }
+            return staging_.data() + (index % STAGING_BUFFERS) * chunk;
+        }
+
+        // 分块流水线：每批最多 batch 个请求，提交下一批后再等待上一批完成
+        // prepare(i, req) 填写第i块请求；finish(i, req) 按分块顺序处理结果，返回false时不再提交后续分块
+        template<typename Prepare, typename Finish>
+        bool run_pipeline(Uring *ring, size_t count, size_t batch, Prepare &&prepare, Finish &&finish)
+        {
+            std::vector<IoRequest> slots(2 * batch);
+            size_t batches = (count + batch - 1) / batch;
+            size_t prev_n = 0;
+            bool ok = true;
+            for (size_t b = 0; b <= batches; b++)
+            {
+                size_t cur_n = 0;
+                if (ok && b < batches)
+                {
+                    IoRequest *cur = &slots[(b % 2) * batch];
+                    cur_n = std::min(batch, count - b * batch);
+                    for (size_t j = 0; j < cur_n; j++)
+                    {
+                        cur[j] = IoRequest();
+                        prepare(b * batch + j, &cur[j]);
+                    }
+                    if (!ring->submit(cur, cur_n))
+                    {
+                        ring->drain();
+                        return false;
+                    }
+                }
+                if (prev_n > 0)
+                {
+                    IoRequest *prev = &slots[((b - 1) % 2) * batch];
+                    if (!ring->wait(prev, prev_n))
+                    {
+                        ring->drain();
+                        return false;
+                    }
+                    for (size_t j = 0; j < prev_n && ok; j++)
+                    {
+                        ok = finish((b - 1) * batch + j, prev[j]);
+                    }
+                }
+                prev_n = cur_n;
+            }
+            return ok;
+        }
+
+        bool pread_all(int fd, char *data, size_t len, uint64_t offset)
+        {
+            while (len > 0)
+            {
+                ssize_t n = pread(fd, data, len, static_cast<off_t>(offset));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                {
+                    if (n == 0)
+                        errno = EIO; // 文件在读取期间被截断
+                    return false;
+                }
+                data += n;
+                len -= n;
+                offset += n;
+            }
+            return true;
+        }
+
+        bool pwrite_all(int fd, const char *data, size_t len, uint64_t offset)
+        {
+            while (len > 0)
+            {
+                ssize_t n = pwrite(fd, data, len, static_cast<off_t>(offset));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0)
+                    return false;
+                data += n;
+                len -= n;
+                offset += n;
+            }
+            return true;
+        }
+
+        bool use_direct(size_t len)
+        {
+            return g_options.direct_threshold > 0 && len >= g_options.direct_threshold;
+        }
+
+        // 以O_DIRECT重新打开同一文件，得到独立的文件描述；不修改 fd 自身的标志，
+        // 因为 fd 可能来自描述符缓存，正被其他线程做普通读取。文件系统不支持时返回-1
+        int reopen_direct(int fd)
+        {
+            int flags = fcntl(fd, F_GETFL);
+            if (flags < 0)
+                return -1;
+            std::string path = "/proc/self/fd/" + std::to_string(fd);
+            return open(path.c_str(), (flags & O_ACCMODE) | O_DIRECT | O_CLOEXEC);
+        }
+
+        // 普通读写请求的结果检查，短读写用同步调用补齐
+        bool finish_buffered(const IoRequest &req, bool is_read)
+        {
+            if (req.result < 0)
+            {
+                errno = -req.result;
+                ZBACKUP_LOG_ERROR("io_uring {} failed at offset {}: {}", is_read ? "read" : "write", req.offset,
+                                  strerror(errno));
+                return false;
+            }
+            auto n = static_cast<uint32_t>(req.result);
+            if (n == req.len)
+            {
+                return true;
+            }
+            if (is_read)
+            {
+                return n > 0 && pread_all(req.fd, req.addr + n, req.len - n, req.offset + n);
+            }
+            return pwrite_all(req.fd, req.addr + n, req.len - n, req.offset + n);
+        }
+
+        bool read_buffered(Uring *ring, int fd, char *data, size_t len, uint64_t offset)
+        {
+            size_t chunk = g_options.chunk_size;
+            size_t count = (len + chunk - 1) / chunk;
+            size_t batch = std::max(1u, ring->depth() / 2);
+            return run_pipeline(ring, count, batch, [&](size_t i, IoRequest *req)
+            {
+                req->opcode = IORING_OP_READ;
+                req->fd = fd;
+                req->addr = data + i * chunk;
+                req->len = static_cast<uint32_t>(std::min(chunk, len - i * chunk));
+                req->offset = offset + i * chunk;
+            }, [](size_t, const IoRequest &req)
+            {
+                return finish_buffered(req, true);
+            });
+        }
+
+        // O_DIRECT读取：按对齐边界扩展读取范围，经由暂存缓冲区拷出所需部分
+        bool read_direct(Uring *ring, int fd, char *data, size_t len, uint64_t offset)
+        {
+            size_t chunk = g_options.chunk_size;
+            uint64_t begin = offset & ~(DIRECT_ALIGN - 1);
+            uint64_t end = (offset + len + DIRECT_ALIGN - 1) & ~(DIRECT_ALIGN - 1);
+            size_t count = (end - begin + chunk - 1) / chunk;
+            size_t batch = std::max(1u, std::min(ring->depth(), STAGING_BUFFERS) / 2);
+            if (ring->staging(0) == nullptr)
+            {
+                return false;
+            }
+            return run_pipeline(ring, count, batch, [&](size_t i, IoRequest *req)
+            {
+                size_t slot = i % (2 * batch);
+                req->opcode = ring->registered() ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                req->fd = fd;
+                req->addr = ring->staging(slot);
+                req->len = static_cast<uint32_t>(std::min<uint64_t>(chunk, end - begin - i * chunk));
+                req->offset = begin + i * chunk;
+                req->buf_index = ring->registered() ? static_cast<int>(slot) : -1;
+            }, [&](size_t, const IoRequest &req)
+            {
+                if (req.result < 0)
+                {
+                    ZBACKUP_LOG_DEBUG("O_DIRECT read failed at offset {}: {}", req.offset, strerror(-req.result));
+                    return false;
+                }
+                uint64_t lo = std::max<uint64_t>(req.offset, offset);
+                uint64_t hi = std::min<uint64_t>(req.offset + req.len, offset + len);
+                if (req.offset + static_cast<uint64_t>(req.result) < hi)
+                {
+                    return false; // 短读，交给普通读取重试
+                }
+                memcpy(data + (lo - offset), req.addr + (lo - req.offset), hi - lo);
+                return true;
+            });
+        }
+
+        // 分块写入，confirmed 返回从头开始连续写成功（并已回调）的字节数
+        bool write_chunks(Uring *ring, int fd, const char *data, size_t len, uint64_t offset, bool direct,
+                          const FileIO::ChunkCallback &on_chunk, size_t *confirmed)
+        {
+            size_t chunk = g_options.chunk_size;
+            size_t count = (len + chunk - 1) / chunk;
+            size_t batch = std::max(1u, ring->depth() / 2);
+            if (direct)
+            {
+                batch = std::max(1u, std::min(ring->depth(), STAGING_BUFFERS) / 2);
+                if (ring->staging(0) == nullptr)
+                {
+                    return false;
+                }
+            }
+            *confirmed = 0;
+            return run_pipeline(ring, count, batch, [&](size_t i, IoRequest *req)
+            {
+                size_t n = std::min(chunk, len - i * chunk);
+                req->fd = fd;
+                req->len = static_cast<uint32_t>(n);
+                req->offset = offset + i * chunk;
+                if (direct)
+                {
+                    size_t slot = i % (2 * batch);
+                    req->addr = ring->staging(slot);
+                    memcpy(req->addr, data + i * chunk, n);
+                    req->opcode = ring->registered() ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+                    req->buf_index = ring->registered() ? static_cast<int>(slot) : -1;
+                }
+                else
+                {
+                    req->addr = const_cast<char *>(data + i * chunk);
+                    req->opcode = IORING_OP_WRITE;
+                }
+            }, [&](size_t i, const IoRequest &req)
+            {
+                if (direct)
+                {
+                    if (req.result != static_cast<int>(req.len))
+                    {
+                        ZBACKUP_LOG_DEBUG("O_DIRECT write failed at offset {}: {}", req.offset,
+                                          req.result < 0 ? strerror(-req.result) : "short write");
+                        return false;
+                    }
+                }
+                else if (!finish_buffered(req, false))
+                {
+                    return false;
+                }
+                // 回调在下一批写入进行期间执行
+                if (on_chunk)
+                {
+                    on_chunk(data + i * chunk, req.len);
+                }
+                *confirmed += req.len;
+                return true;
+            });
+        }
+
+        bool write_sync(int fd, const char *data, size_t len, uint64_t offset, const FileIO::ChunkCallback &on_chunk)
+        {
+            size_t chunk = g_options.chunk_size;
+            for (size_t pos = 0; pos < len; pos += chunk)
+            {
+                size_t n = std::min(chunk, len - pos);
+                if (!pwrite_all(fd, data + pos, n, offset + pos))
+                {
+                    return false;
+                }
+                if (on_chunk)
+                {
+                    on_chunk(data + pos, n);
+                }
+            }
+            return true;
+        }
+    }
+
+    void FileIO::configure(const FileIOOptions &options)
+    {
+        g_options = options;
+        g_options.queue_depth = std::clamp(g_options.queue_depth, 2u, MAX_QUEUE_DEPTH);
+        // 分块长度按O_DIRECT对齐，保证直接I/O的每个请求都满足对齐要求
+        size_t chunk = std::clamp(g_options.chunk_size, DIRECT_ALIGN, MAX_CHUNK_SIZE);
+        g_options.chunk_size = (chunk + DIRECT_ALIGN - 1) & ~(DIRECT_ALIGN - 1);
+    }
+
+    const FileIOOptions &FileIO::options()
+    {
+        return g_options;
+    }
+
+    const char *FileIO::backend_name()
+    {
+        return Uring::local() != nullptr ? "io_uring" : "pread";
+    }
+
+    int FileIO::open_read(const std::string &path, int64_t *size)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0)
+        {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return -1;
+        }
+        *size = st.st_size;
+        return fd;
+    }
+
+    int FileIO::open_write(const std::string &path)
+    {
+        return open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    }
+
+    bool FileIO::read_at(int fd, char *data, size_t len, uint64_t offset)
+    {
+        if (len == 0)
+        {
+            return true;
+        }
+        Uring *ring = Uring::local();
+        int direct_fd = ring != nullptr && use_direct(len) ? reopen_direct(fd) : -1;
+        if (direct_fd >= 0)
+        {
+            bool ok = read_direct(ring, direct_fd, data, len, offset);
+            close(direct_fd);
+            if (ok)
+            {
+                return true;
+            }
+            // 文件系统不支持直接I/O或读取不完整时改用普通读取
+            ring = Uring::local();
+        }
+        if (ring != nullptr)
+        {
+            if (read_buffered(ring, fd, data, len, offset))
+            {
+                return true;
+            }
+            // 环在本次调用中失效时用pread重试，其余失败是真实的读取错误
+            if (Uring::local() != nullptr)
+            {
+                return false;
+            }
+        }
+        return pread_all(fd, data, len, offset);
+    }
+
+    bool FileIO::write_all(int fd, const char *data, size_t len, const ChunkCallback &on_chunk)
+    {
+        size_t done = 0;
+        Uring *ring = Uring::local();
+        // 对齐部分用O_DIRECT写入，失败时从已确认的位置起改用普通写入，已回调的分块不会重复回调
+        size_t aligned = len & ~(DIRECT_ALIGN - 1);
+        int direct_fd = ring != nullptr && use_direct(len) && aligned > 0 ? reopen_direct(fd) : -1;
+        if (direct_fd >= 0)
+        {
+            write_chunks(ring, direct_fd, data, aligned, 0, true, on_chunk, &done);
+            close(direct_fd);
+            ring = Uring::local();
+        }
+        if (ring != nullptr && done < len)
+        {
+            size_t written = 0;
+            bool ok = write_chunks(ring, fd, data + done, len - done, done, false, on_chunk, &written);
+            done += written;
+            // 环在本次调用中失效时用pwrite写完剩余部分，其余失败是真实的写入错误
+            if (ok || Uring::local() != nullptr)
+            {
+                return ok;
+            }
+        }
+        return write_sync(fd, data + done, len - done, done, on_chunk);
+    }
+}
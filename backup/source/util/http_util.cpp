@@ -0,0 +1,236 @@
+#include "util/http_util.h"
+#include <cstring>
+#include <cstdlib>
+
+namespace zbackup::util
+{
+    std::string HttpUtil::format_http_date(time_t timestamp)
+    {
+        struct tm tm_info{};
+        gmtime_r(&timestamp, &tm_info);
+        char buffer[64];
+        strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm_info);
+        return std::string(buffer);
+    }
+
+    time_t HttpUtil::parse_http_date(const std::string &date)
+    {
+        // 依次尝试 IMF-fixdate、RFC 850、asctime 三种格式
+        static const char *formats[] = {
+            "%a, %d %b %Y %H:%M:%S GMT",
+            "%A, %d-%b-%y %H:%M:%S GMT",
+            "%a %b %e %H:%M:%S %Y"};
+
+        for (const char *format : formats)
+        {
+            struct tm tm_info{};
+            const char *end = strptime(date.c_str(), format, &tm_info);
+            if (end != nullptr && *end == '\0')
+            {
+                return timegm(&tm_info);
+            }
+        }
+        return -1;
+    }
+
+    std::string HttpUtil::quote_etag(const std::string &etag)
+    {
+        if (etag.size() >= 2 && etag.front() == '"' && etag.back() == '"')
+        {
+            return etag;
+        }
+        return "\"" + etag + "\"";
+    }
+
+    bool HttpUtil::etag_match(const std::string &header, const std::string &etag)
+    {
+        if (header.empty())
+        {
+            return false;
+        }
+
+        // 去掉弱校验前缀和引号后比较
+        auto normalize = [](std::string tag) {
+            size_t begin = tag.find_first_not_of(" \t");
+            size_t end = tag.find_last_not_of(" \t");
+            if (begin == std::string::npos)
+                return std::string();
+            tag = tag.substr(begin, end - begin + 1);
+            if (tag.compare(0, 2, "W/") == 0)
+                tag = tag.substr(2);
+            if (tag.size() >= 2 && tag.front() == '"' && tag.back() == '"')
+                tag = tag.substr(1, tag.size() - 2);
+            return tag;
+        };
+
+        const std::string target = normalize(etag);
+        size_t pos = 0;
+        while (pos <= header.size())
+        {
+            size_t comma = header.find(',', pos);
+            if (comma == std::string::npos)
+                comma = header.size();
+            std::string candidate = normalize(header.substr(pos, comma - pos));
+            if (candidate == "*" || (!candidate.empty() && candidate == target))
+            {
+                return true;
+            }
+            pos = comma + 1;
+        }
+        return false;
+    }
+
+    bool HttpUtil::etag_match_strong(const std::string &header, const std::string &etag)
+    {
+        size_t begin = header.find_first_not_of(" \t");
+        size_t end = header.find_last_not_of(" \t");
+        if (begin == std::string::npos)
+        {
+            return false;
+        }
+        std::string tag = header.substr(begin, end - begin + 1);
+        // 只接受单个带引号的强ETag
+        if (tag.size() < 2 || tag.front() != '"' || tag.back() != '"' ||
+            tag.find_first_of(",\"", 1) != tag.size() - 1)
+        {
+            return false;
+        }
+        return tag == quote_etag(etag);
+    }
+
+    bool HttpUtil::if_range_match(const std::string &header, const std::string &etag, time_t mtime)
+    {
+        if (header.empty())
+        {
+            return false;
+        }
+        size_t begin = header.find_first_not_of(" \t");
+        if (begin != std::string::npos && (header[begin] == '"' || header.compare(begin, 2, "W/") == 0))
+        {
+            return etag_match_strong(header, etag);
+        }
+
+        // 日期形式：修改时间距今不足1秒时可能在同一秒内再次修改，不能作为强校验
+        time_t date = parse_http_date(header);
+        return date != -1 && date == mtime && time(nullptr) - mtime >= 1;
+    }
+
+    std::string HttpUtil::html_escape(const std::string &text)
+    {
+        std::string result;
+        result.reserve(text.size());
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '&': result += "&amp;"; break;
+            case '<': result += "&lt;"; break;
+            case '>': result += "&gt;"; break;
+            case '"': result += "&quot;"; break;
+            case '\'': result += "&#39;"; break;
+            default: result += c; break;
+            }
+        }
+        return result;
+    }
+
+    bool HttpUtil::is_not_modified(const zhttp::HttpRequest &req, const std::string &etag, time_t mtime)
+    {
+        // RFC 7232: 存在If-None-Match时忽略If-Modified-Since
+        std::string if_none_match = req.get_header("If-None-Match");
+        if (!if_none_match.empty())
+        {
+            return etag_match(if_none_match, etag);
+        }
+
+        std::string if_modified_since = req.get_header("If-Modified-Since");
+        if (!if_modified_since.empty())
+        {
+            time_t since = parse_http_date(if_modified_since);
+            return since != -1 && mtime <= since;
+        }
+        return false;
+    }
+
+    std::string HttpUtil::choose_encoding(const std::string &accept_encoding,
+                                          const std::vector<std::string> &supported)
+    {
+        if (accept_encoding.empty() || supported.empty())
+        {
+            return "";
+        }
+
+        // 解析 "gzip;q=0.8, br, *;q=0"，记录每种编码的q值
+        std::vector<std::pair<std::string, double>> codings;
+        size_t pos = 0;
+        while (pos < accept_encoding.size())
+        {
+            size_t comma = accept_encoding.find(',', pos);
+            if (comma == std::string::npos)
+                comma = accept_encoding.size();
+            std::string item = accept_encoding.substr(pos, comma - pos);
+            pos = comma + 1;
+
+            double quality = 1.0;
+            size_t semi = item.find(';');
+            if (semi != std::string::npos)
+            {
+                size_t q_pos = item.find("q=", semi);
+                if (q_pos != std::string::npos)
+                    quality = std::strtod(item.c_str() + q_pos + 2, nullptr);
+                item = item.substr(0, semi);
+            }
+
+            size_t begin = item.find_first_not_of(" \t");
+            size_t end = item.find_last_not_of(" \t");
+            if (begin == std::string::npos)
+                continue;
+            std::string name = item.substr(begin, end - begin + 1);
+            for (auto &c : name)
+                c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            codings.emplace_back(name, quality);
+        }
+
+        auto quality_of = [&codings](const std::string &name) {
+            double wildcard = 0.0;
+            for (const auto &coding : codings)
+            {
+                if (coding.first == name)
+                    return coding.second;
+                if (coding.first == "*")
+                    wildcard = coding.second;
+            }
+            return wildcard;
+        };
+
+        std::string best;
+        double best_quality = 0.0;
+        for (const auto &name : supported)
+        {
+            double quality = quality_of(name);
+            if (quality > best_quality)
+            {
+                best = name;
+                best_quality = quality;
+            }
+        }
+        return best;
+    }
+
+    void HttpUtil::set_cache_headers(zhttp::HttpResponse *rsp, const std::string &etag, time_t mtime,
+                                     const std::string &cache_control)
+    {
+        rsp->set_header("ETag", quote_etag(etag));
+        rsp->set_header("Last-Modified", format_http_date(mtime));
+        rsp->set_header("Cache-Control", cache_control);
+    }
+
+    void HttpUtil::set_not_modified(zhttp::HttpResponse *rsp, const std::string &etag, time_t mtime,
+                                    const std::string &cache_control)
+    {
+        rsp->set_status_code(zhttp::HttpResponse::StatusCode::NotModified);
+        rsp->set_status_message("Not Modified");
+        set_cache_headers(rsp, etag, mtime, cache_control);
+        rsp->set_body("");
+    }
+}
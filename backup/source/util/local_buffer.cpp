@@ -0,0 +1,72 @@
+#include "util/local_buffer.h"
+#include <algorithm>
+#include <sys/mman.h>
+#ifdef ZBACKUP_HAVE_NUMA
+#include <numa.h>
+#endif
+
+namespace zbackup::util
+{
+    // 按1MiB对齐分配，减少文件大小略有增长时的反复重分配
+    static constexpr size_t BUFFER_ALIGN = 1024 * 1024;
+
+    LocalBuffer::~LocalBuffer()
+    {
+        release();
+    }
+
+    bool LocalBuffer::reserve(size_t size)
+    {
+        if (data_ != nullptr && size <= capacity_)
+        {
+            return true;
+        }
+        release();
+
+        size_t capacity = std::max<size_t>(1, (size + BUFFER_ALIGN - 1) / BUFFER_ALIGN) * BUFFER_ALIGN;
+        void *ptr = nullptr;
+#ifdef ZBACKUP_HAVE_NUMA
+        if (numa_available() >= 0)
+        {
+            ptr = numa_alloc_local(capacity);
+            if (ptr == nullptr)
+            {
+                return false;
+            }
+        }
+        else
+#endif
+        {
+            // 默认内存策略下，页面落在首次访问它的线程所在节点
+            ptr = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED)
+            {
+                return false;
+            }
+        }
+
+        data_ = static_cast<char *>(ptr);
+        capacity_ = capacity;
+        return true;
+    }
+
+    void LocalBuffer::release()
+    {
+        if (data_ == nullptr)
+        {
+            return;
+        }
+#ifdef ZBACKUP_HAVE_NUMA
+        if (numa_available() >= 0)
+        {
+            numa_free(data_, capacity_);
+        }
+        else
+#endif
+        {
+            munmap(data_, capacity_);
+        }
+        data_ = nullptr;
+        capacity_ = 0;
+    }
+}
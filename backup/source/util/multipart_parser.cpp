@@ -0,0 +1,298 @@
+#include "util/multipart_parser.h"
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
+
+namespace zbackup::util
+{
+    namespace
+    {
+        std::string_view trim(std::string_view str)
+        {
+            size_t begin = str.find_first_not_of(" \t");
+            if (begin == std::string_view::npos)
+                return {};
+            size_t end = str.find_last_not_of(" \t");
+            return str.substr(begin, end - begin + 1);
+        }
+
+        bool iequals(std::string_view a, std::string_view b)
+        {
+            return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+        }
+
+        // 按 ';' 拆分头部参数（引号内的 ';' 不拆分），对每个 key=value 调用 handle
+        template<typename Handle>
+        void for_each_param(std::string_view header, const Handle &handle)
+        {
+            size_t pos = header.find(';');
+            while (pos != std::string_view::npos)
+            {
+                size_t start = pos + 1;
+                bool quoted = false;
+                size_t end = start;
+                for (; end < header.size(); end++)
+                {
+                    if (header[end] == '\\' && quoted)
+                        end++;
+                    else if (header[end] == '"')
+                        quoted = !quoted;
+                    else if (header[end] == ';' && !quoted)
+                        break;
+                }
+                std::string_view item = trim(header.substr(start, std::min(end, header.size()) - start));
+                size_t eq = item.find('=');
+                if (eq != std::string_view::npos)
+                {
+                    std::string value;
+                    std::string_view raw = trim(item.substr(eq + 1));
+                    if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"')
+                    {
+                        // 去掉引号并处理反斜杠转义
+                        for (size_t i = 1; i + 1 < raw.size(); i++)
+                        {
+                            if (raw[i] == '\\' && i + 2 < raw.size())
+                                i++;
+                            value += raw[i];
+                        }
+                    }
+                    else
+                    {
+                        value.assign(raw);
+                    }
+                    handle(trim(item.substr(0, eq)), value);
+                }
+                pos = end < header.size() ? end : std::string_view::npos;
+            }
+        }
+    }
+
+    MultipartParser::MultipartParser(const std::string &boundary)
+        : dash_boundary_("--" + boundary), delimiter_("\r\n--" + boundary)
+    {
+        // Horspool 跳转表：窗口末字符在分隔符中最后一次出现（不含末位）到末尾的距离
+        size_t m = delimiter_.size();
+        skip_.fill(m);
+        for (size_t i = 0; i + 1 < m; i++)
+        {
+            skip_[static_cast<unsigned char>(delimiter_[i])] = m - 1 - i;
+        }
+    }
+
+    bool MultipartParser::extract_boundary(std::string_view content_type, std::string *boundary)
+    {
+        bool found = false;
+        for_each_param(content_type, [&](std::string_view key, const std::string &value)
+        {
+            if (!found && iequals(key, "boundary"))
+            {
+                *boundary = value;
+                found = true;
+            }
+        });
+        return found && !boundary->empty() && boundary->size() <= MAX_BOUNDARY_SIZE &&
+               boundary->find_first_of("\r\n") == std::string::npos;
+    }
+
+    bool MultipartParser::feed(std::string_view data, Sink *sink)
+    {
+        if (state_ == State::FAILED)
+        {
+            return false;
+        }
+
+        if (!carry_.empty())
+        {
+            // 上次剩余的片段与本次开头拼接处理，拼接长度足以越过任意合法的头部或分隔符
+            size_t take = std::min(data.size(), MAX_HEADER_SIZE + delimiter_.size());
+            std::string joined = carry_;
+            joined.append(data.data(), take);
+            size_t used = consume(joined, sink);
+            if (state_ == State::FAILED)
+            {
+                return false;
+            }
+            if (used < carry_.size())
+            {
+                if (take < data.size())
+                {
+                    fail("multipart parser made no progress");
+                    return false;
+                }
+                // 本次数据不足以越过剩余片段，全部留到下次
+                carry_ = joined.substr(used);
+                return true;
+            }
+            data.remove_prefix(used - carry_.size());
+            carry_.clear();
+        }
+
+        size_t used = consume(data, sink);
+        if (state_ == State::FAILED)
+        {
+            return false;
+        }
+        carry_.assign(data.substr(used));
+        return true;
+    }
+
+    size_t MultipartParser::consume(std::string_view input, Sink *sink)
+    {
+        size_t pos = 0;
+        while (true)
+        {
+            switch (state_)
+            {
+            case State::PREAMBLE:
+            {
+                // 第一个分隔符前没有换行，之前的内容（前言）忽略
+                size_t found = input.find(dash_boundary_, pos);
+                if (found == std::string_view::npos)
+                {
+                    size_t keep = std::min(input.size() - pos, dash_boundary_.size() - 1);
+                    return input.size() - keep;
+                }
+                pos = found + dash_boundary_.size();
+                state_ = State::AFTER_BOUNDARY;
+                break;
+            }
+            case State::AFTER_BOUNDARY:
+            {
+                // "--" 表示结束；否则允许行尾空白，之后必须是换行
+                if (input.size() - pos < 2)
+                    return pos;
+                if (input[pos] == '-' && input[pos + 1] == '-')
+                {
+                    state_ = State::DONE;
+                    return input.size();
+                }
+                while (pos < input.size() && (input[pos] == ' ' || input[pos] == '\t'))
+                    pos++;
+                if (input.size() - pos < 2)
+                    return pos;
+                if (input[pos] != '\r' || input[pos + 1] != '\n')
+                    return fail("malformed multipart boundary line");
+                pos += 2;
+                state_ = State::HEADERS;
+                break;
+            }
+            case State::HEADERS:
+            {
+                if (input.size() - pos < 2)
+                    return pos;
+                size_t end;
+                size_t next;
+                if (input[pos] == '\r' && input[pos + 1] == '\n')
+                {
+                    end = pos; // 没有头部
+                    next = pos + 2;
+                }
+                else
+                {
+                    end = input.find("\r\n\r\n", pos);
+                    if (end == std::string_view::npos)
+                    {
+                        if (input.size() - pos > MAX_HEADER_SIZE)
+                            return fail("multipart part headers too large");
+                        return pos;
+                    }
+                    next = end + 4;
+                }
+                if (end - pos > MAX_HEADER_SIZE)
+                    return fail("multipart part headers too large");
+                if (!parse_headers(input.substr(pos, end - pos)))
+                    return fail("malformed multipart part headers");
+                if (!sink->on_part_begin(part_))
+                    return fail("multipart part rejected");
+                pos = next;
+                state_ = State::BODY;
+                break;
+            }
+            case State::BODY:
+            {
+                size_t found = find_delimiter(input, pos);
+                if (found == std::string_view::npos)
+                {
+                    // 末尾可能是不完整的分隔符，保留到下次输入
+                    size_t keep = std::min(input.size() - pos, delimiter_.size() - 1);
+                    size_t safe = input.size() - keep;
+                    if (safe > pos && !sink->on_part_data(input.substr(pos, safe - pos)))
+                        return fail("multipart part rejected");
+                    return safe;
+                }
+                if (found > pos && !sink->on_part_data(input.substr(pos, found - pos)))
+                    return fail("multipart part rejected");
+                if (!sink->on_part_end())
+                    return fail("multipart part rejected");
+                pos = found + delimiter_.size();
+                state_ = State::AFTER_BOUNDARY;
+                break;
+            }
+            case State::DONE:
+                return input.size();
+            case State::FAILED:
+                return pos;
+            }
+        }
+    }
+
+    size_t MultipartParser::find_delimiter(std::string_view input, size_t from) const
+    {
+        const size_t m = delimiter_.size();
+        const char *data = input.data();
+        const char last = delimiter_[m - 1];
+        size_t i = from;
+        while (i + m <= input.size())
+        {
+            char c = data[i + m - 1];
+            if (c == last && memcmp(data + i, delimiter_.data(), m - 1) == 0)
+            {
+                return i;
+            }
+            i += skip_[static_cast<unsigned char>(c)];
+        }
+        return std::string_view::npos;
+    }
+
+    bool MultipartParser::parse_headers(std::string_view block)
+    {
+        part_ = PartHeaders();
+        size_t pos = 0;
+        while (pos < block.size())
+        {
+            size_t eol = block.find("\r\n", pos);
+            if (eol == std::string_view::npos)
+                eol = block.size();
+            std::string_view line = block.substr(pos, eol - pos);
+            pos = eol + 2;
+
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos)
+                return false;
+            std::string_view name = trim(line.substr(0, colon));
+            std::string_view value = trim(line.substr(colon + 1));
+            if (iequals(name, "Content-Disposition"))
+            {
+                for_each_param(value, [this](std::string_view key, const std::string &param)
+                {
+                    if (iequals(key, "name"))
+                        part_.name = param;
+                    else if (iequals(key, "filename"))
+                        part_.filename = param;
+                });
+            }
+            else if (iequals(name, "Content-Type"))
+            {
+                part_.content_type.assign(value);
+            }
+        }
+        return true;
+    }
+
+    size_t MultipartParser::fail(const std::string &reason)
+    {
+        state_ = State::FAILED;
+        error_ = reason;
+        return 0;
+    }
+}
@@ -0,0 +1,155 @@
+#include "util/namespace_path.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace zbackup::util
+{
+    namespace
+    {
+        // FNV-1a 64位哈希：分布均匀，足够用于目录分片
+        uint64_t fnv1a(const std::string &data)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for (unsigned char c : data)
+            {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        // 不需要编码的字节
+        bool is_plain(unsigned char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '.' || c == '_' || c == '-';
+        }
+
+        void encode_byte(unsigned char c, std::string *out)
+        {
+            static const char *HEX = "0123456789ABCDEF";
+            *out += '%';
+            *out += HEX[c >> 4];
+            *out += HEX[c & 0x0f];
+        }
+    }
+
+    bool NamespacePath::normalize(const std::string &path, std::string *normalized)
+    {
+        std::string result;
+        size_t pos = 0;
+        while (pos <= path.size())
+        {
+            size_t end = path.find_first_of("/\\", pos);
+            if (end == std::string::npos)
+                end = path.size();
+            std::string segment = path.substr(pos, end - pos);
+            pos = end + 1;
+
+            if (segment.empty() || segment == ".")
+                continue;
+            if (segment == ".." || segment.size() > MAX_SEGMENT_SIZE)
+                return false;
+            // 控制字符会破坏日志与 tar 头部
+            for (unsigned char c : segment)
+            {
+                if (c < 0x20 || c == 0x7f)
+                    return false;
+            }
+            if (!result.empty())
+                result += '/';
+            result += segment;
+        }
+        if (result.empty())
+        {
+            return false;
+        }
+        *normalized = std::move(result);
+        return true;
+    }
+
+    std::string NamespacePath::sanitize_segment(const std::string &segment, const std::string &fallback)
+    {
+        if (segment.empty())
+        {
+            return fallback;
+        }
+
+        // "."、".." 与 fallback 本身整体编码首字符，避免成为特殊路径段或与空输入冲突
+        bool escape_first = segment == "." || segment == ".." || segment == fallback;
+        std::string result;
+        for (size_t i = 0; i < segment.size(); i++)
+        {
+            auto c = static_cast<unsigned char>(segment[i]);
+            if (is_plain(c) && !(i == 0 && escape_first))
+                result += static_cast<char>(c);
+            else
+                encode_byte(c, &result);
+        }
+        if (result.size() > MAX_SEGMENT_SIZE)
+        {
+            // 截断处不能落在 %XX 中间；'~' 会被编码，不会出现在未截断的结果中
+            size_t keep = MAX_SEGMENT_SIZE - 17;
+            while (keep > 0 && (result[keep - 1] == '%' || (keep > 1 && result[keep - 2] == '%')))
+                keep--;
+            char hex[17];
+            snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(fnv1a(segment)));
+            result = result.substr(0, keep) + "~" + hex;
+        }
+        return result;
+    }
+
+    std::string NamespacePath::percent_encode(const std::string &value)
+    {
+        std::string result;
+        for (unsigned char c : value)
+        {
+            if (is_plain(c))
+                result += static_cast<char>(c);
+            else
+                encode_byte(c, &result);
+        }
+        return result;
+    }
+
+    bool NamespacePath::make_key(const std::string &user, const std::string &host, const std::string &relative_path,
+                                 std::string *key)
+    {
+        std::string result = user + "/" + host + "/" + relative_path;
+        if (result.size() > MAX_KEY_SIZE)
+        {
+            return false;
+        }
+        *key = std::move(result);
+        return true;
+    }
+
+    std::string NamespacePath::shard_path(const std::string &key)
+    {
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(fnv1a(key)));
+
+        // 文件名保留原名便于排查，过长时截断；唯一性由哈希保证
+        size_t slash = key.find_last_of('/');
+        std::string name = slash == std::string::npos ? key : key.substr(slash + 1);
+        if (name.size() > 128)
+        {
+            name.resize(128);
+        }
+        return std::string(hex, 2) + "/" + std::string(hex + 2, 2) + "/" + hex + "_" + name;
+    }
+
+    std::string NamespacePath::version_shard_path(const std::string &key)
+    {
+        // 纳秒时间戳区分不同时刻的上传，序号区分同一时刻的并发上传
+        static std::atomic<uint32_t> sequence{0};
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%016llx%04x",
+                 static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()),
+                 sequence.fetch_add(1, std::memory_order_relaxed) & 0xffff);
+        return shard_path(key) + suffix;
+    }
+}
@@ -0,0 +1,75 @@
+#include "util/rate_limiter.h"
+#include <thread>
+#include <algorithm>
+
+namespace zbackup::util
+{
+    RateLimiter::RateLimiter(size_t rate, size_t burst)
+        : rate_(0), capacity_(0), tokens_(0), last_refill_(std::chrono::steady_clock::now())
+    {
+        set_rate(rate, burst);
+    }
+
+    void RateLimiter::set_rate(size_t rate, size_t burst)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rate_ = rate;
+        // 默认桶容量为1秒的令牌量
+        capacity_ = static_cast<double>(burst > 0 ? burst : rate);
+        tokens_ = capacity_;
+        last_refill_ = std::chrono::steady_clock::now();
+    }
+
+    size_t RateLimiter::get_rate() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rate_;
+    }
+
+    void RateLimiter::refill(std::chrono::steady_clock::time_point now)
+    {
+        std::chrono::duration<double> elapsed = now - last_refill_;
+        tokens_ = std::min(capacity_, tokens_ + elapsed.count() * static_cast<double>(rate_));
+        last_refill_ = now;
+    }
+
+    void RateLimiter::acquire(size_t n)
+    {
+        std::chrono::duration<double> wait{0};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (rate_ == 0)
+            {
+                return;
+            }
+            refill(std::chrono::steady_clock::now());
+            tokens_ -= static_cast<double>(n);
+            if (tokens_ < 0)
+            {
+                wait = std::chrono::duration<double>(-tokens_ / static_cast<double>(rate_));
+            }
+        }
+
+        // 在锁外等待，其他调用者看到的是负余额，会按顺序排在后面
+        if (wait.count() > 0)
+        {
+            std::this_thread::sleep_for(wait);
+        }
+    }
+
+    bool RateLimiter::try_acquire(size_t n)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rate_ == 0)
+        {
+            return true;
+        }
+        refill(std::chrono::steady_clock::now());
+        if (tokens_ < static_cast<double>(n))
+        {
+            return false;
+        }
+        tokens_ -= static_cast<double>(n);
+        return true;
+    }
+}
@@ -0,0 +1,303 @@
+#include "util/reed_solomon.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace zbackup::util
+{
+    namespace
+    {
+        // 生成元为 2 的指数/对数表，指数表加倍长度，乘法时省去取模
+        struct GfTables
+        {
+            std::array<uint8_t, 512> exp{};
+            std::array<uint8_t, 256> log{};
+            std::array<std::array<uint8_t, 256>, 256> mul{}; // 完整乘法表，查表实现逐字节使用
+        };
+
+        const GfTables &tables()
+        {
+            static const GfTables t = []()
+            {
+                GfTables g;
+                unsigned x = 1;
+                for (int i = 0; i < 255; i++)
+                {
+                    g.exp[i] = static_cast<uint8_t>(x);
+                    g.log[x] = static_cast<uint8_t>(i);
+                    x <<= 1;
+                    if (x & 0x100)
+                        x ^= 0x11D;
+                }
+                for (int i = 255; i < 512; i++)
+                {
+                    g.exp[i] = g.exp[i - 255];
+                }
+                for (int a = 1; a < 256; a++)
+                {
+                    for (int b = 1; b < 256; b++)
+                    {
+                        g.mul[a][b] = g.exp[g.log[a] + g.log[b]];
+                    }
+                }
+                return g;
+            }();
+            return t;
+        }
+
+        void mul_add_scalar(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+        {
+            const auto &row = tables().mul[c];
+            for (size_t i = 0; i < len; i++)
+            {
+                dst[i] ^= row[src[i]];
+            }
+        }
+
+#if defined(__x86_64__)
+        // 乘以常数 c 是线性变换：c*x = c*(x 低4位) ^ c*(x 高4位 << 4)，两个16项表用 pshufb 并行查
+        void nibble_tables(uint8_t c, uint8_t *lo, uint8_t *hi)
+        {
+            const auto &row = tables().mul[c];
+            for (int i = 0; i < 16; i++)
+            {
+                lo[i] = row[i];
+                hi[i] = row[i << 4];
+            }
+        }
+
+        __attribute__((target("ssse3")))
+        void mul_add_ssse3(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+        {
+            alignas(16) uint8_t lo[16], hi[16];
+            nibble_tables(c, lo, hi);
+            const __m128i tlo = _mm_load_si128(reinterpret_cast<const __m128i *>(lo));
+            const __m128i thi = _mm_load_si128(reinterpret_cast<const __m128i *>(hi));
+            const __m128i mask = _mm_set1_epi8(0x0F);
+            size_t i = 0;
+            for (; i + 16 <= len; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                __m128i l = _mm_and_si128(v, mask);
+                __m128i h = _mm_and_si128(_mm_srli_epi64(v, 4), mask);
+                __m128i p = _mm_xor_si128(_mm_shuffle_epi8(tlo, l), _mm_shuffle_epi8(thi, h));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(d, p));
+            }
+            mul_add_scalar(c, src + i, dst + i, len - i);
+        }
+
+        __attribute__((target("avx2")))
+        void mul_add_avx2(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+        {
+            alignas(16) uint8_t lo[16], hi[16];
+            nibble_tables(c, lo, hi);
+            // vpshufb 在两个128位通道内分别查表，两个通道放同一张表
+            const __m256i tlo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(lo)));
+            const __m256i thi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(hi)));
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+            size_t i = 0;
+            for (; i + 64 <= len; i += 64)
+            {
+                __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+                __m256i p0 = _mm256_xor_si256(_mm256_shuffle_epi8(tlo, _mm256_and_si256(v0, mask)),
+                                              _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(v0, 4), mask)));
+                __m256i p1 = _mm256_xor_si256(_mm256_shuffle_epi8(tlo, _mm256_and_si256(v1, mask)),
+                                              _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(v1, 4), mask)));
+                __m256i d0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+                __m256i d1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i + 32));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(d0, p0));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), _mm256_xor_si256(d1, p1));
+            }
+            for (; i + 32 <= len; i += 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                __m256i p = _mm256_xor_si256(_mm256_shuffle_epi8(tlo, _mm256_and_si256(v, mask)),
+                                             _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(v, 4), mask)));
+                __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(d, p));
+            }
+            mul_add_scalar(c, src + i, dst + i, len - i);
+        }
+#endif
+
+        std::vector<gf256::Kernel> detect_kernels()
+        {
+            std::vector<gf256::Kernel> found{{"scalar", mul_add_scalar}};
+#if defined(__x86_64__)
+            if (__builtin_cpu_supports("ssse3"))
+            {
+                found.push_back({"ssse3", mul_add_ssse3});
+            }
+            if (__builtin_cpu_supports("avx2"))
+            {
+                found.push_back({"avx2", mul_add_avx2});
+            }
+#endif
+            return found;
+        }
+
+        // 区域运算按段进行，一段内所有源与目标分片同时留在缓存中
+        constexpr size_t SEGMENT_SIZE = 32 * 1024;
+    }
+
+    namespace gf256
+    {
+        uint8_t mul(uint8_t a, uint8_t b)
+        {
+            return tables().mul[a][b];
+        }
+
+        uint8_t inv(uint8_t a)
+        {
+            return a == 0 ? 0 : tables().exp[255 - tables().log[a]];
+        }
+
+        const std::vector<Kernel> &kernels()
+        {
+            static const std::vector<Kernel> all = detect_kernels();
+            return all;
+        }
+
+        const Kernel &best_kernel()
+        {
+            return kernels().back();
+        }
+    }
+
+    ReedSolomon::ReedSolomon(int data_shards, int parity_shards, const gf256::Kernel *kernel)
+        : k_(data_shards), m_(parity_shards), kernel_(kernel ? kernel : &gf256::best_kernel())
+    {
+        if (k_ < 1 || m_ < 0 || k_ + m_ > 256)
+        {
+            throw std::invalid_argument("invalid Reed-Solomon shard counts: " + std::to_string(k_) + "+" +
+                                        std::to_string(m_));
+        }
+        // 柯西矩阵 a(i,j) = 1 / (x_i + y_j)，x_i = k + i，y_j = j 互不相同，任意 k 行（含单位阵的行）都可逆
+        parity_matrix_.resize(static_cast<size_t>(m_) * k_);
+        for (int i = 0; i < m_; i++)
+        {
+            for (int j = 0; j < k_; j++)
+            {
+                parity_matrix_[i * k_ + j] = gf256::inv(static_cast<uint8_t>((k_ + i) ^ j));
+            }
+        }
+    }
+
+    void ReedSolomon::encode(const uint8_t *const *data, uint8_t *const *parity, size_t len) const
+    {
+        for (int i = 0; i < m_; i++)
+        {
+            combine(&parity_matrix_[i * k_], data, k_, parity[i], len);
+        }
+    }
+
+    bool ReedSolomon::reconstruct(uint8_t *const *shards, const bool *present, size_t len, bool rebuild_parity) const
+    {
+        // 取前 k 个可用分片，对应生成矩阵的 k 行组成方阵
+        std::vector<int> rows;
+        for (int i = 0; i < k_ + m_ && static_cast<int>(rows.size()) < k_; i++)
+        {
+            if (present[i])
+                rows.push_back(i);
+        }
+        if (static_cast<int>(rows.size()) < k_)
+        {
+            return false;
+        }
+
+        bool data_missing = false;
+        for (int i = 0; i < k_; i++)
+        {
+            data_missing = data_missing || !present[i];
+        }
+        if (data_missing)
+        {
+            // 高斯-约当消元求逆：decode 的第 d 行给出数据分片 d 由所选分片线性组合的系数
+            std::vector<uint8_t> a(static_cast<size_t>(k_) * k_), decode(static_cast<size_t>(k_) * k_, 0);
+            for (int r = 0; r < k_; r++)
+            {
+                for (int c = 0; c < k_; c++)
+                {
+                    a[r * k_ + c] = rows[r] < k_ ? (rows[r] == c ? 1 : 0) : parity_matrix_[(rows[r] - k_) * k_ + c];
+                }
+                decode[r * k_ + r] = 1;
+            }
+            for (int c = 0; c < k_; c++)
+            {
+                int pivot = c;
+                while (pivot < k_ && a[pivot * k_ + c] == 0)
+                    pivot++;
+                if (pivot == k_)
+                    return false;
+                if (pivot != c)
+                {
+                    for (int j = 0; j < k_; j++)
+                    {
+                        std::swap(a[pivot * k_ + j], a[c * k_ + j]);
+                        std::swap(decode[pivot * k_ + j], decode[c * k_ + j]);
+                    }
+                }
+                uint8_t scale = gf256::inv(a[c * k_ + c]);
+                for (int j = 0; j < k_; j++)
+                {
+                    a[c * k_ + j] = gf256::mul(a[c * k_ + j], scale);
+                    decode[c * k_ + j] = gf256::mul(decode[c * k_ + j], scale);
+                }
+                for (int r = 0; r < k_; r++)
+                {
+                    uint8_t factor = a[r * k_ + c];
+                    if (r == c || factor == 0)
+                        continue;
+                    for (int j = 0; j < k_; j++)
+                    {
+                        a[r * k_ + j] ^= gf256::mul(factor, a[c * k_ + j]);
+                        decode[r * k_ + j] ^= gf256::mul(factor, decode[c * k_ + j]);
+                    }
+                }
+            }
+
+            std::vector<const uint8_t *> srcs(k_);
+            for (int r = 0; r < k_; r++)
+            {
+                srcs[r] = shards[rows[r]];
+            }
+            for (int d = 0; d < k_; d++)
+            {
+                if (!present[d])
+                    combine(&decode[d * k_], srcs.data(), k_, shards[d], len);
+            }
+        }
+
+        if (rebuild_parity)
+        {
+            for (int i = 0; i < m_; i++)
+            {
+                if (!present[k_ + i])
+                    combine(&parity_matrix_[i * k_], shards, k_, shards[k_ + i], len);
+            }
+        }
+        return true;
+    }
+
+    void ReedSolomon::combine(const uint8_t *coefs, const uint8_t *const *srcs, int count, uint8_t *out, size_t len) const
+    {
+        for (size_t offset = 0; offset < len; offset += SEGMENT_SIZE)
+        {
+            size_t n = std::min(SEGMENT_SIZE, len - offset);
+            memset(out + offset, 0, n);
+            for (int j = 0; j < count; j++)
+            {
+                if (coefs[j] != 0)
+                    kernel_->mul_add(coefs[j], srcs[j] + offset, out + offset, n);
+            }
+        }
+    }
+}
@@ -0,0 +1,430 @@
+#include "util/snapshot_manifest.h"
+#include "log/backup_logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace zbackup::util
+{
+    namespace
+    {
+        constexpr char MANIFEST_MAGIC[4] = {'Z', 'B', 'S', 'N'};
+        constexpr char TRAILER_MAGIC[4] = {'Z', 'B', 'S', 'E'};
+        constexpr uint8_t FORMAT_VERSION = 1;
+        constexpr uint8_t TAG_END = 0;
+        constexpr uint8_t TAG_ENTRY = 1;
+        constexpr uint8_t FLAG_CHECKSUM = 1;
+        constexpr size_t TRAILER_SIZE = 8 + 8 + 4 + sizeof(TRAILER_MAGIC);
+        constexpr size_t IO_CHUNK_SIZE = 64 * 1024;
+        constexpr uint64_t MAX_STRING_SIZE = 64 * 1024; // 损坏的清单不能导致超大分配
+
+        void put_varint(std::string *out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out->push_back(static_cast<char>(value));
+        }
+
+        void put_fixed(std::string *out, uint64_t value, size_t bytes)
+        {
+            for (size_t i = 0; i < bytes; i++)
+            {
+                out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+            }
+        }
+
+        uint64_t get_fixed(const char *data, size_t bytes)
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < bytes; i++)
+            {
+                value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+            }
+            return value;
+        }
+
+        void put_string(std::string *out, const std::string &value)
+        {
+            put_varint(out, value.size());
+            out->append(value);
+        }
+
+        // 与上一个值共同前缀的长度 + 不同的后缀
+        void put_delta(std::string *out, const std::string &last, const std::string &value)
+        {
+            size_t shared = 0;
+            size_t limit = std::min(last.size(), value.size());
+            while (shared < limit && last[shared] == value[shared])
+                shared++;
+            put_varint(out, shared);
+            put_varint(out, value.size() - shared);
+            out->append(value, shared, std::string::npos);
+        }
+
+        // 校验值是8位十六进制时按整数存储
+        bool parse_crc(const std::string &hex, uint32_t *value)
+        {
+            if (hex.size() != 8)
+                return false;
+            char *end = nullptr;
+            unsigned long parsed = strtoul(hex.c_str(), &end, 16);
+            if (end != hex.c_str() + hex.size())
+                return false;
+            *value = static_cast<uint32_t>(parsed);
+            return true;
+        }
+
+        bool write_fully(int fd, const char *data, size_t len)
+        {
+            while (len > 0)
+            {
+                ssize_t n = ::write(fd, data, len);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                data += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+    }
+
+    ManifestWriter::~ManifestWriter()
+    {
+        if (fd_ >= 0)
+        {
+            abort();
+        }
+    }
+
+    bool ManifestWriter::open(const std::string &path, const SnapshotHeader &header)
+    {
+        path_ = path;
+        temp_path_ = path + ".tmp";
+        fd_ = ::open(temp_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to create snapshot manifest [{}]: {}", temp_path_, strerror(errno));
+            return false;
+        }
+
+        buffer_.assign(MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC));
+        buffer_.push_back(static_cast<char>(FORMAT_VERSION));
+        put_string(&buffer_, header.id);
+        put_string(&buffer_, header.owner);
+        put_string(&buffer_, header.host);
+        put_string(&buffer_, header.base);
+        put_varint(&buffer_, static_cast<uint64_t>(header.created));
+        return true;
+    }
+
+    bool ManifestWriter::add(const SnapshotEntry &entry)
+    {
+        if (fd_ < 0 || failed_)
+        {
+            return false;
+        }
+
+        buffer_.push_back(static_cast<char>(TAG_ENTRY));
+        put_delta(&buffer_, last_.path, entry.path);
+        put_varint(&buffer_, entry.version);
+        put_varint(&buffer_, entry.size);
+        put_varint(&buffer_, static_cast<uint64_t>(entry.mtime));
+        uint32_t crc = 0;
+        bool has_crc = parse_crc(entry.checksum, &crc);
+        buffer_.push_back(static_cast<char>(has_crc ? FLAG_CHECKSUM : 0));
+        if (has_crc)
+        {
+            put_fixed(&buffer_, crc, 4);
+        }
+        put_delta(&buffer_, last_.real_path, entry.real_path);
+        put_delta(&buffer_, last_.pack_path, entry.pack_path);
+
+        last_.path = entry.path;
+        last_.real_path = entry.real_path;
+        last_.pack_path = entry.pack_path;
+        trailer_.files++;
+        trailer_.bytes += entry.size;
+
+        if (buffer_.size() >= IO_CHUNK_SIZE && !flush())
+        {
+            failed_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool ManifestWriter::finish(SnapshotTrailer *trailer)
+    {
+        if (fd_ < 0)
+        {
+            return false;
+        }
+
+        // 结束标记计入校验值，结尾本身不计入
+        buffer_.push_back(static_cast<char>(TAG_END));
+        if (failed_ || !flush())
+        {
+            abort();
+            return false;
+        }
+        put_fixed(&buffer_, trailer_.files, 8);
+        put_fixed(&buffer_, trailer_.bytes, 8);
+        put_fixed(&buffer_, crc_.value(), 4);
+        buffer_.append(TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+        if (!write_fully(fd_, buffer_.data(), buffer_.size()) || ::fsync(fd_) != 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to write snapshot manifest [{}]: {}", temp_path_, strerror(errno));
+            abort();
+            return false;
+        }
+        ::close(fd_);
+        fd_ = -1;
+
+        if (::rename(temp_path_.c_str(), path_.c_str()) != 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to rename snapshot manifest [{}]: {}", path_, strerror(errno));
+            ::unlink(temp_path_.c_str());
+            return false;
+        }
+        *trailer = trailer_;
+        return true;
+    }
+
+    bool ManifestWriter::flush()
+    {
+        crc_.update(buffer_);
+        if (!write_fully(fd_, buffer_.data(), buffer_.size()))
+        {
+            ZBACKUP_LOG_ERROR("Failed to write snapshot manifest [{}]: {}", temp_path_, strerror(errno));
+            return false;
+        }
+        buffer_.clear();
+        return true;
+    }
+
+    void ManifestWriter::abort()
+    {
+        ::close(fd_);
+        fd_ = -1;
+        ::unlink(temp_path_.c_str());
+    }
+
+    ManifestReader::~ManifestReader()
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+
+    bool ManifestReader::open(const std::string &path, SnapshotHeader *header)
+    {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0)
+        {
+            ZBACKUP_LOG_ERROR("Failed to open snapshot manifest [{}]: {}", path, strerror(errno));
+            return false;
+        }
+
+        uint64_t created = 0;
+        bool valid = fill(sizeof(MANIFEST_MAGIC) + 1) &&
+                     memcmp(buffer_.data(), MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC)) == 0 &&
+                     static_cast<uint8_t>(buffer_[sizeof(MANIFEST_MAGIC)]) == FORMAT_VERSION;
+        if (valid)
+        {
+            pos_ = sizeof(MANIFEST_MAGIC) + 1;
+            valid = read_string(&header->id) && read_string(&header->owner) && read_string(&header->host) &&
+                    read_string(&header->base) && read_varint(&created);
+        }
+        if (!valid)
+        {
+            ZBACKUP_LOG_ERROR("Invalid snapshot manifest header: {}", path);
+            return false;
+        }
+        header->created = static_cast<time_t>(created);
+        return true;
+    }
+
+    bool ManifestReader::next(SnapshotEntry *entry)
+    {
+        if (fd_ < 0 || done_)
+        {
+            return false;
+        }
+
+        uint8_t tag = 0;
+        if (!read_byte(&tag))
+        {
+            return false;
+        }
+        if (tag == TAG_END)
+        {
+            done_ = read_trailer();
+            return false;
+        }
+        if (tag != TAG_ENTRY)
+        {
+            return false;
+        }
+
+        uint64_t version = 0;
+        uint64_t mtime = 0;
+        uint8_t flags = 0;
+        bool valid = read_delta(&last_.path) && read_varint(&version) && read_varint(&entry->size) &&
+                     read_varint(&mtime) && read_byte(&flags);
+        entry->checksum.clear();
+        if (valid && (flags & FLAG_CHECKSUM))
+        {
+            valid = fill(4);
+            if (valid)
+            {
+                char hex[9];
+                snprintf(hex, sizeof(hex), "%08x", static_cast<uint32_t>(get_fixed(buffer_.data() + pos_, 4)));
+                entry->checksum.assign(hex, 8);
+                pos_ += 4;
+            }
+        }
+        valid = valid && read_delta(&last_.real_path) && read_delta(&last_.pack_path);
+        if (!valid)
+        {
+            return false;
+        }
+
+        entry->path = last_.path;
+        entry->version = static_cast<uint32_t>(version);
+        entry->mtime = static_cast<time_t>(mtime);
+        entry->real_path = last_.real_path;
+        entry->pack_path = last_.pack_path;
+        count_++;
+        return true;
+    }
+
+    bool ManifestReader::read_summary(const std::string &path, SnapshotHeader *header, SnapshotTrailer *trailer)
+    {
+        ManifestReader reader;
+        if (!reader.open(path, header))
+        {
+            return false;
+        }
+
+        off_t size = ::lseek(reader.fd_, 0, SEEK_END);
+        char data[TRAILER_SIZE];
+        if (size < static_cast<off_t>(TRAILER_SIZE) ||
+            ::pread(reader.fd_, data, TRAILER_SIZE, size - static_cast<off_t>(TRAILER_SIZE)) !=
+            static_cast<ssize_t>(TRAILER_SIZE) ||
+            memcmp(data + TRAILER_SIZE - sizeof(TRAILER_MAGIC), TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0)
+        {
+            ZBACKUP_LOG_ERROR("Invalid snapshot manifest trailer: {}", path);
+            return false;
+        }
+        trailer->files = get_fixed(data, 8);
+        trailer->bytes = get_fixed(data + 8, 8);
+        return true;
+    }
+
+    bool ManifestReader::fill(size_t n)
+    {
+        if (buffer_.size() - pos_ >= n)
+        {
+            return true;
+        }
+        // 已读过的字节计入校验值后移出缓冲区
+        crc_.update(buffer_.data(), pos_);
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+
+        char chunk[IO_CHUNK_SIZE];
+        while (buffer_.size() < n && !eof_)
+        {
+            ssize_t len = ::read(fd_, chunk, sizeof(chunk));
+            if (len < 0 && errno == EINTR)
+                continue;
+            if (len <= 0)
+            {
+                eof_ = true;
+                break;
+            }
+            buffer_.append(chunk, static_cast<size_t>(len));
+        }
+        return buffer_.size() >= n;
+    }
+
+    bool ManifestReader::read_byte(uint8_t *value)
+    {
+        if (!fill(1))
+            return false;
+        *value = static_cast<uint8_t>(buffer_[pos_++]);
+        return true;
+    }
+
+    bool ManifestReader::read_varint(uint64_t *value)
+    {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t byte = 0;
+            if (!read_byte(&byte))
+                return false;
+            result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                *value = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ManifestReader::read_string(std::string *value)
+    {
+        uint64_t len = 0;
+        if (!read_varint(&len) || len > MAX_STRING_SIZE || !fill(len))
+            return false;
+        value->assign(buffer_, pos_, len);
+        pos_ += len;
+        return true;
+    }
+
+    bool ManifestReader::read_delta(std::string *value)
+    {
+        uint64_t shared = 0;
+        uint64_t len = 0;
+        if (!read_varint(&shared) || shared > value->size() || !read_varint(&len) || len > MAX_STRING_SIZE ||
+            !fill(len))
+            return false;
+        value->resize(shared);
+        value->append(buffer_, pos_, len);
+        pos_ += len;
+        return true;
+    }
+
+    bool ManifestReader::read_trailer()
+    {
+        // 结尾之前的全部字节（含结束标记）都已读过
+        if (!fill(TRAILER_SIZE))
+            return false;
+        crc_.update(buffer_.data(), pos_);
+        const char *data = buffer_.data() + pos_;
+        trailer_.files = get_fixed(data, 8);
+        trailer_.bytes = get_fixed(data + 8, 8);
+        auto crc = static_cast<uint32_t>(get_fixed(data + 16, 4));
+        bool valid = memcmp(data + 20, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) == 0 && crc == crc_.value() &&
+                     trailer_.files == count_;
+        if (!valid)
+        {
+            ZBACKUP_LOG_ERROR("Snapshot manifest checksum mismatch");
+        }
+        return valid;
+    }
+}
@@ -0,0 +1,129 @@
+#include "util/tar_writer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace zbackup::util
+{
+    namespace
+    {
+        constexpr size_t NAME_SIZE = 100;
+        constexpr size_t PREFIX_SIZE = 155;
+        constexpr uint64_t MAX_OCTAL_SIZE = 077777777777ULL; // 12字节字段中11位八进制能表示的最大值
+
+        // 以 digits 位八进制写入数字，末尾补'\0'
+        void put_octal(char *field, size_t digits, uint64_t value)
+        {
+            for (size_t i = digits; i > 0; i--)
+            {
+                field[i - 1] = static_cast<char>('0' + (value & 7));
+                value >>= 3;
+            }
+            field[digits] = '\0';
+        }
+
+        // 超过八进制范围的长度使用 base-256 编码（首字节最高位置1，其余按大端存放）
+        void put_size(char *field, uint64_t size)
+        {
+            if (size <= MAX_OCTAL_SIZE)
+            {
+                put_octal(field, 11, size);
+                return;
+            }
+            field[0] = static_cast<char>(0x80);
+            for (size_t i = 11; i > 0; i--)
+            {
+                field[i] = static_cast<char>(size & 0xff);
+                size >>= 8;
+            }
+        }
+    }
+
+    bool TarWriter::split_name(const std::string &name, size_t *split)
+    {
+        if (name.size() <= NAME_SIZE)
+        {
+            *split = std::string::npos;
+            return true;
+        }
+        // 在 '/' 处拆分，prefix 不超过155字节，剩余部分不超过100字节
+        size_t pos = name.rfind('/', PREFIX_SIZE);
+        if (pos == std::string::npos || pos == 0 || pos + 1 == name.size() || name.size() - pos - 1 > NAME_SIZE)
+        {
+            return false;
+        }
+        *split = pos;
+        return true;
+    }
+
+    std::string TarWriter::pax_records(const std::string &name)
+    {
+        // 记录格式 "<长度> path=<名字>\n"，长度包含自身的位数
+        std::string body = " path=" + name + "\n";
+        size_t len = body.size() + 1;
+        while (std::to_string(len).size() + body.size() != len)
+        {
+            len = std::to_string(len).size() + body.size();
+        }
+        return std::to_string(len) + body;
+    }
+
+    size_t TarWriter::header_size(const std::string &name)
+    {
+        size_t split;
+        if (split_name(name, &split))
+        {
+            return BLOCK_SIZE;
+        }
+        return BLOCK_SIZE + BLOCK_SIZE + padded_size(pax_records(name).size());
+    }
+
+    void TarWriter::write_header(char *out, const std::string &name, uint64_t size, time_t mtime)
+    {
+        size_t split;
+        if (split_name(name, &split))
+        {
+            if (split == std::string::npos)
+                write_block(out, name, std::string(), size, mtime, '0');
+            else
+                write_block(out, name.substr(split + 1), name.substr(0, split), size, mtime, '0');
+            return;
+        }
+
+        // 名字过长：先写 PAX 扩展头，普通头部中的名字截断，解包时以扩展头为准
+        std::string records = pax_records(name);
+        write_block(out, "PaxHeader/" + name.substr(name.size() - (NAME_SIZE - 10)), std::string(),
+                    records.size(), mtime, 'x');
+        out += BLOCK_SIZE;
+        size_t padded = padded_size(records.size());
+        memcpy(out, records.data(), records.size());
+        memset(out + records.size(), 0, padded - records.size());
+        out += padded;
+        write_block(out, name.substr(name.size() - NAME_SIZE), std::string(), size, mtime, '0');
+    }
+
+    void TarWriter::write_block(char *block, const std::string &name, const std::string &prefix, uint64_t size,
+                                time_t mtime, char type)
+    {
+        memset(block, 0, BLOCK_SIZE);
+        memcpy(block, name.data(), std::min(name.size(), NAME_SIZE));
+        put_octal(block + 100, 7, 0644);
+        put_octal(block + 108, 7, 0);
+        put_octal(block + 116, 7, 0);
+        put_size(block + 124, size);
+        put_octal(block + 136, 11, mtime > 0 ? static_cast<uint64_t>(mtime) : 0);
+        block[156] = type;
+        memcpy(block + 257, "ustar", 6);
+        memcpy(block + 263, "00", 2);
+        memcpy(block + 345, prefix.data(), std::min(prefix.size(), PREFIX_SIZE));
+
+        // 校验和按校验和字段全为空格计算
+        memset(block + 148, ' ', 8);
+        unsigned sum = 0;
+        for (size_t i = 0; i < BLOCK_SIZE; i++)
+        {
+            sum += static_cast<unsigned char>(block[i]);
+        }
+        put_octal(block + 148, 6, sum);
+        block[155] = ' ';
+    }
+}
@@ -1,5 +1,8 @@
 #include <utility>
+#include <unistd.h>
 #include "util/util.h"
+#include "util/file_io.h"
+#include "util/fd_cache.h"
 #include "core/service_container.h"
 #include "db_pool/mysql_pool.h"
 #include "db_pool/redis_pool.h"
@@ -19,6 +22,7 @@ namespace zbackup::util
         // 1. 判断文件是否存在
         if (exists() == false)
         {
+            FdCache::get_instance().invalidate(pathname_);
             return true;
         }
 
@@ -27,6 +31,8 @@ namespace zbackup::util
             ZBACKUP_LOG_ERROR("Failed to remove file [{}]: {}", pathname_, strerror(errno));
             return false;
         }
+        // 缓存的描述符仍指向已删除的文件，需要失效
+        FdCache::get_instance().invalidate(pathname_);
         ZBACKUP_LOG_DEBUG("File removed successfully: {}", pathname_);
         return true;
     }
@@ -42,6 +48,7 @@ namespace zbackup::util
         try
         {
             bool result = fs::remove_all(pathname_);
+            FdCache::get_instance().invalidate_tree(pathname_);
             if (result)
             {
                 ZBACKUP_LOG_DEBUG("Directory removed successfully: {}", pathname_);
@@ -140,71 +147,121 @@ namespace zbackup::util
     // 读取文件指定位置和长度的内容
     bool FileUtil::get_pos_len(std::string *body, size_t pos, size_t len)
     {
-        if (exists() == false)
+        body->resize(len);
+        return get_pos_len(&(*body)[0], pos, len);
+    }
+
+    // 读取指定位置和长度的内容到缓冲区：一次open与fstat，读取走FileIO后端
+    bool FileUtil::get_pos_len(char *data, size_t pos, size_t len)
+    {
+        int64_t file_size = 0;
+        int fd = FileIO::open_read(pathname_, &file_size);
+        if (fd < 0)
         {
-            ZBACKUP_LOG_WARN("File not exists: {}", pathname_);
+            if (errno == ENOENT)
+                ZBACKUP_LOG_WARN("File not exists: {}", pathname_);
+            else
+                ZBACKUP_LOG_ERROR("Failed to open file for reading: {}: {}", pathname_, strerror(errno));
             return false;
         }
 
-        int64_t file_size = get_size();
-        if (pos + len > file_size)
+        if (pos + len > static_cast<size_t>(file_size))
         {
             ZBACKUP_LOG_WARN("Read range out of bounds [{}]: pos={}, len={}, file_size={}", pathname_, pos, len,
                              file_size);
+            close(fd);
             return false;
         }
 
-        std::ifstream ifs;
-        ifs.open(pathname_, std::ios::in | std::ios::binary);
-        if (!ifs.is_open())
+        bool ok = FileIO::read_at(fd, data, len, pos);
+        if (!ok)
         {
-            ZBACKUP_LOG_ERROR("Failed to open file for reading: {}", pathname_);
-            return false;
+            ZBACKUP_LOG_ERROR("Failed to read file content: {}: {}", pathname_, strerror(errno));
         }
+        close(fd);
+        return ok;
+    }
 
-        ifs.seekg(pos, std::ios::beg);
-        body->resize(len);
-        ifs.read(&(*body)[0], (size_t)len);
-
-        if (!ifs.good())
+    // 读取整个文件内容
+    bool FileUtil::get_content(std::string *body)
+    {
+        int64_t file_size = 0;
+        int fd = FileIO::open_read(pathname_, &file_size);
+        if (fd < 0)
         {
-            ZBACKUP_LOG_ERROR("Failed to read file content: {}", pathname_);
-            ifs.close();
+            if (errno == ENOENT)
+                ZBACKUP_LOG_WARN("File not exists: {}", pathname_);
+            else
+                ZBACKUP_LOG_ERROR("Failed to open file for reading: {}: {}", pathname_, strerror(errno));
             return false;
         }
 
-        ifs.close();
-        return true;
+        body->resize(file_size);
+        bool ok = FileIO::read_at(fd, &(*body)[0], body->size(), 0);
+        if (!ok)
+        {
+            ZBACKUP_LOG_ERROR("Failed to read file content: {}: {}", pathname_, strerror(errno));
+        }
+        close(fd);
+        return ok;
     }
 
-    // 读取整个文件内容
-    bool FileUtil::get_content(std::string *body)
+    // 写入内容到文件
+    bool FileUtil::set_content(const std::string &body)
     {
-        int64_t file_size = get_size();
-        return get_pos_len(body, 0, file_size);
+        return set_content(body.data(), body.size());
     }
 
-    // 写入内容到文件
-    bool FileUtil::set_content(const std::string &body)
+    // 写入缓冲区内容到文件
+    bool FileUtil::set_content(const char *data, size_t len)
     {
-        std::ofstream ofs;
-        ofs.open(pathname_, std::ios::out | std::ios::binary);
-        if (!ofs.is_open())
+        return set_content(data, len, nullptr);
+    }
+
+    // 分块写入内容到文件，写入每一块后回调
+    bool FileUtil::set_content(const std::string &body, const std::function<void(const char *, size_t)> &on_chunk)
+    {
+        return set_content(body.data(), body.size(), on_chunk);
+    }
+
+    bool FileUtil::set_content(const char *data, size_t len, const std::function<void(const char *, size_t)> &on_chunk)
+    {
+        int fd = FileIO::open_write(pathname_);
+        if (fd < 0)
         {
-            ZBACKUP_LOG_ERROR("Failed to open file for writing: {}", pathname_);
+            ZBACKUP_LOG_ERROR("Failed to open file for writing: {}: {}", pathname_, strerror(errno));
             return false;
         }
 
-        ofs.write(&body[0], body.size());
-        if (!ofs.good())
+        bool ok = FileIO::write_all(fd, data, len, on_chunk);
+        FdCache::get_instance().invalidate(pathname_);
+        if (!ok)
         {
-            ZBACKUP_LOG_ERROR("Failed to write file content: {}", pathname_);
-            ofs.close();
-            return false;
+            ZBACKUP_LOG_ERROR("Failed to write file content: {}: {}", pathname_, strerror(errno));
         }
+        if (close(fd) != 0 && ok)
+        {
+            ZBACKUP_LOG_ERROR("Failed to close file after writing: {}: {}", pathname_, strerror(errno));
+            ok = false;
+        }
+        if (ok)
+        {
+            ZBACKUP_LOG_DEBUG("File written successfully: {} ({} bytes)", pathname_, len);
+        }
+        return ok;
+    }
 
-        ofs.close();
-        ZBACKUP_LOG_DEBUG("File written successfully: {} ({} bytes)", pathname_, body.size());
+    // 重命名文件，成功后本对象指向新路径
+    bool FileUtil::rename_to(const std::string &new_path)
+    {
+        if (rename(pathname_.c_str(), new_path.c_str()) == -1)
+        {
+            ZBACKUP_LOG_ERROR("Failed to rename [{}] to [{}]: {}", pathname_, new_path, strerror(errno));
+            return false;
+        }
+        FdCache::get_instance().invalidate(pathname_);
+        FdCache::get_instance().invalidate(new_path);
+        pathname_ = new_path;
         return true;
     }
 
@@ -224,6 +281,7 @@ namespace zbackup::util
             return false;
         }
         create_file.close();
+        FdCache::get_instance().invalidate(pathname_);
         ZBACKUP_LOG_DEBUG("File created successfully: {}", pathname_);
         return true;
     }
@@ -233,7 +291,9 @@ namespace zbackup::util
     {
         if (exists())
             return true;
-        bool ret = fs::create_directories(pathname_);
+        std::error_code ec;
+        // 并发创建同一目录时，其他线程可能已先创建成功
+        bool ret = fs::create_directories(pathname_, ec) || fs::is_directory(pathname_, ec);
         if (ret == false)
         {
             ZBACKUP_LOG_ERROR("Failed to create directory: {}", pathname_);
@@ -246,16 +306,23 @@ namespace zbackup::util
     }
 
     // 浏览目录
-    void FileUtil::scan_directory(std::vector<std::string> *arry)
+    void FileUtil::scan_directory(std::vector<std::string> *arry, bool recursive)
     {
+        auto add = [arry](const fs::directory_entry &p) {
+            if (!fs::is_directory(p))
+                arry->push_back(fs::path(p).relative_path().string());
+        };
         try
         {
-            for (auto &p : fs::directory_iterator(pathname_))
+            if (recursive)
+            {
+                for (auto &p : fs::recursive_directory_iterator(pathname_, fs::directory_options::skip_permission_denied))
+                    add(p);
+            }
+            else
             {
-                if (fs::is_directory(p))
-                    continue;
-                std::string dir = fs::path(p).relative_path().string();
-                arry->push_back(dir);
+                for (auto &p : fs::directory_iterator(pathname_))
+                    add(p);
             }
             ZBACKUP_LOG_DEBUG("Directory scanned: {} files found in {}", arry->size(), pathname_);
         }
@@ -374,9 +441,14 @@ namespace zbackup::util
         return std::string(buffer);
     }
 
-    std::string get_etag(const info::BackupInfo &info)
+    std::string get_etag(const std::string &path, size_t fsize, time_t mtime)
     {
-        std::string etag = info.real_path_ + std::to_string(info.fsize_) + std::to_string(info.mtime_);
+        std::string etag = path + std::to_string(fsize) + std::to_string(mtime);
         return std::to_string(std::hash<std::string>{}(etag));
     }
+
+    std::string get_etag(const info::BackupInfo &info)
+    {
+        return get_etag(info.real_path_, info.fsize_, info.mtime_);
+    }
 } // namespace zbackup::util
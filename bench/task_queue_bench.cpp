@@ -0,0 +1,198 @@
+// 任务队列微基准：无锁MPMC环形队列 vs 加锁队列、SBO任务 vs std::function、线程池投递/执行吞吐
+// 用法: task_queue_bench [操作数]
+#include "core/threadpool.h"
+#include "core/mpmc_queue.h"
+#include "core/move_only_task.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// 统计堆分配次数，用于验证提交路径是否无分配
+static std::atomic<size_t> g_alloc_count{0};
+
+void *operator new(size_t size)
+{
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    void report(const char *name, size_t ops, Clock::duration elapsed, size_t allocs)
+    {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        printf("%-36s %10zu ops %9.3f ms %12.0f ops/s %8.2f allocs/op\n", name, ops, seconds * 1000,
+               static_cast<double>(ops) / seconds, static_cast<double>(allocs) / static_cast<double>(ops));
+    }
+
+    // 加锁队列，作为对照
+    template<typename T>
+    class MutexQueue
+    {
+    public:
+        bool try_push(T value)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            queue_.push_back(value);
+            return true;
+        }
+
+        bool try_pop(T *value)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (queue_.empty())
+                return false;
+            *value = queue_.front();
+            queue_.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex mtx_;
+        std::deque<T> queue_;
+    };
+
+    // 多生产者多消费者传递指针
+    template<typename Queue>
+    void bench_queue(Queue *queue, const char *name, size_t ops, size_t producers, size_t consumers)
+    {
+        std::atomic<size_t> consumed{0};
+        size_t per_producer = ops / producers;
+        size_t total = per_producer * producers;
+        size_t allocs = g_alloc_count.load();
+        auto begin = Clock::now();
+
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; p++)
+        {
+            threads.emplace_back([queue, per_producer]()
+            {
+                for (size_t i = 0; i < per_producer; i++)
+                {
+                    while (!queue->try_push(reinterpret_cast<void *>(i + 1)))
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for (size_t c = 0; c < consumers; c++)
+        {
+            threads.emplace_back([queue, total, &consumed]()
+            {
+                void *value = nullptr;
+                while (consumed.load(std::memory_order_relaxed) < total)
+                {
+                    if (queue->try_pop(&value))
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for (auto &thread: threads)
+            thread.join();
+        report(name, total, Clock::now() - begin, g_alloc_count.load() - allocs);
+    }
+
+    // 单线程构造+调用小lambda
+    template<typename Wrapper>
+    void bench_wrapper(const char *name, size_t ops)
+    {
+        size_t counter = 0;
+        std::string tag = "task";
+        size_t allocs = g_alloc_count.load();
+        auto begin = Clock::now();
+        for (size_t i = 0; i < ops; i++)
+        {
+            Wrapper task([&counter, i, &tag]() { counter += i + tag.size(); });
+            task();
+        }
+        report(name, ops, Clock::now() - begin, g_alloc_count.load() - allocs);
+        if (counter == 0)
+            printf("unexpected\n");
+    }
+
+    // 旧版提交路径：std::function + shared_ptr<packaged_task>
+    void bench_legacy_wrapper(size_t ops)
+    {
+        size_t counter = 0;
+        size_t allocs = g_alloc_count.load();
+        auto begin = Clock::now();
+        for (size_t i = 0; i < ops; i++)
+        {
+            auto task = std::make_shared<std::packaged_task<void()> >([&counter, i]() { counter += i; });
+            auto future = task->get_future();
+            std::function<void()> wrapper([task]() { (*task)(); });
+            wrapper();
+        }
+        report("function+shared_ptr<packaged_task>", ops, Clock::now() - begin, g_alloc_count.load() - allocs);
+    }
+
+    // 线程池端到端：外部线程提交，等待全部执行完
+    template<typename Submit>
+    void bench_pool(const char *name, size_t ops, Submit submit)
+    {
+        std::atomic<size_t> done{0};
+        size_t allocs = g_alloc_count.load();
+        auto begin = Clock::now();
+        for (size_t i = 0; i < ops; i++)
+        {
+            while (!submit(&done))
+                std::this_thread::yield();
+        }
+        while (done.load(std::memory_order_relaxed) < ops)
+            std::this_thread::yield();
+        report(name, ops, Clock::now() - begin, g_alloc_count.load() - allocs);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    zbackup::Log::Init(zlog::LogLevel::value::WARN);
+    size_t ops = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    using zbackup::core::TaskPriority;
+    using zbackup::core::SubmitStatus;
+
+    {
+        zbackup::core::BoundedMpmcQueue<void *> ring(4096);
+        MutexQueue<void *> locked;
+        bench_queue(&ring, "queue mpmc-ring 4P/4C", ops, 4, 4);
+        bench_queue(&locked, "queue mutex-deque 4P/4C", ops, 4, 4);
+        bench_queue(&ring, "queue mpmc-ring 1P/1C", ops, 1, 1);
+        bench_queue(&locked, "queue mutex-deque 1P/1C", ops, 1, 1);
+    }
+
+    bench_wrapper<zbackup::core::MoveOnlyTask>("task MoveOnlyTask", ops);
+    bench_wrapper<std::function<void()> >("task std::function", ops);
+    bench_legacy_wrapper(ops);
+
+    auto pool = zbackup::core::ThreadPool::get_instance();
+    pool->set_task_max_count(4096);
+    pool->start();
+    // 预热节点池
+    bench_pool("pool warmup", ops / 10, [pool](std::atomic<size_t> *done)
+    {
+        return pool->try_post_task(TaskPriority::NORMAL, [done]() { done->fetch_add(1); }) == SubmitStatus::ACCEPTED;
+    });
+    bench_pool("pool try_post_task", ops, [pool](std::atomic<size_t> *done)
+    {
+        return pool->try_post_task(TaskPriority::NORMAL, [done]() { done->fetch_add(1); }) == SubmitStatus::ACCEPTED;
+    });
+    bench_pool("pool submit_task (future)", ops, [pool](std::atomic<size_t> *done)
+    {
+        return pool->try_submit_task([done]() { done->fetch_add(1); }).accepted();
+    });
+    return 0;
+}
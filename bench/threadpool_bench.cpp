@@ -0,0 +1,116 @@
+// 线程池基准测试：对比旧版单队列线程池与工作窃取线程池的提交/执行吞吐
+// 用法: threadpool_bench [任务数] [线程数]
+#include "legacy_threadpool.h"
+#include "core/threadpool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // 模拟很小的任务体（热点扫描提交的单个任务在入队阶段的开销远大于此）
+    void tiny_work(std::atomic<size_t> *done)
+    {
+        done->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void wait_done(const std::atomic<size_t> &done, size_t expected)
+    {
+        while (done.load(std::memory_order_relaxed) < expected)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    void report(const char *pool, const char *scenario, size_t tasks, Clock::duration elapsed)
+    {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        printf("%-14s %-22s %10zu tasks %9.3f ms %12.0f tasks/s\n", pool, scenario, tasks,
+               seconds * 1000, static_cast<double>(tasks) / seconds);
+    }
+
+    // 场景1：外部线程连续提交
+    template<typename Pool>
+    void bench_external(Pool *pool, const char *name, size_t tasks)
+    {
+        std::atomic<size_t> done{0};
+        auto begin = Clock::now();
+        for (size_t i = 0; i < tasks; i++)
+        {
+            pool->submit_task(tiny_work, &done);
+        }
+        wait_done(done, tasks);
+        report(name, "external submit", tasks, Clock::now() - begin);
+    }
+
+    // 场景2：池内单个任务突发提交（模拟 BackupLooper 扫描后批量提交压缩任务）
+    template<typename Pool>
+    void bench_fan_out(Pool *pool, const char *name, size_t tasks)
+    {
+        std::atomic<size_t> done{0};
+        auto begin = Clock::now();
+        pool->submit_task([pool, tasks, &done]()
+        {
+            for (size_t i = 0; i < tasks; i++)
+            {
+                pool->submit_task(tiny_work, &done);
+            }
+        });
+        wait_done(done, tasks);
+        report(name, "in-pool fan-out", tasks, Clock::now() - begin);
+    }
+
+    // 场景3：多个外部生产者并发提交
+    template<typename Pool>
+    void bench_multi_producer(Pool *pool, const char *name, size_t tasks, size_t producers)
+    {
+        std::atomic<size_t> done{0};
+        size_t per_producer = tasks / producers;
+        auto begin = Clock::now();
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; p++)
+        {
+            threads.emplace_back([pool, per_producer, &done]()
+            {
+                for (size_t i = 0; i < per_producer; i++)
+                {
+                    pool->submit_task(tiny_work, &done);
+                }
+            });
+        }
+        for (auto &thread: threads)
+        {
+            thread.join();
+        }
+        wait_done(done, per_producer * producers);
+        report(name, "multi-producer", per_producer * producers, Clock::now() - begin);
+    }
+
+    template<typename Pool>
+    void run_all(Pool *pool, const char *name, size_t tasks, size_t threads)
+    {
+        // 放开队列上限，只比较调度本身的开销
+        pool->set_task_max_count(tasks + 1);
+        pool->start(threads);
+        bench_external(pool, name, tasks);
+        bench_fan_out(pool, name, tasks);
+        bench_multi_producer(pool, name, tasks, 4);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    zbackup::Log::Init(zlog::LogLevel::value::WARN);
+
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : zbackup::core::DEFAULT_THREAD_NUM;
+    printf("tasks=%zu threads=%zu\n", tasks, threads);
+
+    run_all(zbackup::bench::LegacyThreadPool::get_instance(), "legacy", tasks, threads);
+    run_all(zbackup::core::ThreadPool::get_instance(), "work-stealing", tasks, threads);
+    return 0;
+}